@@ -0,0 +1,204 @@
+#ifndef SimTK_SimTKCOMMON_REALIZATION_PROFILE_H_
+#define SimTK_SimTKCOMMON_REALIZATION_PROFILE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This file declares the RealizationProfile class, which records where a
+ * System's realize() calls spend their time.
+ */
+
+#include "SimTKcommon/basics.h"
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+
+namespace SimTK {
+
+class SubsystemIndex;
+
+/** Statistics about the realization of a System, broken down by Subsystem and
+Stage. Profiling is off by default and costs next to nothing then; turn it on
+with System::setRealizationProfilingEnabled() and obtain the results with
+System::getRealizationProfile().
+
+For each Subsystem and Stage this records
+  - the number of calls to the Subsystem's realize method for that Stage that
+    did something (that is, found the Subsystem below that Stage),
+  - the wall clock time spent in them, including the Subsystem's Measures,
+  - the number of heap allocations made during them, if you have installed an
+    allocation counter with setAllocationCounter(), and
+  - the number of times a cache entry of the Subsystem that depends on that
+    Stage was marked realized, by whatever code computed it.
+
+The same quantities are recorded for each System-level stage realization,
+which include all the Subsystem realizations at that Stage; the System's
+Topology realization also includes the Model realization of its default
+State. Cache entries are
+attributed only when they are realized on the thread that is realizing the
+System; that includes lazily evaluated entries only if they are evaluated
+during a realize() call.
+
+Timing is inclusive: if one Subsystem's realize method realizes something on
+behalf of another, both are charged for it. The counters can be updated from
+several threads at once, for example when different States of one System are
+realized concurrently. **/
+class SimTK_SimTKCOMMON_EXPORT RealizationProfile {
+public:
+    /** A function returning the number of heap allocations made so far by the
+    process (or by the calling thread). See setAllocationCounter(). **/
+    typedef long long (*AllocationCounter)();
+
+    RealizationProfile();
+
+    /** Zero all the statistics. **/
+    void clear();
+
+    /** Return the number of Subsystems for which statistics are available.
+    This is zero until the System has been realized while profiling. **/
+    int getNumSubsystems() const;
+    /** Return the name of a Subsystem, as reported by the System. **/
+    const String& getSubsystemName(SubsystemIndex subsys) const;
+
+    /** Number of calls to \a subsys's realize method for \a stage that did
+    something. **/
+    long long getNumCalls(SubsystemIndex subsys, Stage stage) const;
+    /** Total wall clock time in seconds spent in those calls. **/
+    double getWallTime(SubsystemIndex subsys, Stage stage) const;
+    /** Number of heap allocations made during those calls, as measured by the
+    allocation counter; always zero if there is none. **/
+    long long getNumAllocations(SubsystemIndex subsys, Stage stage) const;
+    /** Number of times a cache entry of \a subsys that depends on \a stage
+    was marked realized. **/
+    long long getNumCacheEntryRealizations(SubsystemIndex subsys,
+                                           Stage stage) const;
+
+    /** Number of System-level realizations of \a stage. **/
+    long long getNumCalls(Stage stage) const;
+    /** Wall clock time in seconds spent realizing \a stage for the whole
+    System. **/
+    double getWallTime(Stage stage) const;
+    /** Heap allocations made while realizing \a stage for the whole System. **/
+    long long getNumAllocations(Stage stage) const;
+
+    /** Write one line per Subsystem and Stage that has any nonzero statistic,
+    preceded by the System-level lines (with an empty subsystem index and the
+    name "System") and a header line. The columns are subsystem, name, stage,
+    calls, seconds, allocations, cacheEntries. **/
+    void writeCSV(std::ostream& o) const;
+    /** Write the same information as writeCSV() as a JSON object with arrays
+    "system" and "subsystems". **/
+    void writeJSON(std::ostream& o) const;
+
+    /** Install a function that the profiler calls before and after each
+    realization to count heap allocations, or remove it by passing null. The
+    library does not replace operator new itself; an application that does so
+    to count allocations can make the counts available here. This affects all
+    Systems. **/
+    static void setAllocationCounter(AllocationCounter counter);
+    /** Return the installed allocation counter, or null. **/
+    static AllocationCounter getAllocationCounter();
+
+    /** @cond **/ // Internal use only.
+    // Number of Systems that currently have profiling turned on; when it is
+    // zero none of the hooks below do anything.
+    static bool isAnyProfilingEnabled()
+    {   return numEnabled.load(std::memory_order_relaxed) != 0; }
+    static void noteProfilingEnabled(bool enabled);
+
+    // Called by the State when a cache entry is marked realized.
+    static void noteCacheEntryRealized(int subsys, Stage dependsOn);
+
+    // While one of these exists, realizations on this thread are recorded in
+    // the given profile (if non-null). It is created by the System's realize
+    // methods.
+    class SimTK_SimTKCOMMON_EXPORT Activation {
+    public:
+        explicit Activation(RealizationProfile* profile)
+        :   previous(nullptr), active(profile != nullptr)
+        {   if (active) previous = activate(profile); }
+        ~Activation() {if (active) activate(previous);}
+    private:
+        static RealizationProfile* activate(RealizationProfile* profile);
+        RealizationProfile* previous;
+        bool                active;
+        Activation(const Activation&) = delete;
+        Activation& operator=(const Activation&) = delete;
+    };
+
+    // Times one realization of a Subsystem (subsys >= 0) or of the whole
+    // System (subsys == -1) on behalf of the active profile, if any.
+    class SimTK_SimTKCOMMON_EXPORT Timer {
+    public:
+        Timer(int subsys, Stage stage)
+        :   profile(isAnyProfilingEnabled() ? getActive() : nullptr)
+        {   if (profile) start(subsys, stage); }
+        ~Timer() {if (profile) stop();}
+    private:
+        static RealizationProfile* getActive();
+        void start(int subsys, Stage stage);
+        void stop();
+        RealizationProfile* profile;
+        int                 subsys;
+        Stage               stage;
+        long long           allocationsAtStart;
+        std::chrono::steady_clock::time_point startTime;
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    void setSubsystemNames(const Array_<String>& names);
+    /** @endcond **/
+
+private:
+    struct Entry {
+        Entry() : numCalls(0), wallTime(0), numAllocations(0),
+                  numCacheEntryRealizations(0) {}
+        bool isEmpty() const
+        {   return !numCalls && !numAllocations && !numCacheEntryRealizations; }
+        long long   numCalls;
+        double      wallTime;
+        long long   numAllocations;
+        long long   numCacheEntryRealizations;
+    };
+
+    // Row 0 is the System; row i+1 is subsystem i.
+    const Entry& getEntry(int subsys, Stage stage) const;
+    Entry& updEntry(int subsys, Stage stage); // grows as needed; lock held
+
+    RealizationProfile(const RealizationProfile&) = delete;
+    RealizationProfile& operator=(const RealizationProfile&) = delete;
+
+    mutable std::mutex  mutex;
+    Array_<Entry>       entries; // (subsys+1)*Stage::NValid + stage
+    Array_<String>      names;
+
+    static std::atomic<int> numEnabled;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_REALIZATION_PROFILE_H_
@@ -33,6 +33,7 @@ done in a separate internal class. **/
 #include "SimTKcommon/basics.h"
 #include "SimTKcommon/Simmatrix.h"
 #include "SimTKcommon/internal/Event.h"
+#include "SimTKcommon/internal/RealizationProfile.h"
 
 #include <ostream>
 #include <cassert>
@@ -336,6 +337,28 @@ void clear();
 /// two states.
 bool isConsistent(const SimTK::State& otherState) const;
 
+/// Returns true if copyValuesFrom() can be used to make this %State take on
+/// the values in `source`. That requires both states to come from the same
+/// realization of Instance stage, which is the case for a copy of `source`
+/// (or `source` a copy of this %State, or both copies of a common state) as
+/// long as neither has had Instance stage or an earlier one invalidated
+/// since. Two independently created or re-realized states are never
+/// compatible, even if their stage versions happen to agree. (Changing a
+/// discrete variable that invalidates Instance stage or earlier counts as
+/// invalidating Instance stage.) Value versions are not used for this; each
+/// %State counts its own changes, so versions can't be compared between
+/// states.
+bool canCopyValuesFrom(const State& source) const;
+
+/// Copy time, the continuous variables y, and the discrete variables that
+/// invalidate Time stage or later from `source` into this %State, in place.
+/// Everything through Instance stage is kept, including the cache, and
+/// nothing is allocated, so this is much cheaper than copy assignment when
+/// the same pair of states is copied repeatedly, as an integrator does. This
+/// %State is left realized through Instance stage. Throws if
+/// canCopyValuesFrom(source) is false.
+void copyValuesFrom(const State& source);
+
 /// Set the number of subsystems in this state. This is done during
 /// initialization of the State by a System; it completely wipes out
 /// anything that used to be in the State so use cautiously!
@@ -0,0 +1,138 @@
+#ifndef SimTK_SimTKCOMMON_STATE_HISTORY_H_
+#define SimTK_SimTKCOMMON_STATE_HISTORY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This file declares the StateHistory class, a ring buffer of State
+ * checkpoints for rolling a simulation back.
+ */
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/Simmatrix.h"
+#include "SimTKcommon/internal/State.h"
+
+#include <memory>
+
+namespace SimTK {
+
+class System;
+
+/** A fixed-size ring buffer of checkpoints of a State, for rolling a
+simulation back to an earlier time and running it again from there. Once the
+buffer is full, each new checkpoint replaces the oldest one.
+
+A checkpoint doesn't hold a whole State. Consecutive checkpoints of a
+simulation normally share everything through Instance stage, so a full copy
+of the State is made only for the first checkpoint and whenever something at
+Instance stage or earlier has changed since the previous one (see
+State::canCopyValuesFrom()). Each checkpoint otherwise records just the time,
+the continuous variables y, and the values of the discrete variables that
+invalidate Time stage or later. Recording reuses the checkpoint's storage, so
+once the buffer has been filled recording a checkpoint normally doesn't
+allocate.
+
+Restoring a checkpoint costs the same regardless of how far back it is. The
+State being restored into is updated in place when it shares its Instance
+stage with the checkpoint, as it does when it is the State that was recorded,
+and is otherwise replaced by a copy of the checkpoint's full State first.
+Either way, the restored State is realized only through Instance stage unless
+you ask for it to be realized further.
+
+Checkpoints are numbered from 0 for the oldest to getNumCheckpoints()-1 for
+the newest, and their times must not decrease. To roll back, restore a
+checkpoint found with findCheckpoint() and then discardCheckpointsAfter() it
+so that new checkpoints can be recorded as the simulation is repeated.
+@see TimeStepper::setStateHistoryCapacity() **/
+class SimTK_SimTKCOMMON_EXPORT StateHistory {
+public:
+    /** Create a history that keeps at most \a capacity checkpoints. A
+    capacity of zero is allowed; nothing is recorded then. **/
+    explicit StateHistory(int capacity=0);
+
+    /** Change the maximum number of checkpoints. This clears the history. **/
+    void setCapacity(int capacity);
+    /** Return the maximum number of checkpoints kept. **/
+    int getCapacity() const {return (int)m_checkpoints.size();}
+
+    /** Return the number of checkpoints currently held. **/
+    int getNumCheckpoints() const {return m_numCheckpoints;}
+    /** Forget all checkpoints. The storage is kept for reuse. **/
+    void clear();
+
+    /** Add a checkpoint of \a state, replacing the oldest one if the history
+    is full. The State must have been realized through Instance stage, and its
+    time must be no earlier than that of the newest checkpoint. Nothing
+    happens if the capacity is zero. **/
+    void record(const State& state);
+
+    /** Return the time of checkpoint \a i. **/
+    Real getCheckpointTime(int i) const;
+
+    /** Return the newest checkpoint whose time is at or before \a time, or
+    -1 if there isn't one. **/
+    int findCheckpoint(Real time) const;
+
+    /** Make \a state a copy of checkpoint \a i. The restored State is
+    realized through Instance stage. **/
+    void restore(int i, State& state) const;
+
+    /** Restore checkpoint \a i into \a state as above, then realize it
+    through \a stage using \a system, which must be the System whose State
+    was recorded. **/
+    void restore(int i, const System& system, State& state, Stage stage) const;
+
+    /** Forget the checkpoints newer than checkpoint \a i, so that the next
+    one recorded follows it. Use -1 to forget them all. **/
+    void discardCheckpointsAfter(int i);
+
+    /** (Advanced) Return the number of full State copies currently held by
+    the checkpoints. Normally this is one. **/
+    int getNumFullStates() const;
+
+private:
+    struct Checkpoint {
+        std::shared_ptr<const State>    full;  // shared by later checkpoints
+        Real                            t;
+        Vector                          y;
+        // Discrete variables that invalidate Time stage or later, unless
+        // the full State was copied from this checkpoint's State. Only the
+        // first numChanged values are in use; the rest are kept so their
+        // storage can be reused.
+        Array_<DiscreteVarKey>          changedVars;
+        Array_<ClonePtr<AbstractValue>> changedValues;
+        int                             numChanged{0};
+    };
+
+    int getSlot(int i) const;
+    const Checkpoint& getCheckpoint(int i) const;
+
+    Array_<Checkpoint>  m_checkpoints;
+    int                 m_oldest{0};
+    int                 m_numCheckpoints{0};
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_STATE_HISTORY_H_
@@ -144,10 +144,97 @@ private:
 // discrete variable and cache entry *values* must remain in a fixed location in 
 // memory once allocated, because callers are permitted to retain references to
 // these values once they have been allocated. So pointers to the AbstractValues
-// are kept in these objects, and only the pointers are copied around. That 
-// means the actual value object will not be deleted by the destructor; be sure
-// to do that explicitly in the higher-level destructor or you'll have a nasty
-// leak.
+// are kept in these objects, and only the pointers are copied around. 
+//
+// Copying a State need not clone every value, though; see StateValue below.
+
+//==============================================================================
+//                               STATE VALUE
+//==============================================================================
+// Holds the value of a discrete variable or cache entry. Normally the State
+// owns the value object outright. A copied State may instead borrow a
+// read-only snapshot of the source's value. The source makes the snapshot
+// when it is copied, keeps it for later copies, and drops it as soon as it
+// hands out write access to its own value. So the source's value object
+// never moves and is never seen by another State, and a snapshot is never
+// written by anyone, which makes it safe to share between States in
+// different threads. A borrowing State makes its own value object when it
+// first asks for write access, taking over the snapshot if no one else
+// holds it any more; from then on its value stays at a fixed address, too.
+//
+// Making a snapshot costs a clone, which only pays off if the value is still
+// unchanged at the next copy. Values written between every pair of copies
+// (most cache entries, while time stepping) are therefore cloned straight
+// into each copy as they always were; a value is snapshotted only when it is
+// copied a second time without having been written in between. Whatever a
+// value's stage, a copy never costs more than one clone of it.
+class StateValue {
+public:
+    StateValue() = default;
+    explicit StateValue(AbstractValue* v) : m_own(v) {}
+
+    // Copying borrows the source's snapshot if it has one, otherwise it
+    // clones the source's value. Call prepareToCopy() on the source first.
+    StateValue(const StateValue& src) {*this = src;}
+    StateValue& operator=(const StateValue& src) {
+        if (&src == this) return *this;
+        if (src.m_snapshot.empty()) m_own.reset(src.getRef().clone());
+        else                        m_own.reset();
+        m_snapshot = src.m_snapshot;
+        m_writtenSinceCopied = true;
+        return *this;
+    }
+    StateValue(StateValue&&) = default;
+    StateValue& operator=(StateValue&&) = default;
+
+    bool empty() const {return m_own.empty() && m_snapshot.empty();}
+    explicit operator bool() const {return !empty();}
+
+    const AbstractValue& getRef() const 
+    {   return m_own.empty() ? m_snapshot.getRef() : m_own.getRef(); }
+
+    // Any snapshot is dropped since it may no longer match.
+    AbstractValue& updRef() {
+        if (m_own.empty()) 
+            m_own.reset(m_snapshot.release()); // clones only if still shared
+        else
+            m_snapshot.reset();
+        m_writtenSinceCopied = true;
+        return m_own.updRef();
+    }
+
+    // Decide whether copies of this value should share a snapshot of it:
+    // only if it hasn't been written since it was last copied. This changes
+    // a const object, so the containing State must be protected from
+    // concurrent copies while this is called; see StateImpl::copyFrom().
+    void prepareToCopy() const {
+        if (m_own.empty() || !m_snapshot.empty())
+            return; // already shared
+        if (m_writtenSinceCopied)
+            m_writtenSinceCopied = false;
+        else
+            m_snapshot.reset(m_own.getRef().clone());
+    }
+
+    // Both values are known to be equal because they have the same snapshot.
+    bool hasSameSnapshotAs(const StateValue& other) const {
+        return !m_snapshot.empty() 
+            && m_snapshot.get() == other.m_snapshot.get(); 
+    }
+
+    // Exchange values; each ends up owning its new value.
+    void swap(StateValue& other) {
+        updRef(); other.updRef();
+        m_own.swap(other.m_own);
+    }
+
+    void reset() {m_own.reset(); m_snapshot.reset();}
+
+private:
+    ClonePtr<AbstractValue>                 m_own;      // null if borrowing
+    mutable CloneOnWritePtr<AbstractValue>  m_snapshot; // never written
+    mutable bool                            m_writtenSinceCopied{true};
+};
 
 //==============================================================================
 //                           DISCRETE VAR INFO
@@ -163,10 +250,11 @@ public:
 
     // Default copy constructor, copy assignment, destructor are shallow.
 
-    // Use this to make this entry contain a *copy* of the source value.
-    // If the destination already has a value, the new value must be
-    // assignment compatible.
+    // Use this to make this entry contain a *copy* of the source value,
+    // possibly a shared snapshot (see StateValue above); the source State
+    // must be locked against concurrent copies.
     DiscreteVarInfo& deepAssign(const DiscreteVarInfo& src) {
+        src.m_value.prepareToCopy();
         *this = src; // copy assignment forgets dependents
         return *this;
     }
@@ -179,10 +267,11 @@ public:
     const Stage& getAllocationStage()  const {return m_allocationStage;}
 
     // Exchange value pointers (should be from this dv's update cache entry).
-    void swapValue(Real updTime, ClonePtr<AbstractValue>& other) 
+    void swapValue(Real updTime, StateValue& other) 
     {   m_value.swap(other); m_timeLastUpdated=updTime; }
 
-    const AbstractValue& getValue() const {assert(m_value); return *m_value;}
+    const AbstractValue& getValue() const 
+    {   assert(m_value); return m_value.getRef(); }
 
     // Whenever we hand out this variables value for write access we update
     // the value version, note the update time, and notify any dependents that
@@ -192,8 +281,26 @@ public:
        ++m_valueVersion;
        m_timeLastUpdated=updTime; 
        m_dependents.notePrerequisiteChange(stateImpl);
-       return *m_value; 
+       return m_value.updRef(); 
+    }
+
+    // Assign the source variable's value to this one's existing value object,
+    // which must be assignment compatible, and note the change as updValue()
+    // does. The update time is copied from the source but the value version
+    // is not: it only ever increases, so that this State's dependents see
+    // the change.
+    void copyValueFrom(const StateImpl& stateImpl, const DiscreteVarInfo& src) {
+       assert(m_value && src.m_value);
+       if (!m_value.hasSameSnapshotAs(src.m_value))
+           m_value.updRef().compatibleAssign(src.m_value.getRef());
+       ++m_valueVersion;
+       m_timeLastUpdated=src.m_timeLastUpdated;
+       m_dependents.notePrerequisiteChange(stateImpl);
     }
+    // The value version counts changes made to this variable in this State.
+    // Copies start out with the source's version but then count their own
+    // changes, so two States can reach the same version with different
+    // values; versions must not be compared across States.
     ValueVersion getValueVersion() const {return m_valueVersion;}
     Real getTimeLastUpdated() const 
     {   assert(m_value); return m_timeLastUpdated; }
@@ -218,7 +325,7 @@ private:
     ResetOnCopy<ListOfDependents>   m_dependents;
 
     // These change at run time.
-    ClonePtr<AbstractValue>         m_value;
+    StateValue                      m_value;
     ValueVersion                    m_valueVersion{1};
     Real                            m_timeLastUpdated{NaN};
 
@@ -226,7 +333,7 @@ private:
     {    return (m_allocationStage==Stage::Topology 
                  || m_allocationStage==Stage::Model)
              && (m_invalidatedStage > m_allocationStage)
-             && (m_value != nullptr); }
+             && !m_value.empty(); }
 };
 
 
@@ -331,8 +438,11 @@ public:
         m_dependents.notePrerequisiteChange(stateImpl);
     }
 
-    // Use this to make this entry contain a *copy* of the source value.
+    // Use this to make this entry contain a *copy* of the source value,
+    // possibly a shared snapshot (see StateValue above); the source State
+    // must be locked against concurrent copies.
     CacheEntryInfo& deepAssign(const CacheEntryInfo& src) {
+        src.m_value.prepareToCopy();
         *this = src; // copy assignment forgets dependents
         return *this;
     }
@@ -351,17 +461,18 @@ public:
     void swapValue(Real updTime, DiscreteVarInfo& dv) 
     {   dv.swapValue(updTime, m_value); }
 
-    const AbstractValue& getValue() const {assert(m_value); return *m_value;}
+    const AbstractValue& getValue() const 
+    {   assert(m_value); return m_value.getRef(); }
 
     // Merely handing out the cache entry's value with write access does not
     // trigger invalidation of dependents. (Maybe it should, but currently it
     // gets done often with no intent to modify, esp. by SBStateDigest.)
     // So be sure that the cache entry gets invalidated first either by an
     // explicit prerequisite change notification, or because the depends-on
-    // stage got invalidated.
+    // stage got invalidated. A borrowed value is cloned here.
     AbstractValue& updValue(const StateImpl& stateImpl) {
        assert(m_value); 
-       return *m_value; 
+       return m_value.updRef(); 
     }
     ValueVersion getValueVersion() const {return m_valueVersion;}
 
@@ -424,7 +535,7 @@ private:
     // prerequisites so we are up to date with respect to them. We'll change
     // the initial value to false in registerWithPrerequisites() if there
     // are some.
-    ClonePtr<AbstractValue>     m_value;
+    StateValue                  m_value;
     ValueVersion                m_valueVersion{1};
     StageVersion                m_dependsOnVersionWhenLastComputed{0};
     bool                        m_isUpToDateWithPrerequisites{true};
@@ -445,7 +556,7 @@ private:
                 || m_allocationStage==Stage::Model
                 || m_allocationStage==Stage::Instance)
             && (m_computedByStage >= m_dependsOnStage)
-            && (m_value != nullptr)
+            && !m_value.empty()
             && (m_dependsOnVersionWhenLastComputed >= 0)
             && (ListOfDependents::isCacheEntryKeyValid(m_myKey)); 
     }
@@ -2040,6 +2151,9 @@ public:
                             "StateImpl::markCacheValueRealized()");
 
         ce.markAsUpToDate(*this);
+        if (RealizationProfile::isAnyProfilingEnabled())
+            RealizationProfile::noteCacheEntryRealized
+               (ck.first, ce.getDependsOnStage());
     }
 
     void markCacheValueNotRealized(const CacheEntryKey& ck) const {
@@ -2096,6 +2210,10 @@ public:
     ListOfDependents& updZDependents() {return zDependents;}
 
     void autoUpdateDiscreteVariables();
+
+    // See State::canCopyValuesFrom() and State::copyValuesFrom().
+    bool canCopyValuesFrom(const StateImpl& src) const;
+    void copyValuesFrom(const StateImpl& src);
     
     String toString() const;    
     String cacheToString() const;
@@ -2210,6 +2328,15 @@ private:
     // These are initialized to version 1.
     mutable StageVersion systemStageVersions[Stage::NValid];
 
+    // Identifies the realization of Instance stage that this State's
+    // Instance-or-earlier contents came from. A fresh, process-wide unique
+    // value is drawn each time the System stage advances to Instance, and
+    // a copy inherits its source's value. Two States can share their
+    // Instance stage only if these match; the stage versions above can't
+    // tell because independent States bump them in lockstep. Zero means
+    // Instance stage has never been realized.
+    mutable long long    instanceLineage{0};
+
         // DIFFERENTIAL EQUATIONS
 
     // All the state derivatives taken together (qdot,udot,zdot)
@@ -2247,6 +2374,11 @@ private:
     // has its own mutex.
     mutable std::mutex stateLock;
 
+    // Held while this State is the source of a copy, since copying may
+    // create value snapshots in it (see StateValue). This is separate from
+    // stateLock so that copying a State is allowed while stateLock is held.
+    mutable std::mutex copySourceLock;
+
 };
 
 //==============================================================================
@@ -44,6 +44,7 @@ class RealizeOptions;
 class RealizeResults;
 class ProjectOptions;
 class ProjectResults;
+class ParallelExecutor;
 
 //==============================================================================
 //                                 SYSTEM
@@ -281,6 +282,25 @@ requested stage or higher, nothing happens here. Otherwise, the state is
 realized one stage at a time until it reaches the requested stage. 
 @see realizeTopology(), realizeModel() **/
 void realize(const State& state, Stage stage = Stage::HighestRuntime) const;
+
+/** Realize each of a set of independent States to the indicated \a stage, as
+though by calling realize() for each one. With an \a executor the States are
+distributed over its threads, which is worthwhile when there are many of them,
+as in Monte Carlo or optimization studies. The States must be distinct, and
+each must already have been realized through Stage::Model for this %System.
+
+Concurrent realization of different States is supported by all the %System and
+Subsystem code in this library; Subsystem::Guts and Measure implementations
+written elsewhere must not modify anything but the State they are given
+(mutable topology-stage members set in realizeTopology() are fine) to be used
+this way. Each thread reuses its own workspace from one State to the next.
+
+If realizing some State throws an exception, the others are still realized
+and the first exception is rethrown once they are done.
+@see realize() **/
+void realizeBatch(const ArrayView_<State*>& states,
+                  Stage stage = Stage::HighestRuntime,
+                  ParallelExecutor* executor = nullptr) const;
 /**@}**/
 
 
@@ -696,6 +716,28 @@ void multiplyByNPInvTranspose(const State& state, const Vector& fu,
 /**@}**/
 
 
+//------------------------------------------------------------------------------
+/**@name                Jacobian of the state derivatives
+
+These methods are primarily for use by implicit numerical integration 
+methods, which need the Jacobian J=d ydot/dy to solve their nonlinear 
+equations by Newton iteration. An integrator can always form J by finite
+differences of ydot, at a cost of one realization per state, but a System 
+may know how to do better. The Jacobian supplied here need not be exact:
+it changes only how quickly the integrator's Newton iteration converges,
+not the answer, so a %System may leave out dependencies that are smooth or
+weak in favor of speed. **/
+/**@{**/
+/** Calculate J=d ydot/dy, the ny X ny Jacobian of the state derivatives with
+respect to the continuous state variables y=(q,u,z), at the given state. 
+Returns false, leaving \a dYDotdY untouched, if this %System doesn't know how
+to calculate its Jacobian; in that case the caller should fall back to 
+finite differences. The state must be realized through Stage::Velocity; 
+this method may realize it further. **/
+bool calcYDotJacobian(const State& state, Matrix& dYDotdY) const;
+/**@}**/
+
+
 //------------------------------------------------------------------------------
 /**@name                         Statistics
 
@@ -703,11 +745,23 @@ The %System keeps mutable statistics internally, initialized to zero at
 construction. These <em>must not</em> affect results in any way. **/
 /**@{**/
 
-/** Zero out the statistics for this System. Although the statistics are 
-mutable, we only allow them to be reset by a caller who has write access since
-setting the stats to zero is associated with construction. **/
+/** Zero out the statistics for this System, including the realization 
+profile. Although the statistics are mutable, we only allow them to be reset by
+a caller who has write access since setting the stats to zero is associated 
+with construction. **/
 void resetAllCountersToZero();
 
+/** Turn on or off recording of the time, heap allocations and cache entry
+realizations of each Subsystem and Stage during realization; see
+RealizationProfile. This is off by default, and costs next to nothing while
+it is off. Turning it off keeps the statistics gathered so far. **/
+void setRealizationProfilingEnabled(bool enabled);
+/** Return true if realizations of this System are being profiled. **/
+bool isRealizationProfilingEnabled() const;
+/** Return the statistics gathered while realization profiling was enabled
+since construction or the last resetAllCountersToZero(). **/
+const RealizationProfile& getRealizationProfile() const;
+
     // Realization
 
 /** Whenever the system was realized from Stage-1 to the indicated Stage,
@@ -740,6 +794,13 @@ int getNumQProjections() const;
 /** How many of the projectQ() calls that did a constraint projection also
 projected an error estimate? **/
 int getNumQErrorEstimateProjections() const;
+/** Return the total number of times projectQ() or projectU() factored an
+iteration matrix. **/
+int getNumProjectionFactorizations() const;
+/** Return the total number of times projectQ() or projectU() reused an
+iteration matrix factored by an earlier projection instead of factoring a new
+one; see ProjectResults::getNumReusedFactorizations(). **/
+int getNumReusedProjectionFactorizations() const;
 
 /** Return the total number of calls to projectU(), regardless of
 whether the call did anything. **/
@@ -1090,6 +1151,7 @@ public:
         m_exitStatus = Invalid;
         m_anyChangeMade = m_projectionLimitExceeded = false;
         m_numIterations = 0;
+        m_numFactorizations = m_numReusedFactorizations = 0;
         m_worstError = -1;
         m_normOnEntrance = m_normOnExit = NaN;
         return *this;
@@ -1105,6 +1167,15 @@ public:
     {   assert(isValid());return m_worstError; }
     bool getProjectionLimitExceeded() const 
     {   assert(isValid());return m_projectionLimitExceeded; }
+    /** The number of times the iteration matrix was factored during this
+    projection. **/
+    int  getNumFactorizations() const
+    {   assert(isValid());return m_numFactorizations; }
+    /** The number of times a projection began with an iteration matrix that
+    was factored by an earlier projection of the same State, rather than
+    factoring a new one. **/
+    int  getNumReusedFactorizations() const
+    {   assert(isValid());return m_numReusedFactorizations; }
 
     ProjectResults& setExitStatus(Status status) 
     {   m_exitStatus=status; return *this; }
@@ -1114,6 +1185,10 @@ public:
     {   m_projectionLimitExceeded=limitExceeded; return *this; }
     ProjectResults& setNumIterations(int numIterations) 
     {   m_numIterations=numIterations; return *this; }
+    ProjectResults& setNumFactorizations(int numFactorizations) 
+    {   m_numFactorizations=numFactorizations; return *this; }
+    ProjectResults& setNumReusedFactorizations(int numReused) 
+    {   m_numReusedFactorizations=numReused; return *this; }
     ProjectResults& setNormOnEntrance(Real norm, int worstError) 
     {   m_normOnEntrance=norm; m_worstError=worstError; return *this; }
     ProjectResults& setNormOnExit(Real norm) 
@@ -1123,6 +1198,8 @@ private:
     bool    m_anyChangeMade;
     bool    m_projectionLimitExceeded;
     int     m_numIterations;
+    int     m_numFactorizations;
+    int     m_numReusedFactorizations;
     int     m_worstError;       // index of worst error on entrance
     Real    m_normOnEntrance;   // in selected rms or infinity norm
     Real    m_normOnExit;
@@ -148,6 +148,8 @@ public:
     void multiplyByNPInvTranspose(const State& state, const Vector& fu, 
                                   Vector& fq) const;
 
+    bool calcYDotJacobian(const State& state, Matrix& dYDotdY) const;
+
     bool prescribeQ(State&) const;
     bool prescribeU(State&) const;
     void getFreeQIndex(const State&, Array_<SystemQIndex>& freeQs) const;
@@ -206,6 +208,11 @@ protected:
     virtual void multiplyByNPInvTransposeImpl(const State& state, const Vector& fu, 
                                               Vector& fq) const;
 
+    // Default says this System can't calculate its own Jacobian; the caller
+    // will have to use finite differences.
+    virtual bool calcYDotJacobianImpl(const State& state, 
+                                      Matrix& dYDotdY) const {return false;}
+
     // Defaults assume no prescribed motion; hence, no change made.
     virtual bool prescribeQImpl(State&) const {return false;}
     virtual bool prescribeUImpl(State&) const {return false;}
@@ -0,0 +1,252 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of RealizationProfile.
+ */
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/internal/State.h"
+#include "SimTKcommon/internal/RealizationProfile.h"
+
+#include <iomanip>
+#include <ostream>
+
+using namespace SimTK;
+
+std::atomic<int> RealizationProfile::numEnabled(0);
+
+namespace {
+std::atomic<RealizationProfile::AllocationCounter> allocationCounter(nullptr);
+
+// The profile of the System being realized on this thread, if it is being
+// profiled.
+thread_local RealizationProfile* activeProfile = nullptr;
+
+long long countAllocations() {
+    const RealizationProfile::AllocationCounter counter = allocationCounter;
+    return counter ? counter() : 0;
+}
+
+// Quote a name for JSON; Subsystem names are plain text.
+void writeJSONString(std::ostream& o, const String& s) {
+    o << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            o << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            o << ' ';
+        else
+            o << c;
+    }
+    o << '"';
+}
+}
+
+RealizationProfile::RealizationProfile() {}
+
+void RealizationProfile::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : entries)
+        entry = Entry();
+}
+
+int RealizationProfile::getNumSubsystems() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const int numRows = (int)entries.size()/Stage::NValid;
+    return std::max(numRows-1, (int)names.size());
+}
+
+const String& RealizationProfile::getSubsystemName(SubsystemIndex subsys) const
+{
+    static const String unknown;
+    std::lock_guard<std::mutex> lock(mutex);
+    return subsys < (int)names.size() ? names[subsys] : unknown;
+}
+
+const RealizationProfile::Entry& 
+RealizationProfile::getEntry(int subsys, Stage stage) const {
+    static const Entry empty;
+    const int i = (subsys+1)*Stage::NValid + stage;
+    return i < (int)entries.size() ? entries[i] : empty;
+}
+
+RealizationProfile::Entry& 
+RealizationProfile::updEntry(int subsys, Stage stage) {
+    const int i = (subsys+1)*Stage::NValid + stage;
+    if (i >= (int)entries.size())
+        entries.resize((subsys+2)*Stage::NValid);
+    return entries[i];
+}
+
+long long RealizationProfile::
+getNumCalls(SubsystemIndex subsys, Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(subsys, stage).numCalls;
+}
+
+double RealizationProfile::
+getWallTime(SubsystemIndex subsys, Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(subsys, stage).wallTime;
+}
+
+long long RealizationProfile::
+getNumAllocations(SubsystemIndex subsys, Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(subsys, stage).numAllocations;
+}
+
+long long RealizationProfile::
+getNumCacheEntryRealizations(SubsystemIndex subsys, Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(subsys, stage).numCacheEntryRealizations;
+}
+
+long long RealizationProfile::getNumCalls(Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(-1, stage).numCalls;
+}
+
+double RealizationProfile::getWallTime(Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(-1, stage).wallTime;
+}
+
+long long RealizationProfile::getNumAllocations(Stage stage) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntry(-1, stage).numAllocations;
+}
+
+void RealizationProfile::writeCSV(std::ostream& o) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    o << "subsystem,name,stage,calls,seconds,allocations,cacheEntries\n";
+    const int numRows = (int)entries.size()/Stage::NValid;
+    for (int row=0; row < numRows; ++row) {
+        const int subsys = row-1;
+        for (Stage g = Stage::LowestValid; g <= Stage::HighestRuntime; ++g) {
+            const Entry& e = getEntry(subsys, g);
+            if (e.isEmpty())
+                continue;
+            if (subsys >= 0)
+                o << subsys << ",\"" 
+                  << (subsys < (int)names.size() ? names[subsys] : String())
+                  << "\",";
+            else
+                o << ",\"System\",";
+            o << g.getName() << ',' << e.numCalls << ','
+              << std::setprecision(9) << e.wallTime << ','
+              << e.numAllocations << ',' << e.numCacheEntryRealizations 
+              << '\n';
+        }
+    }
+}
+
+void RealizationProfile::writeJSON(std::ostream& o) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Write the rows for subsystems [begin,end) as the elements of an array.
+    auto writeRows = [&](int begin, int end) {
+        bool first = true;
+        for (int subsys=begin; subsys < end; ++subsys) {
+            for (Stage g=Stage::LowestValid; g <= Stage::HighestRuntime; ++g) {
+                const Entry& e = getEntry(subsys, g);
+                if (e.isEmpty())
+                    continue;
+                o << (first ? "\n" : ",\n") << "    {";
+                first = false;
+                if (subsys >= 0) {
+                    o << "\"subsystem\": " << subsys << ", \"name\": ";
+                    writeJSONString(o, subsys < (int)names.size() 
+                                       ? names[subsys] : String());
+                    o << ", ";
+                }
+                o << "\"stage\": \"" << g.getName() << "\", \"calls\": " 
+                  << e.numCalls << ", \"seconds\": " << std::setprecision(9) 
+                  << e.wallTime << ", \"allocations\": " << e.numAllocations 
+                  << ", \"cacheEntries\": " << e.numCacheEntryRealizations 
+                  << "}";
+            }
+        }
+        if (!first)
+            o << "\n  ";
+    };
+    o << "{\n  \"system\": [";
+    writeRows(-1, 0);
+    o << "],\n  \"subsystems\": [";
+    writeRows(0, (int)entries.size()/Stage::NValid - 1);
+    o << "]\n}\n";
+}
+
+void RealizationProfile::setAllocationCounter(AllocationCounter counter)
+{   allocationCounter = counter; }
+
+RealizationProfile::AllocationCounter 
+RealizationProfile::getAllocationCounter()
+{   return allocationCounter; }
+
+void RealizationProfile::noteProfilingEnabled(bool enabled) {
+    if (enabled) ++numEnabled;
+    else --numEnabled;
+}
+
+void RealizationProfile::noteCacheEntryRealized(int subsys, Stage dependsOn) {
+    RealizationProfile* profile = activeProfile;
+    if (!profile)
+        return;
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    profile->updEntry(subsys, dependsOn).numCacheEntryRealizations++;
+}
+
+void RealizationProfile::setSubsystemNames(const Array_<String>& newNames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    names = newNames;
+}
+
+RealizationProfile* 
+RealizationProfile::Activation::activate(RealizationProfile* profile) {
+    RealizationProfile* previous = activeProfile;
+    activeProfile = profile;
+    return previous;
+}
+
+RealizationProfile* RealizationProfile::Timer::getActive() 
+{   return activeProfile; }
+
+void RealizationProfile::Timer::start(int subsys, Stage stage) {
+    this->subsys = subsys;
+    this->stage = stage;
+    allocationsAtStart = countAllocations();
+    startTime = std::chrono::steady_clock::now();
+}
+
+void RealizationProfile::Timer::stop() {
+    const double seconds = std::chrono::duration<double>
+        (std::chrono::steady_clock::now() - startTime).count();
+    const long long allocations = countAllocations() - allocationsAtStart;
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    Entry& entry = profile->updEntry(subsys, stage);
+    entry.numCalls++;
+    entry.wallTime += seconds;
+    entry.numAllocations += allocations;
+}
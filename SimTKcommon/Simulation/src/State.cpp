@@ -32,6 +32,7 @@
 #include <ostream>
 #include <set>
 #include <mutex>
+#include <atomic>
 #include <thread>
 
 using namespace SimTK;
@@ -157,6 +158,14 @@ bool State::isConsistent(const SimTK::State& otherState) const {
     return true;
 }
 
+bool State::canCopyValuesFrom(const State& source) const {
+    return getImpl().canCopyValuesFrom(source.getImpl());
+}
+
+void State::copyValuesFrom(const State& source) {
+    updImpl().copyValuesFrom(source.getImpl());
+}
+
 
 //==============================================================================
 //                          PER SUBSYSTEM INFO
@@ -392,7 +401,10 @@ void StateImpl::copyFrom(const StateImpl& src) {
     // it was up to date. We'll change some of these below if appropriate.
     invalidateCopiedStageVersions(src);
 
-    subsystems = src.subsystems;
+    {   // Copying may make value snapshots in src; see StateValue.
+        std::lock_guard<std::mutex> lock(src.copySourceLock);
+        subsystems = src.subsystems;
+    }
     for (auto& subsys : subsystems)
         subsys.m_stateImpl = this;
 
@@ -417,6 +429,7 @@ void StateImpl::copyFrom(const StateImpl& src) {
             advanceSystemToStage(Stage::Instance);
             systemStageVersions[Stage::Instance] = 
                 src.systemStageVersions[Stage::Instance];
+            instanceLineage = src.instanceLineage;
             // careful -- don't allow reallocation
             qerrWeights = src.qerrWeights;
             uerrWeights = src.uerrWeights;
@@ -450,6 +463,80 @@ StateImpl& StateImpl::operator=(const StateImpl& src) {
     return *this;
 }
 
+//------------------------------------------------------------------------------
+//                           CAN COPY VALUES FROM
+//------------------------------------------------------------------------------
+// Both states must have been realized through Instance stage, and that
+// realization must be the same one (one State is a copy of the other, or
+// both are copies of a common source, with no Instance-or-earlier change
+// since). The stage and value versions alone can't establish that because
+// independent States advance them identically. Discrete variables that
+// invalidate Instance stage or earlier aren't copied, but changing one
+// invalidates Instance stage and realizing it again starts a new lineage, so
+// there is no need to compare them; value versions couldn't be compared
+// across States anyway. The later ones only need compatible values.
+bool StateImpl::canCopyValuesFrom(const StateImpl& src) const {
+    if (   currentSystemStage < Stage::Instance
+        || src.currentSystemStage < Stage::Instance
+        || subsystems.size() != src.subsystems.size()
+        || y.size() != src.y.size()
+        || instanceLineage != src.instanceLineage)
+        return false;
+
+    for (int g=Stage::Topology; g <= Stage::Instance; ++g)
+        if (systemStageVersions[g] != src.systemStageVersions[g])
+            return false;
+
+    for (SubsystemIndex sx(0); sx < (int)subsystems.size(); ++sx) {
+        const PerSubsystemInfo& mine   = subsystems[sx];
+        const PerSubsystemInfo& theirs = src.subsystems[sx];
+        if (   mine.currentStage < Stage::Instance
+            || theirs.currentStage < Stage::Instance
+            || mine.discreteInfo.size() != theirs.discreteInfo.size())
+            return false;
+        for (int g=Stage::Topology; g <= Stage::Instance; ++g)
+            if (mine.stageVersions[g] != theirs.stageVersions[g])
+                return false;
+        for (int dx=0; dx < (int)mine.discreteInfo.size(); ++dx) {
+            const DiscreteVarInfo& dv    = mine.discreteInfo[dx];
+            const DiscreteVarInfo& srcdv = theirs.discreteInfo[dx];
+            if (   dv.getInvalidatedStage() > Stage::Instance
+                && !dv.getValue().isCompatible(srcdv.getValue()))
+                return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//                             COPY VALUES FROM
+//------------------------------------------------------------------------------
+// Time and y are assigned in place since they are the same size, and the
+// discrete variables that invalidate Time stage or later are assigned into
+// their existing value objects. Nothing is allocated or freed, and cache
+// entries that depend only on Instance stage or earlier stay valid.
+void StateImpl::copyValuesFrom(const StateImpl& src) {
+    if (&src == this) return;
+    SimTK_ERRCHK_ALWAYS(canCopyValuesFrom(src), "State::copyValuesFrom()",
+        "The source State doesn't share this State's Instance stage; use "
+        "copy assignment instead.");
+
+    invalidateAll(Stage::Time);
+    t = src.t;
+    y = src.y; // same size; no reallocation
+    noteYChange();
+
+    for (SubsystemIndex sx(0); sx < (int)subsystems.size(); ++sx) {
+        PerSubsystemInfo&       mine   = subsystems[sx];
+        const PerSubsystemInfo& theirs = src.subsystems[sx];
+        for (int dx=0; dx < (int)mine.discreteInfo.size(); ++dx) {
+            DiscreteVarInfo& dv = mine.discreteInfo[dx];
+            if (dv.getInvalidatedStage() > Stage::Instance)
+                dv.copyValueFrom(*this, theirs.discreteInfo[dx]);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 //                     INVALIDATE JUST SYSTEM STAGE
 //------------------------------------------------------------------------------
@@ -756,6 +843,11 @@ void StateImpl::advanceSystemToStage(Stage stg) const {
             }
 
         }
+
+        // This is a new realization of Instance stage; nothing else shares
+        // it until this State is copied.
+        static std::atomic<long long> nextInstanceLineage{1};
+        instanceLineage = nextInstanceLineage.fetch_add(1);
     }
 
     // All cases fall through to here.
@@ -0,0 +1,199 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of StateHistory.
+ */
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/internal/State.h"
+#include "SimTKcommon/internal/System.h"
+#include "SimTKcommon/internal/StateHistory.h"
+
+using namespace SimTK;
+
+StateHistory::StateHistory(int capacity) {
+    setCapacity(capacity);
+}
+
+void StateHistory::setCapacity(int capacity) {
+    SimTK_APIARGCHECK1_ALWAYS(capacity >= 0, "StateHistory", "setCapacity",
+        "The capacity must not be negative but was %d.", capacity);
+    m_checkpoints.clear();
+    m_checkpoints.resize(capacity);
+    m_oldest = m_numCheckpoints = 0;
+}
+
+void StateHistory::clear() {
+    discardCheckpointsAfter(-1);
+}
+
+int StateHistory::getSlot(int i) const {
+    SimTK_INDEXCHECK_ALWAYS(i, m_numCheckpoints, "StateHistory::getSlot()");
+    return (m_oldest + i) % getCapacity();
+}
+
+const StateHistory::Checkpoint& StateHistory::getCheckpoint(int i) const {
+    return m_checkpoints[getSlot(i)];
+}
+
+Real StateHistory::getCheckpointTime(int i) const {
+    return getCheckpoint(i).t;
+}
+
+//------------------------------------------------------------------------------
+//                                 RECORD
+//------------------------------------------------------------------------------
+// The new checkpoint shares the newest checkpoint's full State if the
+// recorded State can still have its values copied from that; otherwise it
+// gets a new full State of its own. The discrete variables that invalidate
+// Instance stage or earlier are then the same as the full State's, or
+// canCopyValuesFrom() would have failed. The later ones have to be saved
+// with the checkpoint unless the full State was just copied from this one:
+// value versions are counted separately in each State, so the recorded
+// State may be a different one of the lineage (an integrator's interpolated
+// State, say) whose version matches the full State's for a different value.
+void StateHistory::record(const State& state) {
+    if (getCapacity() == 0)
+        return;
+
+    SimTK_ERRCHK_ALWAYS(state.getSystemStage() >= Stage::Instance,
+        "StateHistory::record()",
+        "The State must be realized through Instance stage.");
+    if (m_numCheckpoints) {
+        const Real tNewest = getCheckpointTime(m_numCheckpoints-1);
+        SimTK_ERRCHK2_ALWAYS(state.getTime() >= tNewest,
+            "StateHistory::record()",
+            "The State's time %g is earlier than the newest checkpoint's "
+            "time %g.", state.getTime(), tNewest);
+    }
+
+    std::shared_ptr<const State> full;
+    if (m_numCheckpoints) {
+        const std::shared_ptr<const State>& newest =
+            getCheckpoint(m_numCheckpoints-1).full;
+        if (state.canCopyValuesFrom(*newest))
+            full = newest;
+    }
+
+    // Take the slot after the newest, which holds the oldest if we're full.
+    if (m_numCheckpoints == getCapacity())
+        m_oldest = (m_oldest + 1) % getCapacity();
+    else
+        ++m_numCheckpoints;
+    Checkpoint& cp = m_checkpoints[getSlot(m_numCheckpoints-1)];
+
+    const bool isFresh = !full;
+    if (isFresh)
+        full = std::make_shared<const State>(state);
+    cp.full = std::move(full);
+    cp.t = state.getTime();
+    cp.y = state.getY(); // no reallocation if the size hasn't changed
+
+    cp.changedVars.clear();
+    cp.numChanged = 0;
+    if (isFresh)
+        return;
+    for (SubsystemIndex sx(0); sx < state.getNumSubsystems(); ++sx) {
+        for (DiscreteVariableIndex dx(0);
+             state.hasDiscreteVar(DiscreteVarKey(sx,dx)); ++dx)
+        {
+            const DiscreteVarKey dk(sx,dx);
+            const DiscreteVarInfo& dv = state.getDiscreteVarInfo(dk);
+            if (dv.getInvalidatedStage() <= Stage::Instance)
+                continue;
+            const AbstractValue& value = dv.getValue();
+            cp.changedVars.push_back(dk);
+            if (cp.numChanged == (int)cp.changedValues.size())
+                cp.changedValues.emplace_back(value);
+            else {
+                ClonePtr<AbstractValue>& saved = cp.changedValues[cp.numChanged];
+                if (saved->isCompatible(value)) saved->compatibleAssign(value);
+                else saved.reset(value.clone());
+            }
+            ++cp.numChanged;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//                             FIND CHECKPOINT
+//------------------------------------------------------------------------------
+// Times don't decrease so this is a binary search.
+int StateHistory::findCheckpoint(Real time) const {
+    int lo = 0, hi = m_numCheckpoints; // answer is in [lo-1,hi-1]
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (getCheckpointTime(mid) <= time) lo = mid+1;
+        else hi = mid;
+    }
+    return lo-1;
+}
+
+//------------------------------------------------------------------------------
+//                                 RESTORE
+//------------------------------------------------------------------------------
+void StateHistory::restore(int i, State& state) const {
+    const Checkpoint& cp = getCheckpoint(i);
+    if (!state.canCopyValuesFrom(*cp.full))
+        state = *cp.full;
+    state.copyValuesFrom(*cp.full);
+
+    state.setTime(cp.t);
+    state.updY() = cp.y;
+    for (int k=0; k < cp.numChanged; ++k) {
+        const DiscreteVarKey& dk = cp.changedVars[k];
+        state.updDiscreteVariable(dk.first, dk.second)
+             .compatibleAssign(*cp.changedValues[k]);
+    }
+}
+
+void StateHistory::restore(int i, const System& system, State& state,
+                           Stage stage) const {
+    restore(i, state);
+    system.realize(state, stage);
+}
+
+//------------------------------------------------------------------------------
+//                         DISCARD CHECKPOINTS AFTER
+//------------------------------------------------------------------------------
+// Let go of the discarded checkpoints' full States but keep the rest of their
+// storage for reuse.
+void StateHistory::discardCheckpointsAfter(int i) {
+    SimTK_APIARGCHECK2_ALWAYS(-1 <= i && i < m_numCheckpoints,
+        "StateHistory", "discardCheckpointsAfter",
+        "Checkpoint %d is out of range; there are %d checkpoints.",
+        i, m_numCheckpoints);
+    for (int j=i+1; j < m_numCheckpoints; ++j)
+        m_checkpoints[getSlot(j)].full.reset();
+    m_numCheckpoints = i+1;
+}
+
+int StateHistory::getNumFullStates() const {
+    int n = 0;
+    for (int i=0; i < m_numCheckpoints; ++i)
+        if (i==0 || getCheckpoint(i).full != getCheckpoint(i-1).full)
+            ++n;
+    return n;
+}
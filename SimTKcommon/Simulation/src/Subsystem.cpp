@@ -35,6 +35,7 @@
 #include "SimTKcommon/internal/EventReporter.h"
 #include "SimTKcommon/internal/System.h"
 #include "SimTKcommon/internal/Subsystem.h"
+#include "SimTKcommon/internal/RealizationProfile.h"
 
 #include "SimTKcommon/internal/MeasureImplementation.h"
 
@@ -206,6 +207,7 @@ Subsystem::Guts* Subsystem::Guts::clone() const {
 void Subsystem::Guts::realizeSubsystemTopology(State& s) const {
     SimTK_STAGECHECK_EQ_ALWAYS(getStage(s), Stage::Empty, 
         "Subsystem::Guts::realizeSubsystemTopology()");
+    RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Topology);
     realizeSubsystemTopologyImpl(s);
 
     // Realize this Subsystem's Measures.
@@ -226,6 +228,7 @@ void Subsystem::Guts::realizeSubsystemModel(State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage::Topology, 
         "Subsystem::Guts::realizeSubsystemModel()");
     if (getStage(s) < Stage::Model) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Model);
         realizeSubsystemModelImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -243,6 +246,7 @@ void Subsystem::Guts::realizeSubsystemInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Instance).prev(), 
         "Subsystem::Guts::realizeSubsystemInstance()");
     if (getStage(s) < Stage::Instance) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Instance);
         realizeSubsystemInstanceImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -260,6 +264,7 @@ void Subsystem::Guts::realizeSubsystemTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Time).prev(), 
         "Subsystem::Guts::realizeTime()");
     if (getStage(s) < Stage::Time) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Time);
         realizeSubsystemTimeImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -277,6 +282,7 @@ void Subsystem::Guts::realizeSubsystemPosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Position).prev(), 
         "Subsystem::Guts::realizeSubsystemPosition()");
     if (getStage(s) < Stage::Position) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Position);
         realizeSubsystemPositionImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -294,6 +300,7 @@ void Subsystem::Guts::realizeSubsystemVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Velocity).prev(), 
         "Subsystem::Guts::realizeSubsystemVelocity()");
     if (getStage(s) < Stage::Velocity) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Velocity);
         realizeSubsystemVelocityImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -311,6 +318,7 @@ void Subsystem::Guts::realizeSubsystemDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Dynamics).prev(), 
         "Subsystem::Guts::realizeSubsystemDynamics()");
     if (getStage(s) < Stage::Dynamics) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Dynamics);
         realizeSubsystemDynamicsImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -328,6 +336,8 @@ void Subsystem::Guts::realizeSubsystemAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Acceleration).prev(), 
         "Subsystem::Guts::realizeSubsystemAcceleration()");
     if (getStage(s) < Stage::Acceleration) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(),
+                                        Stage::Acceleration);
         realizeSubsystemAccelerationImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -345,6 +355,7 @@ void Subsystem::Guts::realizeSubsystemReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Report).prev(), 
         "Subsystem::Guts::realizeSubsystemReport()");
     if (getStage(s) < Stage::Report) {
+        RealizationProfile::Timer timer(getMySubsystemIndex(), Stage::Report);
         realizeSubsystemReportImpl(s);
 
         // Realize this Subsystem's Measures.
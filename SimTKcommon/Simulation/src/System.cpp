@@ -36,11 +36,15 @@
 #include "SimTKcommon/internal/SystemGuts.h"
 #include "SimTKcommon/internal/EventHandler.h"
 #include "SimTKcommon/internal/EventReporter.h"
+#include "SimTKcommon/internal/RealizationProfile.h"
+#include "SimTKcommon/internal/ParallelExecutor.h"
 
 #include "SystemGutsRep.h"
 
 #include <cassert>
+#include <exception>
 #include <map>
+#include <mutex>
 #include <set>
 
 namespace SimTK {
@@ -116,6 +120,13 @@ void System::resetAllCountersToZero() {updSystemGuts().updRep().resetAllCounters
 int System::getNumRealizationsOfThisStage(Stage g) const {return getSystemGuts().getRep().nRealizationsOfStage[g];}
 int System::getNumRealizeCalls() const {return getSystemGuts().getRep().nRealizeCalls;}
 
+void System::setRealizationProfilingEnabled(bool enabled) 
+{   updSystemGuts().updRep().setProfilingEnabled(enabled); }
+bool System::isRealizationProfilingEnabled() const 
+{   return getSystemGuts().getRep().profilingEnabled; }
+const RealizationProfile& System::getRealizationProfile() const 
+{   return getSystemGuts().getRep().profile; }
+
 int System::getNumPrescribeQCalls() const {return getSystemGuts().getRep().nPrescribeQCalls;}
 int System::getNumPrescribeUCalls() const {return getSystemGuts().getRep().nPrescribeUCalls;}
 
@@ -127,6 +138,8 @@ int System::getNumQProjections() const {return getSystemGuts().getRep().nQProjec
 int System::getNumUProjections() const {return getSystemGuts().getRep().nUProjections;} 
 int System::getNumQErrorEstimateProjections() const {return getSystemGuts().getRep().nQErrEstProjections;}
 int System::getNumUErrorEstimateProjections() const {return getSystemGuts().getRep().nUErrEstProjections;}
+int System::getNumProjectionFactorizations() const {return getSystemGuts().getRep().nProjectionFactorizations;}
+int System::getNumReusedProjectionFactorizations() const {return getSystemGuts().getRep().nReusedProjectionFactorizations;}
 
 int System::getNumHandlerCallsThatChangedStage(Stage g) const {return getSystemGuts().getRep().nHandlerCallsThatChangedStage[g];}
 int System::getNumHandleEventCalls() const {return getSystemGuts().getRep().nHandleEventsCalls;}
@@ -169,6 +182,51 @@ void System::invalidateSystemTopologyCache() const
 const State& System::realizeTopology() const {return getSystemGuts().realizeTopology();}
 void System::realizeModel(State& s) const {getSystemGuts().realizeModel(s);}
 void System::realize(const State& s, Stage g) const {getSystemGuts().realize(s,g);}
+
+namespace {
+// Realizes one State per index for System::realizeBatch(), remembering the
+// first exception so that it can be rethrown on the calling thread.
+class RealizeBatchTask : public ParallelExecutor::Task {
+public:
+    RealizeBatchTask(const System& system, const ArrayView_<State*>& states,
+                     Stage stage)
+    :   system(system), states(states), stage(stage) {}
+
+    void execute(int index) override {
+        try {
+            system.realize(*states[index], stage);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    void rethrowIfFailed() const {
+        if (error) std::rethrow_exception(error);
+    }
+private:
+    const System&               system;
+    const ArrayView_<State*>&   states;
+    const Stage                 stage;
+    std::mutex                  errorMutex;
+    std::exception_ptr          error;
+};
+}
+
+void System::realizeBatch(const ArrayView_<State*>& states, Stage g,
+                          ParallelExecutor* executor) const {
+    SimTK_STAGECHECK_TOPOLOGY_REALIZED_ALWAYS(systemTopologyHasBeenRealized(),
+        "System", getName(), "System::realizeBatch()");
+    RealizeBatchTask task(*this, states, g);
+    const int numStates = (int)states.size();
+    if (executor && numStates > 1) {
+        executor->execute(task, numStates);
+    } else {
+        for (int i=0; i < numStates; ++i)
+            task.execute(i);
+    }
+    task.rethrowIfFailed();
+}
 void System::calcDecorativeGeometryAndAppend
    (const State& s, Stage g, Array_<DecorativeGeometry>& geom) const 
 {   getSystemGuts().calcDecorativeGeometryAndAppend(s,g,geom); }
@@ -181,6 +239,8 @@ void System::multiplyByNPInv(const State& s, const Vector& dq, Vector& u) const
 {   getSystemGuts().multiplyByNPInv(s,dq,u); }
 void System::multiplyByNPInvTranspose(const State& s, const Vector& fu, Vector& fq) const
 {   getSystemGuts().multiplyByNPInvTranspose(s,fu,fq); }
+bool System::calcYDotJacobian(const State& s, Matrix& dYDotdY) const
+{   return getSystemGuts().calcYDotJacobian(s,dYDotdY); }
 
 bool System::prescribeQ(State& s) const
 {   return getSystemGuts().prescribeQ(s); }
@@ -348,6 +408,12 @@ const State& System::Guts::realizeTopology() const {
     if (getRep().systemTopologyHasBeenRealized())
         return defaultState;
 
+    // This includes the realizeModel() below.
+    RealizationProfile::Activation activation(getRep().getActiveProfile());
+    if (getRep().profilingEnabled)
+        getRep().updateProfileSubsystemNames();
+    RealizationProfile::Timer timer(-1, Stage::Topology);
+
     defaultState.clear();
     defaultState.setNumSubsystems(getNumSubsystems());
     for (SubsystemIndex i(0); i<getNumSubsystems(); ++i) 
@@ -393,6 +459,9 @@ void System::Guts::realizeModel(State& s) const {
         getSystemTopologyCacheVersion(), s.getSystemTopologyStageVersion(),
         "System", getName(), "System::Guts::realizeModel()");
     if (s.getSystemStage() < Stage::Model) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Model);
         // Allow the subclass to do its processing.
         realizeModelImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -415,6 +484,9 @@ void System::Guts::realizeInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Instance).prev(), 
         "System::Guts::realizeInstance()");
     if (s.getSystemStage() < Stage::Instance) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Instance);
         realizeInstanceImpl(s);    // take care of the Subsystems
         // Realize any subsystems that the subclass didn't already take care of.
         for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
@@ -436,6 +508,9 @@ void System::Guts::realizeTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Time).prev(), 
         "System::Guts::realizeTime()");
     if (s.getSystemStage() < Stage::Time) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Time);
         // Allow the subclass to do processing.
         realizeTimeImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -458,6 +533,9 @@ void System::Guts::realizePosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Position).prev(), 
         "System::Guts::realizePosition()");
     if (s.getSystemStage() < Stage::Position) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Position);
         // Allow the subclass to do processing.
         realizePositionImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -480,6 +558,9 @@ void System::Guts::realizeVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Velocity).prev(), 
         "System::Guts::realizeVelocity()");
     if (s.getSystemStage() < Stage::Velocity) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Velocity);
         // Allow the subclass to do processing.
         realizeVelocityImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -502,6 +583,9 @@ void System::Guts::realizeDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Dynamics).prev(), 
         "System::Guts::realizeDynamics()");
     if (s.getSystemStage() < Stage::Dynamics) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Dynamics);
         // Allow the subclass to do processing.
         realizeDynamicsImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -524,6 +608,9 @@ void System::Guts::realizeAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Acceleration).prev(), 
         "System::Guts::realizeAcceleration()");
     if (s.getSystemStage() < Stage::Acceleration) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Acceleration);
         // Allow the subclass to do processing.
         realizeAccelerationImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -546,6 +633,9 @@ void System::Guts::realizeReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Report).prev(), 
         "System::Guts::realizeReport()");
     if (s.getSystemStage() < Stage::Report) {
+        RealizationProfile::Activation 
+            activation(getRep().getActiveProfile());
+        RealizationProfile::Timer timer(-1, Stage::Report);
         // Allow the subclass to do processing.
         realizeReportImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -591,6 +681,17 @@ void System::Guts::multiplyByNPInvTranspose(const State& s, const Vector& fu,
 
 
 
+//------------------------------------------------------------------------------
+//                            CALC YDOT JACOBIAN
+//------------------------------------------------------------------------------
+bool System::Guts::calcYDotJacobian(const State& s, Matrix& dYDotdY) const {
+    SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage::Velocity,
+        "System::Guts::calcYDotJacobian()");
+    return calcYDotJacobianImpl(s,dYDotdY);
+}
+
+
+
 //------------------------------------------------------------------------------
 //                              PRESCRIBE Q
 //------------------------------------------------------------------------------
@@ -646,6 +747,11 @@ void System::Guts::projectQ(State& s, Vector& qErrEst,
     //---------------------------------------------------------
     projectQImpl(s,qErrEst,options,results);
     //---------------------------------------------------------
+    if (results.isValid()) {
+        rep.nProjectionFactorizations += results.getNumFactorizations();
+        rep.nReusedProjectionFactorizations += 
+            results.getNumReusedFactorizations();
+    }
     if (results.getExitStatus()==ProjectResults::Succeeded) {
         rep.nFailedProjectQCalls--; // never mind!
         if (results.getAnyChangeMade()) rep.nQProjections++;
@@ -670,6 +776,11 @@ void System::Guts::projectU(State& s, Vector& uErrEst,
     //---------------------------------------------------------
     projectUImpl(s,uErrEst,options,results);
     //---------------------------------------------------------
+    if (results.isValid()) {
+        rep.nProjectionFactorizations += results.getNumFactorizations();
+        rep.nReusedProjectionFactorizations += 
+            results.getNumReusedFactorizations();
+    }
     if (results.getExitStatus()==ProjectResults::Succeeded) {
         rep.nFailedProjectUCalls--; // never mind!
         if (results.getAnyChangeMade()) rep.nUProjections++;
@@ -38,6 +38,8 @@
 #include "SimTKcommon/internal/System.h"
 #include "SimTKcommon/internal/SystemGuts.h"
 
+#include <atomic>
+
 namespace SimTK {
 
 class System::Guts::GutsRep {
@@ -53,8 +55,8 @@ public:
         useUniformBackground(false),
         hasTimeAdvancedEventsFlag(false),
         systemTopologyRealized(false), 
-        topologyCacheVersion(1) // not zero
-
+        topologyCacheVersion(1), // not zero
+        profilingEnabled(false)
     {
         resetAllCounters();
     }
@@ -74,12 +76,14 @@ public:
         useUniformBackground(src.useUniformBackground),
         hasTimeAdvancedEventsFlag(src.hasTimeAdvancedEventsFlag),
         systemTopologyRealized(false),
-        topologyCacheVersion(src.topologyCacheVersion)
+        topologyCacheVersion(src.topologyCacheVersion),
+        profilingEnabled(false)
     {
         resetAllCounters();
     }
 
     ~GutsRep() {
+        setProfilingEnabled(false);
         clearMyHandle();
         subsystems.clear();
         invalidateSystemTopologyCache();
@@ -164,6 +168,26 @@ public:
         }
     }
 
+    void setProfilingEnabled(bool enabled) {
+        if (enabled == profilingEnabled)
+            return;
+        profilingEnabled = enabled;
+        RealizationProfile::noteProfilingEnabled(enabled);
+        if (enabled)
+            updateProfileSubsystemNames();
+    }
+
+    // The profile to record realizations in, or null if not profiling.
+    RealizationProfile* getActiveProfile() const
+    {   return profilingEnabled ? &profile : nullptr; }
+
+    void updateProfileSubsystemNames() const {
+        Array_<String> names;
+        for (SubsystemIndex i(0); i < (int)subsystems.size(); ++i)
+            names.push_back(subsystems[i].getName());
+        profile.setSubsystemNames(names);
+    }
+
 protected:
     String systemName;
     String systemVersion;
@@ -200,19 +224,26 @@ private:
     mutable State           defaultState;
 
         // STATISTICS //
-    mutable int nRealizationsOfStage[Stage::NValid];
-    mutable int nRealizeCalls; // counts realizeTopology(), realizeModel(), realize()
+    // These are atomic because different States may be realized (or
+    // projected, etc.) on several threads at once.
+    typedef std::atomic<int> Counter;
+    mutable Counter nRealizationsOfStage[Stage::NValid];
+    mutable Counter nRealizeCalls; // counts realizeTopology(), realizeModel(), realize()
+
+    mutable Counter nPrescribeQCalls, nPrescribeUCalls;
 
-    mutable int nPrescribeQCalls, nPrescribeUCalls;
+    mutable Counter nProjectQCalls, nProjectUCalls;
+    mutable Counter nFailedProjectQCalls, nFailedProjectUCalls;
+    mutable Counter nQProjections, nUProjections; // the ones that did something
+    mutable Counter nQErrEstProjections, nUErrEstProjections;
+    mutable Counter nProjectionFactorizations, nReusedProjectionFactorizations;
 
-    mutable int nProjectQCalls, nProjectUCalls;
-    mutable int nFailedProjectQCalls, nFailedProjectUCalls;
-    mutable int nQProjections, nUProjections; // the ones that did something
-    mutable int nQErrEstProjections, nUErrEstProjections;
+    mutable Counter nHandlerCallsThatChangedStage[Stage::NValid];
+    mutable Counter nHandleEventsCalls;
+    mutable Counter nReportEventsCalls;
 
-    mutable int nHandlerCallsThatChangedStage[Stage::NValid];
-    mutable int nHandleEventsCalls;
-    mutable int nReportEventsCalls;
+    bool                        profilingEnabled;
+    mutable RealizationProfile  profile;
 
     void resetAllCounters() {
         for (int i=0; i<Stage::NValid; ++i)
@@ -222,7 +253,9 @@ private:
         nFailedProjectQCalls = nFailedProjectUCalls = 0;
         nQProjections = nUProjections = 0;
         nQErrEstProjections = nUErrEstProjections = 0;
+        nProjectionFactorizations = nReusedProjectionFactorizations = 0;
         nHandleEventsCalls = nReportEventsCalls = 0;
+        profile.clear();
     }
 
 };
@@ -0,0 +1,180 @@
+#ifndef SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
+#define SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * This file provides explicitly vectorized versions of the double precision
+ * 3x3 matrix-vector and matrix-matrix products, which are at the heart of
+ * nearly every Rotation, Transform and spatial algebra operation. They are
+ * overloads of the generic templates in SmallMatrixMixed.h and Mat.h, so
+ * existing code picks them up without change.
+ *
+ * The kernels use SSE2, which is available whenever the compiler targets it
+ * (always on x86-64). Wider instruction sets don't help here: a 3-vector
+ * fills only part of a 256-bit register and the masked loads and stores
+ * needed at the ends cost more than they save. Each kernel forms every
+ * element with the same operations in the same order as the generic
+ * templates, so results are bitwise identical unless the compiler is
+ * allowed to contract multiplies and adds into fused multiply-adds. Define
+ * SimTK_NO_SIMD before including SimTKcommon to use the generic templates
+ * everywhere.
+ */
+
+#if !defined(SimTK_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) \
+                                || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SimTK_SIMD_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace SimTK {
+
+/** Return the name of the instruction set used by the small matrix kernels
+in this compilation unit, or "none" if they are not vectorized. **/
+inline const char* getSmallMatrixSIMDInstructionSet() {
+#ifdef SimTK_SIMD_SSE2
+    return "SSE2";
+#else
+    return "none";
+#endif
+}
+
+#ifdef SimTK_SIMD_SSE2
+
+namespace SIMD {
+
+// These work on the raw elements of 3x3 matrices. A packed matrix has its
+// columns contiguous; a transposed one (as from operator~) has its rows
+// contiguous. We compute rows 0 and 1 of each result column two at a time
+// and row 2 separately.
+
+// Load columns of the packed matrix a into (c0,c1,c2) rows 0-1.
+inline void loadColumns01(const double* a, __m128d& c0, __m128d& c1,
+                          __m128d& c2) {
+    c0 = _mm_loadu_pd(a); c1 = _mm_loadu_pd(a+3); c2 = _mm_loadu_pd(a+6);
+}
+
+// Same, but for a matrix stored transposed.
+inline void loadTransposedColumns01(const double* a, __m128d& c0,
+                                    __m128d& c1, __m128d& c2) {
+    const __m128d r0 = _mm_loadu_pd(a), r1 = _mm_loadu_pd(a+3);
+    c0 = _mm_unpacklo_pd(r0, r1); c1 = _mm_unpackhi_pd(r0, r1);
+    c2 = _mm_set_pd(a[5], a[2]);
+}
+
+// r[0..1] = (c0*v0 + c1*v1) + c2*v2, the order in which the generic dot
+// product accumulates.
+inline void combine01(__m128d c0, __m128d c1, __m128d c2,
+                      double v0, double v1, double v2, double* r) {
+    _mm_storeu_pd(r, _mm_add_pd(
+        _mm_add_pd(_mm_mul_pd(c0, _mm_set1_pd(v0)),
+                   _mm_mul_pd(c1, _mm_set1_pd(v1))),
+        _mm_mul_pd(c2, _mm_set1_pd(v2))));
+}
+
+inline double combine2(double a0, double a1, double a2,
+                       double v0, double v1, double v2)
+{   return (a0*v0 + a1*v1) + a2*v2; }
+
+} // namespace SIMD
+
+/** Vectorized 3x3 matrix times 3-vector. **/
+inline Vec<3,double> operator*(const Mat<3,3,double>& m, const Vec<3,double>& v) {
+    const double* a = &m(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadColumns01(a, c0, c1, c2);
+    Vec<3,double> r;
+    SIMD::combine01(c0, c1, c2, v[0], v[1], v[2], &r[0]);
+    r[2] = SIMD::combine2(a[2], a[5], a[8], v[0], v[1], v[2]);
+    return r;
+}
+
+/** Vectorized transposed 3x3 matrix times 3-vector, for ~R*v. **/
+inline Vec<3,double>
+operator*(const Mat<3,3,double,1,3>& m, const Vec<3,double>& v) {
+    const double* a = &m(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadTransposedColumns01(a, c0, c1, c2);
+    Vec<3,double> r;
+    SIMD::combine01(c0, c1, c2, v[0], v[1], v[2], &r[0]);
+    r[2] = SIMD::combine2(a[6], a[7], a[8], v[0], v[1], v[2]);
+    return r;
+}
+
+namespace SIMD {
+// Multiply a 3x3 matrix whose columns are in (c0,c1,c2) for rows 0-1 and in
+// row2 for row 2 by any 3x3 matrix r.
+template <int CS, int RS> inline Mat<3,3,double>
+multiply(__m128d c0, __m128d c1, __m128d c2, const double* row2,
+         const Mat<3,3,double,CS,RS>& r) {
+    Mat<3,3,double> out;
+    for (int j=0; j < 3; ++j) {
+        const double b0 = r(0,j), b1 = r(1,j), b2 = r(2,j);
+        combine01(c0, c1, c2, b0, b1, b2, &out(0,j));
+        out(2,j) = combine2(row2[0], row2[1], row2[2], b0, b1, b2);
+    }
+    return out;
+}
+} // namespace SIMD
+
+/** Vectorized 3x3 matrix products, for composing rotations. Either operand
+may be transposed. **/
+//@{
+inline Mat<3,3,double>
+operator*(const Mat<3,3,double>& l, const Mat<3,3,double>& r) {
+    const double* a = &l(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadColumns01(a, c0, c1, c2);
+    const double row2[3] = {a[2], a[5], a[8]};
+    return SIMD::multiply(c0, c1, c2, row2, r);
+}
+inline Mat<3,3,double>
+operator*(const Mat<3,3,double>& l, const Mat<3,3,double,1,3>& r) {
+    const double* a = &l(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadColumns01(a, c0, c1, c2);
+    const double row2[3] = {a[2], a[5], a[8]};
+    return SIMD::multiply(c0, c1, c2, row2, r);
+}
+inline Mat<3,3,double>
+operator*(const Mat<3,3,double,1,3>& l, const Mat<3,3,double>& r) {
+    const double* a = &l(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadTransposedColumns01(a, c0, c1, c2);
+    return SIMD::multiply(c0, c1, c2, a+6, r);
+}
+inline Mat<3,3,double>
+operator*(const Mat<3,3,double,1,3>& l, const Mat<3,3,double,1,3>& r) {
+    const double* a = &l(0,0);
+    __m128d c0, c1, c2;
+    SIMD::loadTransposedColumns01(a, c0, c1, c2);
+    return SIMD::multiply(c0, c1, c2, a+6, r);
+}
+//@}
+
+#endif // SimTK_SIMD_SSE2
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
@@ -44,6 +44,7 @@
 #include "SimTKcommon/internal/Subsystem.h"
 #include "SimTKcommon/internal/SubsystemGuts.h"
 #include "SimTKcommon/internal/Study.h"
+#include "SimTKcommon/internal/StateHistory.h"
 #include "SimTKcommon/internal/Function.h"
 #include "SimTKcommon/internal/Random.h"
 #include "SimTKcommon/internal/PolynomialRootFinder.h"
@@ -26,6 +26,7 @@
 
 #include "SimTKcommon/internal/common.h"
 
+#include <atomic>
 #include <memory>
 #include <iosfwd>
 #include <cassert>
@@ -52,6 +53,12 @@ This class is entirely inline and has no computational or space overhead
 beyond the cost of dealing with the reference count, except when a copy has
 to be made due to a write attempt.
 
+As for `std::shared_ptr`, the reference count is atomic so containers that 
+share an object may be copied, written, and destructed in different threads.
+Access to the contained object itself is not synchronized, but since a write
+always detaches first, one thread's writes are never seen by another thread's
+container.
+
 @tparam T   The type of the contained object, which *must* have a `clone()` 
             method. May be an abstract or concrete type.
 
@@ -79,7 +86,7 @@ public:
     ownership of that object. The use count will be one unless the pointer
     was null in which case it will be zero. **/
     explicit CloneOnWritePtr(T* x) : CloneOnWritePtr()
-    {   if (x) {p=x; count=new long(1);} } 
+    {   if (x) {p=x; count=new std::atomic<long>(1);} } 
 
     /** Given a pointer to a read-only object, create a new heap-allocated 
     copy of that object via its `clone()` method and make this %CloneOnWritePtr
@@ -271,7 +278,7 @@ public:
     void reset(T* x) { // could throw when allocating count
         if (x != p) {
             reset();
-            if (x) {p=x; count=new long(1);}
+            if (x) {p=x; count=new std::atomic<long>(1);}
         }
     }
 
@@ -288,7 +295,7 @@ public:
     sharing the referenced object. There is never more than
     one holding an object for writing. If the pointer is null the use 
     count is zero. **/
-    long use_count() const noexcept {return count ? *count : 0;}
+    long use_count() const noexcept {return count ? count->load() : 0;}
 
     /** Is this the only user of the referenced object? Note that this means
     there is exactly one; if the managed pointer is null `unique()` returns 
@@ -327,8 +334,14 @@ public:
     unique() already then nothing happens. Note that you have to have write
     access to this container in order to detach it. **/
     void detach() { // can throw during clone()
-        if (use_count() > 1) 
-        {   decr(); p=p->clone(); count=new long(1); }
+        if (use_count() > 1) {
+            // Finish the copy before giving up our share so that no other
+            // sharer can find itself unique and write on the original while
+            // we're still reading it.
+            std::unique_ptr<T> x(p->clone());
+            auto* c = new std::atomic<long>(1);
+            reset(); p=x.release(); count=c;
+        }
     }
     /**@}**/
      
@@ -361,8 +374,8 @@ template <class U> friend class CloneOnWritePtr;
     void init() noexcept {p=nullptr; count=nullptr;}
 
     // Can't use std::shared_ptr here due to lack of release() method.
-    T*      p;          // this may be null
-    long*   count;      // if p is null so is count
+    T*                  p;      // this may be null
+    std::atomic<long>*  count;  // if p is null so is count
 };    
 
 
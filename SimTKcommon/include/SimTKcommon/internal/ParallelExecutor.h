@@ -56,6 +56,22 @@ class ParallelExecutorImpl;
  * any assumptions about what order they will occur in or which ones will
  * happen at the same time.
  * 
+ * Work is distributed dynamically. Each worker thread starts out owning an
+ * equal contiguous slice of the indices and executes it in chunks; a worker
+ * that runs out of work steals half of the remaining indices of another
+ * worker. That keeps all threads busy when some indices are much more
+ * expensive than others. Between tasks, idle workers spin for a short while
+ * before going to sleep, so that executing many short tasks in a row does not
+ * pay for waking up every thread each time.
+ *
+ * A Task may itself call execute() on the ParallelExecutor that is running
+ * it. Such a nested call is executed serially on the calling worker thread
+ * rather than deadlocking.
+ * Likewise, if execute() is called from one thread while the workers are
+ * running a task for another, the second task is executed serially on its
+ * calling thread. So one ParallelExecutor may safely be shared by code that
+ * runs concurrently.
+ * 
  * The threads are created in the ParallelExecutor's constructor and remain
  * active until it is deleted. This means that creating a ParallelExecutor is a
  * somewhat expensive operation, but it may then be used repeatedly for
@@ -33,9 +33,45 @@ using namespace std;
 
 namespace SimTK {
 
-static void threadBody(ThreadInfo& info);
+// How long a worker (or the calling thread) polls before parking on a
+// condition variable. The first BusySpinIterations polls are pure busy waits;
+// after that we yield the processor between polls.
+static const int BusySpinIterations = 64;
+static const int SpinIterations     = 4096;
+// Target number of chunks per worker; more chunks means better balance for
+// uneven tasks at the cost of more atomic operations.
+static const int ChunksPerThread    = 4;
 
-ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
+static inline std::uint64_t packRange(int begin, int end) {
+    return (std::uint64_t)(std::uint32_t)begin
+        | ((std::uint64_t)(std::uint32_t)end << 32);
+}
+static inline int rangeBegin(std::uint64_t range) {
+    return (int)(std::uint32_t)range;
+}
+static inline int rangeEnd(std::uint64_t range) {
+    return (int)(std::uint32_t)(range >> 32);
+}
+
+template <class Pred>
+static bool spinUntil(Pred pred) {
+    for (int i = 0; i < SpinIterations; ++i) {
+        if (pred())
+            return true;
+        if (i >= BusySpinIterations)
+            std::this_thread::yield();
+    }
+    return pred();
+}
+
+static void threadBody(ThreadInfo& info) {
+    info.executor->runWorker(info);
+}
+
+ParallelExecutorImpl::ParallelExecutorImpl()
+:   finished(false), generation(0), sleepingWorkers(0), activeWorkers(0),
+    callerSleeping(false), busy(false), currentTask(nullptr),
+    currentTaskCount(0), chunkSize(1) {
 
     //By default, we use the total number of processors available of the
     //computer (including hyperthreads)
@@ -43,7 +79,10 @@ ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
     if(numMaxThreads <= 0)
       numMaxThreads = 1;
 }
-ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl(int numThreads)
+:   finished(false), generation(0), sleepingWorkers(0), activeWorkers(0),
+    callerSleeping(false), busy(false), currentTask(nullptr),
+    currentTaskCount(0), chunkSize(1) {
 
     // Set the maximum number of threads that we can use
     SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelExecutorImpl",
@@ -54,12 +93,12 @@ ParallelExecutorImpl::~ParallelExecutorImpl() {
     
     // Notify the threads that they should exit.
     
-    std::unique_lock<std::mutex> lock(runMutex);
     finished = true;
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threadInfo[i].running = true;
-    runCondition.notify_all();
-    lock.unlock();
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        generation.fetch_add(1);
+        runCondition.notify_all();
+    }
     
     // Wait until all the threads have finished.
     
@@ -69,11 +108,29 @@ ParallelExecutorImpl::~ParallelExecutorImpl() {
 ParallelExecutorImpl* ParallelExecutorImpl::clone() const {
     return new ParallelExecutorImpl(numMaxThreads);
 }
+void ParallelExecutorImpl::launchThreads() {
+    // We do not support numMaxThreads changing for a given instance of
+    // ParallelExecutor.
+    assert(threads.size() == 0);
+    threadInfo.reset(new ThreadInfo[numMaxThreads]);
+    threads.resize(numMaxThreads);
+    for (int i = 0; i < numMaxThreads; ++i) {
+        threadInfo[i].index = i;
+        threadInfo[i].executor = this;
+        threads[i] = std::thread(threadBody, std::ref(threadInfo[i]));
+    }
+}
 void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
-  if (min(times, numMaxThreads) == 1) {
+  if (min(times, numMaxThreads) == 1 || currentExecutor == this
+      || busy.exchange(true)) {
       //(1) NON-PARALLEL CASE:
       // Nothing is actually going to get done in parallel, so we might as well
-      // just execute the task directly and save the threading overhead.
+      // just execute the task directly and save the threading overhead. This
+      // is also how we handle a nested call made by one of our own workers:
+      // every other worker may be busy with the enclosing task, so running
+      // the inner task inline is the only way to guarantee progress. The
+      // same goes for a call from another thread while the workers are busy
+      // with someone else's task, as when several States are realized at once.
       task.initialize();
       for (int i = 0; i < times; ++i)
           task.execute(i);
@@ -84,83 +141,128 @@ void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
     //(2) PARALLEL CASE:
     // We launch the maximum number of threads and save them for later use
     if(threads.size() < (size_t)numMaxThreads)
-    {
-      // We do not support numMaxThreads changing for a given instance of
-      // ParallelExecutor.
-      assert(threads.size() == 0);
-      threadInfo.reserve(numMaxThreads);
-      threads.resize(numMaxThreads);
-      for (int i = 0; i < numMaxThreads; ++i) {
-          threadInfo.emplace_back(i, this);
-          threads[i] = std::thread(threadBody, std::ref(threadInfo[i]));
-      }
-    }
+        launchThreads();
    
-    // Initialize fields to execute the new task.
-    std::unique_lock<std::mutex> lock(runMutex);
+    // Initialize fields to execute the new task. Each worker starts out
+    // owning an equal contiguous slice of the index range.
+    const int numThreads = getThreadCount();
     currentTask = &task;
     currentTaskCount = times;
-    waitingThreadCount = 0;
-    for (int i = 0; i < (int)threadInfo.size(); ++i) {
-        threadInfo[i].running = true;
+    chunkSize = std::max(1, times / (numThreads*ChunksPerThread));
+    for (int i = 0; i < numThreads; ++i) {
+        const int begin = (int)((long long)times*i/numThreads);
+        const int end   = (int)((long long)times*(i+1)/numThreads);
+        threadInfo[i].range.store(packRange(begin, end),
+                                  std::memory_order_relaxed);
     }
+    activeWorkers.store(numThreads, std::memory_order_relaxed);
 
-    // Wake up the worker threads and wait until they finish.
-    runCondition.notify_all();
-    waitCondition.wait(lock,
-        [&] { return waitingThreadCount == (int)threads.size(); });
-    lock.unlock();
-}
-void ParallelExecutorImpl::incrementWaitingThreads() {
-    std::lock_guard<std::mutex> lock(runMutex);
-    getCurrentTask().finish();
-    waitingThreadCount++;
-    if (waitingThreadCount == (int)threads.size()) {
-        waitCondition.notify_one();
+    // Publish the task and wake any worker that has gone to sleep.
+    generation.fetch_add(1);
+    if (sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(runMutex);
+        runCondition.notify_all();
     }
+
+    waitForWorkers();
+    busy.store(false);
+}
+void ParallelExecutorImpl::waitForWorkers() {
+    auto done = [this] { return activeWorkers.load() == 0; };
+    if (spinUntil(done))
+        return;
+    std::unique_lock<std::mutex> lock(waitMutex);
+    callerSleeping = true;
+    waitCondition.wait(lock, done);
+    callerSleeping = false;
+}
+bool ParallelExecutorImpl::waitForTask(int& seenGeneration) {
+    auto ready = [&] { return generation.load() != seenGeneration; };
+    if (!spinUntil(ready)) {
+        std::unique_lock<std::mutex> lock(runMutex);
+        sleepingWorkers.fetch_add(1);
+        runCondition.wait(lock, ready);
+        sleepingWorkers.fetch_sub(1);
+    }
+    seenGeneration = generation.load();
+    return !finished;
+}
+bool ParallelExecutorImpl::takeWork(ThreadInfo& info, int& begin, int& end) {
+    std::uint64_t range = info.range.load();
+    for (;;) {
+        const int b = rangeBegin(range), e = rangeEnd(range);
+        if (b >= e)
+            return false;
+        const int mid = std::min(e, b + chunkSize);
+        if (info.range.compare_exchange_weak(range, packRange(mid, e))) {
+            begin = b; end = mid;
+            return true;
+        }
+    }
+}
+bool ParallelExecutorImpl::stealWork(ThreadInfo& thief, int& begin, int& end) {
+    const int numThreads = getThreadCount();
+    for (int k = 1; k < numThreads; ++k) {
+        ThreadInfo& victim = threadInfo[(thief.index + k) % numThreads];
+        std::uint64_t range = victim.range.load();
+        for (;;) {
+            const int b = rangeBegin(range), e = rangeEnd(range);
+            if (b >= e)
+                break;
+            // Take the back half of the victim's remaining indices. We run
+            // the first chunk of it right away and publish the rest as our
+            // own range so that it can be stolen in turn.
+            const int split = e - std::max(1, (e-b)/2);
+            if (victim.range.compare_exchange_weak(range, packRange(b, split))) {
+                const int mid = std::min(e, split + chunkSize);
+                thief.range.store(packRange(mid, e));
+                begin = split; end = mid;
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 thread_local bool ParallelExecutorImpl::isWorker(false);
+thread_local ParallelExecutorImpl* ParallelExecutorImpl::currentExecutor(nullptr);
 
 /**
  * This function contains the code executed by the worker threads.
  */
 
-void threadBody(ThreadInfo& info) {
-    ParallelExecutorImpl::isWorker = true;
-    ParallelExecutorImpl& executor = *info.executor;
-    int threadCount = executor.getThreadCount();
-    while (!executor.isFinished()) {
+void ParallelExecutorImpl::runWorker(ThreadInfo& info) {
+    isWorker = true;
+    currentExecutor = this;
+    int seenGeneration = 0;
+    while (waitForTask(seenGeneration)) {
         
-        // Wait for a Task to come in.
+        // Execute the task for our own indices, then help the others.
         
-        std::unique_lock<std::mutex> lock(executor.getMutex());
-        executor.getCondition().wait(lock, [&] { return info.running; });
-        lock.unlock();
-        if (!executor.isFinished()) {
-            
-            // Execute the task for all the indices belonging to this thread.
-            
-            int count = executor.getCurrentTaskCount();
-            ParallelExecutor::Task& task = executor.getCurrentTask();
-            task.initialize();
-            int index = info.index;
+        ParallelExecutor::Task& task = *currentTask;
+        task.initialize();
+        int begin, end;
                         
-            try {
-                while (index < count) {
+        try {
+            while (takeWork(info, begin, end) || stealWork(info, begin, end))
+                for (int index = begin; index < end; ++index)
                     task.execute(index);
-                    index += threadCount;
-                }
-            }
-            catch (const std::exception& ex) {
-                std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
-                std::cerr <<ex.what()<< std::endl;
-            }
-            catch (...) {
-                std::cerr <<"The parallel task threw an error."<< std::endl;
-            }
-            info.running = false;
-            executor.incrementWaitingThreads();
+        }
+        catch (const std::exception& ex) {
+            std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
+            std::cerr <<ex.what()<< std::endl;
+        }
+        catch (...) {
+            std::cerr <<"The parallel task threw an error."<< std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(finishMutex);
+            task.finish();
+        }
+        if (activeWorkers.fetch_sub(1) == 1 && callerSleeping) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            waitCondition.notify_one();
         }
     }
 }
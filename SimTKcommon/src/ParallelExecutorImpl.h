@@ -31,26 +31,40 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
 
 namespace SimTK {
 
 class ParallelExecutorImpl;
 
 /**
- * This class stores per-thread information used while executing a task.
+ * This class stores per-thread information used while executing a task. Each
+ * worker owns a contiguous range of task indices, packed into a single 64-bit
+ * word (begin in the low half, end in the high half) so that the owner can
+ * take chunks from the front and idle workers can steal from the back using
+ * nothing more than compare-and-swap.
  */
 
 class ThreadInfo {
 public:
-    ThreadInfo(int index, ParallelExecutorImpl* executor) : index(index), executor(executor), running(false) {
+    ThreadInfo() : range(0), index(0), executor(nullptr) {
     }
-    const int index;
-    ParallelExecutorImpl* const executor;
-    bool running;
+    std::atomic<std::uint64_t> range;
+    // Keep each worker's range on its own cache line.
+    char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+    int index;
+    ParallelExecutorImpl* executor;
 };
 
 /**
- * This is the internal implementation class for ParallelExecutor.
+ * This is the internal implementation class for ParallelExecutor. It is a
+ * work-stealing scheduler: execute() splits the index range evenly over the
+ * workers, each worker consumes its own range in chunks and then steals half
+ * of whatever is left in another worker's range. Workers and the calling
+ * thread spin briefly before parking on a condition variable, so that
+ * back-to-back short tasks do not pay for a kernel wake-up each time.
  */
 
 class ParallelExecutorImpl : public PIMPLImplementation<ParallelExecutor, ParallelExecutorImpl> {
@@ -60,39 +74,40 @@ public:
     ~ParallelExecutorImpl();
     ParallelExecutorImpl* clone() const;
     void execute(ParallelExecutor::Task& task, int times);
-    int getThreadCount() {
-        return threads.size();
-    }
-    ParallelExecutor::Task& getCurrentTask() {
-        return *currentTask;
-    }
-    int getCurrentTaskCount() {
-        return currentTaskCount;
-    }
-    bool isFinished() {
-        return finished;
-    }
-    std::mutex& getMutex() {
-        return runMutex;
-    }
-    std::condition_variable& getCondition() {
-        return runCondition;
+    int getThreadCount() const {
+        return (int)threads.size();
     }
     int getMaxThreads() const{
       return numMaxThreads;
     }
-    void incrementWaitingThreads();
+    void runWorker(ThreadInfo& info);
     static thread_local bool isWorker;
 private:
-    bool finished;
-    std::mutex runMutex;
+    void launchThreads();
+    bool waitForTask(int& seenGeneration);
+    bool takeWork(ThreadInfo& info, int& begin, int& end);
+    bool stealWork(ThreadInfo& thief, int& begin, int& end);
+    void waitForWorkers();
+
+    std::atomic<bool> finished;
+    std::atomic<int> generation;
+    std::atomic<int> sleepingWorkers;
+    std::atomic<int> activeWorkers;
+    std::atomic<bool> callerSleeping;
+    // Set while a task is being run on the workers; a call to execute() from
+    // another thread during that time runs serially instead.
+    std::atomic<bool> busy;
+    std::mutex runMutex, waitMutex, finishMutex;
     std::condition_variable runCondition, waitCondition;
     Array_<std::thread> threads;
-    Array_<ThreadInfo> threadInfo;
+    std::unique_ptr<ThreadInfo[]> threadInfo;
     ParallelExecutor::Task* currentTask;
     int currentTaskCount;
-    int waitingThreadCount;
+    int chunkSize;
     int numMaxThreads;
+    // The executor whose worker is running on this thread, if any; used to
+    // detect nested calls to execute().
+    static thread_local ParallelExecutorImpl* currentExecutor;
 };
 
 } // namespace SimTK
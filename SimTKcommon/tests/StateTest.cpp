@@ -518,6 +518,330 @@ void testConsistent() {
 
 }
 
+// copyValuesFrom() works in place between states that share their Instance
+// stage, which a copy does until Instance stage is invalidated in either one.
+void testCopyValues() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dvxParam = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<Real>(1));
+    const DiscreteVariableIndex dvxDyn = 
+        s.allocateDiscreteVariable(Sub0, Stage::Dynamics, new Value<Real>(2));
+    advanceStage(s, Stage::Topology);
+    s.allocateQ(Sub0, Vector(2, Real(0)));
+    s.allocateU(Sub0, Vector(2, Real(0)));
+    advanceStage(s, Stage::Model);
+
+    State copy = s;
+    SimTK_TEST(!copy.canCopyValuesFrom(s)); // not realized through Instance
+    advanceStage(s, Stage::Instance);
+    copy = s;
+    SimTK_TEST(copy.canCopyValuesFrom(s) && s.canCopyValuesFrom(copy));
+
+    s.updTime() = 3;
+    s.updQ()[1] = 4;
+    s.updU()[0] = 5;
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxDyn)) = 6;
+    SimTK_TEST(copy.canCopyValuesFrom(s));
+    const Real* qData = &copy.getQ()[0];
+    copy.copyValuesFrom(s);
+    SimTK_TEST(copy.getSystemStage() == Stage::Instance);
+    SimTK_TEST(copy.getTime() == 3);
+    SimTK_TEST(copy.getQ()[1] == 4 && copy.getU()[0] == 5);
+    SimTK_TEST(&copy.getQ()[0] == qData); // no reallocation
+    SimTK_TEST(Value<Real>::downcast(copy.getDiscreteVariable(Sub0, dvxDyn))
+               == 6);
+
+    // Each State counts its own changes, so equal value versions say nothing
+    // about the values.
+    Value<Real>::updDowncast(copy.updDiscreteVariable(Sub0, dvxDyn)) = 8;
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxDyn)) = 9;
+    SimTK_TEST(copy.canCopyValuesFrom(s));
+    copy.copyValuesFrom(s);
+    SimTK_TEST(Value<Real>::downcast(copy.getDiscreteVariable(Sub0, dvxDyn))
+               == 9);
+
+    // Changing a parameter means the Instance stage isn't shared any more,
+    // even after it is realized again.
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxParam)) = 7;
+    SimTK_TEST(!copy.canCopyValuesFrom(s));
+    advanceStage(s, Stage::Instance);
+    SimTK_TEST(!copy.canCopyValuesFrom(s));
+    SimTK_TEST_MUST_THROW(copy.copyValuesFrom(s));
+    copy = s;
+    SimTK_TEST(copy.canCopyValuesFrom(s));
+    SimTK_TEST(Value<Real>::downcast(copy.getDiscreteVariable(Sub0, dvxParam))
+               == 7);
+}
+
+// Two copies of the same default State that are given different Instance
+// stage parameters and then realized independently have identical stage and
+// value versions, but they don't share an Instance stage.
+void testIndependentCopiesNotCompatible() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dvxParam = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<Real>(1));
+    advanceStage(s, Stage::Topology);
+    s.allocateQ(Sub0, Vector(2, Real(0)));
+    advanceStage(s, Stage::Model);
+
+    State a = s, b = s;
+    Value<Real>::updDowncast(a.updDiscreteVariable(Sub0, dvxParam)) = 2;
+    Value<Real>::updDowncast(b.updDiscreteVariable(Sub0, dvxParam)) = 3;
+    advanceStage(a, Stage::Instance);
+    advanceStage(b, Stage::Instance);
+    SimTK_TEST(!a.canCopyValuesFrom(b) && !b.canCopyValuesFrom(a));
+    SimTK_TEST_MUST_THROW(a.copyValuesFrom(b));
+    SimTK_TEST(Value<Real>::downcast(a.getDiscreteVariable(Sub0, dvxParam))
+               == 2);
+
+    // Same parameters, but still two separate realizations of Instance.
+    State c = s, d = s;
+    advanceStage(c, Stage::Instance);
+    advanceStage(d, Stage::Instance);
+    SimTK_TEST(!c.canCopyValuesFrom(d));
+
+    // A copy of either one is compatible with it, and stays so through
+    // further copies.
+    State e = a;
+    State f = e;
+    SimTK_TEST(e.canCopyValuesFrom(a) && f.canCopyValuesFrom(a));
+    SimTK_TEST(!f.canCopyValuesFrom(b));
+}
+
+// Copying a State shares the values that weren't written since the source's
+// previous copy through read-only snapshots, and clones the rest. The
+// source's own values never move, whoever writes first.
+void testCopySharesSnapshots() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dvxParam = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<Real>(1));
+    const DiscreteVariableIndex dvxDyn = 
+        s.allocateDiscreteVariable(Sub0, Stage::Dynamics, new Value<Real>(2));
+    const CacheEntryIndex cxTopo =
+        s.allocateCacheEntry(Sub0, Stage::Topology, new Value<Real>(3));
+    const CacheEntryIndex cxPos =
+        s.allocateCacheEntry(Sub0, Stage::Position, new Value<Real>(4));
+    advanceStage(s, Stage::Topology);
+    s.allocateQ(Sub0, Vector(2, Real(0)));
+    advanceStage(s, Stage::Model);
+    advanceStage(s, Stage::Instance);
+    advanceStage(s, Stage::Time);
+    advanceStage(s, Stage::Position);
+
+    const AbstractValue* param = &s.getDiscreteVariable(Sub0, dvxParam);
+    const AbstractValue* dyn   = &s.getDiscreteVariable(Sub0, dvxDyn);
+    const AbstractValue* topo  = &s.getCacheEntry(Sub0, cxTopo);
+    const AbstractValue* pos   = &s.getCacheEntry(Sub0, cxPos);
+    auto sourceDidNotMove = [&] {
+        return &s.getDiscreteVariable(Sub0, dvxParam) == param
+            && &s.getDiscreteVariable(Sub0, dvxDyn)   == dyn
+            && &s.getCacheEntry(Sub0, cxTopo)         == topo
+            && &s.getCacheEntry(Sub0, cxPos)          == pos;
+    };
+
+    // The first copy clones every value. Values that are still unchanged
+    // when the source is copied again are snapshotted, and later copies
+    // borrow the same snapshots.
+    State copy0 = s;
+    const AbstractValue* cloneParam = &copy0.getDiscreteVariable(Sub0,dvxParam);
+    State copy1 = s, copy2 = s;
+    advanceStage(copy1, Stage::Time);
+    advanceStage(copy1, Stage::Position);
+    SimTK_TEST(sourceDidNotMove());
+    const AbstractValue* snapParam = &copy1.getDiscreteVariable(Sub0,dvxParam);
+    const AbstractValue* snapTopo  = &copy1.getCacheEntry(Sub0, cxTopo);
+    SimTK_TEST(snapParam != param && snapTopo != topo);
+    SimTK_TEST(cloneParam != param && cloneParam != snapParam);
+    SimTK_TEST(&copy2.getDiscreteVariable(Sub0, dvxParam) == snapParam);
+    SimTK_TEST(&copy2.getCacheEntry(Sub0, cxTopo) == snapTopo);
+    SimTK_TEST(&copy1.getDiscreteVariable(Sub0, dvxDyn)
+               == &copy2.getDiscreteVariable(Sub0, dvxDyn));
+    SimTK_TEST(&copy1.getCacheEntry(Sub0, cxPos) != pos);
+    SimTK_TEST(Value<Real>::downcast(*snapParam) == 1);
+    SimTK_TEST(Value<Real>::downcast(*snapTopo) == 3);
+
+    // A value written before every copy is cloned into each copy without
+    // a snapshot, so each copy gets its own.
+    const AbstractValue* snapDyn = &copy1.getDiscreteVariable(Sub0, dvxDyn);
+    {   Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxDyn)) = 10;
+        State copy3 = s;
+        Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxDyn)) = 11;
+        State copy4 = s;
+        SimTK_TEST(sourceDidNotMove());
+        const AbstractValue& dyn3 = copy3.getDiscreteVariable(Sub0, dvxDyn);
+        const AbstractValue& dyn4 = copy4.getDiscreteVariable(Sub0, dvxDyn);
+        SimTK_TEST(&dyn3 != snapDyn && &dyn3 != &dyn4);
+        SimTK_TEST(Value<Real>::downcast(dyn3) == 10);
+        SimTK_TEST(Value<Real>::downcast(dyn4) == 11);
+        SimTK_TEST(Value<Real>::downcast(*snapDyn) == 2);
+    }
+
+    // Writing on the source leaves it in place and doesn't affect the
+    // copies. The source's next copies get a new snapshot.
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxParam)) = 5;
+    Value<Real>::updDowncast(s.updCacheEntry(Sub0, cxTopo)) = 6;
+    advanceStage(s, Stage::Instance);
+    advanceStage(s, Stage::Time);
+    advanceStage(s, Stage::Position);
+    SimTK_TEST(sourceDidNotMove());
+    SimTK_TEST(Value<Real>::downcast(*snapParam) == 1);
+    SimTK_TEST(Value<Real>::downcast(*snapTopo) == 3);
+    State copy3 = s;
+    SimTK_TEST(&copy3.getDiscreteVariable(Sub0, dvxParam) != snapParam);
+    SimTK_TEST(Value<Real>::downcast(copy3.getDiscreteVariable(Sub0, dvxParam))
+               == 5);
+
+    // Writing on a copy gives it its own value, which then stays put, and
+    // doesn't disturb the other copy.
+    Value<Real>::updDowncast(copy1.updDiscreteVariable(Sub0, dvxParam)) = 7;
+    const AbstractValue* own = &copy1.getDiscreteVariable(Sub0, dvxParam);
+    SimTK_TEST(own != snapParam);
+    Value<Real>::updDowncast(copy1.updDiscreteVariable(Sub0, dvxParam)) = 8;
+    SimTK_TEST(&copy1.getDiscreteVariable(Sub0, dvxParam) == own);
+    SimTK_TEST(&copy2.getDiscreteVariable(Sub0, dvxParam) == snapParam);
+    SimTK_TEST(Value<Real>::downcast(*snapParam) == 1);
+    SimTK_TEST(sourceDidNotMove());
+
+    // Once no one else holds a snapshot, the copy that writes it takes it
+    // over instead of cloning it.
+    Value<Real>::updDowncast(copy2.updDiscreteVariable(Sub0, dvxParam)) = 9;
+    SimTK_TEST(&copy2.getDiscreteVariable(Sub0, dvxParam) == snapParam);
+    SimTK_TEST(Value<Real>::downcast(*snapParam) == 9);
+}
+
+// A StateHistory keeps one full State plus per-checkpoint deltas until a
+// change at Instance stage forces another full State.
+void testStateHistory() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dvxParam = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<Real>(1));
+    const DiscreteVariableIndex dvxDyn = 
+        s.allocateDiscreteVariable(Sub0, Stage::Dynamics, new Value<Real>(2));
+    advanceStage(s, Stage::Topology);
+    s.allocateQ(Sub0, Vector(2, Real(0)));
+    advanceStage(s, Stage::Model);
+    advanceStage(s, Stage::Instance);
+
+    auto getDyn = [&](const State& state) 
+    {   return Value<Real>::downcast(state.getDiscreteVariable(Sub0, dvxDyn)); };
+    auto setDyn = [&](State& state, Real v) 
+    {   Value<Real>::updDowncast(state.updDiscreteVariable(Sub0, dvxDyn)) = v; };
+
+    StateHistory history(3);
+    SimTK_TEST(history.getCapacity() == 3 && history.getNumCheckpoints() == 0);
+    SimTK_TEST(history.findCheckpoint(0) == -1);
+
+    // Checkpoints at t=0,1,2,3; the first gets replaced.
+    for (int i=0; i < 4; ++i) {
+        s.setTime(i);
+        s.updQ()[0] = 10*i;
+        if (i == 2) setDyn(s, 20);
+        history.record(s);
+    }
+    SimTK_TEST(history.getNumCheckpoints() == 3);
+    SimTK_TEST(history.getNumFullStates() == 1);
+    SimTK_TEST(history.getCheckpointTime(0) == 1);
+    SimTK_TEST(history.getCheckpointTime(2) == 3);
+    SimTK_TEST(history.findCheckpoint(0.5) == -1);
+    SimTK_TEST(history.findCheckpoint(2.5) == 1);
+    SimTK_TEST(history.findCheckpoint(7) == 2);
+    State earlier(s);
+    earlier.setTime(2.5);
+    SimTK_TEST_MUST_THROW(history.record(earlier)); // time went backwards
+
+    // Restore in place; the discrete variable goes back too.
+    const Real* qData = &s.getQ()[0];
+    history.restore(0, s);
+    SimTK_TEST(s.getTime() == 1 && s.getQ()[0] == 10 && getDyn(s) == 2);
+    SimTK_TEST(s.getSystemStage() == Stage::Instance);
+    SimTK_TEST(&s.getQ()[0] == qData);
+    history.restore(1, s);
+    SimTK_TEST(s.getTime() == 2 && s.getQ()[0] == 20 && getDyn(s) == 20);
+
+    // Restore into a State that has nothing in common with the history.
+    State other;
+    history.restore(2, other);
+    SimTK_TEST(other.getTime() == 3 && other.getQ()[0] == 30);
+    SimTK_TEST(getDyn(other) == 20);
+
+    // Roll back to t=2 and record an alternative t=3 after changing a 
+    // parameter, which needs another full State.
+    history.restore(1, s);
+    history.discardCheckpointsAfter(1);
+    SimTK_TEST(history.getNumCheckpoints() == 2);
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxParam)) = 5;
+    advanceStage(s, Stage::Instance);
+    s.setTime(3);
+    history.record(s);
+    SimTK_TEST(history.getNumCheckpoints() == 3);
+    SimTK_TEST(history.getNumFullStates() == 2);
+
+    history.restore(0, s);
+    SimTK_TEST(Value<Real>::downcast(s.getDiscreteVariable(Sub0, dvxParam)) 
+               == 1);
+    history.restore(2, s);
+    SimTK_TEST(Value<Real>::downcast(s.getDiscreteVariable(Sub0, dvxParam)) 
+               == 5);
+    SimTK_TEST(s.getTime() == 3 && getDyn(s) == 20);
+
+    history.clear();
+    SimTK_TEST(history.getNumCheckpoints() == 0);
+    SimTK_TEST(history.getCapacity() == 3);
+}
+
+// The States recorded in one history can be different States of the same
+// lineage, like an integrator's advanced and interpolated States. Each counts
+// its own changes, so the same value version can mean different values.
+void testStateHistoryOfTwoStates() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dvxDyn = 
+        s.allocateDiscreteVariable(Sub0, Stage::Dynamics, new Value<Real>(2));
+    advanceStage(s, Stage::Topology);
+    s.allocateQ(Sub0, Vector(1, Real(0)));
+    advanceStage(s, Stage::Model);
+    advanceStage(s, Stage::Instance);
+
+    auto getDyn = [&](const State& state) 
+    {   return Value<Real>::downcast(state.getDiscreteVariable(Sub0, dvxDyn)); };
+    auto setDyn = [&](State& state, Real v) 
+    {   Value<Real>::updDowncast(state.updDiscreteVariable(Sub0, dvxDyn)) = v; };
+
+    StateHistory history(4);
+    State other(s);
+    setDyn(other, 7);
+    history.record(other);
+    setDyn(s, 99);
+    s.setTime(1);
+    history.record(s);
+    SimTK_TEST(history.getNumFullStates() == 1);
+
+    State restored;
+    history.restore(1, restored);
+    SimTK_TEST(restored.getTime() == 1 && getDyn(restored) == 99);
+    history.restore(0, restored);
+    SimTK_TEST(restored.getTime() == 0 && getDyn(restored) == 7);
+
+    // The other way round: the full State now comes from s.
+    history.clear();
+    history.record(s);
+    other.setTime(2);
+    history.record(other);
+    history.restore(1, restored);
+    SimTK_TEST(restored.getTime() == 2 && getDyn(restored) == 7);
+    history.restore(0, restored);
+    SimTK_TEST(getDyn(restored) == 99);
+}
+
 int main() {
     int major,minor,build;
     char out[100];
@@ -537,5 +861,10 @@ int main() {
         SimTK_SUBTEST(testCacheValidity);
         SimTK_SUBTEST(testMisc);
         SimTK_SUBTEST(testConsistent);
+        SimTK_SUBTEST(testCopyValues);
+        SimTK_SUBTEST(testIndependentCopiesNotCompatible);
+        SimTK_SUBTEST(testCopySharesSnapshots);
+        SimTK_SUBTEST(testStateHistory);
+        SimTK_SUBTEST(testStateHistoryOfTwoStates);
     SimTK_END_TEST();
 }
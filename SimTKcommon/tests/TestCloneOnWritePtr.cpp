@@ -33,6 +33,8 @@ SimTK::ReinitOnCopy. */
 #include <utility>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <thread>
 
 using namespace SimTK;
 using std::cout; using std::endl; using std::string; using std::unique_ptr;
@@ -342,6 +344,40 @@ void testAllocate() {
 
 }
 
+// Containers sharing an object can be copied, written and destructed
+// concurrently; the use count must stay exact or objects would leak or be
+// deleted twice. (Base's counters aren't thread safe so use another class.)
+class Shared {
+public:
+    explicit Shared(int v) : m_value(v) {++m_numAlive;}
+    Shared(const Shared& src) : m_value(src.m_value) {++m_numAlive;}
+    ~Shared() {--m_numAlive;}
+    Shared* clone() const {return new Shared(*this);}
+    int m_value;
+    static std::atomic<int> m_numAlive;
+};
+std::atomic<int> Shared::m_numAlive(0);
+
+void testSharingAcrossThreads() {
+    {
+        const CloneOnWritePtr<Shared> original(new Shared(1));
+        std::vector<std::thread> threads;
+        for (int t=0; t < 4; ++t)
+            threads.emplace_back([&original, t]() {
+                for (int i=0; i < 10000; ++i) {
+                    CloneOnWritePtr<Shared> mine(original);
+                    CloneOnWritePtr<Shared> another(mine);
+                    mine.upd()->m_value = t; // detach
+                }
+            });
+        for (auto& thread : threads)
+            thread.join();
+        SimTK_TEST(original.unique() && original->m_value == 1);
+        SimTK_TEST(Shared::m_numAlive == 1);
+    }
+    SimTK_TEST(Shared::m_numAlive == 0);
+}
+
 // Call this at the end after all the destructors should have been
 // called for anything allocated in the other tests. The Base class
 // has been counting them.
@@ -636,6 +672,7 @@ int main() {
     SimTK_START_TEST("TestCloneOnWritePtr");
         SimTK_SUBTEST(testEmpty);
         SimTK_SUBTEST(testAllocate);
+        SimTK_SUBTEST(testSharingAcrossThreads);
         SimTK_SUBTEST(testForLeaks);
 
         SimTK_SUBTEST(testResetOnCopy);
@@ -24,6 +24,7 @@
 #include "SimTKcommon.h"
 
 #include <iostream>
+#include <cmath>
 
 #define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
 
@@ -93,6 +94,75 @@ void testSingleThreadedExecution() {
         ASSERT(flags[j] == (j < numFlags-10 ? 1 : 0));
 }
 
+// Each index does an amount of work proportional to its value, so a static
+// partition would leave most threads idle; every index must still be executed
+// exactly once.
+class UnevenTask : public ParallelExecutor::Task {
+public:
+    UnevenTask(Array_<int>& flags) : flags(flags) {
+    }
+    void execute(int index) override {
+        volatile double sum = 0;
+        for (int i = 0; i < 100*index; ++i)
+            sum += std::sqrt((double)i);
+        flags[index]++;
+    }
+private:
+    Array_<int>& flags;
+};
+
+void testUnevenWork() {
+    const int numFlags = 200;
+    Array_<int> flags(numFlags);
+    ParallelExecutor executor(4);
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < numFlags; ++j)
+            flags[j] = 0;
+        UnevenTask task(flags);
+        executor.execute(task, numFlags);
+        for (int j = 0; j < numFlags; ++j)
+            ASSERT(flags[j] == 1);
+    }
+}
+
+// A task that calls back into the executor that is running it.
+class NestedTask : public ParallelExecutor::Task {
+public:
+    NestedTask(ParallelExecutor& executor, Array_<int>& flags, int innerCount)
+    :   executor(executor), flags(flags), innerCount(innerCount) {
+    }
+    void execute(int index) override {
+        InnerTask inner(flags, index*innerCount);
+        executor.execute(inner, innerCount);
+    }
+private:
+    class InnerTask : public ParallelExecutor::Task {
+    public:
+        InnerTask(Array_<int>& flags, int offset)
+        :   flags(flags), offset(offset) {
+        }
+        void execute(int index) override {
+            flags[offset+index]++;
+        }
+    private:
+        Array_<int>& flags;
+        int offset;
+    };
+    ParallelExecutor& executor;
+    Array_<int>& flags;
+    int innerCount;
+};
+
+void testNestedExecution() {
+    const int outerCount = 16, innerCount = 10;
+    Array_<int> flags(outerCount*innerCount, 0);
+    ParallelExecutor executor(3);
+    NestedTask task(executor, flags, innerCount);
+    executor.execute(task, outerCount);
+    for (int j = 0; j < outerCount*innerCount; ++j)
+        ASSERT(flags[j] == 1);
+}
+
 void testResizeThreads() {
     for(int x = 1; x < 100; ++x)
     {
@@ -104,6 +174,8 @@ int main() {
     SimTK_START_TEST("TestParallelExecutor");
         SimTK_SUBTEST(testParallelExecution);
         SimTK_SUBTEST(testSingleThreadedExecution);
+        SimTK_SUBTEST(testUnevenWork);
+        SimTK_SUBTEST(testNestedExecution);
         SimTK_SUBTEST(testResizeThreads);
     SimTK_END_TEST();
     return 0;
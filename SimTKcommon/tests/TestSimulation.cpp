@@ -33,6 +33,7 @@
 
 #include <map>
 #include <iostream>
+#include <sstream>
 using std::cout;
 using std::endl;
 
@@ -861,8 +862,77 @@ void testOne() {
     }
 }
 
+static long long fakeAllocationCount = 0;
+static long long countFakeAllocations() {return ++fakeAllocationCount;}
+
+void testRealizationProfile() {
+    TestSystem sys;
+    TestSubsystem subsys(sys);
+    const SubsystemIndex subIx = subsys.getMySubsystemIndex();
+    // Integrate evaluates the lazy Sinusoid during Acceleration realization.
+    Measure::Sinusoid cos2pit(subsys, 1, 2*Pi, Pi/2);
+    Measure::Integrate integ(subsys, cos2pit, Measure::Zero(subsys));
+
+    ASSERT(!sys.isRealizationProfilingEnabled());
+    sys.setRealizationProfilingEnabled(true);
+    ASSERT(sys.isRealizationProfilingEnabled());
+    RealizationProfile::setAllocationCounter(countFakeAllocations);
+
+    State state = sys.realizeTopology();
+    const int NRealize = 5;
+    for (int i=0; i < NRealize; ++i) {
+        state.invalidateAllCacheAtOrAbove(Stage::Time);
+        sys.realize(state, Stage::Acceleration);
+    }
+
+    const RealizationProfile& profile = sys.getRealizationProfile();
+    ASSERT(profile.getNumSubsystems() == sys.getNumSubsystems());
+    ASSERT(profile.getNumCalls(Stage::Topology) == 1);
+    ASSERT(profile.getNumCalls(Stage::Model) == 1); // the default State
+    ASSERT(profile.getNumCalls(Stage::Instance) == 1);
+    ASSERT(profile.getNumCalls(Stage::Time) == NRealize);
+    ASSERT(profile.getNumCalls(Stage::Acceleration) == NRealize);
+    ASSERT(profile.getNumCalls(subIx, Stage::Position) == NRealize);
+    ASSERT(profile.getNumCalls(subIx, Stage::Acceleration) == NRealize);
+    ASSERT(profile.getWallTime(Stage::Time) >= 0);
+    ASSERT(profile.getWallTime(Stage::Time)
+           >= profile.getWallTime(subIx, Stage::Time));
+    // Every start and stop of a timer calls the counter once.
+    ASSERT(profile.getNumAllocations(subIx, Stage::Velocity) == NRealize);
+
+    ASSERT(profile.getNumCacheEntryRealizations(subIx, Stage::Time)
+           == NRealize);
+
+    std::ostringstream csv, json;
+    profile.writeCSV(csv);
+    profile.writeJSON(json);
+    ASSERT(csv.str().find("subsystem,name,stage,calls,") == 0);
+    ASSERT(csv.str().find(",\"System\",Acceleration,5,")
+           != std::string::npos);
+    ASSERT(json.str().find("\"subsystems\"") != std::string::npos);
+    ASSERT(json.str().find("\"stage\": \"Position\"") != std::string::npos);
+    ASSERT(json.str().find("\"cacheEntries\": 5}") != std::string::npos);
+
+    // Nothing is recorded while profiling is off, and turning it back on
+    // keeps what was there.
+    RealizationProfile::setAllocationCounter(nullptr);
+    sys.setRealizationProfilingEnabled(false);
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    sys.realize(state, Stage::Acceleration);
+    ASSERT(profile.getNumCalls(Stage::Time) == NRealize);
+    sys.setRealizationProfilingEnabled(true);
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    sys.realize(state, Stage::Acceleration);
+    ASSERT(profile.getNumCalls(Stage::Time) == NRealize+1);
+    ASSERT(profile.getNumAllocations(subIx, Stage::Velocity) == NRealize);
+
+    sys.resetAllCountersToZero();
+    ASSERT(profile.getNumCalls(Stage::Time) == 0);
+}
+
 int main() {
     try {
+        testRealizationProfile();
         testOne();
     } catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
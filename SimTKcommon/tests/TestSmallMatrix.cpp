@@ -485,6 +485,65 @@ void testAppendRowCol() {
 
 }
 
+// The vectorized 3x3 kernels in SmallMatrixSIMD.h must give the same answers
+// as the generic templates they replace, which we call explicitly here. They
+// are bitwise identical unless the compiler is fusing multiplies and adds.
+template <class T>
+static void testSameAsGeneric(const T& simd, const T& generic) {
+#ifdef __FMA__
+    SimTK_TEST_EQ_TOL(simd, generic, 4*NTraits<double>::getEps());
+#else
+    SimTK_TEST(simd == generic);
+#endif
+}
+
+void testSIMDKernels() {
+    cout << "Small matrix kernels use: "
+         << getSmallMatrixSIMDInstructionSet() << endl;
+
+    typedef Mat<3,3,double,1,3> TMat33;
+    Random::Uniform random(-10, 10);
+    random.setSeed(17);
+    for (int trial=0; trial < 100; ++trial) {
+        Mat33 a, b; Vec3 v;
+        for (int i=0; i < 3; ++i) {
+            v[i] = random.getValue();
+            for (int j=0; j < 3; ++j) {
+                a(i,j) = random.getValue(); b(i,j) = random.getValue();
+            }
+        }
+        const TMat33& at = ~a;
+        const TMat33& bt = ~b;
+
+        testSameAsGeneric(a*v, SimTK::operator*<3,3,double,3,1,double,1>(a,v));
+        testSameAsGeneric(at*v, SimTK::operator*<3,3,double,1,3,double,1>(at,v));
+
+        testSameAsGeneric(a*b,
+            SimTK::operator*<3,3,double,3,1,3,double,3,1>(a,b));
+        testSameAsGeneric(a*bt,
+            SimTK::operator*<3,3,double,3,1,3,double,1,3>(a,bt));
+        testSameAsGeneric(at*b,
+            SimTK::operator*<3,3,double,1,3,3,double,3,1>(at,b));
+        testSameAsGeneric(at*bt,
+            SimTK::operator*<3,3,double,1,3,3,double,1,3>(at,bt));
+
+        // Rotations reach the same kernels through their base classes.
+        const Rotation R1(random.getValue(), UnitVec3(v));
+        const Rotation R2(random.getValue(), UnitVec3(b(0)));
+        const Mat33& m1 = R1;
+        const Mat33& m2 = R2;
+        testSameAsGeneric(R1*v,
+            SimTK::operator*<3,3,double,3,1,double,1>(m1,v));
+        testSameAsGeneric(~R1*v,
+            SimTK::operator*<3,3,double,1,3,double,1>(~m1,v));
+        testSameAsGeneric(Mat33(R1*R2),
+            SimTK::operator*<3,3,double,3,1,3,double,3,1>(m1,m2));
+        testSameAsGeneric(Mat33(R1*~R2),
+            SimTK::operator*<3,3,double,3,1,3,double,1,3>(m1,~m2));
+        SimTK_TEST_EQ(~R1*(R1*v), v);
+    }
+}
+
 int main() {
     SimTK_START_TEST("TestSmallMatrix");
         SimTK_SUBTEST(testSymMat);
@@ -498,5 +557,6 @@ int main() {
         SimTK_SUBTEST(testNumericallyEqual);
         SimTK_SUBTEST(testUnitVec);
         SimTK_SUBTEST(testAppendRowCol);
+        SimTK_SUBTEST(testSIMDKernels);
     SimTK_END_TEST();
 }
@@ -0,0 +1,160 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the dispatch latency of ParallelExecutor, that is, the wall time
+for executing a task whose indices do (almost) no work, and compares it with
+the mutex/condition-variable scheme that ParallelExecutor used before it
+became a work-stealing scheduler. The old scheme is reproduced here as
+LegacyExecutor so the comparison can be repeated on any machine.
+
+Usage: ParallelExecutorBenchmark [numThreads] [numRepetitions]
+*/
+
+#include "SimTKcommon.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using std::cout;
+using std::endl;
+using namespace SimTK;
+
+// Each index does a configurable amount of floating point work.
+class SpinTask : public ParallelExecutor::Task {
+public:
+    explicit SpinTask(int work) : work(work) {}
+    void execute(int index) override {
+        double sum = index;
+        for (int i = 0; i < work; ++i)
+            sum = sum*0.999 + 1;
+        result = sum;
+    }
+    volatile double result;
+private:
+    const int work;
+};
+
+// The ParallelExecutor implementation prior to the work-stealing scheduler:
+// one mutex and condition variable wake every worker, indices are handed out
+// round-robin, and finish() is called under the global mutex.
+class LegacyExecutor {
+public:
+    explicit LegacyExecutor(int numThreads)
+    :   finished(false), running(numThreads, false), currentTask(nullptr),
+        currentTaskCount(0), waitingThreadCount(0), threadCount(numThreads) {
+        for (int i = 0; i < numThreads; ++i)
+            threads.emplace_back([this, i] { threadBody(i); });
+    }
+    ~LegacyExecutor() {
+        std::unique_lock<std::mutex> lock(runMutex);
+        finished = true;
+        for (int i = 0; i < threadCount; ++i)
+            running[i] = true;
+        runCondition.notify_all();
+        lock.unlock();
+        for (auto& t : threads)
+            t.join();
+    }
+    void execute(ParallelExecutor::Task& task, int times) {
+        std::unique_lock<std::mutex> lock(runMutex);
+        currentTask = &task;
+        currentTaskCount = times;
+        waitingThreadCount = 0;
+        for (int i = 0; i < threadCount; ++i)
+            running[i] = true;
+        runCondition.notify_all();
+        waitCondition.wait(lock,
+            [&] { return waitingThreadCount == threadCount; });
+    }
+private:
+    void threadBody(int index) {
+        while (true) {
+            std::unique_lock<std::mutex> lock(runMutex);
+            runCondition.wait(lock, [&] { return (bool)running[index]; });
+            if (finished)
+                return;
+            lock.unlock();
+            currentTask->initialize();
+            for (int i = index; i < currentTaskCount; i += threadCount)
+                currentTask->execute(i);
+            lock.lock();
+            running[index] = false;
+            currentTask->finish();
+            if (++waitingThreadCount == threadCount)
+                waitCondition.notify_one();
+        }
+    }
+    bool finished;
+    Array_<bool> running;
+    std::mutex runMutex;
+    std::condition_variable runCondition, waitCondition;
+    ParallelExecutor::Task* currentTask;
+    int currentTaskCount;
+    int waitingThreadCount;
+    const int threadCount;
+    std::vector<std::thread> threads;
+};
+
+template <class Executor>
+static double timeDispatch(Executor& executor, int times, int work, int reps) {
+    SpinTask task(work);
+    executor.execute(task, times); // warm up; launches threads
+    const double start = realTime();
+    for (int r = 0; r < reps; ++r)
+        executor.execute(task, times);
+    return (realTime() - start)/reps;
+}
+
+int main(int argc, char** argv) {
+    const int numThreads = argc > 1 ? std::atoi(argv[1])
+                         : std::max(2, ParallelExecutor::getNumProcessors());
+    const int reps = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    cout << "Dispatch latency with " << numThreads << " threads, "
+         << reps << " repetitions (microseconds per execute()):\n";
+    cout << "  indices   work/index     legacy   stealing\n";
+
+    ParallelExecutor executor(numThreads);
+    const int timesList[] = {4, 16, 64, 256, 4096};
+    const int workList[]  = {0, 100, 1000};
+    for (int times : timesList) {
+        for (int work : workList) {
+            double legacy;
+            {
+                // Create the legacy threads only while measuring them so the
+                // two pools do not compete for processors while spinning.
+                LegacyExecutor old(numThreads);
+                legacy = timeDispatch(old, times, work, reps);
+            }
+            const double stealing = timeDispatch(executor, times, work, reps);
+            printf("  %7d   %10d   %8.2f   %8.2f\n", times, work,
+                   1e6*legacy, 1e6*stealing);
+        }
+    }
+    return 0;
+}
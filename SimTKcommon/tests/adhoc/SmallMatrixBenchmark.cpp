@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures nanoseconds per operation for the 3x3 products that have
+vectorized kernels in SmallMatrixSIMD.h, comparing them with the generic
+templates they replace (called explicitly). Cross products and symmetric
+matrix-vector products are timed too for reference; they are left to the
+generic code because vectorized versions were no faster. Each loop feeds its
+result back into the next operand so the operations can't be overlapped or
+hoisted.
+
+Usage: SmallMatrixBenchmark [numOperations]
+*/
+
+#include "SimTKcommon.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+typedef Mat<3,3,double,1,3> TMat33;
+
+static volatile double sink;
+
+template <class F>
+static double timeOps(int n, F f) {
+    const double start = realTime();
+    f(n);
+    return 1e9*(realTime() - start)/n;
+}
+
+static void report(const char* name, double generic, double simd) {
+    if (simd < 0)
+        printf("  %-10s %8.2f %8s\n", name, generic, "-");
+    else
+        printf("  %-10s %8.2f %8.2f %8.2fx\n", name, generic, simd,
+               generic/simd);
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 20000000;
+
+    Random::Uniform random(-1, 1);
+    Array_<Mat33> M(64); Array_<Vec3> V(64); Array_<SymMat33> S(64);
+    for (int k=0; k < 64; ++k) {
+        for (int i=0; i < 3; ++i) {
+            V[k][i] = random.getValue();
+            for (int j=0; j < 3; ++j) M[k](i,j) = random.getValue();
+        }
+        S[k].setFromSymmetric(M[k] + ~M[k]);
+    }
+
+    printf("Small matrix kernels use: %s\n",
+           getSmallMatrixSIMDInstructionSet());
+    printf("nanoseconds per operation\n");
+    printf("  %-10s %8s %8s %9s\n", "op", "generic", "SIMD", "speedup");
+
+    report("M*v",
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += operator*<3,3,double,3,1,double,1>
+                           (M[i&63], V[i&63] + acc*1e-9);
+            sink = acc[0];}),
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += M[i&63]*(V[i&63] + acc*1e-9);
+            sink = acc[0];}));
+
+    report("~M*v",
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += operator*<3,3,double,1,3,double,1>
+                           (~M[i&63], V[i&63] + acc*1e-9);
+            sink = acc[0];}),
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += ~M[i&63]*(V[i&63] + acc*1e-9);
+            sink = acc[0];}));
+
+    report("M*M",
+        timeOps(n, [&](int n) {
+            Mat33 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += operator*<3,3,double,3,1,3,double,3,1>
+                           (M[i&63], M[(i+1)&63] + acc*1e-9);
+            sink = acc(0,0);}),
+        timeOps(n, [&](int n) {
+            Mat33 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += M[i&63]*(M[(i+1)&63] + acc*1e-9);
+            sink = acc(0,0);}));
+
+    report("M*~M",
+        timeOps(n, [&](int n) {
+            Mat33 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += operator*<3,3,double,3,1,3,double,1,3>
+                           (M[i&63] + acc*1e-9, ~M[(i+1)&63]);
+            sink = acc(0,0);}),
+        timeOps(n, [&](int n) {
+            Mat33 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += (M[i&63] + acc*1e-9)*~M[(i+1)&63];
+            sink = acc(0,0);}));
+
+    report("v%w",
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += V[i&63] % (V[(i+1)&63] + acc*1e-9);
+            sink = acc[0];}),
+        -1);
+
+    report("S*v",
+        timeOps(n, [&](int n) {
+            Vec3 acc(0);
+            for (int i=0; i < n; ++i)
+                acc += S[i&63]*(V[i&63] + acc*1e-9);
+            sink = acc[0];}),
+        -1);
+
+    return 0;
+}
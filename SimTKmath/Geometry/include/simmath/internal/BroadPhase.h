@@ -0,0 +1,130 @@
+#ifndef SimTK_SIMMATH_BROAD_PHASE_H_
+#define SimTK_SIMMATH_BROAD_PHASE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+Defines the BroadPhase class, which finds the pairs of overlapping axis-aligned
+bounding boxes in a collection of objects. **/
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/internal/Geo.h"
+#include "simmath/internal/Geo_Box.h"
+
+#include <utility>
+
+namespace SimTK {
+
+//==============================================================================
+//                               BROAD PHASE
+//==============================================================================
+/** A %BroadPhase object finds all the pairs of objects whose axis-aligned
+bounding boxes overlap, as the first step of contact detection. The objects are
+identified by their position in the array of boxes passed to
+findOverlappingPairs(), and the result is a flat array of index pairs (i,j) with
+i < j, sorted by i and then by j. Boxes that just touch are considered to
+overlap.
+
+A %BroadPhase object is meant to be called repeatedly on the same collection of
+objects as they move. Some of the methods retain information from one call to
+the next and are much faster when the objects have moved only a little since the
+last call (temporal coherence). That information is discarded automatically if
+the number of objects changes, or explicitly by calling clear(). The result
+never depends on that information, only the time it takes to compute it; all
+methods produce exactly the same pairs.
+
+Methods:
+  - SweepAndPrune: sorts the boxes from scratch along the axis on which their
+    centers are most spread out, then sweeps along that axis testing the other
+    two axes only for boxes whose extents overlap on the sweep axis. This
+    remembers nothing between calls.
+  - IncrementalSweepAndPrune: the same sweep, but the sorted order is kept
+    between calls and repaired with an insertion sort, which is linear in the
+    number of objects when few of them have passed one another since the last
+    call. The sweeps are fastest when the objects are strung out along one
+    direction; when many objects share the same stretch of the sweep axis, as
+    in a pile or a bed of grains, most of the time goes into rejecting pairs
+    that overlap only along that axis.
+  - DynamicAABBTree: maintains a balanced bounding volume hierarchy of boxes
+    enlarged by a margin. An object is reinserted only when it leaves its
+    enlarged box, and each object's box is then tested against the tree. This
+    does not depend on how the objects are arranged and is the default.
+
+If you provide a ParallelExecutor to findOverlappingPairs(), the pair search
+(the sweep or the tree queries) is divided among its threads. Updating the
+sorted order or the tree is done serially. **/
+class SimTK_SIMMATH_EXPORT BroadPhase {
+public:
+    /** The available broad phase algorithms; see the BroadPhase class
+    description. **/
+    enum Method {
+        SweepAndPrune               = 0,
+        IncrementalSweepAndPrune    = 1,
+        DynamicAABBTree             = 2
+    };
+
+    /** The indices of two overlapping objects; the first is always the lower
+    one. **/
+    typedef std::pair<int,int> IndexPair;
+
+    /** Create a %BroadPhase object that uses the given method. **/
+    explicit BroadPhase(Method method = DynamicAABBTree);
+    BroadPhase(const BroadPhase& source);
+    BroadPhase& operator=(const BroadPhase& source);
+    ~BroadPhase();
+
+    /** Return the method currently in use. **/
+    Method getMethod() const;
+    /** Change the method to use for subsequent calls. This discards any
+    information retained from previous calls. **/
+    void setMethod(Method method);
+    /** Return a human-readable name for a method, for reporting. **/
+    static const char* getMethodName(Method method);
+
+    /** Discard any information retained from previous calls so that the next
+    call starts from scratch. **/
+    void clear();
+
+    /** Find all pairs of overlapping boxes. On return \a pairs contains one
+    entry (i,j) with i < j for each pair of overlapping boxes, sorted by i and
+    then by j; its previous contents are discarded but its heap space is
+    reused. If \a executor is given, its threads are used to search for the
+    pairs. **/
+    void findOverlappingPairs(const Array_<Geo::AlignedBox>& boxes,
+                              Array_<IndexPair>&             pairs,
+                              ParallelExecutor*              executor = nullptr);
+
+    /** Return the number of objects passed to the last call, or zero if there
+    has been no call since construction or the last clear(). **/
+    int getNumObjects() const;
+
+private:
+    class Impl;
+    Impl*   impl;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_BROAD_PHASE_H_
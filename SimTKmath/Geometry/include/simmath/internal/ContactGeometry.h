@@ -1232,11 +1232,18 @@ the TriangleMesh. Cost is 11 flops.
 @param uv      The point within the face, specified by its barycentric uv 
                coordinates. **/
 Vec3 findPoint(int face, const Vec2& uv) const;
-/** Calculate the location of a face's centroid, that is, the point uv=(1/3,1/3)
+/** Get the location of a face's centroid, that is, the point uv=(1/3,1/3)
 which is the average of the three vertex locations. This is a common special 
-case of findPoint() that can be calculated more quickly (7 flops).
+case of findPoint(); the centroids are calculated when the mesh is created
+so this costs nothing.
 @param face    The index of the face whose centroid is of interest. **/
 Vec3 findCentroid(int face) const;
+/** Get the centroids of all the faces, indexed by face, as calculated when
+the mesh was created. Use this rather than findCentroid() when looking at
+many faces at once. **/
+const Array_<Vec3>& getFaceCentroids() const;
+/** Get the areas of all the faces, indexed by face; see getFaceArea(). **/
+const Array_<Real>& getFaceAreas() const;
 /** Calculate the normal vector at a point on the surface.
 @param face    The index of the face containing the point.
 @param uv      The point within the face, specified by its barycentric uv 
@@ -1305,6 +1312,44 @@ hit.
                   stored in this. Otherwise, it is left unchanged.
 @return \c true if an intersection is found, \c false otherwise. **/
 bool intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, int& face, Vec2& uv) const;
+
+/** Find the nearest point on the surface to each of a set of points. This
+gives the same results as calling findNearestPoint(position, inside, face, uv)
+for each point, except that where several faces are equally close a different
+one may be chosen. It is considerably faster for many points, because it uses
+a compact copy of the Oriented Bounding Box Tree that tests several boxes at a
+time and reuses its working space from one query to the next. The output
+arrays are resized to the number of points.
+@param positions      The points in question.
+@param nearestPoints  On exit, the point on the surface closest to each point.
+@param inside         On exit, whether each point is inside this object.
+@param faces          On exit, the index of the face containing each nearest
+                      point.
+@param uvs            On exit, the barycentric coordinates (u and v) of each
+                      nearest point within its face.
+@param executor       If given, its threads share the queries. **/
+void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                       Array_<Vec3>& nearestPoints, Array_<bool>& inside,
+                       Array_<int>& faces, Array_<Vec2>& uvs,
+                       ParallelExecutor* executor = nullptr) const;
+/** Intersect a set of rays with this mesh. This gives the same results as
+calling intersectsRay(origin, direction, distance, face, uv) for each ray,
+using the same faster search as findNearestPoints(). The output arrays are
+resized to the number of rays.
+@param origins     The position at which each ray begins.
+@param directions  The direction of each ray.
+@param distances   On exit, the distance from each ray origin to the nearest
+                   intersection point, or Infinity if the ray misses the mesh.
+@param faces       On exit, the index of the face hit by each ray, or -1.
+@param uvs         On exit, the barycentric coordinates (u and v) of each
+                   intersection point within the hit face; NaN for a miss.
+@param executor    If given, its threads share the rays.
+@return The number of rays that hit the mesh. **/
+int intersectsRays(const ArrayViewConst_<Vec3>& origins,
+                   const ArrayViewConst_<UnitVec3>& directions,
+                   Array_<Real>& distances, Array_<int>& faces,
+                   Array_<Vec2>& uvs,
+                   ParallelExecutor* executor = nullptr) const;
 /** Get the OBBTreeNode which forms the root of this mesh's Oriented Bounding 
 Box Tree. **/
 OBBTreeNode getOBBTreeNode() const;
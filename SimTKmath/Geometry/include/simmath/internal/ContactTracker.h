@@ -74,17 +74,32 @@ class GeneralImplicitPair;
 
 /** Base class constructor for use by the concrete classes. **/
 ContactTracker(ContactGeometryTypeId typeOfSurface1,
-               ContactGeometryTypeId typeOfSurface2)
-:   m_surfaceTypes(typeOfSurface1, typeOfSurface2)
-{
-}
+               ContactGeometryTypeId typeOfSurface2);
 
 /** Return the pair of contact geometry type ids handled by this tracker,
 in the order that they must be presented to the tracker's methods. **/
 const std::pair<ContactGeometryTypeId,ContactGeometryTypeId>&
 getContactGeometryTypeIds() const {return m_surfaceTypes;}
 
-virtual ~ContactTracker() {}
+virtual ~ContactTracker();
+
+/**@name                     Cache statistics
+The trackers for contacts involving a TriangleMesh record, in each
+TriangleMeshContact they produce, where their search of the mesh's bounding
+box tree stopped. The next time they evaluate the same contact they resume
+from there, growing or shrinking that boundary as the surfaces move, rather
+than searching again from the root. These count how often that was possible;
+trackers that keep no such record report zero hits and misses. **/
+/**@{**/
+/** Return the number of contact evaluations that started from the record
+left by the previous evaluation of the same contact. **/
+long long getNumCacheHits() const;
+/** Return the number of contact evaluations that had to start from 
+scratch, because the contact was new or the record was missing. **/
+long long getNumCacheMisses() const;
+/** Set the hit and miss counts back to zero. **/
+void resetCacheStatistics() const;
+/**@}**/
 
 /** The ContactTrackerSubsystem will invoke this method for any pair of
 contact surfaces that is already being tracked, or for which the static broad 
@@ -164,11 +179,28 @@ static bool estimateConvexImplicitPairContactUsingMPR
     int& numIterations);
 
 
+//--------------------------------------------------------------------------
+                                protected:
+/** Concrete trackers that keep a per-contact cache call this once per
+evaluation to record whether they were able to use it. **/
+void noteCacheUse(bool wasHit) const;
+
+class Impl;
+/** Return the private state shared by all the concrete trackers. **/
+Impl& getImpl() const {return *m_impl;}
+
 //--------------------------------------------------------------------------
                                 private:
 // This tracker should be called only for surfaces of these two types,
 // in this order.
 std::pair<ContactGeometryTypeId,ContactGeometryTypeId> m_surfaceTypes;
+
+// Cache statistics and reusable search storage. Trackers may be invoked
+// concurrently for different contacts so this is thread safe.
+Impl* m_impl;
+
+ContactTracker(const ContactTracker&) = delete;
+ContactTracker& operator=(const ContactTracker&) = delete;
 };
 
 
@@ -289,14 +321,6 @@ bool trackContact
     const ContactGeometry& surface2,    // the mesh
     Real                   cutoff,
     Contact&               currentStatus) const override;
-
-private:
-void processBox(const ContactGeometry::TriangleMesh&              mesh, 
-                const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-                const Transform& X_HM, const UnitVec3& hsNormal_M, 
-                Real hsFaceHeight_M, std::set<int>& insideFaces) const;
-void addAllTriangles(const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-                     std::set<int>& insideFaces) const; 
 };
 
 
@@ -321,13 +345,6 @@ bool trackContact
     const ContactGeometry& surface2,    // the mesh
     Real                   cutoff,
     Contact&               currentStatus) const override;
-
-private:
-void processBox
-   (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-    const Vec3& center_M, Real radius2,   
-    std::set<int>& insideFaces) const ;
 };
 
 
@@ -354,16 +371,6 @@ bool trackContact
     Contact&               currentStatus) const override;
 
 private:
-void findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      insideFaces1, 
-    std::set<int>&                                      insideFaces2) const; 
-
 void findBuriedFaces
    (const ContactGeometry::TriangleMesh&    mesh,
     const ContactGeometry::TriangleMesh&    otherMesh,
@@ -0,0 +1,549 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/internal/BroadPhase.h"
+
+#include <algorithm>
+
+using namespace SimTK;
+
+namespace {
+
+// Boxes are stored as lower and upper corners, which is what the overlap
+// tests need.
+inline bool overlaps(const Vec3& lo1, const Vec3& hi1,
+                     const Vec3& lo2, const Vec3& hi2) {
+    return lo1[0] <= hi2[0] && lo2[0] <= hi1[0]
+        && lo1[1] <= hi2[1] && lo2[1] <= hi1[1]
+        && lo1[2] <= hi2[2] && lo2[2] <= hi1[2];
+}
+
+inline bool contains(const Vec3& outerLo, const Vec3& outerHi,
+                     const Vec3& lo, const Vec3& hi) {
+    return outerLo[0] <= lo[0] && outerLo[1] <= lo[1] && outerLo[2] <= lo[2]
+        && hi[0] <= outerHi[0] && hi[1] <= outerHi[1] && hi[2] <= outerHi[2];
+}
+
+// Surface area of a box, used as the insertion cost in the tree.
+inline Real area(const Vec3& lo, const Vec3& hi) {
+    const Vec3 d = hi - lo;
+    return 2*(d[0]*d[1] + d[1]*d[2] + d[2]*d[0]);
+}
+
+inline Real unionArea(const Vec3& lo1, const Vec3& hi1,
+                      const Vec3& lo2, const Vec3& hi2) {
+    return area(Vec3(std::min(lo1[0],lo2[0]), std::min(lo1[1],lo2[1]),
+                     std::min(lo1[2],lo2[2])),
+                Vec3(std::max(hi1[0],hi2[0]), std::max(hi1[1],hi2[1]),
+                     std::max(hi1[2],hi2[2])));
+}
+
+//==============================================================================
+//                            DYNAMIC AABB TREE
+//==============================================================================
+// A bounding volume hierarchy whose leaves are the objects' boxes enlarged by
+// a margin, kept balanced by tree rotations as leaves are inserted and removed.
+// This follows the well-known dynamic tree used in Box2D and Bullet.
+class DynamicTree {
+public:
+    static const int Null = -1;
+
+    DynamicTree() : root(Null), freeList(Null) {}
+
+    void clear() {
+        nodes.clear(); leafOf.clear();
+        root = freeList = Null;
+    }
+
+    int getNumObjects() const {return (int)leafOf.size();}
+
+    // Insert every object from scratch.
+    void build(const Array_<Vec3>& lower, const Array_<Vec3>& upper) {
+        clear();
+        const int n = (int)lower.size();
+        nodes.reserve(2*n);
+        leafOf.resize(n);
+        for (int i=0; i < n; ++i) {
+            const int leaf = allocateNode();
+            Node& node = nodes[leaf];
+            node.object = i;
+            fatten(lower[i], upper[i], node.lo, node.hi);
+            insertLeaf(leaf);
+            leafOf[i] = leaf;
+        }
+    }
+
+    // Reinsert any object that has left its enlarged box.
+    void update(const Array_<Vec3>& lower, const Array_<Vec3>& upper) {
+        for (int i=0; i < (int)leafOf.size(); ++i) {
+            const int leaf = leafOf[i];
+            if (contains(nodes[leaf].lo, nodes[leaf].hi, lower[i], upper[i]))
+                continue;
+            removeLeaf(leaf);
+            fatten(lower[i], upper[i], nodes[leaf].lo, nodes[leaf].hi);
+            insertLeaf(leaf);
+        }
+    }
+
+    // Append (i,j) for every object j > i whose box overlaps i's box.
+    void findPairsOf(int i, const Array_<Vec3>& lower,
+                     const Array_<Vec3>& upper,
+                     Array_<BroadPhase::IndexPair>& pairs) const {
+        if (root == Null)
+            return;
+        const Vec3& lo = lower[i];
+        const Vec3& hi = upper[i];
+        // The tree height is logarithmic in the number of objects so a small
+        // fixed stack suffices except for pathological trees.
+        int stackSpace[64];
+        Array_<int> bigStack;
+        int* stack = stackSpace;
+        int stackCapacity = 64;
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!overlaps(node.lo, node.hi, lo, hi))
+                continue;
+            if (node.isLeaf()) {
+                const int j = node.object;
+                if (j > i && overlaps(lower[j], upper[j], lo, hi))
+                    pairs.push_back(BroadPhase::IndexPair(i,j));
+                continue;
+            }
+            if (top+2 > stackCapacity) {
+                bigStack.resize(2*stackCapacity);
+                if (stack == stackSpace)
+                    std::copy(stackSpace, stackSpace+top, bigStack.begin());
+                stack = bigStack.begin();
+                stackCapacity = (int)bigStack.size();
+            }
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+
+private:
+    struct Node {
+        bool isLeaf() const {return child1 == Null;}
+        Vec3 lo, hi;        // enlarged box for leaves; union for the others
+        int  parent;        // also the next link while on the free list
+        int  child1, child2;
+        int  height;        // leaves are at height 0
+        int  object;        // leaves only
+    };
+
+    // The margin is a fraction of the object's size so that the same setting
+    // works for grains and boulders.
+    static void fatten(const Vec3& lo, const Vec3& hi, Vec3& fatLo,
+                       Vec3& fatHi) {
+        const Real margin = Real(0.1)*max(hi-lo) + SignificantReal;
+        fatLo = lo - margin;
+        fatHi = hi + margin;
+    }
+
+    int allocateNode() {
+        int n;
+        if (freeList != Null) {
+            n = freeList;
+            freeList = nodes[n].parent;
+        } else {
+            n = (int)nodes.size();
+            nodes.push_back();
+        }
+        Node& node = nodes[n];
+        node.parent = node.child1 = node.child2 = Null;
+        node.height = 0;
+        node.object = Null;
+        return n;
+    }
+
+    void freeNode(int n) {
+        nodes[n].parent = freeList;
+        nodes[n].height = -1;
+        freeList = n;
+    }
+
+    void refit(int n) {
+        Node& node = nodes[n];
+        const Node& c1 = nodes[node.child1];
+        const Node& c2 = nodes[node.child2];
+        for (int k=0; k < 3; ++k) {
+            node.lo[k] = std::min(c1.lo[k], c2.lo[k]);
+            node.hi[k] = std::max(c1.hi[k], c2.hi[k]);
+        }
+        node.height = 1 + std::max(c1.height, c2.height);
+    }
+
+    // Walk from n to the root, rebalancing and refitting on the way.
+    void fixUpwards(int n) {
+        while (n != Null) {
+            n = balance(n);
+            refit(n);
+            n = nodes[n].parent;
+        }
+    }
+
+    void insertLeaf(int leaf) {
+        if (root == Null) {
+            root = leaf;
+            nodes[root].parent = Null;
+            return;
+        }
+
+        // Descend to the sibling that minimizes the total area added.
+        const Vec3 lo = nodes[leaf].lo, hi = nodes[leaf].hi;
+        int index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node& node = nodes[index];
+            const Real nodeArea = area(node.lo, node.hi);
+            const Real combinedArea = unionArea(node.lo, node.hi, lo, hi);
+            // Cost of making a new parent for this node and the leaf, and the
+            // minimum cost of pushing the leaf further down.
+            const Real cost = 2*combinedArea;
+            const Real inheritanceCost = 2*(combinedArea - nodeArea);
+            Real childCost[2];
+            for (int c=0; c < 2; ++c) {
+                const Node& child = nodes[c==0 ? node.child1 : node.child2];
+                childCost[c] = unionArea(child.lo, child.hi, lo, hi)
+                               + inheritanceCost;
+                if (!child.isLeaf())
+                    childCost[c] -= area(child.lo, child.hi);
+            }
+            if (cost < childCost[0] && cost < childCost[1])
+                break;
+            index = childCost[0] < childCost[1] ? node.child1 : node.child2;
+        }
+
+        const int sibling = index;
+        const int oldParent = nodes[sibling].parent;
+        const int newParent = allocateNode(); // invalidates Node references
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        if (oldParent != Null) {
+            if (nodes[oldParent].child1 == sibling)
+                nodes[oldParent].child1 = newParent;
+            else
+                nodes[oldParent].child2 = newParent;
+        } else
+            root = newParent;
+
+        fixUpwards(newParent);
+    }
+
+    void removeLeaf(int leaf) {
+        if (leaf == root) {
+            root = Null;
+            return;
+        }
+        const int parent = nodes[leaf].parent;
+        const int grandParent = nodes[parent].parent;
+        const int sibling = nodes[parent].child1 == leaf
+                            ? nodes[parent].child2 : nodes[parent].child1;
+        if (grandParent != Null) {
+            if (nodes[grandParent].child1 == parent)
+                nodes[grandParent].child1 = sibling;
+            else
+                nodes[grandParent].child2 = sibling;
+            nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            fixUpwards(grandParent);
+        } else {
+            root = sibling;
+            nodes[sibling].parent = Null;
+            freeNode(parent);
+        }
+    }
+
+    // If node a is unbalanced, rotate its taller child up and return the
+    // index of the node that took a's place; otherwise return a.
+    int balance(int a) {
+        Node& A = nodes[a];
+        if (A.isLeaf() || A.height < 2)
+            return a;
+        const int b = A.child1, c = A.child2;
+        const int heightDiff = nodes[c].height - nodes[b].height;
+        if (heightDiff > 1)
+            return rotateUp(a, c, false);
+        if (heightDiff < -1)
+            return rotateUp(a, b, true);
+        return a;
+    }
+
+    // Rotate child \a up of node a above a. The taller of up's children stays
+    // with it; the shorter one replaces \a up as a child of a. \a upIsChild1
+    // says on which side of a \a up was.
+    int rotateUp(int a, int up, bool upIsChild1) {
+        Node& A = nodes[a];
+        Node& U = nodes[up];
+        const int f = U.child1, g = U.child2;
+
+        U.child1 = a;
+        U.parent = A.parent;
+        A.parent = up;
+        if (U.parent != Null) {
+            if (nodes[U.parent].child1 == a)
+                nodes[U.parent].child1 = up;
+            else
+                nodes[U.parent].child2 = up;
+        } else
+            root = up;
+
+        const bool fTaller = nodes[f].height > nodes[g].height;
+        const int keep  = fTaller ? f : g;
+        const int moved = fTaller ? g : f;
+        U.child2 = keep;
+        if (upIsChild1) A.child1 = moved; else A.child2 = moved;
+        nodes[moved].parent = a;
+        refit(a);
+        refit(up);
+        return up;
+    }
+
+    Array_<Node>    nodes;
+    Array_<int>     leafOf;     // object index -> leaf node
+    int             root;
+    int             freeList;
+};
+
+} // anonymous namespace
+
+//==============================================================================
+//                              BROAD PHASE IMPL
+//==============================================================================
+class BroadPhase::Impl {
+public:
+    explicit Impl(Method method) : method(method), axis(-1) {}
+
+    void clear() {
+        lower.clear(); upper.clear(); order.clear();
+        axis = -1;
+        tree.clear();
+    }
+
+    // Copy the boxes into corner form.
+    void setBoxes(const Array_<Geo::AlignedBox>& boxes) {
+        const int n = (int)boxes.size();
+        if (n != (int)lower.size()) {
+            clear();
+            lower.resize(n); upper.resize(n);
+        }
+        for (int i=0; i < n; ++i) {
+            const Vec3& c = boxes[i].getCenter();
+            const Vec3& h = boxes[i].getHalfLengths();
+            lower[i] = c - h;
+            upper[i] = c + h;
+        }
+    }
+
+    // Choose the axis along which the box centers are most spread out. The
+    // incremental sweep only abandons its current axis if another one is
+    // clearly better, since that requires a full sort.
+    int chooseAxis() const {
+        const int n = (int)lower.size();
+        Vec3 mean(0);
+        for (int i=0; i < n; ++i)
+            mean += lower[i] + upper[i];
+        mean /= Real(2*n);
+        Vec3 spread(0);
+        for (int i=0; i < n; ++i)
+            spread += ((lower[i] + upper[i])/2 - mean).abs();
+        int best = spread[0] > spread[1] ? 0 : 1;
+        if (spread[2] > spread[best])
+            best = 2;
+        if (method == IncrementalSweepAndPrune && axis >= 0
+            && spread[best] <= AxisSwitchRatio*spread[axis])
+            return axis;
+        return best;
+    }
+
+    void prepareSweep() {
+        const int n = (int)lower.size();
+        const int newAxis = chooseAxis();
+        const Array_<Vec3>& lo = lower;
+        const bool canRepair = method == IncrementalSweepAndPrune
+                               && newAxis == axis && (int)order.size() == n;
+        axis = newAxis;
+        const int ax = axis;
+        if (!canRepair) {
+            order.resize(n);
+            for (int i=0; i < n; ++i)
+                order[i] = i;
+            std::sort(order.begin(), order.end(),
+                      [&lo,ax](int i, int j) {return lo[i][ax] < lo[j][ax];});
+            return;
+        }
+        // Insertion sort, which is linear when the order is nearly correct.
+        for (int p=1; p < n; ++p) {
+            const int i = order[p];
+            const Real key = lo[i][ax];
+            int q = p;
+            for (; q > 0 && lo[order[q-1]][ax] > key; --q)
+                order[q] = order[q-1];
+            order[q] = i;
+        }
+    }
+
+    void prepareTree() {
+        if (tree.getNumObjects() != (int)lower.size())
+            tree.build(lower, upper);
+        else
+            tree.update(lower, upper);
+    }
+
+    // Append the pairs found starting from sorted position (sweep) or object
+    // (tree) p.
+    void findPairsFrom(int p, Array_<IndexPair>& pairs) const {
+        if (method == DynamicAABBTree) {
+            tree.findPairsOf(p, lower, upper, pairs);
+            return;
+        }
+        const int n = (int)order.size();
+        const int i = order[p];
+        const Vec3& lo = lower[i];
+        const Vec3& hi = upper[i];
+        for (int q=p+1; q < n; ++q) {
+            const int j = order[q];
+            if (lower[j][axis] > hi[axis])
+                break; // no later box can overlap box i
+            if (overlaps(lower[j], upper[j], lo, hi))
+                pairs.push_back(i < j ? IndexPair(i,j) : IndexPair(j,i));
+        }
+    }
+
+    class FindPairsTask : public ParallelExecutor::Task {
+    public:
+        FindPairsTask(const Impl& impl, int numChunks)
+        :   impl(impl), numChunks(numChunks) {}
+        void execute(int chunk) override {
+            const int n = (int)impl.lower.size();
+            Array_<IndexPair>& pairs = impl.chunkPairs[chunk];
+            const int end = (int)((long long)n*(chunk+1)/numChunks);
+            for (int p=(int)((long long)n*chunk/numChunks); p < end; ++p)
+                impl.findPairsFrom(p, pairs);
+        }
+    private:
+        const Impl& impl;
+        const int   numChunks;
+    };
+
+    void findPairs(Array_<IndexPair>& pairs, ParallelExecutor* executor) {
+        pairs.clear();
+        const int n = (int)lower.size();
+        if (n < 2)
+            return;
+
+        if (method == DynamicAABBTree)
+            prepareTree();
+        else
+            prepareSweep();
+
+        if (!executor || executor->getMaxThreads() < 2 || n < MinParallelObjects) {
+            for (int p=0; p < n; ++p)
+                findPairsFrom(p, pairs);
+        } else {
+            // More chunks than threads so that a thread whose chunk happened
+            // to have many overlaps doesn't hold up the others.
+            const int numChunks = ChunksPerThread*executor->getMaxThreads();
+            chunkPairs.resize(numChunks);
+            for (auto& chunk : chunkPairs)
+                chunk.clear();
+            FindPairsTask task(*this, numChunks);
+            executor->execute(task, numChunks);
+            for (const auto& chunk : chunkPairs)
+                pairs.insert(pairs.end(), chunk.begin(), chunk.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    static const int MinParallelObjects = 256;
+    static const int ChunksPerThread = 4;
+    static constexpr Real AxisSwitchRatio = Real(1.5);
+
+    Method          method;
+    Array_<Vec3>    lower, upper;
+    // Sweep and prune
+    Array_<int>     order;      // object indices sorted by lower[axis]
+    int             axis;
+    // Dynamic tree
+    DynamicTree     tree;
+    // Per-chunk results for a parallel search.
+    mutable Array_<Array_<IndexPair>> chunkPairs;
+};
+
+constexpr Real BroadPhase::Impl::AxisSwitchRatio;
+
+//==============================================================================
+//                                BROAD PHASE
+//==============================================================================
+
+BroadPhase::BroadPhase(Method method) : impl(new Impl(method)) {}
+
+BroadPhase::BroadPhase(const BroadPhase& source)
+:   impl(new Impl(*source.impl)) {}
+
+BroadPhase& BroadPhase::operator=(const BroadPhase& source) {
+    if (&source != this)
+        *impl = *source.impl;
+    return *this;
+}
+
+BroadPhase::~BroadPhase() {delete impl;}
+
+BroadPhase::Method BroadPhase::getMethod() const {return impl->method;}
+
+void BroadPhase::setMethod(Method method) {
+    SimTK_APIARGCHECK1_ALWAYS(SweepAndPrune <= method
+                              && method <= DynamicAABBTree,
+        "BroadPhase", "setMethod", "Unknown broad phase method %d.",
+        (int)method);
+    if (method != impl->method) {
+        impl->clear();
+        impl->method = method;
+    }
+}
+
+const char* BroadPhase::getMethodName(Method method) {
+    switch (method) {
+    case SweepAndPrune:             return "SweepAndPrune";
+    case IncrementalSweepAndPrune:  return "IncrementalSweepAndPrune";
+    case DynamicAABBTree:           return "DynamicAABBTree";
+    }
+    return "Unknown";
+}
+
+void BroadPhase::clear() {impl->clear();}
+
+int BroadPhase::getNumObjects() const {return (int)impl->lower.size();}
+
+void BroadPhase::findOverlappingPairs(const Array_<Geo::AlignedBox>& boxes,
+                                      Array_<IndexPair>&             pairs,
+                                      ParallelExecutor*              executor) {
+    impl->setBoxes(boxes);
+    impl->findPairs(pairs, executor);
+}
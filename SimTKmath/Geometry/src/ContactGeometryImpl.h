@@ -34,6 +34,7 @@
 
 #include <atomic>
 #include <limits>
+#include <mutex>
 
 namespace SimTK {
 
@@ -1001,6 +1002,86 @@ public:
 
 
 
+//==============================================================================
+//                              FLAT OBB TREE
+//==============================================================================
+/* A linearized copy of a TriangleMesh's OBB tree, used by the batched ray and
+nearest point queries. Each node packs the boxes of up to Width children in
+structure-of-arrays form so that a single loop over the lanes tests all of them
+against a ray or a point; a binary node whose children are not leaves
+contributes its grandchildren instead, so there are about half as many levels
+as in the pointer tree. Nodes are stored in depth-first order. The triangles of
+all leaves are kept in one pool, together with a copy of their vertex positions
+so that the ray-triangle tests don't have to go through the face and vertex
+arrays. Most meshes never get a batched query, so the tree isn't built until
+the first one asks for it. */
+class FlatOBBTree {
+public:
+    static const int Width = 4;
+
+    // An entry on the traversal stack: a node or leaf reference (see Node)
+    // and the squared distance or ray distance to its box.
+    struct StackEntry {
+        StackEntry() {}
+        StackEntry(int ref, Real key) : ref(ref), key(key) {}
+        int  ref;
+        Real key;
+    };
+
+    FlatOBBTree() : built(false) {}
+    // A copy, like a new tree, is built when it is first used.
+    FlatOBBTree(const FlatOBBTree&) : built(false) {}
+    FlatOBBTree& operator=(const FlatOBBTree&) = delete;
+
+    // Build the tree from the mesh's OBB tree unless that has already been
+    // done. Several threads may call this at once; the queries below must not
+    // be used until it has returned.
+    void ensureBuilt(const ContactGeometry::TriangleMesh::Impl& mesh);
+
+    // These are equivalent to the queries on OBBTreeNodeImpl. The stack is
+    // working space; pass the same one to successive calls to avoid heap
+    // allocation.
+    bool intersectsRay(const Vec3& origin, const UnitVec3& direction,
+                       Real& distance, int& face, Vec2& uv,
+                       Array_<StackEntry>& stack) const;
+    Vec3 findNearestPoint(const ContactGeometry::TriangleMesh::Impl& mesh,
+                          const Vec3& position, int& face, Vec2& uv,
+                          Array_<StackEntry>& stack) const;
+private:
+    // Lane k of a node holds the box of one child. The box axes are stored as
+    // rows, so a point p is in box coordinates axis*(p-origin). A child
+    // reference is the index of a node if it is >= 0 and ~leaf otherwise.
+    // Lanes at or beyond numChildren are unused.
+    struct Node {
+        Real axis[9][Width];
+        Real origin[3][Width];
+        Real size[3][Width];
+        int  child[Width];
+        int  numChildren;
+    };
+
+    void build(const ContactGeometry::TriangleMesh::Impl& mesh);
+    int addNode(const ContactGeometry::TriangleMesh::Impl& mesh,
+                const OBBTreeNodeImpl& node);
+    int addLeaf(const ContactGeometry::TriangleMesh::Impl& mesh,
+                const OBBTreeNodeImpl& node);
+    void pushHits(const Node& node, const Real* key, const bool* hit,
+                  Array_<StackEntry>& stack) const;
+
+    Array_<Node>    nodes;
+    // Pooled triangles of leaf i are [leafStart[i], leafStart[i+1]).
+    Array_<int>     leafStart;
+    Array_<int>     triangles;
+    // First vertex (0-2), first edge (3-5) and second edge (6-8) of each
+    // pooled triangle.
+    Array_<Real>    vertexData[9];
+
+    std::atomic<bool>   built;
+    std::mutex          buildMutex;
+};
+
+
+
 //==============================================================================
 //                            TRIANGLE MESH IMPL
 //==============================================================================
@@ -1034,12 +1115,25 @@ public:
                        Real& distance, UnitVec3& normal) const override;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, int& face, Vec2& uv) const;
+    void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                           Array_<Vec3>& nearestPoints, Array_<bool>& inside,
+                           Array_<int>& faces, Array_<Vec2>& uvs,
+                           ParallelExecutor* executor) const;
+    int intersectsRays(const ArrayViewConst_<Vec3>& origins,
+                       const ArrayViewConst_<UnitVec3>& directions,
+                       Array_<Real>& distances, Array_<int>& faces,
+                       Array_<Vec2>& uvs, ParallelExecutor* executor) const;
     void getBoundingSphere(Vec3& center, Real& radius) const override;
 
     bool isSmooth() const override {return false;}
     bool isConvex() const override {return false;}
     bool isFinite() const override {return true;}
 
+    /* A number identifying this mesh's OBB tree, for code that keeps
+    references to its nodes from one call to the next (see OBBTreeFront). It
+    is never reused, even after the mesh is deleted, and a copy of the mesh,
+    which builds a tree of its own, gets a new one. */
+    long long getTreeId() const {return treeId.get();}
 
     static ContactGeometryTypeId classTypeId() {
         static const ContactGeometryTypeId id = 
@@ -1047,6 +1141,20 @@ public:
         return id;
     }
 private:
+    class TreeId {
+    public:
+        TreeId() : id(nextId()) {}
+        TreeId(const TreeId&) : id(nextId()) {}
+        TreeId& operator=(const TreeId&) {id = nextId(); return *this;}
+        long long get() const {return id;}
+    private:
+        static long long nextId() {
+            static std::atomic<long long> next(1);
+            return next++;
+        }
+        long long id;
+    };
+
     void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices);
     void createObbTree(OBBTreeNodeImpl& node, const Array_<int>& faceIndices);
     void splitObbAxis(const Array_<int>& parentIndices, 
@@ -1056,13 +1164,18 @@ private:
                             Vec3& center, Real& radius);
     friend class ContactGeometry::TriangleMesh;
     friend class OBBTreeNodeImpl;
+    friend class FlatOBBTree;
 
     Array_<Edge>    edges;
     Array_<Face>    faces;
     Array_<Vertex>  vertices;
+    Array_<Vec3>    faceCentroids;  // indexed by face
+    Array_<Real>    faceAreas;      // same as in faces, but contiguous
     Vec3            boundingSphereCenter;
     Real            boundingSphereRadius;
     OBBTreeNodeImpl obb;
+    mutable FlatOBBTree flatObb;    // built by the first batched query
+    TreeId          treeId;
     bool            smooth;
 };
 
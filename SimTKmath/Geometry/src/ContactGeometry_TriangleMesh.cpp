@@ -151,6 +151,14 @@ Vec3 ContactGeometry::TriangleMesh::findCentroid(int face) const {
     return getImpl().findCentroid(face);
 }
 
+const Array_<Vec3>& ContactGeometry::TriangleMesh::getFaceCentroids() const {
+    return getImpl().faceCentroids;
+}
+
+const Array_<Real>& ContactGeometry::TriangleMesh::getFaceAreas() const {
+    return getImpl().faceAreas;
+}
+
 UnitVec3 ContactGeometry::TriangleMesh::
 findNormalAtPoint(int face, const Vec2& uv) const {
     return getImpl().findNormalAtPoint(face, uv);
@@ -183,6 +191,22 @@ bool ContactGeometry::TriangleMesh::intersectsRay
     return getImpl().intersectsRay(origin, direction, distance, face, uv);
 }
 
+void ContactGeometry::TriangleMesh::findNearestPoints
+   (const ArrayViewConst_<Vec3>& positions, Array_<Vec3>& nearestPoints,
+    Array_<bool>& inside, Array_<int>& faces, Array_<Vec2>& uvs,
+    ParallelExecutor* executor) const {
+    getImpl().findNearestPoints(positions, nearestPoints, inside, faces, uvs,
+                                executor);
+}
+
+int ContactGeometry::TriangleMesh::intersectsRays
+   (const ArrayViewConst_<Vec3>& origins,
+    const ArrayViewConst_<UnitVec3>& directions, Array_<Real>& distances,
+    Array_<int>& faces, Array_<Vec2>& uvs, ParallelExecutor* executor) const {
+    return getImpl().intersectsRays(origins, directions, distances, faces, uvs,
+                                    executor);
+}
+
 ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::getOBBTreeNode() const {
     return OBBTreeNode(getImpl().obb);
@@ -226,12 +250,9 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findPoint
            +  (1-uv[0]-uv[1])* vertices[f.vertices[2]].pos;
 }
 
-// same as findPoint(face, (1/3,1/3)) but faster
+// same as findPoint(face, (1/3,1/3)) but calculated once, in init()
 Vec3 ContactGeometry::TriangleMesh::Impl::findCentroid(int face) const {
-    const Face& f = faces[face];
-    return (  vertices[f.vertices[0]].pos
-            + vertices[f.vertices[1]].pos
-            + vertices[f.vertices[2]].pos) / 3;
+    return faceCentroids[face];
 }
 
 UnitVec3 ContactGeometry::TriangleMesh::Impl::findNormalAtPoint
@@ -283,6 +304,93 @@ intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance,
     return obb.intersectsRay(*this, origin, direction, distance, face, uv);
 }
 
+namespace {
+// Answers queries [begin,end) of a batch for each chunk, with one traversal
+// stack per chunk so that successive queries reuse its heap space.
+template <class Query>
+class BatchQueryTask : public ParallelExecutor::Task {
+public:
+    BatchQueryTask(const Query& query, int numQueries, int numChunks)
+    :   query(query), numQueries(numQueries), numChunks(numChunks) {}
+    void execute(int chunk) override {
+        Array_<FlatOBBTree::StackEntry> stack;
+        const int end = (int)((long long)numQueries*(chunk+1)/numChunks);
+        for (int i=(int)((long long)numQueries*chunk/numChunks); i < end; ++i)
+            query(i, stack);
+    }
+private:
+    const Query&    query;
+    const int       numQueries;
+    const int       numChunks;
+};
+
+// Below this many queries a batch isn't worth dividing among threads.
+const int MinParallelQueries = 64;
+// More chunks than threads so that a thread whose queries happen to be
+// expensive doesn't hold up the others.
+const int ChunksPerThread = 4;
+
+template <class Query>
+void runBatch(const Query& query, int numQueries, ParallelExecutor* executor) {
+    if (!executor || executor->getMaxThreads() < 2 
+        || numQueries < MinParallelQueries) {
+        BatchQueryTask<Query>(query, numQueries, 1).execute(0);
+        return;
+    }
+    const int numChunks = ChunksPerThread*executor->getMaxThreads();
+    BatchQueryTask<Query> task(query, numQueries, numChunks);
+    executor->execute(task, numChunks);
+}
+}
+
+void ContactGeometry::TriangleMesh::Impl::
+findNearestPoints(const ArrayViewConst_<Vec3>& positions, 
+                  Array_<Vec3>& nearestPoints, Array_<bool>& inside, 
+                  Array_<int>& nearestFaces, Array_<Vec2>& uvs, 
+                  ParallelExecutor* executor) const {
+    const int n = (int)positions.size();
+    nearestPoints.resize(n);
+    inside.resize(n);
+    nearestFaces.resize(n);
+    uvs.resize(n);
+    flatObb.ensureBuilt(*this);
+    runBatch([&](int i, Array_<FlatOBBTree::StackEntry>& stack) {
+        nearestPoints[i] = flatObb.findNearestPoint
+           (*this, positions[i], nearestFaces[i], uvs[i], stack);
+        const Vec3 delta = positions[i]-nearestPoints[i];
+        inside[i] = (~delta*faces[nearestFaces[i]].normal < 0);
+    }, n, executor);
+}
+
+int ContactGeometry::TriangleMesh::Impl::
+intersectsRays(const ArrayViewConst_<Vec3>& origins, 
+               const ArrayViewConst_<UnitVec3>& directions, 
+               Array_<Real>& distances, Array_<int>& hitFaces, 
+               Array_<Vec2>& uvs, ParallelExecutor* executor) const {
+    SimTK_APIARGCHECK2_ALWAYS(origins.size() == directions.size(),
+        "ContactGeometry::TriangleMesh", "intersectsRays",
+        "Got %d ray origins but %d directions.", 
+        (int)origins.size(), (int)directions.size());
+    const int n = (int)origins.size();
+    distances.resize(n);
+    hitFaces.resize(n);
+    uvs.resize(n);
+    flatObb.ensureBuilt(*this);
+    runBatch([&](int i, Array_<FlatOBBTree::StackEntry>& stack) {
+        if (!flatObb.intersectsRay(origins[i], directions[i], distances[i], 
+                                   hitFaces[i], uvs[i], stack)) {
+            distances[i] = Infinity;
+            hitFaces[i] = -1;
+            uvs[i] = Vec2(NaN);
+        }
+    }, n, executor);
+    int numHits = 0;
+    for (int i=0; i < n; ++i)
+        if (hitFaces[i] >= 0)
+            ++numHits;
+    return numHits;
+}
+
 void ContactGeometry::TriangleMesh::Impl::
 getBoundingSphere(Vec3& center, Real& radius) const {
     center = boundingSphereCenter;
@@ -529,6 +637,19 @@ void ContactGeometry::TriangleMesh::Impl::init
     for (int i = 0; i < (int) vertices.size(); i++)
         vertices[i].normal = UnitVec3(vertNorm[i]);
     
+    // Calculate each face's centroid, and copy out the areas, for code that
+    // works on many faces at a time.
+
+    faceCentroids.resize(faces.size());
+    faceAreas.resize(faces.size());
+    for (int i = 0; i < (int) faces.size(); i++) {
+        const Face& f = faces[i];
+        faceCentroids[i] = (  vertices[f.vertices[0]].pos
+                            + vertices[f.vertices[1]].pos
+                            + vertices[f.vertices[2]].pos) / 3;
+        faceAreas[i] = f.area;
+    }
+    
     // Create the OBBTree.
     
     Array_<int> allFaces(faces.size());
@@ -989,6 +1110,272 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
 
 
 
+//==============================================================================
+//                              FLAT OBB TREE
+//==============================================================================
+
+void FlatOBBTree::ensureBuilt(const ContactGeometry::TriangleMesh::Impl& mesh)
+{
+    if (built.load(std::memory_order_acquire))
+        return;
+    std::lock_guard<std::mutex> lock(buildMutex);
+    if (built.load(std::memory_order_relaxed))
+        return; // another thread built it while we waited
+    build(mesh);
+    built.store(true, std::memory_order_release);
+}
+
+void FlatOBBTree::build(const ContactGeometry::TriangleMesh::Impl& mesh) {
+    nodes.clear();
+    leafStart.clear();
+    triangles.clear();
+    for (int i=0; i < 9; ++i)
+        vertexData[i].clear();
+    leafStart.push_back(0);
+    // If the whole tree is a single leaf, addNode() gives node 0 just that
+    // one lane; otherwise node 0 holds the root's children or grandchildren.
+    addNode(mesh, mesh.obb);
+}
+
+int FlatOBBTree::addNode(const ContactGeometry::TriangleMesh::Impl& mesh,
+                         const OBBTreeNodeImpl& node) {
+    // Gather up to Width descendants of the node a level at a time, replacing
+    // each internal one by its two children.
+    const OBBTreeNodeImpl* lanes[Width] = {&node};
+    int numLanes = 1;
+    for (int k=0; k < numLanes && numLanes < Width; ) {
+        const OBBTreeNodeImpl& split = *lanes[k];
+        if (split.child1 == NULL) {
+            ++k;
+            continue;
+        }
+        for (int m=numLanes; m > k+1; --m)
+            lanes[m] = lanes[m-1];
+        lanes[k] = split.child1;
+        lanes[k+1] = split.child2;
+        ++numLanes;
+        k += 2;
+    }
+
+    const int index = (int)nodes.size();
+    nodes.push_back(Node());
+    Node& flat = nodes.back();
+    flat.numChildren = numLanes;
+    for (int k=0; k < Width; ++k) {
+        const bool used = k < numLanes;
+        const Transform X = used ? lanes[k]->bounds.getTransform() 
+                                 : Transform();
+        const Vec3 size = used ? lanes[k]->bounds.getSize() : Vec3(0);
+        for (int i=0; i < 3; ++i) {
+            for (int j=0; j < 3; ++j)
+                flat.axis[3*i+j][k] = X.R()[j][i];
+            flat.origin[i][k] = X.p()[i];
+            flat.size[i][k] = size[i];
+        }
+        flat.child[k] = 0;
+    }
+
+    // Append the children after this node, so the nodes are in depth-first
+    // order. This may reallocate nodes, so don't use flat below.
+    for (int k=0; k < numLanes; ++k) {
+        const int child = lanes[k]->child1 != NULL ? addNode(mesh, *lanes[k]) 
+                                                   : addLeaf(mesh, *lanes[k]);
+        nodes[index].child[k] = child;
+    }
+    return index;
+}
+
+int FlatOBBTree::addLeaf(const ContactGeometry::TriangleMesh::Impl& mesh,
+                         const OBBTreeNodeImpl& node) {
+    const int leaf = (int)leafStart.size()-1;
+    for (int face : node.triangles) {
+        const int* v = mesh.faces[face].vertices;
+        const Vec3& p0 = mesh.vertices[v[0]].pos;
+        const Vec3 e1 = mesh.vertices[v[1]].pos-p0;
+        const Vec3 e2 = mesh.vertices[v[2]].pos-p0;
+        triangles.push_back(face);
+        for (int i=0; i < 3; ++i) {
+            vertexData[i].push_back(p0[i]);
+            vertexData[3+i].push_back(e1[i]);
+            vertexData[6+i].push_back(e2[i]);
+        }
+    }
+    leafStart.push_back((int)triangles.size());
+    return ~leaf;
+}
+
+// Push the children of a node that passed the box test so that the one with
+// the smallest key ends up on top of the stack.
+void FlatOBBTree::pushHits(const Node& node, const Real* key, const bool* hit,
+                           Array_<StackEntry>& stack) const {
+    StackEntry sorted[Width];
+    int numHits = 0;
+    for (int k=0; k < node.numChildren; ++k) {
+        if (!hit[k])
+            continue;
+        int m = numHits++;
+        for (; m > 0 && sorted[m-1].key < key[k]; --m)
+            sorted[m] = sorted[m-1];
+        sorted[m] = StackEntry(node.child[k], key[k]);
+    }
+    for (int m=0; m < numHits; ++m)
+        stack.push_back(sorted[m]);
+}
+
+bool FlatOBBTree::intersectsRay
+   (const Vec3& origin, const UnitVec3& direction, Real& distance, int& face,
+    Vec2& uv, Array_<StackEntry>& stack) const {
+    // A direction component this small is replaced by one that doesn't
+    // overflow when inverted, which gives the right answer for a ray parallel
+    // to a pair of box faces without needing a branch.
+    const Real TinyComponent = Real(1e-30);
+    const Vec3& d = direction.asVec3();
+    Real best = MostPositiveReal;
+    int bestFace = -1;
+    Real bestU = 0, bestV = 0;
+
+    stack.clear();
+    stack.push_back(StackEntry(0, 0));
+    while (!stack.empty()) {
+        const StackEntry entry = stack.back();
+        stack.pop_back();
+        if (entry.key > best)
+            continue; // we found a closer triangle since this was pushed
+
+        if (entry.ref >= 0) {
+            // Slab test of the ray against all the child boxes at once.
+            const Node& node = nodes[entry.ref];
+            Real key[Width];
+            bool hit[Width];
+            for (int k=0; k < Width; ++k) {
+                const Real dx = origin[0]-node.origin[0][k];
+                const Real dy = origin[1]-node.origin[1][k];
+                const Real dz = origin[2]-node.origin[2][k];
+                Real tnear = 0, tfar = best;
+                for (int i=0; i < 3; ++i) {
+                    const Real* a0 = node.axis[3*i];
+                    const Real* a1 = node.axis[3*i+1];
+                    const Real* a2 = node.axis[3*i+2];
+                    const Real o = a0[k]*dx + a1[k]*dy + a2[k]*dz;
+                    Real dir = a0[k]*d[0] + a1[k]*d[1] + a2[k]*d[2];
+                    if (std::abs(dir) < TinyComponent)
+                        dir = dir < 0 ? -TinyComponent : TinyComponent;
+                    const Real t1 = -o/dir;
+                    const Real t2 = (node.size[i][k]-o)/dir;
+                    tnear = std::max(tnear, std::min(t1, t2));
+                    tfar = std::min(tfar, std::max(t1, t2));
+                }
+                key[k] = tnear;
+                hit[k] = tnear <= tfar;
+            }
+            pushHits(node, key, hit, stack);
+            continue;
+        }
+
+        // A leaf: intersect the ray with each of its triangles.
+        const int leaf = ~entry.ref;
+        for (int j=leafStart[leaf]; j < leafStart[leaf+1]; ++j) {
+            const Vec3 p0(vertexData[0][j], vertexData[1][j], vertexData[2][j]);
+            const Vec3 e1(vertexData[3][j], vertexData[4][j], vertexData[5][j]);
+            const Vec3 e2(vertexData[6][j], vertexData[7][j], vertexData[8][j]);
+            const Vec3 p = d % e2;
+            const Real det = ~e1*p;
+            if (det == 0)
+                continue; // The ray is parallel to the plane.
+            const Real scale = 1/det;
+            const Vec3 s = origin-p0;
+            const Real u = (~s*p)*scale;
+            if (u < 0 || u > 1)
+                continue;
+            const Vec3 q = s % e1;
+            const Real v = (~d*q)*scale;
+            if (v < 0 || u+v > 1)
+                continue;
+            const Real t = (~e2*q)*scale;
+            if (t < 0 || t >= best)
+                continue;
+            best = t;
+            bestFace = triangles[j];
+            bestU = u;
+            bestV = v;
+        }
+    }
+    if (bestFace < 0)
+        return false;
+    // u and v are the weights of the second and third vertices; the mesh's
+    // uv coordinates are the weights of the first and second.
+    distance = best;
+    face = bestFace;
+    uv = Vec2(1-bestU-bestV, bestU);
+    return true;
+}
+
+Vec3 FlatOBBTree::findNearestPoint
+   (const ContactGeometry::TriangleMesh::Impl& mesh, const Vec3& position,
+    int& face, Vec2& uv, Array_<StackEntry>& stack) const {
+    // Distances within this relative tolerance are ties, which are broken in
+    // favor of the face whose normal is closest to the offset direction, as
+    // in OBBTreeNodeImpl::findNearestPoint().
+    const Real tol = 100*Eps;
+    Real best = MostPositiveReal;
+    Vec3 nearestPoint;
+    face = -1;
+
+    stack.clear();
+    stack.push_back(StackEntry(0, 0));
+    while (!stack.empty()) {
+        const StackEntry entry = stack.back();
+        stack.pop_back();
+        if (entry.key > best*(1+tol))
+            continue; // we found a closer triangle since this was pushed
+
+        if (entry.ref >= 0) {
+            // Squared distance from the point to all the child boxes at once.
+            const Node& node = nodes[entry.ref];
+            Real key[Width];
+            bool hit[Width];
+            for (int k=0; k < Width; ++k) {
+                const Real dx = position[0]-node.origin[0][k];
+                const Real dy = position[1]-node.origin[1][k];
+                const Real dz = position[2]-node.origin[2][k];
+                Real d2 = 0;
+                for (int i=0; i < 3; ++i) {
+                    const Real o = node.axis[3*i][k]*dx + node.axis[3*i+1][k]*dy
+                                 + node.axis[3*i+2][k]*dz;
+                    const Real c = std::min(std::max(o, Real(0)), 
+                                            node.size[i][k]);
+                    d2 += square(o-c);
+                }
+                key[k] = d2;
+                hit[k] = d2 <= best*(1+tol);
+            }
+            pushHits(node, key, hit, stack);
+            continue;
+        }
+
+        const int leaf = ~entry.ref;
+        for (int j=leafStart[leaf]; j < leafStart[leaf+1]; ++j) {
+            const int candidate = triangles[j];
+            Vec2 candidateUV;
+            const Vec3 p = mesh.findNearestPointToFace(position, candidate, 
+                                                       candidateUV);
+            const Vec3 offset = p-position;
+            const Real d2 = offset.normSqr();
+            if (d2 < best || (d2 < best*(1+tol) 
+                && std::abs(~offset*mesh.faces[candidate].normal)
+                   > std::abs(~offset*mesh.faces[face].normal))) {
+                nearestPoint = p;
+                best = d2;
+                face = candidate;
+                uv = candidateUV;
+            }
+        }
+    }
+    return nearestPoint;
+}
+
+
+
 //==============================================================================
 //            CONTACT GEOMETRY :: TRIANGLE MESH :: OBB TREE NODE
 //==============================================================================
@@ -26,8 +26,13 @@
 
 #include "simmath/internal/common.h"
 #include "simmath/internal/Contact.h"
+#include "simmath/internal/ContactGeometry.h"
+#include "simmath/internal/ContactTracker.h"
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace SimTK {
 
@@ -229,6 +234,117 @@ friend class BrickHalfSpaceContact;
 
 
 
+//==============================================================================
+//                               OBB TREE FRONT
+//==============================================================================
+/** The part of a mesh's OBB tree (or of a pair of meshes' trees) that a
+ContactTracker visited the last time it evaluated a TriangleMeshContact, in
+depth-first order. Each entry is a node (or pair of nodes) and what the
+tracker found there: the node was entirely outside or inside the other surface,
+was a leaf partially inside it, or was split and its children's entries
+follow. The tracker uses this as the starting point for its next evaluation
+of the same contact. **/
+class OBBTreeFront {
+public:
+    typedef ContactGeometry::TriangleMesh::OBBTreeNode OBBTreeNode;
+    enum Status {Outside=0, Inside=1, Partial=2, Split=3};
+
+    class Entry {
+    public:
+        Entry(const OBBTreeNode& node1, const OBBTreeNode& node2, 
+              Status status)
+        :   node1(node1), node2(node2), status(status) {}
+        OBBTreeNode node1, node2; // node2 is node1 for a single tree
+        Status      status;
+    };
+
+    OBBTreeFront() : treeId1(0), treeId2(0) {}
+
+    /** Forget the entries, keeping their storage, and set the trees the new
+    ones will belong to. **/
+    void reset(long long newTreeId1, long long newTreeId2) {
+        treeId1 = newTreeId1; treeId2 = newTreeId2;
+        entries.clear();
+        faces1.clear(); faces2.clear();
+    }
+
+    /** The trees the nodes belong to, as identified by 
+    TriangleMesh::Impl::getTreeId(); treeId2 is 0 for a single tree. **/
+    long long           treeId1;
+    long long           treeId2;
+    std::vector<Entry>  entries;
+
+    /** Workspace for the tracker while it builds this front: the faces it 
+    finds in each mesh, before they are turned into the contact's face sets.
+    Kept here so that reusing a front reuses their storage too. **/
+    Array_<int>         faces1, faces2;
+};
+
+
+
+//==============================================================================
+//                            CONTACT TRACKER IMPL
+//==============================================================================
+/** The state that a ContactTracker shares among its evaluations, which may
+run concurrently for different contacts: statistics about the trackers' use of
+prior contact information, and the OBBTreeFront objects recorded by the mesh
+trackers. A front is reused once no contact refers to it any more, so in a 
+steady state the mesh trackers don't allocate any. **/
+class ContactTracker::Impl {
+public:
+    Impl() : numCacheHits(0), numCacheMisses(0), 
+             freeFronts(std::make_shared<FreeFronts>()) {}
+
+    /** Return a front for the given trees (see OBBTreeFront::reset()) that
+    nothing else refers to. It goes back on the free list when the last
+    reference to it is dropped. **/
+    std::shared_ptr<OBBTreeFront> acquireFront(long long treeId1, 
+                                               long long treeId2) {
+        std::unique_ptr<OBBTreeFront> front;
+        {   std::lock_guard<std::mutex> lock(freeFronts->lock);
+            if (!freeFronts->fronts.empty()) {
+                front = std::move(freeFronts->fronts.back());
+                freeFronts->fronts.pop_back();
+            }
+        }
+        if (!front)
+            front.reset(new OBBTreeFront());
+        front->reset(treeId1, treeId2);
+        return std::shared_ptr<OBBTreeFront>(front.release(), 
+                                             FrontReturner(freeFronts));
+    }
+
+    std::atomic<long long> numCacheHits;
+    std::atomic<long long> numCacheMisses;
+
+private:
+    // The fronts that no contact refers to any more. Contacts live in States,
+    // which can outlive the tracker, so the fronts' deleters share this with
+    // the tracker rather than pointing back at it.
+    struct FreeFronts {
+        std::mutex                                  lock;
+        std::vector<std::unique_ptr<OBBTreeFront>>  fronts;
+    };
+
+    // The deleter of the shared_ptrs handed out by acquireFront().
+    class FrontReturner {
+    public:
+        explicit FrontReturner(const std::shared_ptr<FreeFronts>& freeFronts)
+        :   freeFronts(freeFronts) {}
+        void operator()(OBBTreeFront* front) const {
+            std::unique_ptr<OBBTreeFront> owned(front);
+            std::lock_guard<std::mutex> lock(freeFronts->lock);
+            freeFronts->fronts.push_back(std::move(owned));
+        }
+    private:
+        std::shared_ptr<FreeFronts> freeFronts;
+    };
+
+    std::shared_ptr<FreeFronts> freeFronts;
+};
+
+
+
 //==============================================================================
 //                            TRIANGLE MESH IMPL
 //==============================================================================
@@ -247,11 +363,25 @@ public:
         return tid;
     }
 
+    /** Take over the contents of the given face sets, leaving them empty. 
+    This is for use by a tracker that has just created this contact with 
+    empty face sets, to avoid copying. **/
+    void adoptFaces(std::set<int>& newFaces1, std::set<int>& newFaces2) 
+    {   faces1.swap(newFaces1); faces2.swap(newFaces2); }
+
+    /** The front of the tracker's OBB tree search when this contact was 
+    created, or null if the tracker didn't record one. This is not modified 
+    while any contact refers to it so may be shared by any number of them. **/
+    const OBBTreeFront* getFront() const {return front.get();}
+    void setFront(const std::shared_ptr<const OBBTreeFront>& newFront) 
+    {   front = newFront; }
+
 private:
 friend class TriangleMeshContact;
 
-    const std::set<int> faces1;
-    const std::set<int> faces2;
+    std::set<int> faces1;
+    std::set<int> faces2;
+    std::shared_ptr<const OBBTreeFront> front;
 };
 
 
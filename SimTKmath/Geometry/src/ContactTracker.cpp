@@ -23,6 +23,9 @@
 
 #include "SimTKmath.h"
 
+#include "ContactImpl.h"
+#include "ContactGeometryImpl.h"
+
 #include <algorithm>
 using std::pair; using std::make_pair;
 #include <iostream>
@@ -38,6 +41,26 @@ namespace SimTK {
 //==============================================================================
 //                             CONTACT TRACKER
 //==============================================================================
+ContactTracker::ContactTracker(ContactGeometryTypeId typeOfSurface1,
+                               ContactGeometryTypeId typeOfSurface2)
+:   m_surfaceTypes(typeOfSurface1, typeOfSurface2), m_impl(new Impl()) {}
+
+ContactTracker::~ContactTracker() {
+    delete m_impl;
+}
+
+long long ContactTracker::getNumCacheHits() const 
+{   return m_impl->numCacheHits; }
+
+long long ContactTracker::getNumCacheMisses() const 
+{   return m_impl->numCacheMisses; }
+
+void ContactTracker::resetCacheStatistics() const 
+{   m_impl->numCacheHits = 0; m_impl->numCacheMisses = 0; }
+
+void ContactTracker::noteCacheUse(bool wasHit) const {
+    if (wasHit) ++m_impl->numCacheHits; else ++m_impl->numCacheMisses;
+}
 
 
 //------------------------------------------------------------------------------
@@ -768,6 +791,332 @@ bool ContactTracker::SphereSphere::trackContact
 
 
 
+//==============================================================================
+//                        TRIANGLE MESH OBB TREE FRONTS
+//==============================================================================
+// The mesh trackers below find the faces of a mesh that are inside the other
+// surface by descending the mesh's OBB tree, stopping at nodes that are 
+// entirely outside or entirely inside the other surface and at leaves, where
+// the individual faces are tested. (The mesh-mesh tracker does the same with 
+// pairs of nodes, one from each tree.) The nodes visited are saved, in 
+// depth-first order, as an OBBTreeFront in the TriangleMeshContact that is 
+// produced. Surfaces move only a little between evaluations of a contact, so 
+// the next evaluation resumes from the saved front: each node where the 
+// descent stopped is tested again, and the descent continues below it if it 
+// is now partially inside (the front grows); if the children of a split node
+// are now both entirely outside, or both entirely inside, and the node itself
+// is too, they are replaced by it (the front shrinks). Nodes above the front 
+// are not tested again. The faces found are the same as those of a search 
+// from the root.
+namespace {
+
+typedef ContactGeometry::TriangleMesh::OBBTreeNode  OBBTreeNode;
+typedef OBBTreeFront::Entry                         FrontEntry;
+
+// Return the front saved in the prior status of a contact between the given
+// meshes' trees (see TriangleMesh::Impl::getTreeId()), if there is one.
+const OBBTreeFront* findPriorFront(const Contact& priorStatus,
+                                   long long treeId1, long long treeId2) {
+    if (!TriangleMeshContact::isInstance(priorStatus))
+        return nullptr;
+    const OBBTreeFront* front = static_cast<const TriangleMeshContactImpl&>
+                                    (priorStatus.getImpl()).getFront();
+    return front && front->treeId1 == treeId1 && front->treeId2 == treeId2 
+           ? front : nullptr;
+}
+
+// Turn the faces found during a search into the set required by 
+// TriangleMeshContact. Sorting first makes constructing the set linear.
+void makeFaceSet(Array_<int>& faces, std::set<int>& faceSet) {
+    std::sort(faces.begin(), faces.end());
+    std::set<int>(faces.begin(), faces.end()).swap(faceSet);
+}
+
+void addAllFaces(const OBBTreeNode& node, Array_<int>& faces) {
+    if (node.isLeafNode()) {
+        const Array_<int>& triangles = node.getTriangles();
+        faces.insert(faces.end(), triangles.begin(), triangles.end());
+    } else {
+        addAllFaces(node.getFirstChildNode(), faces);
+        addAllFaces(node.getSecondChildNode(), faces);
+    }
+}
+
+// Descend from a node of a single tree, appending the nodes visited to the 
+// front and the inside faces to the list. Query must provide 
+//   OBBTreeFront::Status classify(const OBBTreeNode&) const;  // not Split
+//   void addLeafFaces(const OBBTreeNode& leaf, Array_<int>& faces) const;
+// Returns the node's classification.
+template <class Query>
+OBBTreeFront::Status descend(const Query& query, const OBBTreeNode& node,
+                             std::vector<FrontEntry>& front, 
+                             Array_<int>& faces) {
+    const OBBTreeFront::Status status = query.classify(node);
+    if (status == OBBTreeFront::Partial && !node.isLeafNode()) {
+        front.push_back(FrontEntry(node, node, OBBTreeFront::Split));
+        descend(query, node.getFirstChildNode(), front, faces);
+        descend(query, node.getSecondChildNode(), front, faces);
+        return status;
+    }
+    front.push_back(FrontEntry(node, node, status));
+    if (status == OBBTreeFront::Inside)
+        addAllFaces(node, faces);
+    else if (status == OBBTreeFront::Partial)
+        query.addLeafFaces(node, faces);
+    return status;
+}
+
+// Bring up to date the subtree of a prior front that starts at "prior", 
+// advancing "prior" past it, and append the result to the new front.
+template <class Query>
+OBBTreeFront::Status refresh(const Query& query, const FrontEntry*& prior,
+                             std::vector<FrontEntry>& front, 
+                             Array_<int>& faces) {
+    const FrontEntry& entry = *prior++;
+    if (entry.status != OBBTreeFront::Split)
+        return descend(query, entry.node1, front, faces);
+
+    const size_t start = front.size();
+    front.push_back(entry);
+    const OBBTreeFront::Status status1 = refresh(query, prior, front, faces);
+    const OBBTreeFront::Status status2 = refresh(query, prior, front, faces);
+    if (status1 == status2 && status1 != OBBTreeFront::Partial
+        && query.classify(entry.node1) == status1) {
+        // The children's faces, if any, are already in the list, and they 
+        // are all of this node's faces.
+        front.erase(front.begin()+start, front.end());
+        front.push_back(FrontEntry(entry.node1, entry.node1, status1));
+        return status1;
+    }
+    return OBBTreeFront::Partial;
+}
+
+// Find the inside faces of a mesh, starting from the prior front if there is
+// one, and record the new front.
+template <class Query>
+void findInsideFaces(const Query& query, const OBBTreeNode& root, 
+                     const OBBTreeFront* priorFront, OBBTreeFront& front,
+                     Array_<int>& faces) {
+    if (priorFront) {
+        const FrontEntry* prior = priorFront->entries.data();
+        refresh(query, prior, front.entries, faces);
+        assert(prior == priorFront->entries.data() 
+                        + priorFront->entries.size());
+    } else
+        descend(query, root, front.entries, faces);
+}
+
+// Find the faces of a mesh that are all or partially below a half space's
+// surface. The half space is given by its normal and the height of its 
+// surface along the normal, both in the mesh frame M.
+class HalfSpaceQuery {
+public:
+    HalfSpaceQuery(const ContactGeometry::TriangleMesh& mesh, 
+                   const UnitVec3& hsNormal_M, Real hsFaceHeight_M)
+    :   mesh(mesh), hsNormal_M(hsNormal_M), hsFaceHeight_M(hsFaceHeight_M) {}
+
+    OBBTreeFront::Status classify(const OBBTreeNode& node) const {
+        const OrientedBoundingBox& bounds = node.getBounds();
+        const Transform& X_MB = bounds.getTransform(); // box frame in mesh
+        const Vec3 p_BC = bounds.getSize()/2; // from box origin corner to center
+        // Express the half space normal in the box frame, then reflect it into
+        // the first (+,+,+) quadrant where it is the normal of a different 
+        // but symmetric and more convenient half space.
+        const UnitVec3 octant1hsNormal_B = (~X_MB.R()*hsNormal_M).abs();
+        // Dot our octant1 radius p_BC with our octant1 normal to get
+        // the extent of the box from its center in the direction of the 
+        // octant1 reflection of the halfspace.
+        const Real extent = dot(p_BC, octant1hsNormal_B);
+        // Compute the height of the box center over the mesh origin,
+        // measured along the real halfspace normal.
+        const Vec3 boxCenter_M       = X_MB*p_BC;
+        const Real boxCenterHeight_M = dot(boxCenter_M, hsNormal_M);
+        // Subtract the halfspace surface position to get the height of the 
+        // box center over the halfspace.
+        const Real boxCenterHeight = boxCenterHeight_M - hsFaceHeight_M;
+        if (boxCenterHeight >= extent)
+            return OBBTreeFront::Outside;   // no penetration
+        if (boxCenterHeight <= -extent)
+            return OBBTreeFront::Inside;    // box is entirely in halfspace
+        return OBBTreeFront::Partial;
+    }
+
+    // Some of a penetrating leaf's triangles may be penetrating.
+    void addLeafFaces(const OBBTreeNode& leaf, Array_<int>& faces) const {
+        const Array_<int>& triangles = leaf.getTriangles();
+        for (int i = 0; i < (int) triangles.size(); i++) {
+            for (int vx=0; vx < 3; ++vx) {
+                const int   vertex = mesh.getFaceVertex(triangles[i], vx);
+                const Vec3& vertexPos      = mesh.getVertexPosition(vertex);
+                const Real  vertexHeight_M = dot(vertexPos, hsNormal_M);
+                if (vertexHeight_M < hsFaceHeight_M) {
+                    faces.push_back(triangles[i]);
+                    break; // done with this face
+                }
+            }
+        }
+    }
+
+private:
+    const ContactGeometry::TriangleMesh&    mesh;
+    const UnitVec3                          hsNormal_M;
+    const Real                              hsFaceHeight_M;
+};
+
+// Find the faces of a mesh that are all or partially inside a sphere whose 
+// center location in M and radius squared are given.
+class SphereQuery {
+public:
+    SphereQuery(const ContactGeometry::TriangleMesh& mesh, 
+                const Vec3& center_M, Real radius2)
+    :   mesh(mesh), center_M(center_M), radius2(radius2) {}
+
+    // A box is never reported as entirely inside; its triangles are always
+    // checked individually.
+    OBBTreeFront::Status classify(const OBBTreeNode& node) const {
+        const Vec3 nearest_M = node.getBounds().findNearestPoint(center_M);
+        return (nearest_M-center_M).normSqr() >= radius2 
+               ? OBBTreeFront::Outside : OBBTreeFront::Partial;
+    }
+
+    void addLeafFaces(const OBBTreeNode& leaf, Array_<int>& faces) const {
+        const Array_<int>& triangles = leaf.getTriangles();
+        for (unsigned i = 0; i < triangles.size(); i++) {
+            Vec2 uv;
+            Vec3 nearest_M = mesh.findNearestPointToFace
+                                        (center_M, triangles[i], uv);
+            if ((nearest_M-center_M).normSqr() < radius2)
+                faces.push_back(triangles[i]);
+        }
+    }
+
+private:
+    const ContactGeometry::TriangleMesh&    mesh;
+    const Vec3                              center_M;
+    const Real                              radius2;
+};
+
+// Find the faces of two meshes that intersect faces of the other. Pairs of
+// nodes are classified only as Outside (bounding boxes disjoint) or Partial.
+class MeshMeshQuery {
+public:
+    MeshMeshQuery(const ContactGeometry::TriangleMesh& mesh1,
+                  const ContactGeometry::TriangleMesh& mesh2,
+                  const Transform& X_M1M2)
+    :   mesh1(mesh1), mesh2(mesh2), X_M1M2(X_M1M2) {}
+
+    OBBTreeFront::Status classify(const OBBTreeNode& node1, 
+                                  const OBBTreeNode& node2) const {
+        return node1.getBounds().intersectsBox(X_M1M2*node2.getBounds())
+               ? OBBTreeFront::Partial : OBBTreeFront::Outside;
+    }
+
+    // These are both leaf nodes, so check triangles for intersections.
+    void addLeafFaces(const OBBTreeNode& node1, const OBBTreeNode& node2,
+                      Array_<int>& triangles1, Array_<int>& triangles2) const {
+        const Array_<int>& node1triangles = node1.getTriangles();
+        const Array_<int>& node2triangles = node2.getTriangles();
+        for (unsigned i = 0; i < node2triangles.size(); i++) {
+            const int face2 = node2triangles[i];
+            Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
+            Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
+            Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
+            const Geo::Triangle A(a1,a2,a3);
+            for (unsigned j = 0; j < node1triangles.size(); j++) {
+                const int face1 = node1triangles[j];
+                const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
+                const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
+                const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
+                const Geo::Triangle B(b1,b2,b3);
+                if (A.overlapsTriangle(B)) 
+                {   // The triangles intersect.
+                    triangles1.push_back(face1);
+                    triangles2.push_back(face2);
+                }
+            }
+        }
+    }
+
+private:
+    const ContactGeometry::TriangleMesh&    mesh1;
+    const ContactGeometry::TriangleMesh&    mesh2;
+    const Transform                         X_M1M2;
+};
+
+// Split a pair of nodes the way the descent does: both nodes if neither is a
+// leaf, otherwise whichever one isn't. Calls visit(child1, child2) for each 
+// resulting pair in order.
+template <class Visit>
+void splitPair(const OBBTreeNode& node1, const OBBTreeNode& node2,
+               Visit visit) {
+    if (!node1.isLeafNode()) {
+        if (!node2.isLeafNode()) {
+            visit(node1.getFirstChildNode(),  node2.getFirstChildNode());
+            visit(node1.getFirstChildNode(),  node2.getSecondChildNode());
+            visit(node1.getSecondChildNode(), node2.getFirstChildNode());
+            visit(node1.getSecondChildNode(), node2.getSecondChildNode());
+        } else {
+            visit(node1.getFirstChildNode(),  node2);
+            visit(node1.getSecondChildNode(), node2);
+        }
+    } else {
+        visit(node1, node2.getFirstChildNode());
+        visit(node1, node2.getSecondChildNode());
+    }
+}
+
+// The pair-of-trees versions of descend() and refresh() above.
+OBBTreeFront::Status descendPair
+   (const MeshMeshQuery& query, 
+    const OBBTreeNode& node1, const OBBTreeNode& node2,
+    std::vector<FrontEntry>& front, 
+    Array_<int>& faces1, Array_<int>& faces2) {
+    const OBBTreeFront::Status status = query.classify(node1, node2);
+    if (status == OBBTreeFront::Outside 
+        || (node1.isLeafNode() && node2.isLeafNode())) {
+        front.push_back(FrontEntry(node1, node2, status));
+        if (status == OBBTreeFront::Partial)
+            query.addLeafFaces(node1, node2, faces1, faces2);
+        return status;
+    }
+    front.push_back(FrontEntry(node1, node2, OBBTreeFront::Split));
+    splitPair(node1, node2, [&](const OBBTreeNode& child1, 
+                                const OBBTreeNode& child2) 
+    {   descendPair(query, child1, child2, front, faces1, faces2); });
+    return status;
+}
+
+OBBTreeFront::Status refreshPair
+   (const MeshMeshQuery& query, const FrontEntry*& prior, 
+    std::vector<FrontEntry>& front,
+    Array_<int>& faces1, Array_<int>& faces2) {
+    const FrontEntry& entry = *prior++;
+    if (entry.status != OBBTreeFront::Split)
+        return descendPair(query, entry.node1, entry.node2, 
+                           front, faces1, faces2);
+
+    const size_t start = front.size();
+    front.push_back(entry);
+    bool allOutside = true;
+    splitPair(entry.node1, entry.node2, [&](const OBBTreeNode&,
+                                            const OBBTreeNode&) 
+    {   if (refreshPair(query, prior, front, faces1, faces2) 
+            != OBBTreeFront::Outside)
+            allOutside = false; });
+    if (allOutside && query.classify(entry.node1, entry.node2) 
+                      == OBBTreeFront::Outside) {
+        front.erase(front.begin()+start, front.end());
+        front.push_back(FrontEntry(entry.node1, entry.node2, 
+                                   OBBTreeFront::Outside));
+        return OBBTreeFront::Outside;
+    }
+    return OBBTreeFront::Partial;
+}
+
+} // anonymous namespace
+
+
+
 //==============================================================================
 //                  HALFSPACE - TRIANGLE MESH CONTACT TRACKER
 //==============================================================================
@@ -806,99 +1155,34 @@ bool ContactTracker::HalfSpaceTriangleMesh::trackContact
     const Real hsFaceHeight_M = dot((~X_HM).p(), hsNormal_M);
     // Now collect all the faces that are all or partially below the 
     // halfspace surface.
-    std::set<int> insideFaces;
-    processBox(mesh, mesh.getOBBTreeNode(), X_HM, 
-               hsNormal_M, hsFaceHeight_M, insideFaces);
+    const long long treeId = mesh.getImpl().getTreeId();
+    const OBBTreeFront* priorFront = findPriorFront(priorStatus, treeId, 0);
+    noteCacheUse(priorFront != nullptr);
+    const std::shared_ptr<OBBTreeFront> front = 
+        getImpl().acquireFront(treeId, 0);
+    Array_<int>& faces = front->faces1;
+    findInsideFaces(HalfSpaceQuery(mesh, hsNormal_M, hsFaceHeight_M), 
+                    mesh.getOBBTreeNode(), priorFront, *front, faces);
     
-    if (insideFaces.empty()) {
+    if (faces.empty()) {
         currentStatus.clear(); // not touching
         return true; // successful return
     }
     
+    std::set<int> noFaces, insideFaces;
+    makeFaceSet(faces, insideFaces);
     currentStatus = TriangleMeshContact(priorStatus.getSurface1(), 
                                         priorStatus.getSurface2(), 
                                         X_HM, 
-                                        std::set<int>(), insideFaces);
+                                        std::set<int>(), std::set<int>());
+    TriangleMeshContactImpl& impl = 
+        static_cast<TriangleMeshContactImpl&>(currentStatus.updImpl());
+    impl.adoptFaces(noFaces, insideFaces);
+    impl.setFront(front);
     return true; // success
 }
 
 
-// Check a single OBB and its contents (recursively) against the halfspace,
-// appending any penetrating faces to the insideFaces list.
-void ContactTracker::HalfSpaceTriangleMesh::processBox
-   (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-    const Transform& X_HM, const UnitVec3& hsNormal_M, Real hsFaceHeight_M, 
-    std::set<int>& insideFaces) const 
-{   // First check against the node's bounding box.
-    
-    const OrientedBoundingBox& bounds = node.getBounds();
-    const Transform& X_MB = bounds.getTransform(); // box frame in mesh
-    const Vec3 p_BC = bounds.getSize()/2; // from box origin corner to center
-    // Express the half space normal in the box frame, then reflect it into
-    // the first (+,+,+) quadrant where it is the normal of a different 
-    // but symmetric and more convenient half space.
-    const UnitVec3 octant1hsNormal_B = (~X_MB.R()*hsNormal_M).abs();
-    // Dot our octant1 radius p_BC with our octant1 normal to get
-    // the extent of the box from its center in the direction of the octant1
-    // reflection of the halfspace.
-    const Real extent = dot(p_BC, octant1hsNormal_B);
-    // Compute the height of the box center over the mesh origin,
-    // measured along the real halfspace normal.
-    const Vec3 boxCenter_M       = X_MB*p_BC;
-    const Real boxCenterHeight_M = dot(boxCenter_M, hsNormal_M);
-    // Subtract the halfspace surface position to get the height of the 
-    // box center over the halfspace.
-    const Real boxCenterHeight = boxCenterHeight_M - hsFaceHeight_M;
-    if (boxCenterHeight >= extent)
-        return;                             // no penetration
-    if (boxCenterHeight <= -extent) {
-        addAllTriangles(node, insideFaces); // box is entirely in halfspace
-        return;
-    }
-    
-    // Box is partially penetrated into halfspace. If it is not a leaf node, 
-    // check its children.
-    if (!node.isLeafNode()) {
-        processBox(mesh, node.getFirstChildNode(), X_HM, hsNormal_M, 
-                   hsFaceHeight_M, insideFaces);
-        processBox(mesh, node.getSecondChildNode(), X_HM, hsNormal_M, 
-                   hsFaceHeight_M, insideFaces);
-        return;
-    }
-    
-    // This is a leaf OBB node that is penetrating, so some of its triangles
-    // may be penetrating.
-    const Array_<int>& triangles = node.getTriangles();
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        for (int vx=0; vx < 3; ++vx) {
-            const int   vertex         = mesh.getFaceVertex(triangles[i], vx);
-            const Vec3& vertexPos      = mesh.getVertexPosition(vertex);
-            const Real  vertexHeight_M = dot(vertexPos, hsNormal_M);
-            if (vertexHeight_M < hsFaceHeight_M) {
-                insideFaces.insert(triangles[i]);
-                break; // done with this face
-            }
-        }
-    }
-}
-
-void ContactTracker::HalfSpaceTriangleMesh::addAllTriangles
-   (const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-    std::set<int>& insideFaces) const 
-{
-    if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
-        for (int i = 0; i < (int) triangles.size(); i++)
-            insideFaces.insert(triangles[i]);
-    }
-    else {
-        addAllTriangles(node.getFirstChildNode(), insideFaces);
-        addAllTriangles(node.getSecondChildNode(), insideFaces);
-    }
-}
-
-
 
 //==============================================================================
 //                  SPHERE - TRIANGLE MESH CONTACT TRACKER
@@ -933,56 +1217,33 @@ bool ContactTracker::SphereTriangleMesh::trackContact
 
     // Want the sphere center measured and expressed in the mesh frame.
     const Vec3 p_MC = (~X_SM).p();
-    std::set<int> insideFaces;
-    processBox(mesh, mesh.getOBBTreeNode(), p_MC, square(sphere.getRadius()), 
-               insideFaces);
+    const long long treeId = mesh.getImpl().getTreeId();
+    const OBBTreeFront* priorFront = findPriorFront(priorStatus, treeId, 0);
+    noteCacheUse(priorFront != nullptr);
+    const std::shared_ptr<OBBTreeFront> front = 
+        getImpl().acquireFront(treeId, 0);
+    Array_<int>& faces = front->faces1;
+    findInsideFaces(SphereQuery(mesh, p_MC, square(sphere.getRadius())), 
+                    mesh.getOBBTreeNode(), priorFront, *front, faces);
     
-    if (insideFaces.empty()) {
+    if (faces.empty()) {
         currentStatus.clear(); // not touching
         return true; // successful return
     }
     
+    std::set<int> noFaces, insideFaces;
+    makeFaceSet(faces, insideFaces);
     currentStatus = TriangleMeshContact(priorStatus.getSurface1(), 
                                         priorStatus.getSurface2(), 
                                         X_SM, 
-                                        std::set<int>(), insideFaces);
+                                        std::set<int>(), std::set<int>());
+    TriangleMeshContactImpl& impl = 
+        static_cast<TriangleMeshContactImpl&>(currentStatus.updImpl());
+    impl.adoptFaces(noFaces, insideFaces);
+    impl.setFront(front);
     return true; // success
 }
 
-// Check a single OBB and its contents (recursively) against the sphere
-// whose center location in M and radius squared is given, appending any 
-// penetrating faces to the insideFaces list.
-void ContactTracker::SphereTriangleMesh::processBox
-   (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
-    const Vec3& center_M, Real radius2, 
-    std::set<int>& insideFaces) const 
-{   // First check against the node's bounding box.
-
-    const Vec3 nearest_M = node.getBounds().findNearestPoint(center_M);
-    if ((nearest_M-center_M).normSqr() >= radius2)
-        return; // no intersection possible
-    
-    // Bounding box is penetrating. If it's not a leaf node, check its children.
-    if (!node.isLeafNode()) {
-        processBox(mesh, node.getFirstChildNode(), center_M, radius2,
-                   insideFaces);
-        processBox(mesh, node.getSecondChildNode(), center_M, radius2,
-                   insideFaces);
-        return;
-    }
-    
-    // This is a leaf node that may be penetrating; check the triangles.
-    const Array_<int>& triangles = node.getTriangles();
-    for (unsigned i = 0; i < triangles.size(); i++) {
-        Vec2 uv;
-        Vec3 nearest_M = mesh.findNearestPointToFace
-                                    (center_M, triangles[i], uv);
-        if ((nearest_M-center_M).normSqr() < radius2)
-            insideFaces.insert(triangles[i]);
-    }
-}
-
 
 
 //==============================================================================
@@ -1015,22 +1276,32 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
 
     // Transform giving mesh2 (M2) frame in the mesh1 (M1) frame.
     const Transform X_M1M2 = ~X_GM1*X_GM2; 
-    std::set<int> insideFaces1, insideFaces2;
-
-    // Get M2's bounding box in M1's frame.
-    const OrientedBoundingBox 
-        mesh2Bounds_M1 = X_M1M2*mesh2.getOBBTreeNode().getBounds();
 
     // Find the faces that are actually intersecting faces on the other
     // surface (this doesn't yet include faces that may be completely buried).
-    findIntersectingFaces(mesh1, mesh2, 
-                          mesh1.getOBBTreeNode(), mesh2.getOBBTreeNode(), 
-                          mesh2Bounds_M1, X_M1M2, insideFaces1, insideFaces2);
+    const long long treeId1 = mesh1.getImpl().getTreeId();
+    const long long treeId2 = mesh2.getImpl().getTreeId();
+    const OBBTreeFront* priorFront = 
+        findPriorFront(priorStatus, treeId1, treeId2);
+    noteCacheUse(priorFront != nullptr);
+    const std::shared_ptr<OBBTreeFront> front = 
+        getImpl().acquireFront(treeId1, treeId2);
+    const MeshMeshQuery query(mesh1, mesh2, X_M1M2);
+    Array_<int>& faces1 = front->faces1;
+    Array_<int>& faces2 = front->faces2;
+    if (priorFront) {
+        const FrontEntry* prior = priorFront->entries.data();
+        refreshPair(query, prior, front->entries, faces1, faces2);
+        assert(prior == priorFront->entries.data() 
+                        + priorFront->entries.size());
+    } else
+        descendPair(query, mesh1.getOBBTreeNode(), mesh2.getOBBTreeNode(),
+                    front->entries, faces1, faces2);
     
     // It should never be the case that one set of faces is empty and the
     // other isn't, however it is conceivable that roundoff error could cause
     // this to happen so we'll check both lists.
-    if (insideFaces1.empty() && insideFaces2.empty()) {
+    if (faces1.empty() && faces2.empty()) {
         currentStatus.clear(); // not touching
         return true; // successful return
     }
@@ -1038,85 +1309,23 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
     // There was an intersection. We now need to identify every triangle and 
     // vertex of each mesh that is inside the other mesh. We found the border
     // intersections above; now we have to fill in the buried faces.
+    std::set<int> insideFaces1, insideFaces2;
+    makeFaceSet(faces1, insideFaces1);
+    makeFaceSet(faces2, insideFaces2);
     findBuriedFaces(mesh1, mesh2, ~X_M1M2, insideFaces1);
     findBuriedFaces(mesh2, mesh1,  X_M1M2, insideFaces2);
 
     currentStatus = TriangleMeshContact(priorStatus.getSurface1(), 
                                         priorStatus.getSurface2(), 
                                         X_M1M2, 
-                                        insideFaces1, insideFaces2);
+                                        std::set<int>(), std::set<int>());
+    TriangleMeshContactImpl& impl = 
+        static_cast<TriangleMeshContactImpl&>(currentStatus.updImpl());
+    impl.adoptFaces(insideFaces1, insideFaces2);
+    impl.setFront(front);
     return true; // success
 }
 
-void ContactTracker::TriangleMeshTriangleMesh::
-findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      triangles1, 
-    std::set<int>&                                      triangles2) const 
-{   // See if the bounding boxes intersect.
-    
-    if (!node1.getBounds().intersectsBox(node2Bounds_M1))
-        return;
-    
-    // If either node is not a leaf node, process the children recursively.
-    
-    if (!node1.isLeafNode()) {
-        if (!node2.isLeafNode()) {
-            const OrientedBoundingBox firstChildBounds = 
-                X_M1M2*node2.getFirstChildNode().getBounds();
-            const OrientedBoundingBox secondChildBounds = 
-                X_M1M2*node2.getSecondChildNode().getBounds();
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        }
-        else {
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-        }
-        return;
-    }
-    else if (!node2.isLeafNode()) {
-        const OrientedBoundingBox firstChildBounds = 
-            X_M1M2*node2.getFirstChildNode().getBounds();
-        const OrientedBoundingBox secondChildBounds = 
-            X_M1M2*node2.getSecondChildNode().getBounds();
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        return;
-    }
-    
-    // These are both leaf nodes, so check triangles for intersections.
-    
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
-    for (unsigned i = 0; i < node2triangles.size(); i++) {
-        const int face2 = node2triangles[i];
-        Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
-        Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
-        Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
-        const Geo::Triangle A(a1,a2,a3);
-        for (unsigned j = 0; j < node1triangles.size(); j++) {
-            const int face1 = node1triangles[j];
-            const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
-            const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
-            const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
-            const Geo::Triangle B(b1,b2,b3);
-            if (A.overlapsTriangle(B)) 
-            {   // The triangles intersect.
-                triangles1.insert(face1);
-                triangles2.insert(face2);
-            }
-        }
-    }
-}
-
 static const int Outside  = -1;
 static const int Unknown  =  0;
 static const int Boundary =  1;
@@ -73,6 +73,61 @@ public:
      * again with a larger value will fail.
      */
     void setOrderLimit(int order);
+
+    /** The linear solver used by the Newton iteration for the implicit
+    (BDF or Adams) corrector equations (I - gamma*J) dy = r, where J is the
+    Jacobian of ydot with respect to y. */
+    enum LinearSolver {
+        /** Form J by finite differences, one ydot evaluation per state, and
+        factor it with dense LU. This is the default; cost grows as ny^3. */
+        DenseLinearSolver,
+        /** Form only the band of J given by setJacobianBandwidth(), which 
+        takes one ydot evaluation per band width rather than per state.
+        This pays off only when the states are ordered so that J really is 
+        banded. */
+        BandedLinearSolver,
+        /** Never form J. Solve with preconditioned GMRES, using difference
+        quotients of ydot for the products J*v. Each Krylov iteration costs
+        one ydot evaluation, so this is the choice for large systems, 
+        especially with setPreconditionerBlocks(). */
+        KrylovLinearSolver
+    };
+
+    /** Choose the linear solver; see LinearSolver. This method must be 
+    invoked before the integrator is initialized. **/
+    void setLinearSolver(LinearSolver solver);
+    /** Get the linear solver in use. **/
+    LinearSolver getLinearSolver() const;
+    /** Set the upper and lower half-bandwidths of J for the 
+    BandedLinearSolver: J(i,j) is taken to be zero for j-i > upper and for 
+    i-j > lower. Both default to 0, meaning diagonal. This method must be 
+    invoked before the integrator is initialized. **/
+    void setJacobianBandwidth(int upper, int lower);
+    /** Limit the dimension of the Krylov subspace searched by the 
+    KrylovLinearSolver per Newton iteration. 0, the default, means 5. This
+    method must be invoked before the integrator is initialized. **/
+    void setMaxKrylovDimension(int maxl);
+    /** Precondition the KrylovLinearSolver by the block-diagonal part of
+    I - gamma*J, where each element of \a yBlocks lists the indices (into
+    the State's y) of one block. States not named in any block are treated
+    as 1x1 blocks. The blocks are formed by finite differences, which costs
+    one ydot evaluation per state each time CPodes decides the 
+    preconditioner is out of date (typically every 20 steps or so), and each
+    is then factored separately. The preconditioner is applied on the right,
+    so it changes how many Krylov iterations are needed but not the accuracy
+    of the result. It pays off when the stiffness is concentrated within 
+    the blocks; for a multibody system the mobilizers are the natural 
+    choice, see SimbodyMatterSubsystem::findMobilizerYBlocks(). Passing an 
+    empty array turns preconditioning off. This method must be invoked 
+    before the integrator is initialized. **/
+    void setPreconditionerBlocks(const Array_< Array_<int> >& yBlocks);
+    /** Get the number of linear (Krylov) iterations taken by the 
+    KrylovLinearSolver since the statistics were last reset; 0 for the other
+    linear solvers. **/
+    int getNumKrylovIterations() const;
+    /** Get the number of times the block preconditioner was evaluated and 
+    factored since the statistics were last reset. **/
+    int getNumPreconditionerEvaluations() const;
 };
 
 } // namespace SimTK
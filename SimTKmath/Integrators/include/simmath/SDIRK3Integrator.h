@@ -0,0 +1,75 @@
+#ifndef SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
+#define SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+
+namespace SimTK {
+class SDIRK3IntegratorRep;
+
+/** This is a 3rd order, three stage, singly diagonally implicit Runge-Kutta 
+(SDIRK) integrator with an embedded 2nd order error estimate. The method is
+R. Alexander's L-stable one ("Diagonally implicit Runge-Kutta methods for 
+stiff O.D.E.'s", SIAM J. Numer. Anal. 14(6):1006-1021, 1977), so like 
+CPodesIntegrator it can take steps far longer than the period of stiff 
+oscillations such as those of high-stiffness springs, but unlike a multistep
+method it restarts at full order after every event.
+
+Each stage is solved by simplified Newton iteration with the matrix 
+W = I - h*gamma*J, where J is the Jacobian of the state derivatives ydot with
+respect to the states y. Since all stages share the diagonal coefficient 
+gamma, one LU factorization of W serves all three stages, and it is kept for
+later steps until the step size changes appreciably. J itself is reused from
+step to step for as long as the Newton iterations converge quickly. 
+
+J is obtained from System::calcYDotJacobian() if the System can provide it
+(MultibodySystem can, for most force elements), otherwise by forward 
+differences of ydot, which costs one ydot evaluation per state. **/
+class SimTK_SIMMATH_EXPORT SDIRK3Integrator : public Integrator {
+public:
+    /** Create an SDIRK3Integrator for integrating a System. **/
+    explicit SDIRK3Integrator(const System& sys);
+
+    /** Choose whether to ask the System for its ydot Jacobian (the default)
+    or always form it by finite differences. You can turn this off to check
+    an analytic Jacobian against a numerical one. **/
+    void setUseSystemJacobian(bool useSystemJacobian);
+    /** Return the current setting of the option described in 
+    setUseSystemJacobian(). **/
+    bool getUseSystemJacobian() const;
+
+    /** Get the number of times the ydot Jacobian J has been formed, whether
+    by the System or by finite differences. **/
+    int getNumJacobianEvaluations() const;
+    /** Get the number of LU factorizations of the iteration matrix
+    W = I - h*gamma*J. **/
+    int getNumFactorizations() const;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
@@ -115,6 +115,26 @@ public:
      * immediately.
      */
     Integrator::SuccessfulStepStatus stepTo(Real time);
+    /**
+     * Keep checkpoints of the State so that the simulation can be rolled back with rollBackTo().
+     * A checkpoint is recorded by initialize(), which first discards any from an earlier run,
+     * and each time stepTo() returns, in a StateHistory holding at most \a numCheckpoints of
+     * them; after that the oldest are replaced. A capacity of zero, the default, records
+     * nothing. Changing the capacity discards any checkpoints.
+     */
+    void setStateHistoryCapacity(int numCheckpoints);
+    /**
+     * Get the checkpoints recorded for rollBackTo(). See setStateHistoryCapacity().
+     */
+    const StateHistory& getStateHistory() const;
+    /**
+     * Return the simulation to the newest checkpoint recorded at or before the specified time,
+     * and forget the checkpoints after it. The Integrator is restarted from the restored State
+     * as it would be by initialize(), so the next stepTo() simulates forward from there,
+     * recording new checkpoints as it goes. Returns the time of the restored checkpoint. It is
+     * an error if there is no checkpoint at or before \a time.
+     */
+    Real rollBackTo(Real time);
 private:
     class TimeStepperRep* rep;
     friend class TimeStepperRep;
@@ -69,6 +69,22 @@ public:
     virtual void errorHandler(int error_code, const char* module,
                               const char* function, char* msg) const;
 
+    // These supply a preconditioner P ~ I - gamma*df/dy to the iterative
+    // (Krylov) linear solvers; see CPodes::spgmr() and 
+    // CPodes::spilsSetPreconditioner(). preconditionerSetup() is called
+    // now and then to evaluate and factor P; when jacobianOK is true, any 
+    // saved Jacobian data may be reused with the new gamma, and on return
+    // jacobianUpdated says whether the Jacobian data was recomputed.
+    // preconditionerSolve() solves P z = r. lr is 1 for the left and 2 for
+    // the right preconditioner.
+    virtual int  preconditionerSetup(Real t, const Vector& y, 
+                                     const Vector& fy, bool jacobianOK,
+                                     bool& jacobianUpdated, Real gamma) const;
+    virtual int  preconditionerSolve(Real t, const Vector& y, 
+                                     const Vector& fy, const Vector& r,
+                                     Vector& z, Real gamma, Real delta,
+                                     int lr) const;
+
     //TODO: Jacobian functions
 };
 
@@ -111,6 +127,19 @@ static void errorHandler_static(const CPodesSystem& sys,
                                 const char* function, char* msg)
   { sys.errorHandler(error_code,module,function,msg); }
 
+static int preconditionerSetup_static(const CPodesSystem& sys,
+                                      Real t, const Vector& y, 
+                                      const Vector& fy, bool jacobianOK,
+                                      bool& jacobianUpdated, Real gamma)
+  { return sys.preconditionerSetup(t,y,fy,jacobianOK,jacobianUpdated,gamma); }
+
+static int preconditionerSolve_static(const CPodesSystem& sys,
+                                      Real t, const Vector& y, 
+                                      const Vector& fy, const Vector& r,
+                                      Vector& z, Real gamma, Real delta,
+                                      int lr)
+  { return sys.preconditionerSolve(t,y,fy,r,z,gamma,delta,lr); }
+
 /**
  * This is a straightforward translation of the Sundials CPODES C 
  * interface into C++. The class CPodes represents a single instance
@@ -169,6 +198,14 @@ public:
         ProjectWithQRPivot  // for handling redundancy
     };
 
+    enum PreconditioningType {
+        UnspecifiedPreconditioningType=0,
+        NoPreconditioning,
+        LeftPreconditioning,
+        RightPreconditioning,
+        BothPreconditioning
+    };
+
     enum StepMode {
         UnspecifiedStepMode=0,
         Normal,
@@ -342,6 +379,23 @@ public:
     int lapackBand(int N, int mupper, int mlower);
     int lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType);
 
+    // Iterative (Krylov) linear solvers for the Newton iteration: GMRES and
+    // Bi-CGStab with at most maxl Krylov vectors (0 means the default, 5).
+    // Jacobian-vector products are difference quotients of the ODE function,
+    // so no Jacobian matrix is ever formed.
+    int spgmr(PreconditioningType, int maxl);
+    int spbcg(PreconditioningType, int maxl);
+    // This tells CPodes to make use of the user's preconditionerSetup() and
+    // preconditionerSolve() methods from CPodesSystem.
+    int spilsSetPreconditioner();
+
+    int spilsGetNumPrecEvals(int* npevals);
+    int spilsGetNumPrecSolves(int* npsolves);
+    int spilsGetNumLinIters(int* nliters);
+    int spilsGetNumConvFails(int* nlcfails);
+    int spilsGetNumJtimesEvals(int* njvevals);
+    int spilsGetNumFctEvals(int* nfevalsLS);
+
 private:
     // This is how we get the client-side virtual functions to
     // be callable from library-side code while maintaining binary
@@ -366,6 +420,14 @@ private:
     typedef void (*ErrorHandlerFunc)(const CPodesSystem&, 
                                      int error_code, const char* module, 
                                      const char* function, char* msg);
+    typedef int (*PrecSetupFunc)  (const CPodesSystem&,
+                                   Real t, const Vector& y, const Vector& fy,
+                                   bool jacobianOK, bool& jacobianUpdated,
+                                   Real gamma);
+    typedef int (*PrecSolveFunc)  (const CPodesSystem&,
+                                   Real t, const Vector& y, const Vector& fy,
+                                   const Vector& r, Vector& z, Real gamma,
+                                   Real delta, int lr);
 
     // Note that these routines do not tell CPodes to use the supplied
     // functions. They merely provide the client-side addresses of functions
@@ -383,6 +445,8 @@ private:
     void registerRootFunc(RootFunc);
     void registerWeightFunc(WeightFunc);
     void registerErrorHandlerFunc(ErrorHandlerFunc);
+    void registerPrecSetupFunc(PrecSetupFunc);
+    void registerPrecSolveFunc(PrecSolveFunc);
 
 
     // This is the library-side part of the CPodes constructor. This must
@@ -401,6 +465,8 @@ private:
         registerRootFunc(root_static);
         registerWeightFunc(weight_static);
         registerErrorHandlerFunc(errorHandler_static);
+        registerPrecSetupFunc(preconditionerSetup_static);
+        registerPrecSolveFunc(preconditionerSolve_static);
     }
 
     // FOR INTERNAL USE ONLY
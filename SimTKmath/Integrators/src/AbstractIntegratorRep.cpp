@@ -50,6 +50,10 @@ void AbstractIntegratorRep::methodInitialize(const State& state) {
     lastStepSize = currentStepSize;
     actualInitialStepSizeTaken = (hasErrorControl ? NaN : currentStepSize);
     resetMethodStatistics();
+
+    // Forget any interpolated state left from a previous run so that
+    // createInterpolatedState() starts from a full copy of the new one.
+    updInterpolatedState() = State();
  }
 
 
@@ -59,12 +63,18 @@ void AbstractIntegratorRep::methodInitialize(const State& state) {
 //==============================================================================
 // Create an interpolated state at time t, which is between tPrev and tCurrent.
 // If we haven't yet delivered an interpolated state in this interval, we have
-// to initialize its discrete part from the advanced state.
+// to initialize its discrete part from the advanced state. Once the two
+// states share their Instance stage we only need to copy values, which
+// doesn't allocate; a full copy is needed the first time and after an event
+// handler changes something at Instance stage or earlier.
 void AbstractIntegratorRep::createInterpolatedState(Real t) {
     const System& system   = getSystem();
     const State&  advanced = getAdvancedState();
     State&        interp   = updInterpolatedState();
-    interp = advanced; // pick up discrete stuff.
+    if (interp.canCopyValuesFrom(advanced))
+        interp.copyValuesFrom(advanced); // pick up discrete stuff.
+    else
+        interp = advanced;
 
     // Hermite interpolation requires state derivatives so we must realize
     // end-of-step derivatives if they haven't already been realized.
@@ -100,7 +110,6 @@ void AbstractIntegratorRep::createInterpolatedState(Real t) {
 void AbstractIntegratorRep::backUpAdvancedStateByInterpolation(Real t) {
     const System& system   = getSystem();
     State& advanced = updAdvancedState();
-    Vector yinterp, dummy;
 
     assert(getPreviousTime() <= t && t <= advanced.getTime());
 
@@ -109,8 +118,8 @@ void AbstractIntegratorRep::backUpAdvancedStateByInterpolation(Real t) {
     realizeStateDerivatives(advanced);
     interpolateOrder3(getPreviousTime(),  getPreviousY(),  getPreviousYDot(),
                       advanced.getTime(), advanced.getY(), advanced.getYDot(),
-                      t, yinterp);
-    advanced.updY() = yinterp;
+                      t, yInterp);
+    advanced.updY() = yInterp;
     advanced.updTime() = t;
 
     // Ignore any user request not to project interpolated states here -- this
@@ -528,7 +537,7 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
               nz = advanced.getNZ(), 
               ny = nq+nu+nz;
     
-    Vector yErrEst(ny);
+    yErrEst.resize(ny);
     bool stepSucceeded = false;
     do {
         // If we lose more than a small fraction of the step size we wanted
@@ -617,10 +626,6 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
 
     const Real MinWindow = 
         SignificantReal * std::max(Real(1), getAdvancedTime());
-    Array_<SystemEventTriggerIndex> eventCandidates, newEventCandidates;
-    Array_<Event::Trigger> 
-        eventCandidateTransitions, newEventCandidateTransitions;
-    Array_<Real> eventTimeEstimates, newEventTimeEstimates;
 
     Real earliestTimeEst, narrowestWindow;
 
@@ -640,9 +645,9 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
     if (    (tHigh-tLow) <= narrowestWindow 
         && !(tLow < tReport && tReport < tHigh)) 
     {
-        Array_<EventId> ids;
-        findEventIds(eventCandidates, ids);
-        setTriggeredEvents(tLow, tHigh, ids, eventTimeEstimates, 
+        eventIds.clear();
+        findEventIds(eventCandidates, eventIds);
+        setTriggeredEvents(tLow, tHigh, eventIds, eventTimeEstimates, 
                            eventCandidateTransitions);
         // localized already; advanced state is right (tHigh==tAdvanced)
         return true; 
@@ -654,7 +659,7 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
     // From above we have earliestTimeEst which is the time at which we
     // think the first event is triggering.
 
-    Vector eLow = e0, eHigh = e1;
+    eLow = e0; eHigh = e1;
     Real bias = 1; // neutral
 
     // There is an event in (tLow,tHigh], with the eariest occurrence
@@ -734,9 +739,9 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
 
     } while ((tHigh-tLow) > narrowestWindow);
 
-    Array_<EventId> ids;
-    findEventIds(eventCandidates, ids);
-    setTriggeredEvents(tLow, tHigh, ids, eventTimeEstimates, 
+    eventIds.clear();
+    findEventIds(eventCandidates, eventIds);
+    setTriggeredEvents(tLow, tHigh, eventIds, eventTimeEstimates, 
                        eventCandidateTransitions);
 
     // We have to throw away all of the advancedState that occurred after
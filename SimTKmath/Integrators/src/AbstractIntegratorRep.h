@@ -164,6 +164,16 @@ private:
     Real currentStepSize, lastStepSize, actualInitialStepSizeTaken;
     int minOrder, maxOrder;
     std::string methodName;
+
+    // Scratch space for takeOneStep() and the interpolation methods. These
+    // are sized on the first steps and reused after that, so that taking a
+    // step doesn't allocate.
+    Vector yErrEst, yInterp, eLow, eHigh;
+    Array_<SystemEventTriggerIndex> eventCandidates, newEventCandidates;
+    Array_<Event::Trigger> 
+        eventCandidateTransitions, newEventCandidateTransitions;
+    Array_<Real> eventTimeEstimates, newEventTimeEstimates;
+    Array_<EventId> eventIds;
 };
 
 } // namespace SimTK
@@ -30,6 +30,8 @@
 #include "nvector_SimTK.h"
 #include "cpodes/cpodes.h"
 #include "cpodes/cpodes_dense.h"
+#include "cpodes/cpodes_spgmr.h"
+#include "cpodes/cpodes_spbcgs.h"
 #include "cpodes/cpodes_lapack_exports.h"
 
 #include <limits>
@@ -66,6 +68,8 @@ public:
     CPodes::RootFunc            rootFunc;
     CPodes::WeightFunc          weightFunc;
     CPodes::ErrorHandlerFunc    errorHandlerFunc;
+    CPodes::PrecSetupFunc       precSetupFunc;
+    CPodes::PrecSolveFunc       precSolveFunc;
 
     void zeroFunctionPointers() {
         explicitODEFunc  = 0;
@@ -76,6 +80,8 @@ public:
         rootFunc         = 0;
         weightFunc       = 0;
         errorHandlerFunc = 0;
+        precSetupFunc    = 0;
+        precSolveFunc    = 0;
     }
 
     void setMyHandle(CPodes& cp) {myHandle = &cp;}
@@ -183,6 +189,35 @@ static void errorHandlerWrapper(int error_code,
     return rep.errorHandlerFunc(rep.getCPodesSystem(), error_code,module,function,msg);
 }
 
+static int precSetupWrapper(realtype t, N_Vector nv_y, N_Vector nv_fy,
+                            booleantype jok, booleantype* jcurPtr,
+                            realtype gamma, void* P_data,
+                            N_Vector, N_Vector, N_Vector)
+{
+    const Vector& y  = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy = N_Vector_SimTK::getVector(nv_fy);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(P_data);
+    bool jacobianUpdated = false;
+    const int flag = rep.precSetupFunc(rep.getCPodesSystem(), t, y, fy,
+                                       jok != FALSE, jacobianUpdated, gamma);
+    *jcurPtr = jacobianUpdated ? TRUE : FALSE;
+    return flag;
+}
+
+static int precSolveWrapper(realtype t, N_Vector nv_y, N_Vector nv_fy,
+                            N_Vector nv_r, N_Vector nv_z,
+                            realtype gamma, realtype delta,
+                            int lr, void* P_data, N_Vector)
+{
+    const Vector& y  = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy = N_Vector_SimTK::getVector(nv_fy);
+    const Vector& r  = N_Vector_SimTK::getVector(nv_r);
+    Vector&       z  = N_Vector_SimTK::updVector(nv_z);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(P_data);
+    return rep.precSolveFunc(rep.getCPodesSystem(), t, y, fy, r, z,
+                             gamma, delta, lr);
+}
+
 ////////////////////////////////////////
 // CLASS SimTK::CPodes IMPLEMENTATION //
 ////////////////////////////////////////
@@ -248,6 +283,16 @@ static int mapProjectionFactorizationType(CPodes::ProjectionFactorizationType ft
     }
 }
 
+static int mapPreconditioningType(CPodes::PreconditioningType type) {
+    switch(type) {
+    case CPodes::NoPreconditioning:    return PREC_NONE;
+    case CPodes::LeftPreconditioning:  return PREC_LEFT;
+    case CPodes::RightPreconditioning: return PREC_RIGHT;
+    case CPodes::BothPreconditioning:  return PREC_BOTH;
+    default: return std::numeric_limits<int>::min();
+    }
+}
+
 static int mapStepMode(CPodes::StepMode mode) {
     switch(mode) {
     case CPodes::Normal:       return CP_NORMAL;
@@ -681,6 +726,46 @@ int CPodes::lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType fact_typ
         mapProjectionFactorizationType(fact_type));
 }
 
+int CPodes::spgmr(PreconditioningType type, int maxl) {
+    return CPSpgmr(updRep().cpode_mem, mapPreconditioningType(type), maxl);
+}
+int CPodes::spbcg(PreconditioningType type, int maxl) {
+    return CPSpbcg(updRep().cpode_mem, mapPreconditioningType(type), maxl);
+}
+int CPodes::spilsSetPreconditioner() {
+    return CPSpilsSetPreconditioner(updRep().cpode_mem, 
+                                    (void*)precSetupWrapper,
+                                    (void*)precSolveWrapper, (void*)rep);
+}
+
+// The CPSpilsGet functions report long ints.
+static int getSpilsCounter(int (*get)(void*, long int*), void* cpode_mem,
+                           int* count)
+{
+    long int lcount;
+    const int stat = get(cpode_mem, &lcount);
+    *count = (int)lcount;
+    return stat;
+}
+int CPodes::spilsGetNumPrecEvals(int* npevals) {
+    return getSpilsCounter(CPSpilsGetNumPrecEvals, updRep().cpode_mem, npevals);
+}
+int CPodes::spilsGetNumPrecSolves(int* npsolves) {
+    return getSpilsCounter(CPSpilsGetNumPrecSolves, updRep().cpode_mem, npsolves);
+}
+int CPodes::spilsGetNumLinIters(int* nliters) {
+    return getSpilsCounter(CPSpilsGetNumLinIters, updRep().cpode_mem, nliters);
+}
+int CPodes::spilsGetNumConvFails(int* nlcfails) {
+    return getSpilsCounter(CPSpilsGetNumConvFails, updRep().cpode_mem, nlcfails);
+}
+int CPodes::spilsGetNumJtimesEvals(int* njvevals) {
+    return getSpilsCounter(CPSpilsGetNumJtimesEvals, updRep().cpode_mem, njvevals);
+}
+int CPodes::spilsGetNumFctEvals(int* nfevalsLS) {
+    return getSpilsCounter(CPSpilsGetNumFctEvals, updRep().cpode_mem, nfevalsLS);
+}
+
 
 
 // Client-side function registration
@@ -708,6 +793,12 @@ void CPodes::registerWeightFunc(CPodes::WeightFunc f) {
 void CPodes::registerErrorHandlerFunc(CPodes::ErrorHandlerFunc f) {
     updRep().errorHandlerFunc = f;
 }
+void CPodes::registerPrecSetupFunc(CPodes::PrecSetupFunc f) {
+    updRep().precSetupFunc = f;
+}
+void CPodes::registerPrecSolveFunc(CPodes::PrecSolveFunc f) {
+    updRep().precSolveFunc = f;
+}
 
 /////////////////////////////////
 // CPodesSystem IMPLEMENTATION //
@@ -757,6 +848,19 @@ void CPodesSystem::errorHandler(int, const char*, const char*, char*) const {
     SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "errorHandler"); 
 }
 
+int CPodesSystem::preconditionerSetup(Real, const Vector&, const Vector&, 
+                                      bool, bool&, Real) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "preconditionerSetup"); 
+    return std::numeric_limits<int>::min();
+}
+
+int CPodesSystem::preconditionerSolve(Real, const Vector&, const Vector&, 
+                                      const Vector&, Vector&, Real, Real,
+                                      int) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "preconditionerSolve"); 
+    return std::numeric_limits<int>::min();
+}
+
 } // namespace SimTK
 
 
@@ -367,8 +367,10 @@ int CPLapackBand(void *cpode_mem, int N, int mupper, int mlower)
     return(CPDIRECT_ILL_INPUT);
   }
 
-  /* Set extended upper half-bandwidth for M (required for pivoting) */
-  smu = MIN(N-1, mu + ml);
+  /* Set extended upper half-bandwidth for M (required for pivoting).
+     Unlike the internal band solver, LAPACK's dgbtrf requires the full
+     mu + ml here, even when that exceeds N-1. */
+  smu = mu + ml;
 
   /* Allocate memory for M, savedJ, and pivot arrays */
   M = NULL;
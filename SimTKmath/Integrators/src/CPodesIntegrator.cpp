@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "simmath/CPodesIntegrator.h"
+#include "simmath/LinearAlgebra.h"
 
 #include "IntegratorRep.h"
 #include "CPodesIntegratorRep.h"
@@ -51,6 +52,45 @@ void CPodesIntegrator::setOrderLimit(int order) {
     cprep.setOrderLimit(order);
 }
 
+void CPodesIntegrator::setLinearSolver(LinearSolver solver) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setLinearSolver(solver);
+}
+
+CPodesIntegrator::LinearSolver CPodesIntegrator::getLinearSolver() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getLinearSolver();
+}
+
+void CPodesIntegrator::setJacobianBandwidth(int upper, int lower) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setJacobianBandwidth(upper, lower);
+}
+
+void CPodesIntegrator::setMaxKrylovDimension(int maxl) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setMaxKrylovDimension(maxl);
+}
+
+void CPodesIntegrator::
+setPreconditionerBlocks(const Array_< Array_<int> >& yBlocks) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setPreconditionerBlocks(yBlocks);
+}
+
+int CPodesIntegrator::getNumKrylovIterations() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getNumKrylovIterations();
+}
+
+int CPodesIntegrator::getNumPreconditionerEvaluations() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getNumPreconditionerEvaluations();
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -124,9 +164,89 @@ public:
         gout = integ.getAdvancedState().getEventTriggers();
         return CPodes::Success;
     }
+
+    // Use these blocks of y, which must cover all of y without overlap, for
+    // the block-diagonal preconditioner.
+    void setPreconditionerBlocks(const Array_< Array_<int> >& yBlocks) {
+        blocks = yBlocks;
+        const int nb = (int)blocks.size();
+        blockJ.resize(nb); blockLU.resize(nb);
+        blockR.resize(nb); blockZ.resize(nb);
+        for (int b=0; b < nb; ++b) {
+            const int sz = (int)blocks[b].size();
+            blockJ[b].resize(sz, sz);
+            blockR[b].resize(sz); blockZ[b].resize(sz);
+        }
+    }
+
+    // Evaluate (unless CPodes says the old Jacobian is still good) the 
+    // diagonal blocks of J = d ydot/dy, then factor each block of 
+    // P = I - gamma*J. Each column takes its own ydot evaluation; grouping
+    // columns of different blocks into one evaluation would be cheaper but 
+    // useless for multibody systems, where M^-1 couples every udot to every
+    // q and u.
+    int preconditionerSetup(Real t, const Vector& y, const Vector& fy,
+                            bool jacobianOK, bool& jacobianUpdated,
+                            Real gamma) const override {
+        const int nb = (int)blocks.size();
+        jacobianUpdated = false;
+        if (!jacobianOK) {
+            Vector ewt(y.size()), ypert(y), fpert(y.size());
+            integ.cpodes->getErrWeights(ewt);
+            const Real sqrtEps = std::sqrt(Eps);
+            for (int b=0; b < nb; ++b) {
+                const Array_<int>& blk = blocks[b];
+                for (int k=0; k < (int)blk.size(); ++k) {
+                    const int j = blk[k];
+                    ypert[j] += sqrtEps*std::max(std::abs(y[j]), 1/ewt[j]);
+                    const Real h = ypert[j] - y[j]; // exactly representable
+                    const int status = explicitODE(t, ypert, fpert);
+                    ypert[j] = y[j];
+                    if (status != CPodes::Success)
+                        return CPodes::RecoverableError;
+                    for (int i=0; i < (int)blk.size(); ++i)
+                        blockJ[b](i,k) = (fpert[blk[i]] - fy[blk[i]])/h;
+                }
+            }
+            jacobianUpdated = true;
+            ++integ.statsPreconditionerEvaluations;
+        }
+
+        for (int b=0; b < nb; ++b) {
+            Matrix P = -gamma*blockJ[b];
+            P.diag() += 1;
+            blockLU[b].factor(P);
+            if (blockLU[b].isSingular())
+                return CPodes::RecoverableError;
+        }
+        return CPodes::Success;
+    }
+
+    // Solve P z = r one block at a time.
+    int preconditionerSolve(Real, const Vector&, const Vector&,
+                            const Vector& r, Vector& z, Real, Real, 
+                            int) const override {
+        for (int b=0; b < (int)blocks.size(); ++b) {
+            const Array_<int>& blk = blocks[b];
+            Vector& rb = blockR[b];
+            Vector& zb = blockZ[b];
+            for (int i=0; i < (int)blk.size(); ++i)
+                rb[i] = r[blk[i]];
+            blockLU[b].solve(rb, zb);
+            for (int i=0; i < (int)blk.size(); ++i)
+                z[blk[i]] = zb[i];
+        }
+        return CPodes::Success;
+    }
 private:
     CPodesIntegratorRep& integ;
     const System& system;
+
+    // Block-diagonal preconditioner.
+    Array_< Array_<int> >   blocks;
+    mutable Array_<Matrix>  blockJ;
+    mutable Array_<FactorLU> blockLU;
+    mutable Array_<Vector>  blockR, blockZ;
 };
 
 void CPodesIntegratorRep::init
@@ -137,6 +257,9 @@ void CPodesIntegratorRep::init
     cps = new CPodesSystemImpl(*this, getSystem());
     initialized = false;
     useCpodesProjection = false;
+    linearSolver = CPodesIntegrator::DenseLinearSolver;
+    bandUpper = bandLower = 0;
+    maxKrylovDimension = 0;
 }
 
 CPodesIntegratorRep::CPodesIntegratorRep
@@ -189,7 +312,25 @@ void CPodesIntegratorRep::methodInitialize(const State& state) {
         printf("init() returned %d\n", retval);
         SimTK_THROW1(Integrator::InitializationFailed, "init() failed");
     }
-    cpodes->lapackDense(ny);
+    switch (linearSolver) {
+    case CPodesIntegrator::DenseLinearSolver:
+        cpodes->lapackDense(ny);
+        break;
+    case CPodesIntegrator::BandedLinearSolver:
+        // A band wider than the matrix is just the whole matrix.
+        cpodes->lapackBand(ny, std::min(bandUpper, std::max(ny-1, 0)), 
+                               std::min(bandLower, std::max(ny-1, 0)));
+        break;
+    case CPodesIntegrator::KrylovLinearSolver:
+        if (preconditionerBlocks.empty()) {
+            cpodes->spgmr(CPodes::NoPreconditioning, maxKrylovDimension);
+        } else {
+            cps->setPreconditionerBlocks(completeYBlocks(ny));
+            cpodes->spgmr(CPodes::RightPreconditioning, maxKrylovDimension);
+            cpodes->spilsSetPreconditioner();
+        }
+        break;
+    }
     cpodes->setNonlinConvCoef(Real(0.01)); // TODO (default is 0.1)
     if (useCpodesProjection) {
         const int nqerr = state.getNQErr(), nuerr = state.getNUErr();
@@ -383,7 +524,9 @@ stepTo(Real reportTime, Real scheduledEventTime) {
             Vector yout(getAdvancedState().getY().size());
             Vector ypout(getAdvancedState().getY().size()); // ignored
             int oldSteps=0, oldTestFailures=0, oldNonlinIterations=0, 
-                oldNonlinConvFailures=0;
+                oldNonlinConvFailures=0, oldKrylovIterations=0;
+            if (linearSolver == CPodesIntegrator::KrylovLinearSolver)
+                cpodes->spilsGetNumLinIters(&oldKrylovIterations);
             cpodes->getNumSteps(&oldSteps);
             cpodes->getNumErrTestFails(&oldTestFailures);
             cpodes->getNumNonlinSolvIters(&oldNonlinIterations);
@@ -408,7 +551,15 @@ stepTo(Real reportTime, Real scheduledEventTime) {
             }
 
             int newSteps=0, newTestFailures=0, newNonlinIterations=0, 
-                newNonlinConvFailures=0;
+                newNonlinConvFailures=0, newKrylovIterations=0;
+            if (linearSolver == CPodesIntegrator::KrylovLinearSolver) {
+                cpodes->spilsGetNumLinIters(&newKrylovIterations);
+                // The counter restarts on the first step after a reInit().
+                if (newKrylovIterations < oldKrylovIterations)
+                    oldKrylovIterations = 0;
+                statsKrylovIterations += 
+                    newKrylovIterations - oldKrylovIterations;
+            }
             cpodes->getNumSteps(&newSteps);
             cpodes->getNumErrTestFails(&newTestFailures);
             cpodes->getNumNonlinSolvIters(&newNonlinIterations);
@@ -614,6 +765,8 @@ void CPodesIntegratorRep::resetMethodStatistics() {
     statsErrorTestFailures = 0;
     statsConvergenceTestFailures = 0;
     statsIterations = 0;
+    statsKrylovIterations = 0;
+    statsPreconditionerEvaluations = 0;
 }
 
 const char* CPodesIntegratorRep::getMethodName() const {
@@ -643,4 +796,67 @@ void CPodesIntegratorRep::setOrderLimit(int order) {
     cpodes->setMaxOrd(order);
 }
 
+void CPodesIntegratorRep::
+setLinearSolver(CPodesIntegrator::LinearSolver solver) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setLinearSolver",
+        "This method may not be invoked after the integrator has been initialized.");
+    linearSolver = solver;
+}
+
+void CPodesIntegratorRep::setJacobianBandwidth(int upper, int lower) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setJacobianBandwidth",
+        "This method may not be invoked after the integrator has been initialized.");
+    SimTK_APIARGCHECK2_ALWAYS(upper >= 0 && lower >= 0, "CPodesIntegrator",
+        "setJacobianBandwidth",
+        "The half-bandwidths must be nonnegative but were %d and %d.",
+        upper, lower);
+    bandUpper = upper;
+    bandLower = lower;
+}
+
+void CPodesIntegratorRep::setMaxKrylovDimension(int maxl) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setMaxKrylovDimension",
+        "This method may not be invoked after the integrator has been initialized.");
+    SimTK_APIARGCHECK1_ALWAYS(maxl >= 0, "CPodesIntegrator",
+        "setMaxKrylovDimension",
+        "The maximum Krylov dimension must be nonnegative but was %d.", maxl);
+    maxKrylovDimension = maxl;
+}
+
+void CPodesIntegratorRep::
+setPreconditionerBlocks(const Array_< Array_<int> >& yBlocks) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setPreconditionerBlocks",
+        "This method may not be invoked after the integrator has been initialized.");
+    preconditionerBlocks = yBlocks;
+}
+
+// Check the user's preconditioner blocks against the actual number of 
+// states and add a 1x1 block for each state they leave out.
+Array_< Array_<int> > CPodesIntegratorRep::completeYBlocks(int ny) const {
+    Array_< Array_<int> > blocks;
+    Array_<bool> covered(ny, false);
+    for (const Array_<int>& blk : preconditionerBlocks) {
+        if (blk.empty()) continue;
+        for (int j : blk) {
+            SimTK_ERRCHK2_ALWAYS(0 <= j && j < ny, 
+                "CPodesIntegrator::initialize()",
+                "Preconditioner block index %d is out of range for a "
+                "system with %d states.", j, ny);
+            SimTK_ERRCHK1_ALWAYS(!covered[j], 
+                "CPodesIntegrator::initialize()",
+                "State %d appears in more than one preconditioner block.", j);
+            covered[j] = true;
+        }
+        blocks.push_back(blk);
+    }
+    for (int j=0; j < ny; ++j)
+        if (!covered[j])
+            blocks.push_back(Array_<int>(1, j));
+    return blocks;
+}
+
 
@@ -28,6 +28,7 @@
 #include "simmath/internal/common.h"
 #include "simmath/Integrator.h"
 #include "simmath/internal/SimTKcpodes.h"
+#include "simmath/CPodesIntegrator.h"
 
 #include "IntegratorRep.h"
 
@@ -64,6 +65,15 @@ public:
     bool methodHasErrorControl() const override;
     void setUseCPodesProjection();
     void setOrderLimit(int order);
+    void setLinearSolver(CPodesIntegrator::LinearSolver solver);
+    CPodesIntegrator::LinearSolver getLinearSolver() const
+    {   return linearSolver; }
+    void setJacobianBandwidth(int upper, int lower);
+    void setMaxKrylovDimension(int maxl);
+    void setPreconditionerBlocks(const Array_< Array_<int> >& yBlocks);
+    int getNumKrylovIterations() const {return statsKrylovIterations;}
+    int getNumPreconditionerEvaluations() const 
+    {   return statsPreconditionerEvaluations; }
     class CPodesSystemImpl;
     friend class CPodesSystemImpl;
 private:
@@ -72,10 +82,15 @@ private:
     bool initialized, useCpodesProjection;
     int statsStepsTaken, statsErrorTestFailures, statsConvergenceTestFailures;
     int statsIterations;
+    int statsKrylovIterations, statsPreconditionerEvaluations;
     int pendingReturnCode;
     Real previousStartTime, previousTimeReturned;
     Vector savedY;
     CPodes::LinearMultistepMethod method;
+    CPodesIntegrator::LinearSolver linearSolver;
+    int bandUpper, bandLower, maxKrylovDimension;
+    Array_< Array_<int> > preconditionerBlocks;
+    Array_< Array_<int> > completeYBlocks(int ny) const;
     void init(CPodes::LinearMultistepMethod method, CPodes::NonlinearSystemIterationType iterationType);
 };
 
@@ -309,7 +309,12 @@ public:
         const Real cy1 = d*d*(3-2*d), cy0 = 1-cy1;
         const Real hdd1 = h*d*(d-1), cf1=hdd1*d, cf0=cf1-hdd1;
 
-        yt = cy0*y0 + cy1*y1 + cf0*f0 + cf1*f1; // + O(h^4)
+        // Element by element, since a Vector expression would allocate 
+        // temporaries.
+        const int n = y0.size();
+        yt.resize(n);
+        for (int i=0; i < n; ++i)
+            yt[i] = cy0*y0[i] + cy1*y1[i] + cf0*f0[i] + cf1*f1[i]; // + O(h^4)
     }
 
     // We have bracketed a zero crossing for some function f(t)
@@ -450,25 +455,30 @@ public:
     }
 
     // Calculate the error norm using RMS or Inf norm, and report which y
-    // was dominant.
+    // was dominant. This is done on every step attempt so it works on index
+    // ranges of yErrEst and scratch space rather than making views, which 
+    // would allocate.
     Real calcErrorNorm(const State& s, const Vector& yErrEst, 
                        int& worstY) const {
         const int nq=s.getNQ(), nu=s.getNU(), nz=s.getNZ();
         int worstQ, worstU, worstZ;
         Real qNorm, uNorm, zNorm, maxNorm;
+        dqScratch.resize(nq);
+        for (int i=0; i < nq; ++i)
+            dqScratch[i] = yErrEst[i];
         if (userUseInfinityNorm == 1) {
-            qNorm = calcWeightedInfNormQ(s, s.getUWeights(), yErrEst(0,nq),
+            qNorm = calcWeightedInfNormQ(s, s.getUWeights(), dqScratch,
                                          worstQ);
-            uNorm = calcWeightedInfNorm(getPreviousUScale(), yErrEst(nq,nu),
+            uNorm = calcWeightedInfNorm(getPreviousUScale(), yErrEst, nq,
                                         worstU);
-            zNorm = calcWeightedInfNorm(getPreviousZScale(), yErrEst(nq+nu,nz),
+            zNorm = calcWeightedInfNorm(getPreviousZScale(), yErrEst, nq+nu,
                                         worstZ);
         } else {
-            qNorm = calcWeightedRMSNormQ(s, s.getUWeights(), yErrEst(0,nq),
+            qNorm = calcWeightedRMSNormQ(s, s.getUWeights(), dqScratch,
                                          worstQ);
-            uNorm = calcWeightedRMSNorm(getPreviousUScale(), yErrEst(nq,nu),
+            uNorm = calcWeightedRMSNorm(getPreviousUScale(), yErrEst, nq,
                                         worstU);
-            zNorm = calcWeightedRMSNorm(getPreviousZScale(), yErrEst(nq+nu,nz),
+            zNorm = calcWeightedRMSNorm(getPreviousZScale(), yErrEst, nq+nu,
                                         worstZ);
         }
 
@@ -507,39 +517,56 @@ public:
         assert(Wu.size() == nu);
         dqw.resize(nq);
         if (nq==0) return;
-        Vector du(nu);
-        system.multiplyByNPInv(state, dq, du);
-        du.rowScaleInPlace(Wu);
-        system.multiplyByN(state, du, dqw);
+        duScratch.resize(nu);
+        system.multiplyByNPInv(state, dq, duScratch);
+        for (int i=0; i < nu; ++i) // rowScaleInPlace() would make views
+            duScratch[i] *= Wu[i];
+        system.multiplyByN(state, duScratch, dqw);
     }
     // Calculate |Wq*dq|_RMS=|N*Wu*pinv(N)*dq|_RMS
     Real calcWeightedRMSNormQ(const State& state, const Vector& Wu,
                               const Vector& dq, int& worstQ) const
     {
-        const int nq = state.getNQ();
-        Vector dqw(nq);
-        scaleDQ(state, Wu, dq, dqw);
-        return dqw.normRMS(&worstQ);
+        scaleDQ(state, Wu, dq, dqwScratch);
+        return dqwScratch.normRMS(&worstQ);
     }
     // Calculate |Wq*dq|_Inf=|N*Wu*pinv(N)*dq|_Inf
     Real calcWeightedInfNormQ(const State& state, const Vector& Wu,
                               const Vector& dq, int& worstQ) const
     {
-        const int nq = state.getNQ();
-        Vector dqw(nq);
-        scaleDQ(state, Wu, dq, dqw);
-        return dqw.normInf(&worstQ);
+        scaleDQ(state, Wu, dq, dqwScratch);
+        return dqwScratch.normInf(&worstQ);
     }
 
+    // Weighted norms of the weights.size() elements of values beginning at
+    // start, with worstOne relative to start. These match the Vector 
+    // weightedNormRMS() and weightedNormInf() methods.
     // TODO: these utilities don't really belong here
-    static Real calcWeightedRMSNorm(const Vector& weights, const Vector& values, 
-                                    int& worstOne) {
-        return values.weightedNormRMS(weights, &worstOne);
+    static Real calcWeightedRMSNorm(const Vector& weights, const Vector& values,
+                                    int start, int& worstOne) {
+        const int n = weights.size();
+        assert(start >= 0 && start+n <= values.size());
+        worstOne = n ? 0 : -1;
+        Real sumsq = 0, maxsq = 0;
+        for (int i=0; i < n; ++i) {
+            const Real wv2 = square(weights[i]*values[start+i]);
+            if (wv2 > maxsq) maxsq=wv2, worstOne=i;
+            sumsq += wv2;
+        }
+        return n ? std::sqrt(sumsq/n) : Real(0);
     }
 
     static Real calcWeightedInfNorm(const Vector& weights, const Vector& values,
-                                    int& worstOne) {
-        return values.weightedNormInf(weights, &worstOne);
+                                    int start, int& worstOne) {
+        const int n = weights.size();
+        assert(start >= 0 && start+n <= values.size());
+        worstOne = n ? 0 : -1;
+        Real maxabs = 0;
+        for (int i=0; i < n; ++i) {
+            const Real wv = std::abs(weights[i]*values[start+i]);
+            if (wv > maxabs) maxabs=wv, worstOne=i;
+        }
+        return maxabs;
     }
 
     virtual const char* getMethodName() const = 0;
@@ -579,7 +606,7 @@ protected:
         const int n = eventIds.size();
         assert(n > 0 && estEventTimes.size()==n && transitionsSeen.size()==n);
         triggeredEvents.resize(n); estimatedEventTimes.resize(n); eventTransitionsSeen.resize(n);
-        Array_<int> eventOrder; // will be a permutation of 0:n-1
+        Array_<int>& eventOrder = eventOrderScratch; // permutation of 0:n-1
         calcEventOrder(eventIds, estEventTimes, eventOrder);
         for (int i=0; i<(int)eventOrder.size(); ++i) {
             const int ipos = eventOrder[i];
@@ -655,6 +682,15 @@ protected:
     }
 
 
+    // Make view refer to the n elements of v beginning at start. Making a
+    // view allocates, so an existing view of that same memory is kept; it is
+    // remade only after v has been resized.
+    static void viewSegment(Vector& v, int start, int n, Vector& view) {
+        if (view.size() == n && (n == 0 || &view[0] == &v[start]))
+            return;
+        view.viewAssign(v(start, n));
+    }
+
     // We're about to take a step. Record the current time and state as 
     // the previous ones. We calculate the scaling for
     // u and z here which may include relative scaling based on their current
@@ -665,9 +701,9 @@ protected:
         tPrev        = s.getTime();
 
         yPrev        = s.getY();
-        qPrev.viewAssign(yPrev(0,     nq));
-        uPrev.viewAssign(yPrev(nq,    nu));
-        zPrev.viewAssign(yPrev(nq+nu, nz));
+        viewSegment(yPrev, 0,     nq, qPrev);
+        viewSegment(yPrev, nq,    nu, uPrev);
+        viewSegment(yPrev, nq+nu, nz, zPrev);
 
         calcRelativeScaling(s.getU(), s.getUWeights(), uScalePrev); 
         calcRelativeScaling(s.getZ(), s.getZWeights(), zScalePrev);
@@ -682,9 +718,9 @@ protected:
         const int nq = s.getNQ(), nu = s.getNU(), nz = s.getNZ();
 
         ydotPrev     = s.getYDot();
-        qdotPrev.viewAssign(ydotPrev(0,     nq));
-        udotPrev.viewAssign(ydotPrev(nq,    nu));
-        zdotPrev.viewAssign(ydotPrev(nq+nu, nz));
+        viewSegment(ydotPrev, 0,     nq, qdotPrev);
+        viewSegment(ydotPrev, nq,    nu, udotPrev);
+        viewSegment(ydotPrev, nq+nu, nz, zdotPrev);
 
         qdotdotPrev  = s.getQDotDot();
         triggersPrev = s.getEventTriggers();
@@ -787,8 +823,8 @@ protected:
         // Nothing happens here if position constraints were already satisfied
         // unless we set the ForceProjection option above.
         if (yErrEst.size()) {
-            VectorView qErrEst = yErrEst(0, s.getNQ());
-            getSystem().projectQ(s, qErrEst, options, results);
+            viewSegment(yErrEst, 0, s.getNQ(), qErrEstView);
+            getSystem().projectQ(s, qErrEstView, options, results);
         } else {
             getSystem().projectQ(s, yErrEst, options, results);
         }
@@ -830,8 +866,8 @@ protected:
         // Nothing happens here if velocity constraints were already satisfied
         // unless we set the ForceProjection option above.
         if (yErrEst.size()) {
-            VectorView uErrEst = yErrEst(s.getNQ(), s.getNU());
-            getSystem().projectU(s, uErrEst, options, results);
+            viewSegment(yErrEst, s.getNQ(), s.getNU(), uErrEstView);
+            getSystem().projectU(s, uErrEstView, options, results);
         } else {
             getSystem().projectU(s, yErrEst, options, results);
         }
@@ -877,10 +913,9 @@ protected:
         system.prescribeQ(s);
         system.realize(s, Stage::Position);
 
-        Vector dummy; // no error estimate to project
         ProjectResults results;
         ++statsQProjectionFailures; // assume failure, then fix if no throw
-        system.projectQ(s, dummy, options, results);
+        system.projectQ(s, noErrEst, options, results);
         --statsQProjectionFailures; // false alarm -- it succeeded
         if (results.getAnyChangeMade())
             ++statsQProjections;
@@ -890,7 +925,7 @@ protected:
 
         results.clear();
         ++statsUProjectionFailures; // assume failure, then fix if no throw
-        system.projectU(s, dummy, options, results);
+        system.projectU(s, noErrEst, options, results);
         --statsUProjectionFailures; // false alarm -- it succeeded
         if (results.getAnyChangeMade())
             ++statsUProjections;
@@ -982,7 +1017,8 @@ private:
         }
 
         // otherwise sort
-        Array_<EventSorter> events(n);
+        Array_<EventSorter>& events = eventSorterScratch;
+        events.resize(n);
         for (unsigned i=0; i<n; ++i)
             events[i] = EventSorter(i, eventIds[i], estEventTimes[i]);
         std::sort(events.begin(), events.end());
@@ -1109,6 +1145,14 @@ private:
     Vector qPrev, uPrev, zPrev;
     Vector qdotPrev, udotPrev, zdotPrev;
 
+    // Scratch space, so that once these have grown to the system's sizes a
+    // step allocates nothing here.
+    mutable Vector dqScratch, duScratch, dqwScratch; // error norm of q
+    Vector qErrEstView, uErrEstView; // views into the yErrEst being projected
+    Vector noErrEst; // always empty
+    Array_<int> eventOrderScratch;
+    Array_<EventSorter> eventSorterScratch;
+
     // We'll leave the various arrays above sized as they are and full
     // of garbage. They'll be resized when first assigned to something
     // meaningful.
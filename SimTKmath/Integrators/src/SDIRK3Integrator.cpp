@@ -0,0 +1,305 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the 
+ * SDIRK3Integrator and SDIRK3IntegratorRep classes.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/Integrator.h"
+#include "simmath/SDIRK3Integrator.h"
+
+#include "IntegratorRep.h"
+#include "SDIRK3IntegratorRep.h"
+
+#include <exception>
+#include <limits>
+
+using namespace SimTK;
+
+//------------------------------------------------------------------------------
+//                            SDIRK3 INTEGRATOR
+//------------------------------------------------------------------------------
+
+SDIRK3Integrator::SDIRK3Integrator(const System& sys) 
+{
+    rep = new SDIRK3IntegratorRep(this, sys);
+}
+
+void SDIRK3Integrator::setUseSystemJacobian(bool useSystemJacobian) {
+    SDIRK3IntegratorRep& srep = dynamic_cast<SDIRK3IntegratorRep&>(*rep);
+    srep.setUseSystemJacobian(useSystemJacobian);
+}
+
+bool SDIRK3Integrator::getUseSystemJacobian() const {
+    const SDIRK3IntegratorRep& srep = 
+        dynamic_cast<const SDIRK3IntegratorRep&>(*rep);
+    return srep.getUseSystemJacobian();
+}
+
+int SDIRK3Integrator::getNumJacobianEvaluations() const {
+    const SDIRK3IntegratorRep& srep = 
+        dynamic_cast<const SDIRK3IntegratorRep&>(*rep);
+    return srep.getNumJacobianEvaluations();
+}
+
+int SDIRK3Integrator::getNumFactorizations() const {
+    const SDIRK3IntegratorRep& srep = 
+        dynamic_cast<const SDIRK3IntegratorRep&>(*rep);
+    return srep.getNumFactorizations();
+}
+
+//------------------------------------------------------------------------------
+//                          SDIRK3 INTEGRATOR REP
+//------------------------------------------------------------------------------
+
+// This is R. Alexander's 3-stage, 3rd order, L-stable SDIRK method. Gamma is 
+// the root of gamma^3 - 3 gamma^2 + 3/2 gamma - 1/6 = 0 that lies in 
+// (1/6, 1/2). The Butcher diagram is
+//
+//            gamma|  gamma
+//    (1+gamma)/2  |  (1-gamma)/2   gamma
+//                1|  b1            b2      gamma
+//         --------|--------------------------------
+//                 |  b1            b2      gamma   3rd order
+//                 |  bh1           bh2     0       2nd order, for error est.
+//
+// with b1 = -(6 gamma^2 - 16 gamma + 1)/4, b2 = (6 gamma^2 - 20 gamma + 5)/4.
+// The method is stiffly accurate (the last stage value is the result). The
+// embedded 2nd order formula uses only the first two stages; bh2 is chosen
+// to satisfy the 2nd order condition bh1*c1 + bh2*c2 = 1/2.
+namespace {
+const Real Gamma = Real(0.43586652150845900);
+const Real C[3]  = {Gamma, (1+Gamma)/2, 1};
+const Real B1    = -(6*Gamma*Gamma - 16*Gamma + 1)/4;
+const Real B2    =  (6*Gamma*Gamma - 20*Gamma + 5)/4;
+const Real A[3][2] = {{0,            0 }, 
+                      {(1-Gamma)/2,  0 }, 
+                      {B1,           B2}};
+const Real BHat2 = (1-2*Gamma)/(1-Gamma);
+const Real BErr[3] = {B1-(1-BHat2), B2-BHat2, Gamma}; // b - bhat
+
+// Newton iteration controls. An iteration is considered converged when the
+// predicted remaining change is this fraction of the accuracy requirement.
+const Real Kappa               = Real(0.05);
+const int  MaxNewtonIterations = 7;
+// Form a new Jacobian at the next step if an iteration converged more slowly
+// than this.
+const Real SlowConvergenceRate = Real(0.5);
+// Keep the current factorization of W unless h*gamma has changed by more 
+// than this fraction.
+const Real RefactorTolerance   = Real(0.2);
+}
+
+SDIRK3IntegratorRep::SDIRK3IntegratorRep
+   (Integrator* handle, const System& sys) 
+:   AbstractIntegratorRep(handle, sys, 3, 3, "SDIRK3", true),
+    useSystemJacobian(true), hgammaW(NaN), jacobianTime(NaN),
+    needNewJacobian(true), newtonEta(1) {
+    resetMethodStatistics();
+}
+
+void SDIRK3IntegratorRep::methodInitialize(const State& state) {
+    AbstractIntegratorRep::methodInitialize(state);
+    needNewJacobian = true;
+    hgammaW = jacobianTime = NaN;
+    newtonEta = 1;
+}
+
+// An event handler may have changed anything, including the number of
+// states, so we can't trust J or W any more.
+void SDIRK3IntegratorRep::
+methodReinitialize(Stage stage, bool shouldTerminate) {
+    needNewJacobian = true;
+    hgammaW = jacobianTime = NaN;
+}
+
+void SDIRK3IntegratorRep::resetMethodStatistics() {
+    AbstractIntegratorRep::resetMethodStatistics();
+    statsJacobianEvaluations = 0;
+    statsFactorizations = 0;
+}
+
+// Form J = d ydot/d y at (t0,y0), preferably from the System, otherwise by 
+// forward differences of ydot, one state at a time. We perturb y through the
+// advanced state, which the caller is about to overwrite anyway.
+void SDIRK3IntegratorRep::
+calcJacobian(Real t0, const Vector& y0, const Vector& ydot0) {
+    const int ny = y0.size();
+    bool haveJ = false;
+    if (useSystemJacobian) {
+        setAdvancedStateAndRealizeKinematics(t0, y0);
+        haveJ = getSystem().calcYDotJacobian(getAdvancedState(), J)
+                && J.nrow() == ny && J.ncol() == ny;
+    }
+    if (!haveJ) {
+        J.resize(ny, ny);
+        Vector& y = z; // not in use until the stages are solved
+        y = y0;
+        for (int j=0; j < ny; ++j) {
+            // Make sure the perturbation is exactly representable.
+            const Real yj = y0[j] + SqrtEps*std::max(Real(1), std::abs(y0[j]));
+            const Real dy = yj - y0[j];
+            y[j] = yj;
+            setAdvancedStateAndRealizeDerivatives(t0, y);
+            const Vector& ydot = getAdvancedState().getYDot();
+            for (int i=0; i < ny; ++i)
+                J(i,j) = (ydot[i] - ydot0[i]) / dy;
+            y[j] = y0[j];
+        }
+    }
+    ++statsJacobianEvaluations;
+    jacobianTime = t0;
+    needNewJacobian = false;
+}
+
+// Solve stage i for z = y0 + h*sum_j<i A[i][j]*K[j] + h*gamma*f(t,z) by 
+// simplified Newton iteration with the already-factored W = I - h*gamma*J,
+// then recover the stage derivative K[i] from the stage equation rather than
+// evaluating f(t,z) again.
+bool SDIRK3IntegratorRep::
+solveStage(int i, Real t, const Vector& y0, Real h, int& numIterations) {
+    const Real hgamma = h*Gamma;
+    const int ny = y0.size();
+    // These are all written element by element so that, once sized, the
+    // workspaces are reused with no heap allocation.
+    rhs = y0;
+    for (int j=0; j < i; ++j) {
+        const Real hA = h*A[i][j];
+        const Vector& Kj = K[j];
+        for (int k=0; k < ny; ++k)
+            rhs[k] += hA*Kj[k];
+    }
+
+    // Predict by extrapolating with the most recent derivative.
+    const Vector& fPredict = i==0 ? getPreviousYDot() : K[i-1];
+    z.resize(ny);
+    for (int k=0; k < ny; ++k)
+        z[k] = rhs[k] + hgamma*fPredict[k];
+
+    Real eta = std::max(newtonEta, Eps);
+    eta = std::pow(eta, Real(0.8));
+    Real prevNorm = Infinity;
+    for (int iter=0; iter < MaxNewtonIterations; ++iter) {
+        ++numIterations;
+        setAdvancedStateAndRealizeDerivatives(t, z);
+        const Vector& f = getAdvancedState().getYDot();
+        residual.resize(ny);
+        for (int k=0; k < ny; ++k)
+            residual[k] = rhs[k] + hgamma*f[k] - z[k];
+        luW.solve(residual, dz);
+        z += dz;
+
+        int worstY;
+        const Real norm = calcErrorNorm(getAdvancedState(), dz, worstY);
+        if (iter > 0) {
+            const Real theta = norm/prevNorm;
+            if (theta >= 1) {
+                needNewJacobian = true;
+                return false; // diverging
+            }
+            if (theta > SlowConvergenceRate)
+                needNewJacobian = true;
+            eta = theta/(1-theta);
+        }
+        if (eta*norm <= Kappa*getAccuracyInUse()) {
+            newtonEta = eta;
+            Vector& Ki = K[i];
+            Ki.resize(ny);
+            for (int k=0; k < ny; ++k)
+                Ki[k] = (z[k] - rhs[k])/hgamma;
+            return true;
+        }
+        prevNorm = norm;
+    }
+    needNewJacobian = true;
+    return false;
+}
+
+bool SDIRK3IntegratorRep::attemptODEStep
+   (Real t1, Vector& y1err, int& errOrder, int& numIterations)
+{
+    const Real t0 = getPreviousTime();
+    assert(t1 > t0);
+
+    statsStepsAttempted++;
+    errOrder = 3;
+    numIterations = 0;
+    const Vector& y0 = getPreviousY();
+    const Vector& f0 = getPreviousYDot();
+    const int ny = y0.size();
+    const Real h = t1-t0;
+    const Real hgamma = h*Gamma;
+
+    // We will catch any exceptions thrown by realize() and treat that as a 
+    // failure to converge, so that the caller will try a smaller step.
+  try
+  {
+    if (needNewJacobian || J.nrow() != ny) {
+        calcJacobian(t0, y0, f0);
+        hgammaW = NaN;
+    }
+
+    if (isNaN(hgammaW) 
+        || std::abs(hgamma-hgammaW) > RefactorTolerance*hgammaW) {
+        W = J;
+        W *= -hgamma;
+        W.diag() += 1;
+        luW.factor(W);
+        ++statsFactorizations;
+        hgammaW = luW.isSingular() ? NaN : hgamma;
+        if (isNaN(hgammaW))
+            return false;
+    }
+
+    for (int i=0; i < NStages; ++i)
+        if (!solveStage(i, t0 + C[i]*h, y0, h, numIterations)) {
+            // A failure with a fresh Jacobian just means the step was too 
+            // big; otherwise try again with a new one.
+            if (jacobianTime == t0)
+                needNewJacobian = false;
+            return false;
+        }
+
+    // The method is stiffly accurate so the last stage value is the 3rd 
+    // order result. Evaluate through kinematics only since the caller will
+    // project before evaluating derivatives.
+    setAdvancedStateAndRealizeKinematics(t1, z);
+
+    // The raw error estimate h*sum (b-bhat)*K is dominated by the stiff
+    // components, which the method damps. Premultiplying by W^-1 filters 
+    // those out while leaving the nonstiff ones unchanged to O(h); see 
+    // Hairer & Wanner, Solving ODEs II, 2nd ed., section IV.8.
+    for (int k=0; k < ny; ++k)
+        rhs[k] = h*(BErr[0]*K[0][k] + BErr[1]*K[1][k] + BErr[2]*K[2][k]);
+    luW.solve(rhs, dz);
+    for (int i=0; i < ny; ++i)
+        y1err[i] = std::abs(dz[i]);
+
+    return true;
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+}
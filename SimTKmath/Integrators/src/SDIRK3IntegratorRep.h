@@ -0,0 +1,79 @@
+#ifndef SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
+#define SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "simmath/LinearAlgebra.h"
+
+#include "AbstractIntegratorRep.h"
+
+namespace SimTK {
+
+/**
+ * This is the private (library side) implementation of the 
+ * SDIRK3IntegratorRep class which is a concrete class
+ * implementing the abstract IntegratorRep.
+ */
+
+class SDIRK3IntegratorRep : public AbstractIntegratorRep {
+public:
+    SDIRK3IntegratorRep(Integrator* handle, const System& sys);
+
+    void methodInitialize(const State&) override;
+    void methodReinitialize(Stage stage, bool shouldTerminate) override;
+    void resetMethodStatistics() override;
+
+    void setUseSystemJacobian(bool use) {useSystemJacobian = use;}
+    bool getUseSystemJacobian() const {return useSystemJacobian;}
+    int getNumJacobianEvaluations() const {return statsJacobianEvaluations;}
+    int getNumFactorizations() const {return statsFactorizations;}
+protected:
+    bool attemptODEStep
+       (Real t1, Vector& yErrEst, int& errOrder, int& numIterations) override;
+private:
+    void calcJacobian(Real t0, const Vector& y0, const Vector& ydot0);
+    bool solveStage(int stage, Real t, const Vector& y0, Real h,
+                    int& numIterations);
+
+    bool        useSystemJacobian;
+
+    // J is the ydot Jacobian; W = I - hgammaW*J is factored in luW.
+    Matrix      J, W;
+    FactorLU    luW;
+    Real        hgammaW;        // NaN if W is not current
+    Real        jacobianTime;   // t0 of the step at which J was formed
+    bool        needNewJacobian;
+    Real        newtonEta;      // theta/(1-theta) carried between stages
+
+    static const int NStages = 3;
+    Vector      K[NStages];     // stage derivatives
+    Vector      z, rhs, dz, residual; // Newton temporaries
+
+    int         statsJacobianEvaluations;
+    int         statsFactorizations;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
@@ -75,10 +75,39 @@ void TimeStepper::initialize(const State& initState) {
     updIntegrator().initialize(initState);
     rep->lastEventTime = -Infinity;
     rep->lastReportTime = -Infinity;
+    rep->history.clear();
+    rep->history.record(getState());
 }
 
 Integrator::SuccessfulStepStatus TimeStepper::stepTo(Real reportTime) {
-    return( rep->stepTo(reportTime) );
+    const Integrator::SuccessfulStepStatus status = rep->stepTo(reportTime);
+    rep->history.record(getState());
+    return status;
+}
+
+void TimeStepper::setStateHistoryCapacity(int numCheckpoints) {
+    rep->history.setCapacity(numCheckpoints);
+}
+
+const StateHistory& TimeStepper::getStateHistory() const {
+    return rep->history;
+}
+
+Real TimeStepper::rollBackTo(Real time) {
+    StateHistory& history = rep->history;
+    const int i = history.findCheckpoint(time);
+    SimTK_ERRCHK1_ALWAYS(i >= 0, "TimeStepper::rollBackTo()",
+        "There is no checkpoint at or before time %g to roll back to.", time);
+    // The Integrator copies the State it is initialized with, so restore into
+    // a temporary rather than keeping one around between rollbacks.
+    State restored;
+    history.restore(i, restored);
+    history.discardCheckpointsAfter(i);
+
+    updIntegrator().initialize(restored);
+    rep->lastEventTime = -Infinity;
+    rep->lastReportTime = -Infinity;
+    return getTime();
 }
 
 bool TimeStepper::getReportAllSignificantStates() const {
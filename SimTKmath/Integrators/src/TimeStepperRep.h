@@ -90,6 +90,9 @@ private:
     // The last time at events and reports were processed.
     Real lastEventTime, lastReportTime;
 
+    // Checkpoints for rollBackTo(), recorded when enabled.
+    StateHistory history;
+
     // suppress
     TimeStepperRep(const TimeStepperRep&);
     TimeStepperRep& operator=(const TimeStepperRep&);
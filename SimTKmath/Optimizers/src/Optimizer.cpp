@@ -153,6 +153,13 @@ void Optimizer::setDifferentiatorMethod( Differentiator::Method method) {
      updRep().setDifferentiatorMethod(method);
 }
 
+void Optimizer::setDifferentiatorNumThreads(int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 1, "Optimizer",
+        "setDifferentiatorNumThreads",
+        "The number of threads was %d but must be >= 1", numThreads);
+    updRep().setDifferentiatorNumThreads(numThreads);
+}
+
 void Optimizer::setConvergenceTolerance( Real accuracy ) {
      updRep().setConvergenceTolerance(accuracy);
 }
@@ -209,6 +216,10 @@ Differentiator::Method Optimizer::getDifferentiatorMethod() const {
     return getRep().getDifferentiatorMethod();
 }
 
+int Optimizer::getDifferentiatorNumThreads() const {
+    return getRep().getDifferentiatorNumThreads();
+}
+
 OptimizerAlgorithm Optimizer::getAlgorithm() const {
     return getRep().getAlgorithm();
 }
@@ -125,6 +125,13 @@ setDifferentiatorMethod(Differentiator::Method method) {
      diffMethod = method;
 }
 
+void Optimizer::OptimizerRep::
+setDifferentiatorNumThreads(int numThreads) {
+    diffNumThreads = numThreads;
+    if (gradDiff) gradDiff->setNumThreads(numThreads);
+    if (jacDiff)  jacDiff->setNumThreads(numThreads);
+}
+
 void Optimizer::OptimizerRep::
 useNumericalGradient(bool flag, Real objEstAccuracy) {
     objectiveEstimatedAccuracy = 
@@ -134,6 +141,7 @@ useNumericalGradient(bool flag, Real objEstAccuracy) {
         of = new SysObjectiveFunc(sysp->getNumParameters(), sysp);
         of->setEstimatedAccuracy(objectiveEstimatedAccuracy);
         gradDiff = new Differentiator(*of, diffMethod);
+        gradDiff->setNumThreads(diffNumThreads);
     }
     numericalGradient = flag;
 }
@@ -147,6 +155,7 @@ useNumericalJacobian(bool flag, Real consEstAccuracy) {
                                    sysp->getNumParameters(), sysp);
         cf->setEstimatedAccuracy(constraintsEstimatedAccuracy);
         jacDiff = new Differentiator(*cf, diffMethod); 
+        jacDiff->setNumThreads(diffNumThreads);
     }
     numericalJacobian = flag;
 }
@@ -46,6 +46,7 @@
 #include "simmath/internal/Contact.h"
 #include "simmath/internal/ContactTracker.h"
 #include "simmath/internal/CollisionDetectionAlgorithm.h"
+#include "simmath/internal/BroadPhase.h"
 
 #include "simmath/LinearAlgebra.h"
 #include "simmath/Differentiator.h"
@@ -54,6 +55,7 @@
 #include "simmath/Integrator.h"
 #include "simmath/TimeStepper.h"
 #include "simmath/CPodesIntegrator.h"
+#include "simmath/SDIRK3Integrator.h"
 #include "simmath/RungeKuttaMersonIntegrator.h"
 #include "simmath/RungeKuttaFeldbergIntegrator.h"
 #include "simmath/RungeKutta3Integrator.h"
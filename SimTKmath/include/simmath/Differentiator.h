@@ -107,6 +107,32 @@ public:
     Differentiator& setDefaultMethod(Method);
     Method          getDefaultMethod() const;
 
+    // Evaluate the perturbed function values needed by calcGradient() and
+    // calcJacobian() on up to numThreads threads at once, using a
+    // ParallelExecutor owned by this Differentiator. Each thread calls its
+    // own copy of the function, obtained once from Function::clone(); if
+    // the function does not provide clone() the evaluations stay on the
+    // calling thread. The result does not depend on the number of threads.
+    // The default is 1 (serial); numThreads must be at least 1.
+    Differentiator& setNumThreads(int numThreads);
+    int             getNumThreads() const;
+
+    // For a JacobianFunction whose Jacobian is sparse, tell calcJacobian()
+    // which entries can be nonzero: rowsOfColumn[j] lists the functions
+    // (rows) that depend on parameter j. Columns that share no rows are
+    // then grouped, and all the parameters in a group are perturbed in the
+    // same call, so a banded Jacobian with bandwidth b costs about b+1
+    // calls instead of one per parameter. Entries outside the pattern are
+    // returned as zero, so the pattern must include every entry that might
+    // be nonzero. Clearing the pattern restores one call per column.
+    Differentiator& setJacobianSparsityPattern
+                       (const Array_< Array_<int> >& rowsOfColumn);
+    Differentiator& clearJacobianSparsityPattern();
+    bool            hasJacobianSparsityPattern() const;
+    // The number of column groups found for the sparsity pattern, or the
+    // number of parameters if there is no pattern.
+    int             getNumColumnGroups() const;
+
     // These are the real routines, which are efficient and flexible
     // but somewhat messy to use.
     void calcDerivative(Real y0, Real fy0, Real& dfdy, 
@@ -160,6 +186,15 @@ public:
     int  getNumParameters() const;
     Real getEstimatedAccuracy() const; // approx. "roundoff" in f calculation
 
+    // Override this to let a Differentiator evaluate the function on several
+    // threads (see Differentiator::setNumThreads()). Return a new heap-
+    // allocated function of the same kind and dimensions that computes the
+    // same values as this one and can be called concurrently with it and
+    // with other clones; the Differentiator takes ownership and deletes it.
+    // The default returns null, meaning the function is not thread safe.
+    virtual Function* clone() const {return nullptr;}
+    virtual ~Function();
+
     // Statistics (mutable)
     void resetAllStatistics();
     int getNumCalls()    const; // # evaluations of this function since reset
@@ -169,7 +204,6 @@ public:
     class FunctionRep;
 protected:
     Function();
-    ~Function();
 
     // opaque implementation for binary compatibility
     FunctionRep* rep;
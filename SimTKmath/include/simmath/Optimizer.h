@@ -479,6 +479,18 @@ public:
     /// @see SimTK::Differentiator
     Differentiator::Method getDifferentiatorMethod() const;
 
+    /// Evaluate the perturbed objective or constraint values for a numerical
+    /// gradient or Jacobian on up to \p numThreads threads at once. The
+    /// default is 1. This requires that your OptimizerSystem's objectiveFunc()
+    /// and constraintFunc() can safely be called concurrently from several
+    /// threads; don't use it otherwise. Unlike setDifferentiatorMethod(),
+    /// this also affects numerical derivatives that are already enabled.
+    /// @see SimTK::Differentiator::setNumThreads()
+    void setDifferentiatorNumThreads(int numThreads);
+    /// Return the value last supplied to setDifferentiatorNumThreads(),
+    /// or 1 if it hasn't been called.
+    int getDifferentiatorNumThreads() const;
+
     /// Return the algorithm used for the optimization. You may be interested
     /// in this value if you didn't specify an algorithm, or specified for
     /// Simbody to choose the BestAvailable algorithm. This method won't return
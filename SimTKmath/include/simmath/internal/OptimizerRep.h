@@ -42,6 +42,13 @@ public:
     int f(const Vector& y, Real& fy) const override  {
          return(sysp->objectiveFunc(y, true, fy));   // class user's objectiveFunc
     }
+
+    // Clones share the OptimizerSystem; see setDifferentiatorNumThreads().
+    SysObjectiveFunc* clone() const override {
+        SysObjectiveFunc* copy = new SysObjectiveFunc(getNumParameters(), sysp);
+        copy->setEstimatedAccuracy(getEstimatedAccuracy());
+        return copy;
+    }
     const OptimizerSystem* sysp;
 };
 
@@ -56,6 +63,14 @@ class SysConstraintFunc : public Differentiator::JacobianFunction {
     int f(const Vector& y, Vector& fy) const override  {
        return(sysp->constraintFunc(y, true, fy));  // calls user's contraintFunc
     }
+
+    // Clones share the OptimizerSystem; see setDifferentiatorNumThreads().
+    SysConstraintFunc* clone() const override {
+        SysConstraintFunc* copy = new SysConstraintFunc(getNumFunctions(),
+                                                        getNumParameters(), sysp);
+        copy->setEstimatedAccuracy(getEstimatedAccuracy());
+        return copy;
+    }
     const OptimizerSystem* sysp;
 };
 
@@ -76,6 +91,7 @@ public:
          limitedMemoryHistory(50),
          diagnosticsLevel(0),
          diffMethod(Differentiator::CentralDifference),
+         diffNumThreads(1),
          objectiveEstimatedAccuracy(SignificantReal),
          constraintsEstimatedAccuracy(SignificantReal),
          numericalGradient(false), 
@@ -96,6 +112,7 @@ public:
          limitedMemoryHistory(50),
          diagnosticsLevel(0),
          diffMethod(Differentiator::CentralDifference),
+         diffNumThreads(1),
          objectiveEstimatedAccuracy(SignificantReal),
          constraintsEstimatedAccuracy(SignificantReal),
          numericalGradient(false), 
@@ -136,10 +153,12 @@ public:
     void useNumericalGradient(bool flag, Real objEstAccuracy); 
     void useNumericalJacobian(bool flag, Real consEstAccuracy);  
     void setDifferentiatorMethod( Differentiator::Method method);
+    void setDifferentiatorNumThreads(int numThreads);
 
     bool isUsingNumericalGradient() const { return numericalGradient; }
     bool isUsingNumericalJacobian() const { return numericalJacobian; }
     Differentiator::Method getDifferentiatorMethod() const {return diffMethod;}
+    int getDifferentiatorNumThreads() const {return diffNumThreads;}
     Real getEstimatedAccuracyOfObjective() const 
     {   return objectiveEstimatedAccuracy; }
     Real getEstimatedAccuracyOfConstraints() const 
@@ -185,6 +204,7 @@ protected:
     int maxIterations;
     int limitedMemoryHistory;
     Differentiator::Method   diffMethod;
+    int diffNumThreads;
     Real objectiveEstimatedAccuracy;
     Real constraintsEstimatedAccuracy;
 
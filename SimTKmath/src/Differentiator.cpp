@@ -29,7 +29,12 @@
 #include "SimTKcommon.h"
 #include "simmath/Differentiator.h"
 
+#include <atomic>
 #include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace SimTK {
 
@@ -115,6 +120,17 @@ class JacobianFunctionRep;
 // This is used as a value for y in calculating the step size when
 // the actual y is smaller.
 static const Real YMin = Real(0.1);
+
+// What one thread needs to evaluate perturbations on its own: a private copy
+// of the user's function and scratch space for the perturbed parameters and
+// function values.
+struct DifferentiatorWorkspace {
+    std::unique_ptr<Differentiator::Function>   clone;
+    const Differentiator::Function::FunctionRep* frep;
+    Vector ytmp;           // [NParameters]
+    Vector fyptmp, fymtmp; // [NFunctions]
+};
+
 class Differentiator::DifferentiatorRep {
 public:
     DifferentiatorRep(Differentiator* handle,
@@ -144,6 +160,17 @@ public:
         nDifferentiations = nDifferentiationFailures = nCallsToUserFunction = 0;
     }
 
+    void setNumThreads(int numThreads);
+    void setJacobianSparsityPattern(const Array_< Array_<int> >& rowsOfColumn);
+    void clearJacobianSparsityPattern();
+
+    // Perturbation groups used by calcJacobian(): column j alone if there is
+    // no sparsity pattern, otherwise the columns of the j'th color.
+    int getNumColumnGroups() const {
+        return hasSparsityPattern() ? (int)columnsOfGroup.size() : NParameters;
+    }
+    bool hasSparsityPattern() const {return !rowsOfColumn.empty();}
+
     // Statistics
     mutable int nDifferentiations; 
     mutable int nDifferentiationFailures; 
@@ -173,6 +200,27 @@ private:
     mutable Vector ytmp;           // [NParameters]
     mutable Vector fyptmp, fymtmp; // [NFunctions]
 
+    // Concurrent evaluation; see setNumThreads(). The workspaces, one per
+    // thread, are made on first use because that is when we ask the user's
+    // function for its clones. If it has none we remember that and stay
+    // serial.
+    int numThreads;
+    std::unique_ptr<ParallelExecutor> executor;
+    mutable std::vector<std::unique_ptr<DifferentiatorWorkspace>> workspaces;
+    mutable bool functionCanBeCloned;
+
+    // Column coloring for a sparse Jacobian; see
+    // setJacobianSparsityPattern(). Both are empty if there is no pattern.
+    Array_< Array_<int> > rowsOfColumn;
+    Array_< Array_<int> > columnsOfGroup;
+
+    // Evaluate numTasks tasks on the executor, each with the workspace of
+    // the thread running it, and add the clones' call counts to ours.
+    // Returns false without doing anything if we can't run in parallel.
+    // An exception thrown by a task is rethrown here on the calling thread.
+    bool runInParallel(int numTasks,
+        const std::function<void(DifferentiatorWorkspace&,int)>& task) const;
+
     // suppress
     DifferentiatorRep(const DifferentiatorRep&);
     DifferentiatorRep& operator=(const DifferentiatorRep&);
@@ -221,6 +269,21 @@ public:
         nCalls = nFailures = 0;
     }
 
+    // Add the call counts of a clone of this function to ours and reset
+    // its. Returns the number of calls made to the clone.
+    int absorbStatistics(const FunctionRep& clone) const {
+        const int calls = clone.nCalls;
+        nCalls += clone.nCalls; nFailures += clone.nFailures;
+        clone.nCalls = clone.nFailures = 0;
+        return calls;
+    }
+
+    // The handle that owns this rep, whose clone() we call.
+    virtual const Differentiator::Function& getFunction() const=0;
+
+    static const FunctionRep& getRep(const Differentiator::Function& f)
+    {   return *f.rep; }
+
 protected:
     // Stats
     mutable int nCalls;
@@ -239,6 +302,7 @@ public:
 
     // Virtuals (from FunctionRep)
     String functionKind() const override {return "ScalarFunction";}
+    const Differentiator::Function& getFunction() const override {return sf;}
 
     void calcDerivative(const Differentiator::DifferentiatorRep& diff, Differentiator::Method m,
                         Real y0, const Real* fy0p, Real& dfdy) const override
@@ -302,6 +366,7 @@ public:
 
     // Virtuals (from FunctionRep)
     String functionKind() const override {return "GradientFunction";}
+    const Differentiator::Function& getFunction() const override {return gf;}
 
     void calcDerivative(const Differentiator::DifferentiatorRep& diff, Differentiator::Method m,
                         Real y0, const Real* fy0p, Real& dfdy) const override
@@ -368,6 +433,7 @@ public:
 
     // Virtuals (from FunctionRep)
     String functionKind() const override {return "JacobianFunction";}
+    const Differentiator::Function& getFunction() const override {return jf;}
 
     void calcDerivative(const Differentiator::DifferentiatorRep& diff, Differentiator::Method m,
                         Real y0, const Real* fy0p, Real& dfdy) const override
@@ -451,6 +517,48 @@ Differentiator::Method Differentiator::getDefaultMethod() const {
     return rep->defaultMethod;
 }
 
+Differentiator& Differentiator::setNumThreads(int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 1, "Differentiator",
+        "setNumThreads", "The number of threads was %d but must be >= 1",
+        numThreads);
+    rep->setNumThreads(numThreads);
+    return *this;
+}
+
+int Differentiator::getNumThreads() const {
+    return rep->numThreads;
+}
+
+Differentiator& Differentiator::setJacobianSparsityPattern
+   (const Array_< Array_<int> >& rowsOfColumn)
+{
+    SimTK_APIARGCHECK2_ALWAYS((int)rowsOfColumn.size()==rep->NParameters,
+        "Differentiator", "setJacobianSparsityPattern",
+        "Expecting a list of rows for each of the %d parameters but got %d",
+        rep->NParameters, (int)rowsOfColumn.size());
+    for (const Array_<int>& rows : rowsOfColumn)
+        for (int row : rows)
+            SimTK_APIARGCHECK2_ALWAYS(0 <= row && row < rep->NFunctions,
+                "Differentiator", "setJacobianSparsityPattern",
+                "Row index %d is out of range for a function with %d rows",
+                row, rep->NFunctions);
+    rep->setJacobianSparsityPattern(rowsOfColumn);
+    return *this;
+}
+
+Differentiator& Differentiator::clearJacobianSparsityPattern() {
+    rep->clearJacobianSparsityPattern();
+    return *this;
+}
+
+bool Differentiator::hasJacobianSparsityPattern() const {
+    return rep->hasSparsityPattern();
+}
+
+int Differentiator::getNumColumnGroups() const {
+    return rep->getNumColumnGroups();
+}
+
 void Differentiator::calcDerivative
    (Real y0, Real fy0, Real& dfdy, Differentiator::Method m) const 
 {
@@ -687,7 +795,8 @@ Differentiator::DifferentiatorRep::DifferentiatorRep
     EstimatedAccuracy(fr.getEstimatedAccuracy()),
     defaultMethod(getMethodOrThrow(defMthd, DefaultDefaultMethod, "Differentiator")),
     AccFac1(std::sqrt(EstimatedAccuracy)),
-    AccFac2(std::pow(EstimatedAccuracy, OneThird))
+    AccFac2(std::pow(EstimatedAccuracy, OneThird)),
+    numThreads(1), functionCanBeCloned(true)
 {
     //TODO
     assert(NParameters >= 0 && NFunctions >= 0 && EstimatedAccuracy > 0);
@@ -723,6 +832,143 @@ void Differentiator::DifferentiatorRep::calcDerivative
     }
 }
 
+void Differentiator::DifferentiatorRep::setNumThreads(int n) {
+    if (n == numThreads)
+        return;
+    numThreads = n;
+    executor.reset(n > 1 ? new ParallelExecutor(n) : nullptr);
+    workspaces.clear(); // the clones are kept until the thread count changes
+    functionCanBeCloned = true;
+}
+
+// Greedy column coloring (Curtis, Powell & Reid 1974): give each column the
+// lowest-numbered group containing no column that shares a row with it. This
+// is not optimal in general but finds the bandwidth for banded and block
+// diagonal patterns, which are the common cases.
+void Differentiator::DifferentiatorRep::setJacobianSparsityPattern
+   (const Array_< Array_<int> >& pattern)
+{
+    rowsOfColumn = pattern;
+    columnsOfGroup.clear();
+
+    Array_< Array_<int> > columnsOfRow(NFunctions);
+    Array_<int> groupOfColumn(NParameters);
+    Array_<int> lastExcludedBy; // [group] last column that can't use group
+    for (int j=0; j < NParameters; ++j) {
+        for (int row : rowsOfColumn[j])
+            for (int col : columnsOfRow[row])
+                lastExcludedBy[groupOfColumn[col]] = j;
+        int g = 0;
+        while (g < (int)lastExcludedBy.size() && lastExcludedBy[g] == j)
+            ++g;
+        if (g == (int)lastExcludedBy.size()) {
+            lastExcludedBy.push_back(-1);
+            columnsOfGroup.push_back(Array_<int>());
+        }
+        groupOfColumn[j] = g;
+        columnsOfGroup[g].push_back(j);
+        for (int row : rowsOfColumn[j])
+            columnsOfRow[row].push_back(j);
+    }
+}
+
+void Differentiator::DifferentiatorRep::clearJacobianSparsityPattern() {
+    rowsOfColumn.clear();
+    columnsOfGroup.clear();
+}
+
+namespace {
+// Runs a DifferentiatorRep's tasks. Each index of this ParallelExecutor::Task
+// is a worker with a workspace of its own, selected by the index, which takes
+// tasks from a shared counter until there are none left. That way a workspace
+// is never used by two threads at once, whichever threads the executor runs
+// the indices on, and nothing about the thread needs to be remembered.
+class DifferentiatorTask : public ParallelExecutor::Task {
+public:
+    DifferentiatorTask
+       (const std::vector<std::unique_ptr<DifferentiatorWorkspace>>& ws,
+        const std::function<void(DifferentiatorWorkspace&,int)>& task,
+        int numTasks)
+    :   workspaces(ws), task(task), numTasks(numTasks), nextTask(0), 
+        failed(false) {}
+
+    int getNumWorkers() const 
+    {   return std::min((int)workspaces.size(), numTasks); }
+
+    void execute(int worker) override {
+        DifferentiatorWorkspace& ws = *workspaces[worker];
+        for (int index = nextTask++; index < numTasks && !failed;
+             index = nextTask++) {
+            try {
+                task(ws, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!failed) error = std::current_exception();
+                failed = true;
+            }
+        }
+    }
+
+    // Rethrow the first exception thrown by a task, if any.
+    void rethrowIfFailed() const {
+        if (failed) std::rethrow_exception(error);
+    }
+
+private:
+    const std::vector<std::unique_ptr<DifferentiatorWorkspace>>& workspaces;
+    const std::function<void(DifferentiatorWorkspace&,int)>& task;
+    const int           numTasks;
+    std::atomic<int>    nextTask;
+    std::atomic<bool>   failed;
+    std::mutex          errorMutex;
+    std::exception_ptr  error;
+};
+}
+
+bool Differentiator::DifferentiatorRep::runInParallel
+   (int numTasks,
+    const std::function<void(DifferentiatorWorkspace&,int)>& task) const
+{
+    if (!executor || numTasks < 2 || !functionCanBeCloned)
+        return false;
+
+    if (workspaces.empty()) {
+        const Differentiator::Function& f = frep.getFunction();
+        for (int t=0; t < numThreads; ++t) {
+            std::unique_ptr<DifferentiatorWorkspace>
+                ws(new DifferentiatorWorkspace());
+            ws->clone.reset(f.clone());
+            if (!ws->clone) {
+                workspaces.clear();
+                functionCanBeCloned = false;
+                return false;
+            }
+            ws->frep = &Differentiator::Function::FunctionRep::getRep(*ws->clone);
+            SimTK_ERRCHK4_ALWAYS(
+                ws->frep->functionKind() == frep.functionKind()
+                && ws->frep->getNumFunctions() == NFunctions
+                && ws->frep->getNumParameters() == NParameters,
+                "Differentiator::calcJacobian()",
+                "Function::clone() returned a %s that is %dx%d but it must "
+                "return a copy of the %s being differentiated.",
+                ws->frep->functionKind().c_str(), ws->frep->getNumFunctions(),
+                ws->frep->getNumParameters(), frep.functionKind().c_str());
+            ws->ytmp.resize(NParameters);
+            ws->fyptmp.resize(NFunctions);
+            ws->fymtmp.resize(NFunctions);
+            workspaces.push_back(std::move(ws));
+        }
+    }
+
+    DifferentiatorTask parallelTask(workspaces, task, numTasks);
+    executor->execute(parallelTask, parallelTask.getNumWorkers());
+
+    for (const auto& ws : workspaces)
+        nCallsToUserFunction += frep.absorbStatistics(*ws->frep);
+    parallelTask.rethrowIfFailed();
+    return true;
+}
+
 void Differentiator::DifferentiatorRep::calcGradient
    (const GradientFunctionRep& f, Differentiator::Method m, const Vector& y0, Real fy0, Vector& gradf) const 
 {
@@ -736,23 +982,41 @@ void Differentiator::DifferentiatorRep::calcGradient
 
     gradf.resize(NParameters);
 
-    ytmp = y0;
     const int order = Differentiator::getMethodOrder(method);
 
-    for (int i=0; i < f.getNumParameters(); ++i) {
+    // Perturb parameter i of y, which must equal y0 on entry and does again
+    // on return, calling the function through func.
+    const auto calcElement = [&](const GradientFunctionRep& func, Vector& y,
+                                 int i)
+    {
         const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
         const Real h = cleanUpH(hEst, y0[i]);
         Real fyplus, fyminus;
-        ytmp[i] = y0[i]+h; 
-        nCallsToUserFunction++; f.call(ytmp, fyplus);
+        y[i] = y0[i]+h; 
+        func.call(y, fyplus);
         if (order==1) {
             gradf[i] = (fyplus-fy0)/h;
         } else {
-            ytmp[i] = y0[i]-h; 
-            nCallsToUserFunction++; f.call(ytmp, fyminus);
+            y[i] = y0[i]-h; 
+            func.call(y, fyminus);
             gradf[i] = (fyplus-fyminus)/(2*h);
         }
-        ytmp[i] = y0[i]; // restore
+        y[i] = y0[i]; // restore
+    };
+
+    const bool ranInParallel = runInParallel(NParameters,
+        [&](DifferentiatorWorkspace& ws, int i) {
+            ws.ytmp = y0;
+            calcElement(static_cast<const GradientFunctionRep&>(*ws.frep),
+                        ws.ytmp, i);
+        });
+    if (ranInParallel)
+        return;
+
+    ytmp = y0;
+    for (int i=0; i < f.getNumParameters(); ++i) {
+        nCallsToUserFunction += order;
+        calcElement(f, ytmp, i);
     }
 }
 
@@ -769,23 +1033,70 @@ void Differentiator::DifferentiatorRep::calcJacobian
     assert(fy0.size() == NFunctions);
 
     dfdy.resize(NFunctions,NParameters);
+    if (hasSparsityPattern())
+        dfdy.setToZero();
 
     const int order = Differentiator::getMethodOrder(method);
-
-    ytmp = y0;
-    for (int i=0; i < NParameters; ++i) {
+    const auto calcStep = [&](int i) {
         const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
-        const Real h = cleanUpH(hEst, y0[i]);
-        ytmp[i] = y0[i]+h; 
-        nCallsToUserFunction++; f.call(ytmp, fyptmp);
-        if (order==1) {
-            dfdy(i) = (fyptmp-fy0)/h;
-        } else {
-            ytmp[i] = y0[i]-h; 
-            nCallsToUserFunction++; f.call(ytmp, fymtmp);
-            dfdy(i) = (fyptmp-fymtmp)/(2*h);
+        return cleanUpH(hEst, y0[i]);
+    };
+
+    // Fill in the columns of perturbation group g, using y (which must equal
+    // y0 on entry and does again on return) and fyp, fym as scratch.
+    const auto calcGroup = [&](const JacobianFunctionRep& func, Vector& y,
+                               Vector& fyp, Vector& fym, int g)
+    {
+        if (!hasSparsityPattern()) {
+            const Real h = calcStep(g);
+            y[g] = y0[g]+h; 
+            func.call(y, fyp);
+            if (order==1) {
+                dfdy(g) = (fyp-fy0)/h;
+            } else {
+                y[g] = y0[g]-h; 
+                func.call(y, fym);
+                dfdy(g) = (fyp-fym)/(2*h);
+            }
+            y[g] = y0[g]; // restore
+            return;
+        }
+
+        // The columns of a group share no rows, so the change in each row
+        // comes from only one of the perturbed parameters.
+        const Array_<int>& columns = columnsOfGroup[g];
+        for (int j : columns) y[j] = y0[j]+calcStep(j);
+        func.call(y, fyp);
+        if (order==2) {
+            for (int j : columns) y[j] = y0[j]-calcStep(j);
+            func.call(y, fym);
+        }
+        for (int j : columns) {
+            const Real h = calcStep(j);
+            if (order==1)
+                for (int row : rowsOfColumn[j])
+                    dfdy(row,j) = (fyp[row]-fy0[row])/h;
+            else
+                for (int row : rowsOfColumn[j])
+                    dfdy(row,j) = (fyp[row]-fym[row])/(2*h);
+            y[j] = y0[j]; // restore
         }
-        ytmp[i] = y0[i]; // restore
+    };
+
+    const int numGroups = getNumColumnGroups();
+    const bool ranInParallel = runInParallel(numGroups,
+        [&](DifferentiatorWorkspace& ws, int g) {
+            ws.ytmp = y0;
+            calcGroup(static_cast<const JacobianFunctionRep&>(*ws.frep),
+                      ws.ytmp, ws.fyptmp, ws.fymtmp, g);
+        });
+    if (ranInParallel)
+        return;
+
+    ytmp = y0;
+    for (int g=0; g < numGroups; ++g) {
+        nCallsToUserFunction += order;
+        calcGroup(f, ytmp, fyptmp, fymtmp, g);
     }
 }
 
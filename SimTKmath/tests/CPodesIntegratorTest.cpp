@@ -71,6 +71,41 @@ int main () {
         CPodesIntegrator projInteg(sys, CPodes::BDF);
         projInteg.setUseCPodesProjection();
         testIntegrator(projInteg, sys);
+
+        // Try the banded and the Krylov linear solvers, the latter with and
+        // without a block preconditioner. The pendulum's y is (x, y, vx, vy),
+        // so the (x, vx) and (y, vy) pairs make natural blocks.
+
+        CPodesIntegrator bandInteg(sys, CPodes::BDF);
+        bandInteg.setLinearSolver(CPodesIntegrator::BandedLinearSolver);
+        bandInteg.setJacobianBandwidth(2, 2);
+        testIntegrator(bandInteg, sys);
+
+        CPodesIntegrator krylovInteg(sys, CPodes::BDF);
+        krylovInteg.setLinearSolver(CPodesIntegrator::KrylovLinearSolver);
+        testIntegrator(krylovInteg, sys);
+        ASSERT(krylovInteg.getNumKrylovIterations() > 0);
+        ASSERT(krylovInteg.getNumPreconditionerEvaluations() == 0);
+
+        CPodesIntegrator precInteg(sys, CPodes::BDF);
+        precInteg.setLinearSolver(CPodesIntegrator::KrylovLinearSolver);
+        precInteg.setMaxKrylovDimension(4);
+        Array_< Array_<int> > blocks(2);
+        blocks[0].push_back(0); blocks[0].push_back(2);
+        blocks[1].push_back(1); // leave out vy
+        precInteg.setPreconditionerBlocks(blocks);
+        testIntegrator(precInteg, sys);
+        ASSERT(precInteg.getNumKrylovIterations() > 0);
+        ASSERT(precInteg.getNumPreconditionerEvaluations() > 0);
+
+        bool threw = false;
+        try {
+            precInteg.setLinearSolver(CPodesIntegrator::DenseLinearSolver);
+        }
+        catch (...) {
+            threw = true;
+        }
+        ASSERT(threw);
     }
     cout << "Done" << endl;
     return 0;
@@ -0,0 +1,127 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Checks that once an integrator has taken its first steps, further steps and
+interpolated reports don't allocate heap memory. Allocations are counted by
+replacing the global operator new in this executable; that can't see into
+the SimTK libraries where they are DLLs (Windows), in which case this test 
+passes trivially. */
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include "PendulumSystem.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace SimTK;
+
+static std::atomic<long long> numAllocations(0);
+
+void* operator new(std::size_t size) {
+    ++numAllocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {return operator new(size);}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete[](void* p) noexcept {std::free(p);}
+
+// An event whose witness function never crosses zero, so that every step
+// looks for triggered events but none are ever localized.
+class FarAwayHandler : public TriggeredEventHandler {
+public:
+    explicit FarAwayHandler(const PendulumSystem& pendulum) 
+    :   TriggeredEventHandler(Stage::Position), pendulum(pendulum) {}
+    Real getValue(const State& state) const override {
+        return state.getQ(pendulum.getGuts().getSubsysIndex())[0] - 10;
+    }
+    void handleEvent(State&, Real, bool&) const override {
+        SimTK_TEST(!"FarAwayHandler should never trigger");
+    }
+private:
+    const PendulumSystem& pendulum;
+};
+
+template <class IntegratorType>
+void testStepsDontAllocate() {
+    PendulumSystem sys;
+    sys.addEventHandler(new FarAwayHandler(sys));
+    sys.realizeTopology();
+    Vector q(2), u(2, Real(0));
+    q[0] = 1; q[1] = 0;
+    sys.setDefaultTimeAndState(0, q, u);
+
+    IntegratorType integ(sys);
+    integ.setAccuracy(1e-4);
+    TimeStepper ts(sys, integ);
+    ts.initialize(sys.getDefaultState());
+
+    // The first steps size the scratch space and make the interpolated state.
+    const Real reportInterval = 0.001;
+    Real t = 0;
+    for (int i=0; i < 50; ++i)
+        ts.stepTo(t += reportInterval);
+    for (int i=0; i < 50; ++i)
+        integ.stepTo(t += reportInterval);
+
+    const int stepsBefore = integ.getNumStepsTaken();
+    const long long allocationsBefore = numAllocations;
+    const int NReports = 500;
+    for (int i=0; i < NReports; ++i)
+        ts.stepTo(t += reportInterval);
+
+    // TimeStepper makes the integrator stop at each report time; calling the
+    // integrator directly lets it step past and interpolate instead.
+    for (int i=0; i < NReports; ++i)
+        integ.stepTo(t += reportInterval);
+    const long long numStepAllocations = numAllocations - allocationsBefore;
+    const int numSteps = integ.getNumStepsTaken() - stepsBefore;
+
+    std::cout << integ.getMethodName() << ": " << numSteps << " steps for " 
+              << 2*NReports << " reports, " << numStepAllocations 
+              << " allocations" << std::endl;
+    SimTK_TEST(numSteps > 0);
+    SimTK_TEST(numStepAllocations == 0);
+}
+
+void testRungeKuttaMerson() 
+{   testStepsDontAllocate<RungeKuttaMersonIntegrator>(); }
+void testRungeKuttaFeldberg() 
+{   testStepsDontAllocate<RungeKuttaFeldbergIntegrator>(); }
+void testRungeKutta3() 
+{   testStepsDontAllocate<RungeKutta3Integrator>(); }
+void testRungeKutta2() 
+{   testStepsDontAllocate<RungeKutta2Integrator>(); }
+
+int main() {
+    SimTK_START_TEST("IntegratorAllocationTest");
+        SimTK_SUBTEST(testRungeKuttaMerson);
+        SimTK_SUBTEST(testRungeKuttaFeldberg);
+        SimTK_SUBTEST(testRungeKutta3);
+        SimTK_SUBTEST(testRungeKutta2);
+    SimTK_END_TEST();
+}
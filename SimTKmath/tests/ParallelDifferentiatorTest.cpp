@@ -0,0 +1,287 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Tests Differentiator's options for evaluating perturbations on several
+threads and for grouping the columns of a sparse Jacobian. Neither may
+change the result beyond roundoff. */
+
+#include "SimTKmath.h"
+
+#include <iostream>
+
+using namespace SimTK;
+
+// A function with a tridiagonal Jacobian:
+//   f_i = y_{i-1}^2 + sin(y_i)*y_{i+1}
+// where y_{-1} and y_n are taken to be zero.
+class Tridiagonal : public Differentiator::JacobianFunction {
+public:
+    Tridiagonal(int n, bool canClone=true)
+    :   Differentiator::JacobianFunction(n,n), canClone(canClone),
+        failAt(-1) {}
+
+    int f(const Vector& y, Vector& fy) const override {
+        const int n = y.size();
+        for (int i=0; i < n; ++i) {
+            fy[i] = (i > 0 ? square(y[i-1]) : 0)
+                  + std::sin(y[i])*(i+1 < n ? y[i+1] : 0);
+            if (failAt >= 0 && y[failAt] != 0 && i == failAt)
+                return 1;
+        }
+        return 0;
+    }
+
+    Tridiagonal* clone() const override {
+        if (!canClone) return nullptr;
+        ++numClones;
+        Tridiagonal* copy = new Tridiagonal(getNumFunctions(), canClone);
+        copy->failAt = failAt;
+        return copy;
+    }
+
+    Matrix calcExactJacobian(const Vector& y) const {
+        const int n = y.size();
+        Matrix J(n, n, Real(0));
+        for (int i=0; i < n; ++i) {
+            if (i > 0)   J(i,i-1) = 2*y[i-1];
+            if (i+1 < n) {J(i,i) = std::cos(y[i])*y[i+1];
+                          J(i,i+1) = std::sin(y[i]);}
+        }
+        return J;
+    }
+
+    static Array_< Array_<int> > getSparsityPattern(int n) {
+        Array_< Array_<int> > rowsOfColumn(n);
+        for (int j=0; j < n; ++j)
+            for (int i = std::max(j-1, 0); i <= std::min(j+1, n-1); ++i)
+                rowsOfColumn[j].push_back(i);
+        return rowsOfColumn;
+    }
+
+    // Make the function report failure when parameter i is perturbed,
+    // but not for the unperturbed y = 0.
+    void setFailAt(int i) {failAt = i;}
+
+    static int numClones;
+
+private:
+    bool canClone;
+    int  failAt;
+};
+
+int Tridiagonal::numClones = 0;
+
+class Quartic : public Differentiator::GradientFunction {
+public:
+    explicit Quartic(int n) : Differentiator::GradientFunction(n) {}
+
+    int f(const Vector& y, Real& fy) const override {
+        fy = 0;
+        for (int i=0; i < y.size(); ++i)
+            fy += (i+1)*square(square(y[i]));
+        return 0;
+    }
+
+    Quartic* clone() const override {return new Quartic(getNumParameters());}
+};
+
+static Vector makeParameters(int n) {
+    Vector y(n);
+    for (int i=0; i < n; ++i)
+        y[i] = 0.3 + 0.1*i;
+    return y;
+}
+
+void testColoredJacobian() {
+    const int n = 20;
+    Tridiagonal func(n);
+    const Vector y0 = makeParameters(n);
+    Vector fy0(n); func.f(y0, fy0);
+    const Matrix exact = func.calcExactJacobian(y0);
+
+    Differentiator dense(func, Differentiator::CentralDifference);
+    Matrix Jdense;
+    dense.calcJacobian(y0, fy0, Jdense);
+    SimTK_TEST_EQ_TOL(Jdense, exact, 1e-8);
+    SimTK_TEST(dense.getNumColumnGroups() == n);
+    SimTK_TEST(dense.getNumCallsToUserFunction() == 2*n);
+
+    Differentiator colored(func, Differentiator::CentralDifference);
+    colored.setJacobianSparsityPattern(Tridiagonal::getSparsityPattern(n));
+    SimTK_TEST(colored.hasJacobianSparsityPattern());
+    SimTK_TEST(colored.getNumColumnGroups() == 3);
+
+    Matrix Jcolored(n, n, Real(99)); // entries outside the pattern get zeroed
+    colored.calcJacobian(y0, fy0, Jcolored);
+    SimTK_TEST_EQ_TOL(Jcolored, exact, 1e-8);
+    SimTK_TEST_EQ(Jcolored, Jdense); // same steps, same arithmetic
+    SimTK_TEST(colored.getNumCallsToUserFunction() == 2*3);
+
+    colored.setDefaultMethod(Differentiator::ForwardDifference);
+    colored.calcJacobian(y0, fy0, Jcolored);
+    SimTK_TEST_EQ_TOL(Jcolored, exact, 1e-6);
+    SimTK_TEST(colored.getNumCallsToUserFunction() == 2*3 + 3);
+
+    colored.clearJacobianSparsityPattern();
+    SimTK_TEST(!colored.hasJacobianSparsityPattern());
+    SimTK_TEST(colored.getNumColumnGroups() == n);
+
+    // A dense column forces every other column into its own group.
+    Array_< Array_<int> > pattern = Tridiagonal::getSparsityPattern(n);
+    for (int i=0; i < n; ++i) pattern[0].push_back(i);
+    colored.setJacobianSparsityPattern(pattern);
+    SimTK_TEST(colored.getNumColumnGroups() == 4);
+    colored.calcJacobian(y0, fy0, Jcolored, Differentiator::CentralDifference);
+    SimTK_TEST_EQ_TOL(Jcolored, exact, 1e-8);
+
+    pattern[3].push_back(n);
+    SimTK_TEST_MUST_THROW(colored.setJacobianSparsityPattern(pattern));
+    pattern[3].pop_back();
+    pattern.pop_back();
+    SimTK_TEST_MUST_THROW(colored.setJacobianSparsityPattern(pattern));
+}
+
+void testParallelJacobian() {
+    const int n = 40;
+    Tridiagonal func(n);
+    const Vector y0 = makeParameters(n);
+    Vector fy0(n); func.f(y0, fy0);
+
+    Differentiator serial(func, Differentiator::CentralDifference);
+    Matrix Jserial;
+    serial.calcJacobian(y0, fy0, Jserial);
+
+    for (int colored = 0; colored < 2; ++colored) {
+        Differentiator parallel(func, Differentiator::CentralDifference);
+        parallel.setNumThreads(4);
+        SimTK_TEST(parallel.getNumThreads() == 4);
+        if (colored)
+            parallel.setJacobianSparsityPattern(
+                Tridiagonal::getSparsityPattern(n));
+        func.resetAllStatistics();
+        Tridiagonal::numClones = 0;
+
+        // Twice, to reuse the clones made by the first call.
+        for (int rep = 0; rep < 2; ++rep) {
+            Matrix Jparallel;
+            parallel.calcJacobian(y0, fy0, Jparallel);
+            SimTK_TEST_EQ(Jparallel, Jserial);
+        }
+        SimTK_TEST(Tridiagonal::numClones == 4);
+        const int calls = 2*2*parallel.getNumColumnGroups();
+        SimTK_TEST(parallel.getNumCallsToUserFunction() == calls);
+        SimTK_TEST(func.getNumCalls() == calls);
+        SimTK_TEST(func.getNumFailures() == 0);
+    }
+
+    // Without clones the evaluations stay on this thread.
+    Tridiagonal unclonable(n, false);
+    Differentiator fallback(unclonable, Differentiator::CentralDifference);
+    fallback.setNumThreads(4);
+    Matrix Jfallback;
+    fallback.calcJacobian(y0, fy0, Jfallback);
+    SimTK_TEST_EQ(Jfallback, Jserial);
+
+    SimTK_TEST_MUST_THROW(fallback.setNumThreads(0));
+}
+
+void testParallelGradient() {
+    const int n = 30;
+    Quartic func(n);
+    const Vector y0 = makeParameters(n);
+    Real fy0; func.f(y0, fy0);
+
+    Vector exact(n);
+    for (int i=0; i < n; ++i)
+        exact[i] = 4*(i+1)*cube(y0[i]);
+
+    Differentiator serial(func, Differentiator::CentralDifference);
+    Vector gserial;
+    serial.calcGradient(y0, fy0, gserial);
+    SimTK_TEST_EQ_TOL(gserial, exact, 1e-6);
+
+    Differentiator parallel(func, Differentiator::CentralDifference);
+    parallel.setNumThreads(3);
+    Vector gparallel;
+    parallel.calcGradient(y0, fy0, gparallel);
+    SimTK_TEST_EQ(gparallel, gserial);
+    SimTK_TEST(parallel.getNumCallsToUserFunction() == 2*n);
+}
+
+// A failure on a worker thread must reach the caller as the same exception
+// the serial code would throw.
+void testParallelFailure() {
+    const int n = 16;
+    Tridiagonal func(n);
+    func.setFailAt(5);
+    const Vector y0(n, Real(0));
+    Vector fy0(n); func.f(y0, fy0);
+
+    Differentiator parallel(func);
+    parallel.setNumThreads(4);
+    Matrix J;
+    try {
+        parallel.calcJacobian(y0, fy0, J);
+        SimTK_TEST(!"calcJacobian() should have thrown");
+    } catch (const Exception::Base& e) {
+        SimTK_TEST(String(e.getMessage()).find("non-zero status 1")
+                   != std::string::npos);
+    }
+    SimTK_TEST(func.getNumFailures() > 0);
+    SimTK_TEST(parallel.getNumDifferentiationFailures() == 1);
+}
+
+class QuarticSystem : public OptimizerSystem {
+public:
+    explicit QuarticSystem(int n) : OptimizerSystem(n) {}
+    int objectiveFunc(const Vector& y, bool newParameters,
+                      Real& f) const override {
+        f = 0;
+        for (int i=0; i < y.size(); ++i)
+            f += (i+1)*square(y[i] - 1);
+        return 0;
+    }
+};
+
+void testOptimizerWithThreads() {
+    const int n = 12;
+    QuarticSystem sys(n);
+    Optimizer opt(sys, LBFGS);
+    opt.setConvergenceTolerance(1e-8);
+    opt.setDifferentiatorNumThreads(4);
+    SimTK_TEST(opt.getDifferentiatorNumThreads() == 4);
+    opt.useNumericalGradient(true);
+    Vector y(n, Real(0));
+    opt.optimize(y);
+    SimTK_TEST_EQ_TOL(y, Vector(n, Real(1)), 1e-5);
+}
+
+int main() {
+    SimTK_START_TEST("ParallelDifferentiatorTest");
+        SimTK_SUBTEST(testColoredJacobian);
+        SimTK_SUBTEST(testParallelJacobian);
+        SimTK_SUBTEST(testParallelGradient);
+        SimTK_SUBTEST(testParallelFailure);
+        SimTK_SUBTEST(testOptimizerWithThreads);
+    SimTK_END_TEST();
+}
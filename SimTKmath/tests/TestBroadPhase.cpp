@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Tests for the BroadPhase class: every method, serial and parallel, must find
+exactly the pairs that a brute force search does, both from scratch and when
+reusing information from earlier calls. */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+
+typedef BroadPhase::IndexPair IndexPair;
+
+static const BroadPhase::Method Methods[] = {BroadPhase::SweepAndPrune,
+                                             BroadPhase::IncrementalSweepAndPrune,
+                                             BroadPhase::DynamicAABBTree};
+
+static void findPairsByBruteForce(const Array_<Geo::AlignedBox>& boxes,
+                                  Array_<IndexPair>& pairs) {
+    pairs.clear();
+    for (int i=0; i < (int)boxes.size(); ++i)
+        for (int j=i+1; j < (int)boxes.size(); ++j) {
+            const Vec3 d = (boxes[i].getCenter()-boxes[j].getCenter()).abs();
+            const Vec3 h = boxes[i].getHalfLengths()+boxes[j].getHalfLengths();
+            if (d[0] <= h[0] && d[1] <= h[1] && d[2] <= h[2])
+                pairs.push_back(IndexPair(i,j));
+        }
+}
+
+// Boxes of varying size scattered in a region that is long in x, so that
+// there are plenty of overlaps.
+static void makeBoxes(int n, Random::Uniform& random,
+                      Array_<Geo::AlignedBox>& boxes) {
+    boxes.resize(n);
+    for (int i=0; i < n; ++i) {
+        const Vec3 center(20*random.getValue(), 4*random.getValue(),
+                          4*random.getValue());
+        const Vec3 halfLengths(0.1 + 0.4*random.getValue(),
+                               0.1 + 0.4*random.getValue(),
+                               0.1 + 0.4*random.getValue());
+        boxes[i] = Geo::AlignedBox(center, halfLengths);
+    }
+}
+
+static void moveBoxes(Real distance, Random::Uniform& random,
+                      Array_<Geo::AlignedBox>& boxes) {
+    for (auto& box : boxes) {
+        const Vec3 step = distance*Vec3(random.getValue()-0.5,
+                                        random.getValue()-0.5,
+                                        random.getValue()-0.5);
+        box = Geo::AlignedBox(box.getCenter()+step, box.getHalfLengths());
+    }
+}
+
+void testMatchesBruteForce() {
+    Random::Uniform random(0, 1);
+    random.setSeed(17);
+    ParallelExecutor executor(3);
+    Array_<Geo::AlignedBox> boxes;
+    Array_<IndexPair> expected, pairs;
+
+    for (BroadPhase::Method method : Methods) {
+        BroadPhase serial(method), parallel(method);
+        SimTK_TEST(serial.getMethod() == method);
+        makeBoxes(700, random, boxes);
+        // Small motions exercise the incremental updates; large ones make
+        // boxes pass each other and leave their enlarged tree boxes.
+        for (int step=0; step < 20; ++step) {
+            moveBoxes(step < 10 ? 0.05 : 2, random, boxes);
+            findPairsByBruteForce(boxes, expected);
+            SimTK_TEST(!expected.empty());
+            serial.findOverlappingPairs(boxes, pairs);
+            SimTK_TEST(pairs == expected);
+            parallel.findOverlappingPairs(boxes, pairs, &executor);
+            SimTK_TEST(pairs == expected);
+            SimTK_TEST(serial.getNumObjects() == (int)boxes.size());
+        }
+
+        // Changing the number of objects starts over.
+        boxes.resize(300);
+        findPairsByBruteForce(boxes, expected);
+        serial.findOverlappingPairs(boxes, pairs);
+        SimTK_TEST(pairs == expected);
+        parallel.findOverlappingPairs(boxes, pairs, &executor);
+        SimTK_TEST(pairs == expected);
+    }
+}
+
+void testSpecialCases() {
+    Array_<Geo::AlignedBox> boxes;
+    Array_<IndexPair> pairs;
+    for (BroadPhase::Method method : Methods) {
+        BroadPhase broadPhase(method);
+        pairs.push_back(IndexPair(3,4));
+        broadPhase.findOverlappingPairs(boxes, pairs);
+        SimTK_TEST(pairs.empty());
+
+        // Touching boxes overlap; identical boxes overlap.
+        boxes.clear();
+        boxes.push_back(Geo::AlignedBox(Vec3(0), Vec3(1)));
+        boxes.push_back(Geo::AlignedBox(Vec3(2,0,0), Vec3(1)));
+        boxes.push_back(Geo::AlignedBox(Vec3(2,0,0), Vec3(1)));
+        boxes.push_back(Geo::AlignedBox(Vec3(0,2.5,0), Vec3(1)));
+        broadPhase.findOverlappingPairs(boxes, pairs);
+        SimTK_TEST(pairs.size() == 3);
+        SimTK_TEST(pairs[0] == IndexPair(0,1));
+        SimTK_TEST(pairs[1] == IndexPair(0,2));
+        SimTK_TEST(pairs[2] == IndexPair(1,2));
+
+        // A copy continues from where the original left off.
+        BroadPhase copy(broadPhase);
+        boxes[3] = Geo::AlignedBox(Vec3(-0.5,2,0), Vec3(1));
+        copy.findOverlappingPairs(boxes, pairs);
+        SimTK_TEST(pairs.size() == 4);
+        SimTK_TEST(pairs[2] == IndexPair(0,3));
+        boxes.clear();
+    }
+
+    BroadPhase broadPhase;
+    SimTK_TEST(broadPhase.getMethod() == BroadPhase::DynamicAABBTree);
+    broadPhase.setMethod(BroadPhase::SweepAndPrune);
+    SimTK_TEST(broadPhase.getMethod() == BroadPhase::SweepAndPrune);
+    SimTK_TEST(broadPhase.getNumObjects() == 0);
+    SimTK_TEST(String(BroadPhase::getMethodName(BroadPhase::DynamicAABBTree))
+               == "DynamicAABBTree");
+}
+
+int main() {
+    SimTK_START_TEST("TestBroadPhase");
+        SimTK_SUBTEST(testMatchesBruteForce);
+        SimTK_SUBTEST(testSpecialCases);
+    SimTK_END_TEST();
+}
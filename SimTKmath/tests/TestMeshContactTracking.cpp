@@ -0,0 +1,121 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* The ContactTrackers for TriangleMesh contacts resume each evaluation of a
+contact from where the previous one left off in the mesh's bounding box tree.
+Check that this finds exactly the faces that a search from scratch does as the
+surfaces move into, around in, and out of contact. */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+
+// Pose of surface 2 in Ground at time t, with surface 1 fixed.
+typedef Transform (*PoseFunction)(Real t);
+
+static bool sameContact(const Contact& a, const Contact& b) {
+    if (a.isEmpty() || b.isEmpty())
+        return a.isEmpty() && b.isEmpty();
+    const TriangleMeshContact& ta = TriangleMeshContact::getAs(a);
+    const TriangleMeshContact& tb = TriangleMeshContact::getAs(b);
+    return ta.getSurface1Faces() == tb.getSurface1Faces()
+        && ta.getSurface2Faces() == tb.getSurface2Faces();
+}
+
+static void trackAlongPath(const ContactTracker& tracker,
+                           const Transform& X_G1, const ContactGeometry& geo1,
+                           PoseFunction pose, const ContactGeometry& geo2) {
+    const ContactSurfaceIndex surf1(0), surf2(1);
+    const UntrackedContact untracked(surf1, surf2);
+    tracker.resetCacheStatistics();
+
+    Contact prior = untracked;
+    int numHits = 0, numMisses = 0, numInContact = 0;
+    for (int step=0; step <= 200; ++step) {
+        const Transform X_G2 = pose(0.05*step);
+
+        Contact fromScratch, resumed;
+        tracker.trackContact(untracked, X_G1, geo1, X_G2, geo2, 0, 
+                             fromScratch);
+        ++numMisses;
+        tracker.trackContact(prior, X_G1, geo1, X_G2, geo2, 0, resumed);
+        if (TriangleMeshContact::isInstance(prior)) ++numHits;
+        else ++numMisses;
+
+        SimTK_TEST(sameContact(fromScratch, resumed));
+        if (!resumed.isEmpty()) ++numInContact;
+        prior = resumed.isEmpty() ? Contact(untracked) : resumed;
+    }
+    // The path must include both contact and separation.
+    SimTK_TEST(numInContact > 20 && numInContact < 190);
+    SimTK_TEST(tracker.getNumCacheHits() == numHits);
+    SimTK_TEST(tracker.getNumCacheMisses() == numMisses);
+}
+
+// A mesh sphere of radius 1 bobbing in and out of a half space while it
+// spins and slides.
+static Transform sinkingBall(Real t) {
+    return Transform(Rotation(1.3*t, UnitVec3(1,2,3)), 
+                     Vec3(0.4*t, 0.8 - 0.5*std::sin(t), 0.1*t));
+}
+
+void testHalfSpaceTriangleMesh() {
+    const ContactTracker::HalfSpaceTriangleMesh tracker;
+    const ContactGeometry::HalfSpace halfSpace;
+    const ContactGeometry::TriangleMesh ball
+        (PolygonalMesh::createSphereMesh(1, 4));
+    // The half space occupies y < 0.
+    trackAlongPath(tracker, Transform(Rotation(-Pi/2, ZAxis)), halfSpace,
+                   sinkingBall, ball);
+}
+
+// A mesh brick tumbling through a sphere of radius 1.
+static Transform tumblingBrick(Real t) {
+    return Transform(Rotation(0.9*t, UnitVec3(-1,1,2)),
+                     Vec3(1.8*std::cos(0.6*t), 0.3*std::sin(t), 0.2));
+}
+
+void testSphereTriangleMesh() {
+    const ContactTracker::SphereTriangleMesh tracker;
+    const ContactGeometry::Sphere sphere(1);
+    const ContactGeometry::TriangleMesh brick
+        (PolygonalMesh::createBrickMesh(Vec3(0.6,0.3,0.4), 4));
+    trackAlongPath(tracker, Transform(), sphere, tumblingBrick, brick);
+}
+
+void testTriangleMeshTriangleMesh() {
+    const ContactTracker::TriangleMeshTriangleMesh tracker;
+    const ContactGeometry::TriangleMesh ball
+        (PolygonalMesh::createSphereMesh(1, 3));
+    const ContactGeometry::TriangleMesh brick
+        (PolygonalMesh::createBrickMesh(Vec3(0.6,0.3,0.4), 3));
+    trackAlongPath(tracker, Transform(), ball, tumblingBrick, brick);
+}
+
+int main() {
+    SimTK_START_TEST("TestMeshContactTracking");
+        SimTK_SUBTEST(testHalfSpaceTriangleMesh);
+        SimTK_SUBTEST(testSphereTriangleMesh);
+        SimTK_SUBTEST(testTriangleMeshTriangleMesh);
+    SimTK_END_TEST();
+}
@@ -277,6 +277,103 @@ void testFindNearestPoint() {
     }
 }
 
+// Compare the batched queries to the one-at-a-time ones.
+void compareBatchedQueries(const ContactGeometry::TriangleMesh& mesh) {
+    Vec3 center;
+    Real radius;
+    mesh.getBoundingSphere(center, radius);
+    Random::Gaussian random(0, 1);
+    Random::Uniform randomFace(0, mesh.getNumFaces());
+    const int n = 500;
+    Array_<Vec3> points(n);
+    Array_<UnitVec3> directions(n);
+    for (int i = 0; i < n; i++) {
+        points[i] = center + 1.5*radius*Vec3(random.getValue(), 
+                        random.getValue(), random.getValue());
+        // Aim half of the rays at a face so that they are sure to hit.
+        const Vec3 target = i%2 == 0 
+            ? mesh.findCentroid(randomFace.getIntValue()) : points[i] + 
+            Vec3(random.getValue(), random.getValue(), random.getValue());
+        directions[i] = UnitVec3(target-points[i]);
+    }
+
+    Array_<Real> distances;
+    Array_<int> faces;
+    Array_<Vec2> uvs;
+    const int numHits = mesh.intersectsRays(points, directions, distances, 
+                                            faces, uvs);
+    SimTK_TEST(numHits >= n/2);
+    int expectedHits = 0;
+    for (int i = 0; i < n; i++) {
+        Real distance;
+        int face;
+        Vec2 uv;
+        if (mesh.intersectsRay(points[i], directions[i], distance, face, uv)) {
+            expectedHits++;
+            SimTK_TEST(faces[i] == face);
+            SimTK_TEST_EQ_TOL(distances[i], distance, 1e-10);
+            SimTK_TEST_EQ_TOL(mesh.findPoint(faces[i], uvs[i]), 
+                              points[i]+distances[i]*directions[i], 1e-10);
+        }
+        else
+            SimTK_TEST(faces[i] == -1 && distances[i] == Infinity);
+    }
+    SimTK_TEST(numHits == expectedHits);
+
+    Array_<Vec3> nearest;
+    Array_<bool> inside;
+    mesh.findNearestPoints(points, nearest, inside, faces, uvs);
+    for (int i = 0; i < n; i++) {
+        bool expectedInside;
+        int face;
+        Vec2 uv;
+        const Vec3 expected = mesh.findNearestPoint(points[i], expectedInside,
+                                                    face, uv);
+        SimTK_TEST(inside[i] == expectedInside);
+        SimTK_TEST_EQ_TOL((nearest[i]-points[i]).norm(), 
+                          (expected-points[i]).norm(), 1e-10);
+        SimTK_TEST_EQ_TOL(mesh.findPoint(faces[i], uvs[i]), nearest[i], 1e-10);
+    }
+
+    // Dividing the queries among threads must not change the answers.
+    ParallelExecutor executor(3);
+    Array_<Real> distances2;
+    Array_<int> faces2;
+    Array_<Vec2> uvs2;
+    SimTK_TEST(mesh.intersectsRays(points, directions, distances2, faces2, 
+                                   uvs2, &executor) == numHits);
+    SimTK_TEST(distances2 == distances);
+    Array_<Vec3> nearest2;
+    Array_<bool> inside2;
+    mesh.findNearestPoints(points, nearest2, inside2, faces2, uvs2, &executor);
+    SimTK_TEST(nearest2 == nearest && inside2 == inside && faces2 == faces);
+}
+
+void testBatchedQueries() {
+    // A mesh small enough for its OBB tree to be a single leaf.
+    vector<Vec3> vertices;
+    vector<int> faceIndices;
+    vertices.push_back(Vec3(0, 0, 0));
+    vertices.push_back(Vec3(1, 0, 0));
+    vertices.push_back(Vec3(0, 1, 0));
+    vertices.push_back(Vec3(0, 0, 1));
+    int faces[4][3] = {{0, 2, 1}, {0, 3, 2}, {0, 1, 3}, {1, 2, 3}};
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 3; j++)
+            faceIndices.push_back(faces[i][j]);
+    compareBatchedQueries(ContactGeometry::TriangleMesh(vertices, faceIndices));
+
+    // Separate pieces, then one large connected surface.
+    vertices.clear();
+    faceIndices.clear();
+    for (int i = 0; i < 8; i++)
+        addOctohedron(vertices, faceIndices, 
+                      Vec3(2.5*(i%2), 2.5*((i/2)%2), 2.5*(i/4)));
+    compareBatchedQueries(ContactGeometry::TriangleMesh(vertices, faceIndices));
+    compareBatchedQueries(ContactGeometry::TriangleMesh
+        (PolygonalMesh::createSphereMesh(1, 4)));
+}
+
 void testBoundingSphere() {
     Random::Uniform random(0, 10);
     for (int i = 0; i < 100; i++) {
@@ -315,6 +412,7 @@ int main() {
         SimTK_SUBTEST(testRayIntersection);
         SimTK_SUBTEST(testSmoothMesh);
         SimTK_SUBTEST(testFindNearestPoint);
+        SimTK_SUBTEST(testBatchedQueries);
         SimTK_SUBTEST(testBoundingSphere);
     SimTK_END_TEST();
 }
@@ -0,0 +1,139 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Rolls a TimeStepper back using its StateHistory and checks that running
+forward again reproduces the original trajectory. */
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include "PendulumSystem.h"
+
+using namespace SimTK;
+
+void testRollBack() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    Vector q(2), u(2, Real(0));
+    q[0] = 1; q[1] = 0;
+    sys.setDefaultTimeAndState(0, q, u);
+
+    RungeKuttaMersonIntegrator integ(sys);
+    integ.setAccuracy(1e-8);
+    TimeStepper ts(sys, integ);
+    ts.setStateHistoryCapacity(50);
+    ts.initialize(sys.getDefaultState());
+
+    const SubsystemIndex sx = sys.getGuts().getSubsysIndex();
+    const Real reportInterval = 0.01;
+    Array_<Vector> qReported;
+    for (int i=1; i <= 100; ++i) {
+        ts.stepTo(i*reportInterval);
+        qReported.push_back(ts.getState().getQ(sx));
+    }
+
+    // Only the newest 50 checkpoints (t = .51 to 1) are kept.
+    const StateHistory& history = ts.getStateHistory();
+    SimTK_TEST(history.getNumCheckpoints() == 50);
+    SimTK_TEST_EQ(history.getCheckpointTime(0), 0.51);
+    SimTK_TEST(history.getNumFullStates() == 1);
+    SimTK_TEST_MUST_THROW(ts.rollBackTo(0.5));
+
+    // Roll back to the checkpoint at or before .755 and repeat from there.
+    const Real tBack = ts.rollBackTo(0.755);
+    SimTK_TEST_EQ(tBack, 0.75);
+    SimTK_TEST_EQ(ts.getTime(), 0.75);
+    SimTK_TEST_EQ_TOL(ts.getState().getQ(sx), qReported[74], 1e-12);
+    SimTK_TEST(history.getNumCheckpoints() == 25);
+
+    for (int i=76; i <= 100; ++i) {
+        ts.stepTo(i*reportInterval);
+        SimTK_TEST_EQ_TOL(ts.getState().getQ(sx), qReported[i-1], 1e-6);
+    }
+    SimTK_TEST(history.getNumCheckpoints() == 50);
+}
+
+// Reinitializing starts a new history; a rollback afterwards must land on
+// the new trajectory, with the new run's Instance-stage parameters, even if
+// the new run passes through the same times as the old one.
+void testRollBackAfterReinitialize() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    Vector q(2), u(2, Real(0));
+    q[0] = 1; q[1] = 0;
+    sys.setDefaultTimeAndState(0, q, u);
+
+    RungeKuttaMersonIntegrator integ(sys);
+    integ.setAccuracy(1e-8);
+    TimeStepper ts(sys, integ);
+    ts.setStateHistoryCapacity(50);
+
+    const SubsystemIndex sx = sys.getGuts().getSubsysIndex();
+    const Real reportInterval = 0.05;
+    ts.initialize(sys.getDefaultState());
+    for (int i=1; i <= 10; ++i)
+        ts.stepTo(i*reportInterval);
+    ts.rollBackTo(0.25);
+
+    // Same times again, but a longer pendulum starting somewhere else.
+    sys.setDefaultLength(2);
+    q[0] = 0; q[1] = -2;
+    sys.setDefaultTimeAndState(0, q, u);
+    ts.initialize(sys.getDefaultState());
+    SimTK_TEST(ts.getStateHistory().getNumCheckpoints() == 1);
+    SimTK_TEST(ts.getStateHistory().getNumFullStates() == 1);
+    Array_<Vector> qReported;
+    for (int i=1; i <= 10; ++i) {
+        ts.stepTo(i*reportInterval);
+        qReported.push_back(ts.getState().getQ(sx));
+    }
+    SimTK_TEST(ts.getStateHistory().getNumCheckpoints() == 11);
+
+    SimTK_TEST_EQ(ts.rollBackTo(0.25), 0.25);
+    SimTK_TEST_EQ(sys.getLength(ts.getState()), 2);
+    SimTK_TEST_EQ_TOL(ts.getState().getQ(sx), qReported[4], 1e-12);
+    for (int i=6; i <= 10; ++i) {
+        ts.stepTo(i*reportInterval);
+        SimTK_TEST_EQ_TOL(ts.getState().getQ(sx), qReported[i-1], 1e-6);
+    }
+}
+
+// With no history there is nothing to roll back to.
+void testNoHistory() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    RungeKuttaMersonIntegrator integ(sys);
+    TimeStepper ts(sys, integ);
+    ts.initialize(sys.getDefaultState());
+    ts.stepTo(0.1);
+    SimTK_TEST(ts.getStateHistory().getCapacity() == 0);
+    SimTK_TEST_MUST_THROW(ts.rollBackTo(0));
+}
+
+int main() {
+    SimTK_START_TEST("TimeStepperRollbackTest");
+        SimTK_SUBTEST(testRollBack);
+        SimTK_SUBTEST(testRollBackAfterReinitialize);
+        SimTK_SUBTEST(testNoHistory);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,157 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the time per call of each BroadPhase method on a settling pile of
+equal spheres (a granular bed), where each call sees the spheres moved a
+little, as they would be between consecutive position realizations. For
+comparison, "legacy" is the scheme ContactTrackerSubsystem used before it had a
+BroadPhase: sort every time and insert the pairs into nested std::maps.
+
+Usage: BroadPhaseBenchmark [numThreads] [numCalls]
+*/
+
+#include "SimTKmath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+using namespace SimTK;
+
+typedef BroadPhase::IndexPair IndexPair;
+
+// Spheres on a jittered lattice, 0.9 diameters apart, with the bed wider than
+// it is tall.
+static void makeBed(int n, Array_<Vec3>& centers, Array_<Vec3>& velocities) {
+    Random::Uniform random(-1, 1);
+    random.setSeed(5);
+    const int height = std::max(1, (int)std::cbrt(n/16.));
+    const int width = (int)std::ceil(std::sqrt(double(n)/height));
+    centers.resize(n); velocities.resize(n);
+    for (int i=0; i < n; ++i) {
+        const int x = i % width, y = (i / width) % width, z = i/(width*width);
+        centers[i] = 0.9*Vec3(x, z, y) + 0.05*Vec3(random.getValue(),
+                                                   random.getValue(),
+                                                   random.getValue());
+        velocities[i] = 0.01*Vec3(random.getValue(), random.getValue(),
+                                  random.getValue());
+    }
+}
+
+static void moveBed(Array_<Vec3>& centers, const Array_<Vec3>& velocities,
+                    Array_<Geo::AlignedBox>& boxes) {
+    boxes.resize(centers.size());
+    for (int i=0; i < (int)centers.size(); ++i) {
+        centers[i] += velocities[i];
+        boxes[i] = Geo::AlignedBox(centers[i], Vec3(0.5));
+    }
+}
+
+class LegacyBroadPhase {
+public:
+    void findOverlappingPairs(const Array_<Geo::AlignedBox>& boxes,
+                              std::map<int,std::map<int,const void*>>& pairs) {
+        pairs.clear();
+        const int n = (int)boxes.size();
+        extents.resize(n);
+        for (int i=0; i < n; ++i) {
+            const Real c = boxes[i].getCenter()[0];
+            const Real h = boxes[i].getHalfLengths()[0];
+            extents[i] = Extent{c-h, c+h, i};
+        }
+        std::sort(extents.begin(), extents.end());
+        for (int e1=0; e1 < n; ++e1)
+            for (int e2=e1+1; e2 < n && extents[e2].start <= extents[e1].end;
+                 ++e2) {
+                const int i = extents[e1].index, j = extents[e2].index;
+                const Vec3 d = (boxes[i].getCenter()-boxes[j].getCenter())
+                               .abs();
+                const Vec3 h = boxes[i].getHalfLengths()
+                               + boxes[j].getHalfLengths();
+                if (d[1] <= h[1] && d[2] <= h[2])
+                    pairs[std::min(i,j)].insert
+                        (std::make_pair(std::max(i,j), nullptr));
+            }
+    }
+private:
+    struct Extent {
+        bool operator<(const Extent& e) const {return start < e.start;}
+        Real start, end;
+        int  index;
+    };
+    Array_<Extent> extents;
+};
+
+int main(int argc, char** argv) {
+    const int numThreads = argc > 1 ? std::atoi(argv[1])
+                         : ParallelExecutor::getNumProcessors();
+    const int numCalls = argc > 2 ? std::atoi(argv[2]) : 20;
+    ParallelExecutor executor(std::max(2, numThreads));
+
+    printf("Broad phase on a granular bed, %d calls; milliseconds per call "
+           "(parallel uses %d threads)\n", numCalls, executor.getMaxThreads());
+    printf("  spheres      pairs   legacy  %-26s serial  parallel\n", "method");
+    const int sizes[] = {1000, 10000, 100000};
+    const BroadPhase::Method methods[] = {BroadPhase::SweepAndPrune,
+                                          BroadPhase::IncrementalSweepAndPrune,
+                                          BroadPhase::DynamicAABBTree};
+    for (int n : sizes) {
+        Array_<Vec3> centers, velocities;
+        Array_<Geo::AlignedBox> boxes;
+        Array_<IndexPair> pairs;
+
+        makeBed(n, centers, velocities);
+        LegacyBroadPhase legacy;
+        std::map<int,std::map<int,const void*>> pairMap;
+        double start = realTime();
+        for (int c=0; c < numCalls; ++c) {
+            moveBed(centers, velocities, boxes);
+            legacy.findOverlappingPairs(boxes, pairMap);
+        }
+        const double legacyTime = (realTime()-start)/numCalls;
+
+        for (BroadPhase::Method method : methods) {
+            double times[2];
+            for (int parallel=0; parallel < 2; ++parallel) {
+                makeBed(n, centers, velocities);
+                BroadPhase broadPhase(method);
+                moveBed(centers, velocities, boxes);
+                broadPhase.findOverlappingPairs(boxes, pairs); // warm up
+                start = realTime();
+                for (int c=0; c < numCalls; ++c) {
+                    moveBed(centers, velocities, boxes);
+                    broadPhase.findOverlappingPairs(boxes, pairs,
+                        parallel ? &executor : nullptr);
+                }
+                times[parallel] = (realTime()-start)/numCalls;
+            }
+            printf("  %7d  %9d  %7.2f  %-26s %6.2f  %8.2f\n", n,
+                   (int)pairs.size(), 1e3*legacyTime,
+                   BroadPhase::getMethodName(method), 1e3*times[0],
+                   1e3*times[1]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the wall time of a numerical Jacobian with Differentiator for a
+function with a banded Jacobian that costs about as much as a small multibody
+right-hand side to evaluate, comparing one perturbation per column with
+column grouping from the sparsity pattern, each on 1 thread and on all
+processors.
+
+Usage: DifferentiatorScaling [numParameters [halfBandwidth]]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+// f_i = sum over |j-i| <= b of sin(y_j + i*y_i), repeated to add work.
+class Banded : public Differentiator::JacobianFunction {
+public:
+    Banded(int n, int b) : Differentiator::JacobianFunction(n,n), b(b) {}
+
+    int f(const Vector& y, Vector& fy) const override {
+        const int n = y.size();
+        for (int i=0; i < n; ++i) {
+            Real sum = 0;
+            for (int rep=0; rep < 20; ++rep)
+                for (int j = std::max(i-b, 0); j <= std::min(i+b, n-1); ++j)
+                    sum += std::sin(y[j] + i*y[i] + rep);
+            fy[i] = sum;
+        }
+        return 0;
+    }
+
+    Banded* clone() const override {return new Banded(getNumFunctions(), b);}
+
+    Array_< Array_<int> > getSparsityPattern() const {
+        const int n = getNumParameters();
+        Array_< Array_<int> > rowsOfColumn(n);
+        for (int j=0; j < n; ++j)
+            for (int i = std::max(j-b, 0); i <= std::min(j+b, n-1); ++i)
+                rowsOfColumn[j].push_back(i);
+        return rowsOfColumn;
+    }
+
+private:
+    const int b;
+};
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int b = argc > 2 ? std::atoi(argv[2]) : 2;
+    const int numProcs = std::max(ParallelExecutor::getNumProcessors(), 1);
+
+    Banded func(n, b);
+    Vector y0(n);
+    for (int i=0; i < n; ++i) y0[i] = 0.01*i;
+    Vector fy0(n);
+    func.f(y0, fy0);
+
+    printf("%d parameters, bandwidth %d, %d processors\n", n, 2*b+1, numProcs);
+    printf("  %8s %8s %8s %12s\n", "colored", "threads", "calls", "ms per J");
+
+    Matrix Jref;
+    for (int colored=0; colored < 2; ++colored) {
+        const int threadCounts[] = {1, numProcs};
+        for (int numThreads : threadCounts) {
+            Differentiator diff(func, Differentiator::CentralDifference);
+            diff.setNumThreads(numThreads);
+            if (colored)
+                diff.setJacobianSparsityPattern(func.getSparsityPattern());
+
+            Matrix J;
+            diff.calcJacobian(y0, fy0, J); // make the clones
+            diff.resetAllStatistics();
+            const int numReps = 10;
+            const double start = realTime();
+            for (int r=0; r < numReps; ++r)
+                diff.calcJacobian(y0, fy0, J);
+            const double ms = 1000*(realTime() - start)/numReps;
+
+            if (Jref.nrow() == 0) Jref = J;
+            else if ((J - Jref).normRMS() > 1e-12)
+                printf("  WARNING: Jacobians differ\n");
+            printf("  %8s %8d %8d %12.3f\n", colored ? "yes" : "no",
+                   numThreads, diff.getNumCallsToUserFunction()/numReps, ms);
+        }
+    }
+    return 0;
+}
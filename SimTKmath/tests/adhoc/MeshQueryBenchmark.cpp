@@ -0,0 +1,90 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the time per query of casting rays at, and finding the nearest
+points on, a finely tessellated sphere, one query at a time through the OBB
+tree and in batches through TriangleMesh::intersectsRays() and
+findNearestPoints(), the latter also with several threads.
+
+Usage: MeshQueryBenchmark [numQueries] [sphereLevel]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int numQueries = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int level = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const ContactGeometry::TriangleMesh mesh
+        (PolygonalMesh::createSphereMesh(1, level));
+    Random::Gaussian random(0, 1);
+    random.setSeed(3);
+    Array_<Vec3> points(numQueries);
+    Array_<UnitVec3> directions(numQueries);
+    for (int i=0; i < numQueries; ++i) {
+        points[i] = 2*Vec3(random.getValue(), random.getValue(),
+                           random.getValue());
+        directions[i] = UnitVec3(0.5*Vec3(random.getValue(), random.getValue(),
+                                          random.getValue()) - points[i]);
+    }
+    printf("%d faces, %d queries; microseconds per query\n",
+           mesh.getNumFaces(), numQueries);
+    printf("                    rays    nearest\n");
+
+    double start = realTime();
+    for (int i=0; i < numQueries; ++i) {
+        Real distance; int face; Vec2 uv;
+        mesh.intersectsRay(points[i], directions[i], distance, face, uv);
+    }
+    const double singleRays = realTime() - start;
+    start = realTime();
+    for (int i=0; i < numQueries; ++i) {
+        bool inside; int face; Vec2 uv;
+        mesh.findNearestPoint(points[i], inside, face, uv);
+    }
+    const double singleNearest = realTime() - start;
+    printf("  one at a time  %9.3f  %9.3f\n", 1e6*singleRays/numQueries,
+           1e6*singleNearest/numQueries);
+
+    Array_<Real> distances; Array_<int> faces; Array_<Vec2> uvs;
+    Array_<Vec3> nearest; Array_<bool> inside;
+    const int threadCounts[] = {1, 2, 4};
+    for (int numThreads : threadCounts) {
+        ParallelExecutor executor(numThreads);
+        ParallelExecutor* exec = numThreads > 1 ? &executor : nullptr;
+        start = realTime();
+        mesh.intersectsRays(points, directions, distances, faces, uvs, exec);
+        const double batchRays = realTime() - start;
+        start = realTime();
+        mesh.findNearestPoints(points, nearest, inside, faces, uvs, exec);
+        const double batchNearest = realTime() - start;
+        printf("  batch, %d thr   %9.3f  %9.3f\n", numThreads,
+               1e6*batchRays/numQueries, 1e6*batchNearest/numQueries);
+    }
+    return 0;
+}
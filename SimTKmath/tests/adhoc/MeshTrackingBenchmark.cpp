@@ -0,0 +1,95 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the time per call of tracking the contact between a half space and
+a tessellated sphere pushed into it, searching the sphere's OBB tree from the
+root each time and resuming from the previous call's tree front. The sphere
+bobs up and down a little between calls so that the front has to be updated.
+Each mesh is tried at several depths, chosen so that about the same numbers of
+faces k are inside for all of the meshes; resumed tracking should then cost
+about the same for every mesh and grow in proportion to k.
+
+Usage: MeshTrackingBenchmark [numCalls] [maxSphereLevel]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+static double timeCalls(const ContactTracker& tracker,
+                        const ContactGeometry& halfSpace,
+                        const ContactGeometry::TriangleMesh& mesh,
+                        Real depth, bool resume, int numCalls, int& k) {
+    const Contact untracked = UntrackedContact(ContactSurfaceIndex(0),
+                                               ContactSurfaceIndex(1));
+    Contact prior = untracked, current;
+    const double start = realTime();
+    for (int i=0; i < numCalls; ++i) {
+        // The half space fills x > 0; let a cap of the sphere poke into it.
+        const Real bob = (i & 1 ? 0.05 : -0.05)*depth;
+        const Transform X_GM(Vec3(depth + bob - 1, 0, 0));
+        tracker.trackContact(resume ? prior : untracked, Transform(),
+                             halfSpace, X_GM, mesh, 0, current);
+        std::swap(prior, current);
+    }
+    const double perCall = (realTime() - start)/numCalls;
+    k = TriangleMeshContact::isInstance(prior)
+        ? (int)TriangleMeshContact::getAs(prior).getSurface2Faces().size()
+        : 0;
+    return perCall;
+}
+
+int main(int argc, char** argv) {
+    const int numCalls = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int maxLevel = argc > 2 ? std::atoi(argv[2]) : 7;
+
+    const ContactTracker::HalfSpaceTriangleMesh tracker;
+    const ContactGeometry::HalfSpace halfSpace;
+    printf("%d calls; microseconds per call\n", numCalls);
+    printf("   faces       k   from root   resumed\n");
+    for (int level = 4; level <= maxLevel; ++level) {
+        const ContactGeometry::TriangleMesh mesh
+            (PolygonalMesh::createSphereMesh(1, level));
+        // A cap of depth d on a unit sphere has area 2 pi d, so this many
+        // faces fit in the cap for each unit of depth.
+        const Real facesPerDepth = 2*Pi * mesh.getNumFaces() / (4*Pi);
+        const int targetK[] = {100, 400, 1600};
+        for (int target : targetK) {
+            const Real depth = target/facesPerDepth;
+            if (depth > 0.5) continue;
+            int kRoot, kResumed;
+            const double root =
+                timeCalls(tracker, halfSpace, mesh, depth, false, numCalls,
+                          kRoot);
+            const double resumed =
+                timeCalls(tracker, halfSpace, mesh, depth, true, numCalls,
+                          kResumed);
+            printf("  %6d  %6d   %9.2f %9.2f\n", mesh.getNumFaces(), kResumed,
+                   1e6*root, 1e6*resumed);
+        }
+    }
+    return 0;
+}
@@ -782,8 +782,8 @@ TriangleMeshContact tracking object. **/
 class SimTK_SIMBODY_EXPORT ContactForceGenerator::ElasticFoundation 
 :   public ContactForceGenerator {
 public:
-ElasticFoundation() 
-:   ContactForceGenerator(TriangleMeshContact::classTypeId()) {}
+ElasticFoundation();
+~ElasticFoundation();
 
 void calcContactForce
    (const State&            state,
@@ -805,16 +805,19 @@ void calcContactForceAndDetails
     ContactForce&           contactForce,
     Array_<ContactDetail>*  contactDetails) const;
 
+// The inside faces of one mesh, flattened into structure-of-arrays form.
+class FaceBatch;
+// FaceBatches kept for reuse by later contacts.
+class FaceBatchPool;
+
 void calcWeightedPatchCentroid
-   (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+   (const FaceBatch&                        insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const;
                        
 void processOneMesh
    (const State&                            state,
-    const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    FaceBatch&                              insideFaces,
     const Transform&                        X_MO, 
     const SpatialVec&                       V_MO,
     const ContactGeometry&                  other,
@@ -828,6 +831,11 @@ void processOneMesh
     Vec3&                       weightedCenterOfPressure_M, // COP
     Real&                       sumOfAllPressureMoments,    // COP weight
     Array_<ContactDetail>*      contactDetails) const;
+
+ElasticFoundation(const ElasticFoundation&) = delete;
+ElasticFoundation& operator=(const ElasticFoundation&) = delete;
+
+FaceBatchPool*  m_faceBatches; // owned
 };
 
 
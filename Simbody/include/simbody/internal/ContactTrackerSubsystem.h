@@ -245,6 +245,32 @@ const ContactTracker& getContactTracker(ContactGeometryTypeId surface1,
                                         bool& reverseOrder) const;
 /**@}**/
 
+/**@name                     Broad phase
+Before any ContactTracker is invoked, a broad phase finds the pairs of contact
+surfaces whose bounding spheres overlap. Only those pairs, and the pairs that
+were already being tracked, are examined further. **/
+/**@{**/
+
+/** Select the algorithm used for the broad phase; see BroadPhase for the
+choices. The default is BroadPhase::DynamicAABBTree; 
+BroadPhase::IncrementalSweepAndPrune can be faster when the surfaces are
+strung out along one direction. This is a topological change; you will have to
+call realizeTopology() again. **/
+void setBroadPhaseMethod(BroadPhase::Method method);
+
+/** Return the algorithm currently used for the broad phase. **/
+BroadPhase::Method getBroadPhaseMethod() const;
+
+/** Set the number of threads used to search for broad phase pairs. The default
+is 1, meaning the search is done in the thread that realizes the State; this is
+faster unless there are thousands of contact surfaces.
+@note This method should NOT be called while realizing Stage::Dynamics. **/
+void setNumberOfThreads(unsigned numThreads);
+
+/** Get the number of threads used to search for broad phase pairs. **/
+int getNumberOfThreads() const;
+/**@}**/
+
 /**@name                     Advanced/Obscure
 You probably don't want to call any of these methods. Some may be 
 unimplemented. **/
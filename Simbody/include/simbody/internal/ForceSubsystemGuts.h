@@ -58,6 +58,18 @@ public:
     /// be at Dynamics stage or later.
     virtual Real calcPotentialEnergy(const State& state) const = 0;
 
+    /// Add this subsystem's contribution to the partial derivatives of the
+    /// mobility forces with respect to the matter subsystem's q's and u's:
+    /// \a dFdQ is nu X nq and \a dFdU is nu X nu, both indexed by the matter
+    /// subsystem's QIndex and UIndex. The state must be at Velocity stage or
+    /// later. Return false, without changing anything, if this subsystem
+    /// can't supply its derivatives; that is the default. Used by
+    /// MultibodySystem to form the Jacobian needed by implicit integrators.
+    virtual bool calcMobilityForceDerivatives(const State& state, 
+                                              Matrix& dFdQ, 
+                                              Matrix& dFdU) const 
+    {   return false; }
+
     SimTK_DOWNCAST(ForceSubsystem::Guts, Subsystem::Guts);
 };
 
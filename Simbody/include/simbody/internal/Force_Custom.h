@@ -261,6 +261,55 @@ public:
     virtual bool shouldBeParallelIfPossible() const {
         return false;
     }
+    /**
+     * Returns an estimate of the time in seconds that one call to calcForce()
+     * takes. GeneralForceSubsystem uses it to divide the forces evenly among
+     * its threads. By default this method returns 0, in which case the time
+     * is measured periodically instead (see
+     * GeneralForceSubsystem::setLoadBalancingInterval()). Only the relative
+     * sizes of the estimates matter, but they should be comparable to
+     * measured times if some forces provide a hint and others do not.
+     */
+    virtual Real getCostHint() const {
+        return 0;
+    }
+    /**
+     * Append to \a bodies the MobilizedBodyIndex of every body, and to
+     * \a mobilities the UIndex of every mobility, whose entry of the arrays
+     * passed to calcForce() that method may change for this \a state, and
+     * return true. Listing an entry that isn't changed is harmless, but one
+     * that is changed and not listed will be lost. When this force is
+     * computed in parallel with others, GeneralForceSubsystem uses the lists
+     * to add up the threads' contributions without visiting the other
+     * entries. By default this method returns false, meaning that any entry
+     * may change; the whole of the thread's arrays is then added up. It is
+     * called just before calcForce() whenever the force is to be computed
+     * into a thread's own arrays, so only if shouldBeParallelIfPossible().
+     */
+    virtual bool findAffectedBodiesAndMobilities
+       (const State&                 state,
+        Array_<MobilizedBodyIndex>&  bodies,
+        Array_<UIndex>&              mobilities) const {
+        return false;
+    }
+    /**
+     * Add this force's partial derivatives of its generalized (mobility)
+     * forces with respect to q and u into \a dFdQ (nu X nq) and \a dFdU
+     * (nu X nu), indexed by the matter subsystem's QIndex and UIndex, and
+     * return true. Body forces count through their mobility-space 
+     * equivalents. Implicit integrators use these, by way of
+     * System::calcYDotJacobian(), to avoid finite differencing the whole
+     * System; if any enabled force returns false, as the default 
+     * implementation does, they fall back to finite differences. The 
+     * derivatives need not be exact, and a force that is smooth and weak
+     * may return true without adding anything, but stiff forces should 
+     * report their stiffness and damping accurately.
+     */
+    virtual bool calcMobilityForceDerivatives(const State& state, 
+                                              Matrix& dFdQ, 
+                                              Matrix& dFdU) const {
+        return false;
+    }
     /** The following methods may optionally be overridden to do specialized 
     realization for a Force. **/
     //@{
@@ -122,6 +122,31 @@ public:
      * may still invoke it to calculate forces based on contacts.
      */
     const Array_<Contact>& getContacts(const State& state, ContactSetIndex set) const;
+    /**
+     * Select the algorithm used to find the pairs of bodies in a contact set whose bounding
+     * spheres overlap, which are then examined by a CollisionDetectionAlgorithm.  See BroadPhase
+     * for the choices; the default is BroadPhase::DynamicAABBTree.  This is a topological change;
+     * you will have to call realizeTopology() again.
+     */
+    void setBroadPhaseMethod(BroadPhase::Method method);
+    /**
+     * Get the algorithm used to find the pairs of bodies that might be in contact.
+     */
+    BroadPhase::Method getBroadPhaseMethod() const;
+    /**
+     * Set the number of threads used to find contacts.  The pairs of bodies that might be in
+     * contact are divided among the threads, each of which invokes the CollisionDetectionAlgorithm
+     * for its pairs, so any algorithm you register must be safe to call concurrently.  The contacts
+     * are reported in the same order regardless of the number of threads.  The default is 1, meaning
+     * contacts are found in the thread that realizes the State.
+     *
+     * @note This method should NOT be called while realizing Stage::Dynamics.
+     */
+    void setNumberOfThreads(unsigned numThreads);
+    /**
+     * Get the number of threads used to find contacts.
+     */
+    int getNumberOfThreads() const;
     SimTK_PIMPL_DOWNCAST(GeneralContactSubsystem, Subsystem);
 private:
     class GeneralContactSubsystemImpl& updImpl();
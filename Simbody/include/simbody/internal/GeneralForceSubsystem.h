@@ -103,6 +103,25 @@ public:
     computations**/
     int getNumberOfThreads() const;
 
+    /** Set how often the GeneralForceSubsystem measures the time taken by
+    each force element's calcForce() in order to divide the force elements
+    evenly among its threads. Measurements are taken on the first Dynamics
+    realization after the set of enabled forces or the number of threads
+    (see setNumberOfThreads()) changes and then once every
+    \a numRealizations Dynamics realizations. The non-parallel force elements
+    are always computed together on one thread; the parallel ones are packed
+    around them so that every thread gets about the same amount of work.
+    A value of zero turns measurement off, in which case the cost hints
+    supplied by the force elements are used (or all force elements are
+    assumed to cost the same). The default is 100.
+    
+    @note This method should NOT be called while realizing Stage::Dynamics.**/
+    void setLoadBalancingInterval(int numRealizations);
+
+    /** Return the number of Dynamics realizations between measurements of
+    force element costs. @see setLoadBalancingInterval() **/
+    int getLoadBalancingInterval() const;
+
     /** Every Subsystem is owned by a System; a GeneralForceSubsystem expects
     to be owned by a MultibodySystem. This method returns a const reference
     to the containing MultibodySystem and will throw an exception if there is
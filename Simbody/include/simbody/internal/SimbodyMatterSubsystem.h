@@ -205,6 +205,52 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Request that the O(n) tree sweeps (position kinematics, articulated body
+inertias, forward dynamics, and multiplyByMInv()) use this many threads. If 
+the tree splits into independent branches (see setUseBranchParallelism()) 
+each branch is swept as a single task; otherwise the mobilized bodies at each
+level of the tree are spread over the threads. Levels with fewer than
+getMinBodiesPerParallelLevel() bodies are still done serially, and since each
+body's computation is unchanged the results are bitwise identical to serial
+execution. The default is 1, meaning always serial. Any Custom mobilizers in
+this system must be safe to realize concurrently if you use more than one
+thread.
+@note This method should NOT be called while realizing. **/
+void setNumberOfThreads(unsigned numThreads);
+/** Get the number of threads used for the tree sweeps, as set with
+setNumberOfThreads(). **/
+int getNumberOfThreads() const;
+
+/** When more than one thread is in use (see setNumberOfThreads()), a level of
+the tree is divided among threads only if it contains at least this many
+mobilized bodies; smaller levels don't repay the cost of synchronizing. 
+Likewise the branches of the tree are swept in parallel only if there are at
+least this many bodies in them altogether. The default is 128.
+@note This method should NOT be called while realizing. **/
+void setMinBodiesPerParallelLevel(int numBodies);
+/** Get the minimum number of mobilized bodies in a tree level for it to be
+done in parallel; see setMinBodiesPerParallelLevel(). **/
+int getMinBodiesPerParallelLevel() const;
+
+/** When more than one thread is in use (see setNumberOfThreads()), sweep each
+independent branch of the tree as one task rather than dividing up each level.
+At realizeTopology() the tree is split into a trunk, from Ground down to the 
+first mobilized body with more than one child (so a floating base is part of
+the trunk), and the branches that are the subtrees of that body's children. 
+The trunk is swept serially, and the branches in parallel in between. 
+Branches are used only if there are at least two and none of them has more
+than three quarters of the bodies; otherwise the sweeps go level by level. The default is
+true.
+@note This method should NOT be called while realizing. **/
+void setUseBranchParallelism(bool useBranches);
+/** Get whether the tree sweeps may run each branch of the tree as a single
+task; see setUseBranchParallelism(). **/
+bool getUseBranchParallelism() const;
+/** Return the number of independent branches found in the tree at 
+realizeTopology(); see setUseBranchParallelism(). This is zero if the tree has
+no branches or topology has not yet been realized. **/
+int getNumTreeBranches() const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the first mobilized body, at MobilizedBodyIndex 0. (Note: if 
 special particle handling were implemented, the count here would \e not 
@@ -714,26 +760,16 @@ speeds u. The result is the station velocities measured and expressed in Ground.
     to nt if needed.
 
 <h3>Performance discussion</h3>
-It is almost always better to use this method than to form an explicit 3*nt X n 
-station task Jacobian explicitly and then multiply by it. If you have only one 
-or two tasks, so that the matrix is only 3xn or 6xn, and then perform many 
-multiplies with that matrix, it might be slightly cheaper to form it. For 
-example, it is about 4X cheaper to use this method than to form a one-task 
-Station Jacobian JS explicitly and use it once. However, because this would be 
-such a skinny matrix (3 X n) explicit multiplication is cheap so if you will 
-re-use this same Jacobian repeatedly before recalculating (at least 6 times) 
-then it may be worth calculating and saving it. Here are the details:
-
 A call to this method costs 27*nt + 12*(nb+n) flops. If you assume that 
 nb ~= n >> 1, you could say this is about 27*nt + 24*n flops. In
 contrast, assuming you already have the 3*nt X n station Jacobian JS available,
-you can compute the JS*u product in about 6*nt*n flops, 3X faster for one task,
-about even for three tasks, and slower for more than three tasks.
-However forming JS costs about 40*nt+90*n flops (see calcStationJacobian()).
-So to form a one-task Jacobian and use it once is 4X more expensive (96*n vs
-24*n), but if you use it more than 5 times it is cheaper to do it
-explicitly. Forming a one-task JS and using it 100 times costs about 690*n 
-flops while calling this method 100 times would cost about 2400*n flops.
+you can compute the JS*u product in about 6*nt*n flops, 4X faster for one task,
+about even for four tasks, and slower for more than four tasks. Forming JS
+costs at most 15*nt*n flops, and usually much less since only the columns for
+mobilities between each task body and Ground are filled in (see
+calcStationJacobian()). So if you have only a few tasks and will re-use the
+same Jacobian several times before recalculating, it may be worth forming it
+explicitly; otherwise use this method.
 
 @see multiplyByStationJacobianTranspose(), calcStationJacobian() **/
 void multiplyByStationJacobian(const State&                      state,
@@ -764,8 +800,8 @@ forming the Jacobian explicitly and then performing the matrix-vector multiply.
 
 <h3>Performance discussion</h3>
 Cost is about 30*nt + 18*nb + 11*n. Assuming nb ~= n, this is roughly
-30*(n+nt). In contrast, forming the complete 3*nt X n matrix would cost about
-90*(n+nt/2), and subsequent explicit matrix-vector multiplies would cost
+30*(n+nt). In contrast, forming the complete 3*nt X n matrix would cost at
+most 15*nt*n, and subsequent explicit matrix-vector multiplies would cost
 about 6*nt*n each.
 
 @see multiplyByStationJacobian(), calcStationJacobian() **/
@@ -821,13 +857,16 @@ with scalar elements.
     The resulting nt X n station task Jacobian. Resized if necessary.
 
 <h3>Performance discussion</h3>
-The cost of a call to this method is about 42*nt + 54*nb + 33*n flops. If we 
-assume that nb ~= n >> 1, this is roughly 90*(n+nt/2) flops. Then once the 
-Station Jacobian JS has been formed, each JS*u matrix-vector product costs
-6*nt*n flops to form. When nt is small enough (say one or two tasks), and you
-plan to re-use it a lot, this can be computationally efficient; but for single
-use or more than a few tasks you can do much better with 
-multiplyByStationJacobian() or multiplyByStationJacobianTranspose().
+JS is formed in a single pass over the tasks. For each task we walk from its
+body to Ground, filling in only the columns for the mobilities along that path;
+all the other columns are zero. That costs about 15 flops per task plus 12 flops
+for each mobility on its path, plus the cost of zeroing the 3*nt X n result, so
+at most 15*nt*n flops and typically much less for a branched tree. Then once
+the Station Jacobian JS has been formed, each JS*u matrix-vector product costs
+6*nt*n flops to form. When nt is small and you plan to re-use JS a lot, this
+can be computationally efficient; but for single use or more than a few tasks
+you can do better with multiplyByStationJacobian() or
+multiplyByStationJacobianTranspose().
 
 @see multiplyByStationJacobian(), multiplyByStationJacobianTranspose() **/
 void calcStationJacobian(const State&                        state,
@@ -973,16 +1012,12 @@ nb ~= n >> 1, you could say this is about 25*(nt+n) flops. In contrast, assuming
 you already have the 6*nt X n Frame Jacobian JF available, you can compute the
 JF*u product in about 12*nt*n flops. If you have just one task (nt==1) this
 explicit multiplication is about twice as fast; at two tasks it is about even
-and for more than two it is more expensive. However forming JF costs about 
-180*(n+nt/4) flops (see calcFrameJacobian()). So to form a one-task Jacobian 
-and use it once is almost 8X more expensive (192*n vs 25*n), but if you use it 
-more than 16 times it is (marginally) cheaper to do it explicitly (for one
-task). For example, forming a one-task JF and using it 100 times costs 1392*n 
-flops while calling this method 100 times would cost about 2500*n flops.
+and for more than two it is more expensive. Forming JF costs at most 18*nt*n
+flops, and usually much less (see calcFrameJacobian()), so for one or two tasks
+it can be cheaper to form JF explicitly if you will use it several times.
 
-Conclusion: in almost all practical cases you are better off using this operator
-rather than forming JF, even if you have only a single frame task and certainly 
-if you have more than two tasks.
+Conclusion: unless you have only one or two frame tasks and will re-use the
+Jacobian, you are better off using this operator rather than forming JF.
 
 @see multiplyByFrameJacobianTranspose(), calcFrameJacobian() **/
 void multiplyByFrameJacobian
@@ -1037,17 +1072,12 @@ A call to this method costs 33*nt + 18*nb + 11*n flops. If you assume that
 nb ~= n >> 1, you could say this is about 30*(n+nt) flops. In contrast, assuming 
 you already have the 6*nt X n Frame Jacobian JF available, you can compute the
 ~JF*F product in about 12*nt*n flops. For one or two tasks that would be faster
-than applying the operator. However forming JF costs about 180*(n+nt/4) flops 
-(see calcFrameJacobian()). So to form even a one-task Frame Jacobian and use 
-it once is about 6X more expensive than using the operator (192*n vs 30*n), 
-but if you use it more than 10 times it is (marginally) cheaper to do it 
-explicitly. For example, forming a one-task JF and using it 100 times costs 
-around 1392*n flops while calling this method 100 times would cost about 
-3000*n flops.
-
-Conclusion: in almost all practical cases you are better off using this operator
-rather than forming JF, even if you have only a single frame task and certainly 
-if you have more than two tasks.
+than applying the operator. Forming JF costs at most 18*nt*n flops, and 
+usually much less (see calcFrameJacobian()), so for one or two tasks it can be
+cheaper to form JF explicitly if you will use it several times.
+
+Conclusion: unless you have only one or two frame tasks and will re-use the
+Jacobian, you are better off using this operator rather than forming JF.
 
 @see multiplyByFrameJacobian(), calcFrameJacobian() **/
 void multiplyByFrameJacobianTranspose
@@ -1108,12 +1138,14 @@ Matrix with scalar elements.
     Resized if necessary.
 
 <h3>Performance discussion</h3>
-The cost of a call to this method is about 42*nt + 108*nb + 66*n flops. If we 
-assume that nb ~= n >> 1, this is roughly 180*(n+nt/4) flops. Then once the 
-Frame Jacobian JF has been formed, each JF*u matrix-vector product costs about
-12*nt*n flops to form. When nt is small enough (say one or two tasks), and you
-plan to re-use it a lot, this can be computationally efficient; but for single
-use or more than a few tasks you can do much better with 
+JF is formed in a single pass over the tasks, walking from each task's body to
+Ground and filling in only the columns for the mobilities along that path. That
+costs about 15 flops per task plus 12 flops for each mobility on its path, plus
+the cost of zeroing the 6*nt X n result, so at most 18*nt*n flops and
+typically much less for a branched tree. Then once the Frame Jacobian JF has
+been formed, each JF*u matrix-vector product costs about 12*nt*n flops to form.
+When nt is small and you plan to re-use JF a lot, this can be computationally
+efficient; but for single use or more than a few tasks you can do better with
 multiplyByFrameJacobian() or multiplyByFrameJacobianTranspose().
 
 @see multiplyByFrameJacobian(), multiplyByFrameJacobianTranspose() **/
@@ -1351,12 +1383,20 @@ DURING NORMAL DYNAMICS</em>. To do so would change an O(n) operation into an
 O(n^2) one. Instead, see if you can accomplish what you need with O(n) operators
 like multiplyByM() which calculates the matrix-vector product M*v in O(n)
 without explicitly forming M. Also, don't invert this matrix numerically to get
-M^-1. Instead, call the method calcMInv() which can produce M^-1 directly.
+M^-1. Instead, call the method calcMInv() which can produce M^-1 directly, or
+use calcMFactor() or multiplyByMInvUsingMFactor().
+
+<h3>Performance</h3>
+M is calculated with the composite rigid body algorithm. Element M(i,j) is 
+nonzero only if mobilities i and j are on the same path from a body to Ground,
+and only those elements are computed, so the cost beyond zeroing the matrix
+is proportional to n times the depth of the tree rather than to n^2. Composite
+body inertias are realized first if necessary.
 
 @par Required stage
   \c Stage::Position 
 
-@see multiplyByM(), calcMInv() **/
+@see multiplyByM(), calcMInv(), calcMFactor() **/
 void calcM(const State&, Matrix& M) const;
 
 /** This operator explicitly calculates the inverse of the part of the system
@@ -1372,12 +1412,89 @@ multiplyByMInv() which calculates the matrix-vector product M^-1*v in O(n)
 without explicitly forming M or M^-1. If you need M explicitly, you can get it
 with the calcM() method.
 
+<h3>Performance</h3>
+M^-1 is formed one column at a time using the sparse factorization of M
+described in calcMFactor(), which is cached in the State.
+
 @par Required stage
-  \c Stage::Position (articulated body inertias realized first if necessary)
+  \c Stage::Position
 
-@see multiplyByMInv(), calcM() **/
+@see multiplyByMInv(), calcM(), calcMFactor() **/
 void calcMInv(const State&, Matrix& MInv) const;
 
+/** Return the factor L of the mass matrix M = ~L*L, where L is n X n and
+lower triangular. This is Featherstone's "LTL" factorization: because it is
+done from the last mobility up, L has exactly the sparsity of the lower
+triangle of M, that is, L(i,j) is nonzero only if mobility j is i itself or
+inboard of i on the same branch. So for a branched tree L is sparse and both
+solves with it cost far less than O(n^2). Elements of L that are structurally
+zero are returned as zero.
+
+Prescribed mobilities are treated as in calcMInv(): their rows and columns of
+M are replaced by identity before factoring, so L is the factor of the free
+block M_ff scattered into an n X n matrix, with ones on the diagonal for the
+prescribed mobilities.
+
+<h3>Performance</h3>
+The factorization is cached in the State and is recalculated only when the
+positions q (or instance variables) change, so calling this or the other 
+methods that use it repeatedly at the same configuration, as a controller 
+typically does, costs only the copy out. Forming M and factoring it cost about
+n times the depth of the tree flops.
+
+@par Required stage
+  \c Stage::Position
+
+@throws Exception if M_ff is not positive definite, which can happen if there
+are massless bodies that aren't supported by massive outboard bodies.
+@see calcM(), calcMInv(), multiplyByMInvUsingMFactor(), 
+     calcOperationalSpaceInertia() **/
+void calcMFactor(const State& state, Matrix& L) const;
+
+/** Calculate M^-1*v using the cached factorization of M described in
+calcMFactor(). This gives the same result as multiplyByMInv() for the free
+mobilities (the ones for prescribed mobilities are returned as zero), but 
+costs one sparse triangular solve with each of ~L and L. That is about as 
+fast as multiplyByMInv() for trees that aren't too deep, but it doesn't need
+the articulated body inertias, so this is the better choice if you are 
+already using the factorization (for calcOperationalSpaceInertia(), say) and
+don't otherwise need articulated body inertias at this configuration.
+
+@par Required stage
+  \c Stage::Position
+
+@see multiplyByMInv(), calcMFactor() **/
+void multiplyByMInvUsingMFactor(const State&    state,
+                                const Vector&   v,
+                                Vector&         MinvV) const;
+
+/** Calculate the k X k operational space (task space) inertia matrix
+Lambda = (J M^-1 ~J)^-1, given a k X n task Jacobian J such as the one you get
+from calcStationJacobian() or calcFrameJacobian(). Lambda is the apparent 
+inertia of the system as seen at the tasks, so that task forces 
+F = Lambda*(desired task accelerations - Jdot*u) are mapped to mobility forces
+~J*F by an operational space controller. If the tasks are redundant (J M^-1 ~J
+is singular) Lambda is returned as the pseudoinverse.
+
+Prescribed mobilities don't respond to task forces so their columns of J are
+ignored, just as multiplyByMInv() ignores them.
+
+<h3>Performance</h3>
+This uses the cached factorization of M described in calcMFactor(), with
+Y = L^-T ~J formed one task row at a time and Lambda = (~Y*Y)^-1. A row of J 
+is nonzero only on the path from its task body to Ground, and so is the 
+corresponding column of Y, so the cost for k tasks is about k^2 times the tree
+depth plus the k^3 inversion. The factorization is recalculated only when the
+positions change; Lambda itself depends on J so is not cached.
+
+@par Required stage
+  \c Stage::Position
+
+@see calcMFactor(), calcStationJacobian(), calcFrameJacobian() **/
+void calcOperationalSpaceInertia(const State&   state,
+                                 const Matrix&  J,
+                                 Matrix&        Lambda) const;
+
 /** This operator calculates in O(m*n) time the m X m "projected inverse mass 
 matrix" or "constraint compliance matrix" W=G*M^-1*~G, where G (mXn) is the 
 acceleration-level constraint Jacobian mapped to generalized coordinates,
@@ -2035,6 +2152,82 @@ void calcAccelerationIgnoringConstraints
     Vector&                     udot,    
     Vector_<SpatialVec>&        A_GB) const;
 
+/** Calculate the partial derivatives of the generalized accelerations 
+udot=FD(q,u,f) returned by calcAccelerationIgnoringConstraints() with respect
+to the generalized coordinates q, generalized speeds u, and applied mobility
+forces tau, as needed by trajectory optimizers. The supplied applied forces
+are held fixed; in particular forces from force elements (including gravity, 
+whose moment about a body origin depends on q) are not differentiated. If your
+forces f depend on q or u, add their contribution with the chain rule, 
+dudot/dq += dUDotdTau*df/dq, where for body forces f is the mobility-space
+equivalent you get from multiplyBySystemJacobianTranspose(). Prescribed 
+accelerations are also held fixed, so the rows for prescribed mobilities are
+zero, as are their columns of \a dUDotdTau.
+
+<h3>Performance</h3>
+This is much cheaper than differentiating realize(Acceleration) numerically,
+which costs 2(nq+nu)+1 evaluations of the force elements and articulated body
+inertias. Here \a dUDotdTau is M^-1, calculated from the factored mass 
+matrix (see calcMFactor()). The other derivatives are found from inverse
+dynamics using dudot/dx = -M^-1 * d(ID)/dx, which needs only kinematics and
+inverse dynamics and no force elements. Since a coordinate affects only the
+bodies outboard of its mobilizer, coordinates of mobilizers on different 
+branches are perturbed together, so the kinematics are realized only twice for
+each q (or u) on the longest path from a body to Ground, rather than for each
+q and u. The inertial forces are exactly quadratic in u so the u derivatives 
+obtained this way are exact up to roundoff. The q derivatives are central 
+differences, with the usual accuracy of about Eps^(2/3). For a 30-body 
+humanoid this is about 7 times faster than Differentiator even with trivial
+force elements; see Simbody/tests/adhoc/ForwardDynamicsDerivatives.cpp.
+
+@param[in]  state
+    A State realized through Dynamics stage. A copy of it is used as 
+    workspace; \a state itself is not changed except for its lazily-evaluated
+    cache entries.
+@param[in]  appliedMobilityForces
+    The applied generalized forces tau, one per mobility.
+@param[in]  appliedBodyForces
+    The applied spatial forces, one per body including Ground, applied at the
+    body origins and expressed in Ground.
+@param[out] dUDotdQ
+    The nu X nq matrix dudot/dq.
+@param[out] dUDotdU
+    The nu X nu matrix dudot/du.
+@param[out] dUDotdTau
+    The nu X nu matrix dudot/dtau, which is M^-1 for the free mobilities.
+
+@par Required stage
+  \c Stage::Dynamics
+@see calcAccelerationIgnoringConstraints(), calcResidualForceIgnoringConstraints(),
+     calcMInv() **/
+void calcTreeForwardDynamicsDerivatives
+   (const State&                state,
+    const Vector&               appliedMobilityForces,
+    const Vector_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     dUDotdQ,
+    Matrix&                     dUDotdU,
+    Matrix&                     dUDotdTau) const;
+
+/** Partition the matter subsystem's states by mobilizer: for each non-Ground
+mobilized body, in MobilizedBodyIndex order, return the indices into the 
+System's y vector of its mobilizer's generalized coordinates q followed by 
+its generalized speeds u. Mobilizers with no q's or u's get an empty block.
+These blocks are a natural choice for a block-diagonal preconditioner of a 
+stiff integrator's Newton iteration, since they capture the coupling of a
+mobilizer's own q's and u's (qdot=N(q)u) and any stiff spring or damper 
+acting across that mobilizer. See CPodesIntegrator::setPreconditionerBlocks().
+
+@param[in]      state
+    A State realized through \c Stage::Model.
+@param[out]     yBlocks
+    One block of y indices per mobilized body, with yBlocks[0], for Ground,
+    always empty. Resized if necessary.
+
+@par Required stage
+  \c Stage::Model **/
+void findMobilizerYBlocks(const State&           state,
+                          Array_< Array_<int> >& yBlocks) const;
+
 
 
 /** This is the inverse dynamics operator for the tree system; if there are
@@ -36,6 +36,10 @@ patch analysis methods.
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/MultibodySystem.h"
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace SimTK {
 
 //==============================================================================
@@ -1475,6 +1479,165 @@ void ContactForceGenerator::BrickHalfSpacePenalty::calcContactPatch
 //==============================================================================
 //                         ELASTIC FOUNDATION GENERATOR
 //==============================================================================
+// The inside faces of one mesh in structure-of-arrays form. Each face's spring
+// position (its centroid) and area are copied from the values the mesh
+// calculated when it was created, once per contact, and then shared by the
+// patch centroid calculation and the force loop. The nearest point kernels in
+// findNearestPoints() work on the whole batch, with no virtual calls and no
+// branches in the inner loops for the common kinds of other surface, so the
+// compiler can vectorize them. Batches are reused (see FaceBatchPool) so the
+// arrays stop growing once they have held the largest patch.
+class ContactForceGenerator::ElasticFoundation::FaceBatch {
+public:
+    void gather(const ContactGeometry::TriangleMesh&    mesh,
+                const std::set<int>&                    insideFaces);
+
+    int size() const {return (int)face.size();}
+
+    // Given the spring positions measured in M, set the nearest points on the
+    // other surface O (measured in O) and whether each spring is inside O.
+    void findNearestPoints(const ContactGeometry& other, 
+                           const Transform& X_OM);
+
+    Array_<int>             face;       // mesh face indices, ascending
+    Array_<Real>            px, py, pz; // spring positions, in M
+    Array_<Real>            area;       // face areas
+    Array_<Real>            qx, qy, qz; // nearest points on O, in O
+    Array_<unsigned char>   inside;     // spring penetrates O?
+};
+
+void ContactForceGenerator::ElasticFoundation::FaceBatch::gather
+   (const ContactGeometry::TriangleMesh&    mesh,
+    const std::set<int>&                    insideFaces)
+{
+    face.assign(insideFaces.begin(), insideFaces.end());
+    const int n = size();
+    px.resize(n); py.resize(n); pz.resize(n); area.resize(n);
+    qx.resize(n); qy.resize(n); qz.resize(n); inside.resize(n);
+    const Array_<Vec3>& centroids = mesh.getFaceCentroids();
+    const Array_<Real>& areas = mesh.getFaceAreas();
+    for (int i=0; i < n; ++i) {
+        const Vec3& centroid = centroids[face[i]];
+        px[i] = centroid[0]; py[i] = centroid[1]; pz[i] = centroid[2];
+        area[i] = areas[face[i]];
+    }
+}
+
+// Contact forces may be calculated concurrently, so each calculation borrows
+// its own FaceBatches and returns them when done.
+class ContactForceGenerator::ElasticFoundation::FaceBatchPool {
+public:
+    class Lease {
+    public:
+        explicit Lease(FaceBatchPool& pool)
+        :   pool(pool), batch(pool.acquire()) {}
+        ~Lease() {pool.release(std::move(batch));}
+        FaceBatch& operator*() const {return *batch;}
+    private:
+        FaceBatchPool&              pool;
+        std::unique_ptr<FaceBatch>  batch;
+    };
+
+private:
+    std::unique_ptr<FaceBatch> acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.empty())
+            return std::unique_ptr<FaceBatch>(new FaceBatch());
+        std::unique_ptr<FaceBatch> batch = std::move(idle.back());
+        idle.pop_back();
+        return batch;
+    }
+    void release(std::unique_ptr<FaceBatch> batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(batch));
+    }
+
+    std::mutex                                  mutex;
+    std::vector<std::unique_ptr<FaceBatch>>     idle;
+};
+
+ContactForceGenerator::ElasticFoundation::ElasticFoundation()
+:   ContactForceGenerator(TriangleMeshContact::classTypeId()),
+    m_faceBatches(new FaceBatchPool()) {}
+
+ContactForceGenerator::ElasticFoundation::~ElasticFoundation() {
+    delete m_faceBatches;
+}
+
+void ContactForceGenerator::ElasticFoundation::FaceBatch::findNearestPoints
+   (const ContactGeometry& other, const Transform& X_OM)
+{
+    const int n = size();
+    const Real* const x = px.begin();
+    const Real* const y = py.begin();
+    const Real* const z = pz.begin();
+    Real* const ox = qx.begin();
+    Real* const oy = qy.begin();
+    Real* const oz = qz.begin();
+    unsigned char* const in = inside.begin();
+
+    // Re-express the spring positions in O.              (18 flops/face)
+    const Mat33& R = X_OM.R().asMat33();
+    const Vec3&  p = X_OM.p();
+    const Real r00=R(0,0), r01=R(0,1), r02=R(0,2),
+               r10=R(1,0), r11=R(1,1), r12=R(1,2),
+               r20=R(2,0), r21=R(2,1), r22=R(2,2);
+    const Real p0=p[0], p1=p[1], p2=p[2];
+    for (int i=0; i < n; ++i) {
+        const Real xi=x[i], yi=y[i], zi=z[i];
+        ox[i] = r00*xi + r01*yi + r02*zi + p0;
+        oy[i] = r10*xi + r11*yi + r12*zi + p1;
+        oz[i] = r20*xi + r21*yi + r22*zi + p2;
+    }
+
+    const ContactGeometryTypeId otherType = other.getTypeId();
+    if (otherType == ContactGeometry::HalfSpace::classTypeId()) {
+        // The half space occupies x >= 0; its surface is the x=0 plane.
+        for (int i=0; i < n; ++i) {
+            in[i] = (unsigned char)(ox[i] >= 0);
+            ox[i] = 0;
+        }
+    } else if (otherType == ContactGeometry::Sphere::classTypeId()) {
+        const Real r = ContactGeometry::Sphere::getAs(other).getRadius();
+        const Real r2 = r*r;
+        for (int i=0; i < n; ++i) {
+            const Real d2 = ox[i]*ox[i] + oy[i]*oy[i] + oz[i]*oz[i];
+            in[i] = (unsigned char)(d2 <= r2);
+            const Real scale = r/std::sqrt(d2);
+            ox[i] *= scale; oy[i] *= scale; oz[i] *= scale;
+        }
+    } else if (otherType == ContactGeometry::Ellipsoid::classTypeId()) {
+        // The nearest point on an ellipsoid requires a polynomial root
+        // solve, so classify all the springs first with the cheap implicit
+        // test and solve only for those that are inside.
+        const Vec3& radii = ContactGeometry::Ellipsoid::getAs(other).getRadii();
+        const Real ri0 = 1/square(radii[0]), ri1 = 1/square(radii[1]),
+                   ri2 = 1/square(radii[2]);
+        for (int i=0; i < n; ++i)
+            in[i] = (unsigned char)
+                (ox[i]*ox[i]*ri0 + oy[i]*oy[i]*ri1 + oz[i]*oz[i]*ri2 < 1);
+        for (int i=0; i < n; ++i) {
+            if (!in[i]) continue;
+            bool inside; UnitVec3 normal_O; // not used
+            const Vec3 nearest = 
+                other.findNearestPoint(Vec3(ox[i],oy[i],oz[i]), inside, 
+                                       normal_O);
+            ox[i] = nearest[0]; oy[i] = nearest[1]; oz[i] = nearest[2];
+        }
+    } else {
+        for (int i=0; i < n; ++i) {
+            bool inside; UnitVec3 normal_O; // not used
+            const Vec3 nearest = 
+                other.findNearestPoint(Vec3(ox[i],oy[i],oz[i]), inside, 
+                                       normal_O);
+            in[i] = (unsigned char)inside;
+            ox[i] = nearest[0]; oy[i] = nearest[1]; oz[i] = nearest[2];
+        }
+    }
+}
+
+
+
 void ContactForceGenerator::ElasticFoundation::calcContactForce
    (const State&            state,
     const Contact&          overlap,    // contains X_S1S2
@@ -1613,21 +1776,24 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
     // We want both patches to accumulate forces at the same point in
     // space. For numerical reasons this should be near the center of the
     // patch.
+    // Each mesh's inside faces are gathered once here and used both for the
+    // patch centroid and for the forces.
+    FaceBatchPool::Lease lease1(*m_faceBatches), lease2(*m_faceBatches);
+    FaceBatch& faces1 = *lease1;
+    FaceBatch& faces2 = *lease2;
     Vec3 weightedPatchCentroid1_S1(0), weightedPatchCentroid2_S1(0);
     Real patchArea1 = 0, patchArea2 = 0;
-    if (shape1.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
-        const ContactGeometry::TriangleMesh& mesh1 = 
-            ContactGeometry::TriangleMesh::getAs(shape1);
-
-        calcWeightedPatchCentroid(mesh1, contact.getSurface1Faces(),
+    if (isMesh1) {
+        faces1.gather(ContactGeometry::TriangleMesh::getAs(shape1),
+                      contact.getSurface1Faces());
+        calcWeightedPatchCentroid(faces1, 
                                   weightedPatchCentroid1_S1, patchArea1);
     }
-    if (shape2.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
-        const ContactGeometry::TriangleMesh& mesh2 = 
-            ContactGeometry::TriangleMesh::getAs(shape2);
+    if (isMesh2) {
+        faces2.gather(ContactGeometry::TriangleMesh::getAs(shape2),
+                      contact.getSurface2Faces());
         Vec3 weightedPatchCentroid2_S2;
-
-        calcWeightedPatchCentroid(mesh2, contact.getSurface2Faces(),
+        calcWeightedPatchCentroid(faces2,
                                   weightedPatchCentroid2_S2, patchArea2);
         // Remeasure patch2's weighted centroid from surface1's frame;
         // be sure to weight the new offset also.
@@ -1690,12 +1856,9 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
     Vec3 weightedCOP1_PC_S1(0), weightedCOP2_PC_S1(0); // from patch centroid
     Real weightCOP1=0, weightCOP2=0;
 
-    if (shape1.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
-        const ContactGeometry::TriangleMesh& mesh = 
-            ContactGeometry::TriangleMesh::getAs(shape1);
-
+    if (isMesh1) {
         processOneMesh(state, 
-            mesh, contact.getSurface1Faces(),
+            faces1,
             X_S1S2, V_S1S2, shape2,
             s1, areaScale1,
             kh, c, us, ud, uv,
@@ -1705,10 +1868,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             contactDetails_S1); // details returned if this is non-null
     }
 
-    if (shape2.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
-        const ContactGeometry::TriangleMesh& mesh = 
-            ContactGeometry::TriangleMesh::getAs(shape2);
-
+    if (isMesh2) {
         // Costs 120 flops to flip everything into S2 for processing and
         // then put the results back in S1.
 
@@ -1725,7 +1885,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             wantDetails ? contactDetails_S1->size() : 0;
 
         processOneMesh(state, 
-            mesh, contact.getSurface2Faces(),
+            faces2,
             X_S2S1, V_S2S1, shape1,
             s2, areaScale2,
             kh, c, us, ud, uv,
@@ -1789,19 +1949,19 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
 // The weighted centroid is returned in the mesh surface's own frame.
 void ContactForceGenerator::ElasticFoundation::
 calcWeightedPatchCentroid
-   (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+   (const FaceBatch&                        insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const
 {
-    weightedPatchCentroid = Vec3(0); patchArea = 0;
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter)
-    {   const int  face = *iter;
-        const Real area = mesh.getFaceArea(face);
-        weightedPatchCentroid   += area*mesh.findCentroid(face); 
-        patchArea               += area; 
+    Real wx = 0, wy = 0, wz = 0, a = 0;
+    for (int i=0; i < insideFaces.size(); ++i) {
+        const Real area = insideFaces.area[i];
+        wx += area*insideFaces.px[i];
+        wy += area*insideFaces.py[i];
+        wz += area*insideFaces.pz[i];
+        a  += area;
     }
+    weightedPatchCentroid = Vec3(wx, wy, wz); patchArea = a;
 }
 
 
@@ -1823,8 +1983,7 @@ calcWeightedPatchCentroid
 void ContactForceGenerator::ElasticFoundation::
 processOneMesh
    (const State&                            state,
-    const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    FaceBatch&                              insideFaces,
     const Transform&                        X_MO, 
     const SpatialVec&                       V_MO,
     const ContactGeometry&                  other,
@@ -1839,7 +1998,7 @@ processOneMesh
     Real&                       sumOfAllPressureMoments,   // COP weight
     Array_<ContactDetail>*      contactDetails_M) const    // in/out if present 
 {
-    assert(!insideFaces.empty());
+    assert(insideFaces.size() > 0);
     const bool wantDetails = (contactDetails_M != 0);
 
     // Initialize all results to zero.
@@ -1861,21 +2020,21 @@ processOneMesh
     const Real vtrans   = subsys.getTransitionVelocity();
     const Real ooVtrans = subsys.getOOTransitionVelocity(); // 1/vtrans
 
+    // Find the point on the other surface nearest each spring, for all the
+    // springs at once.
+    insideFaces.findNearestPoints(other, ~X_MO);
+
     // Now loop over all the faces again, evaluate the force from each 
     // spring, and apply it at the patch centroid.
-    // This costs roughly 300 flops per contacting face.
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) 
-    {   const int   face        = *iter;
-        const Vec3  springPos_M = mesh.findCentroid(face);
-        const Real  faceArea    = areaScaleFactor*mesh.getFaceArea(face);
-
-        bool        inside;
-        UnitVec3    normal_O; // not used
-        const Vec3  nearestPoint_O = // 18 flops + cost of findNearestPoint
-            other.findNearestPoint(~X_MO*springPos_M, inside, normal_O);
-        if (!inside)
+    // This costs roughly 280 flops per contacting face.
+    for (int i=0; i < insideFaces.size(); ++i) {
+        if (!insideFaces.inside[i])
             continue;
+        const Vec3 springPos_M(insideFaces.px[i], insideFaces.py[i], 
+                               insideFaces.pz[i]);
+        const Real faceArea = areaScaleFactor*insideFaces.area[i];
+        const Vec3 nearestPoint_O(insideFaces.qx[i], insideFaces.qy[i], 
+                                  insideFaces.qz[i]);
         
         // Although the "spring" is associated with just one surface (the mesh M)
         // it is considered here to include the compression of both surfaces
@@ -1941,7 +2100,7 @@ processOneMesh
         // This will most often occur in to-be-rejected trial steps but can
         // occasionally be real.
         if (fNormal <= 0) {
-            //SimTK_DEBUG1("YANKING!!! (face %d)\n", face);
+            //SimTK_DEBUG1("YANKING!!! (face %d)\n", insideFaces.face[i]);
             continue;
         }
 
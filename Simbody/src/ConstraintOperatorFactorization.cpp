@@ -0,0 +1,180 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ConstraintOperatorFactorization.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SimTK;
+
+namespace {
+
+// Return true if the column-major n X n matrix a is symmetric to within
+// roundoff relative to its largest diagonal element, which must be positive.
+bool isSymmetric(int n, const Real* a) {
+    Real maxDiag = 0;
+    for (int j=0; j < n; ++j)
+        maxDiag = std::max(maxDiag, a[j*n+j]);
+    if (!(maxDiag > 0))
+        return false;
+
+    const Real symTol = SqrtEps*maxDiag;
+    for (int j=0; j < n; ++j)
+        for (int i=j+1; i < n; ++i)
+            if (std::abs(a[j*n+i] - a[i*n+j]) > symTol)
+                return false;
+    return true;
+}
+
+// Replace the lower triangle and diagonal of the symmetric, column-major
+// n X n matrix a by its Cholesky factor L, with a = L*~L; the strict upper
+// triangle is not touched. Returns false without finishing if any pivot falls
+// below minPivotRatio times the largest diagonal element; that is, if the
+// matrix is not safely positive definite. This is left looking so that the
+// inner loops run down contiguous columns.
+bool factorCholesky(int n, Real* a, Real minPivotRatio) {
+    Real maxDiag = 0;
+    for (int j=0; j < n; ++j)
+        maxDiag = std::max(maxDiag, a[j*n+j]);
+
+    const Real minPivot = minPivotRatio*maxDiag;
+    for (int j=0; j < n; ++j) {
+        Real* colj = a + j*n;
+        for (int k=0; k < j; ++k) {
+            const Real* colk = a + k*n;
+            const Real ljk = colk[j];
+            for (int i=j; i < n; ++i)
+                colj[i] -= ljk*colk[i];
+        }
+        if (!(colj[j] > minPivot))
+            return false;
+        const Real ljj = std::sqrt(colj[j]);
+        colj[j] = ljj;
+        const Real oojj = 1/ljj;
+        for (int i=j+1; i < n; ++i)
+            colj[i] *= oojj;
+    }
+    return true;
+}
+
+// Solve L*~L x = x in place given the factor from factorCholesky().
+void solveCholesky(int n, const Real* l, Real* x) {
+    for (int j=0; j < n; ++j) {
+        const Real* colj = l + j*n;
+        const Real xj = (x[j] /= colj[j]);
+        for (int i=j+1; i < n; ++i)
+            x[i] -= colj[i]*xj;
+    }
+    for (int j=n-1; j >= 0; --j) {
+        const Real* colj = l + j*n;
+        Real sum = x[j];
+        for (int i=j+1; i < n; ++i)
+            sum -= colj[i]*x[i];
+        x[j] = sum/colj[j];
+    }
+}
+
+}
+
+void ConstraintOperatorFactorization::
+setBlocks(const Array_<int>& blockOfEquation, int numBlocks) {
+    numEquations = (int)blockOfEquation.size();
+    blocks.resize(numBlocks);
+    for (Block& block : blocks)
+        block.equations.clear();
+    for (int i=0; i < numEquations; ++i)
+        blocks[blockOfEquation[i]].equations.push_back(i);
+    for (Block& block : blocks) {
+        const int n = (int)block.equations.size();
+        block.matrix.resize(n, n);
+        block.useCholesky = false;
+    }
+}
+
+int ConstraintOperatorFactorization::getMaxBlockSize() const {
+    int maxSize = 0;
+    for (const Block& block : blocks)
+        maxSize = std::max(maxSize, (int)block.equations.size());
+    return maxSize;
+}
+
+int ConstraintOperatorFactorization::getNumCholeskyBlocks() const {
+    int n = 0;
+    for (const Block& block : blocks)
+        if (block.useCholesky) ++n;
+    return n;
+}
+
+void ConstraintOperatorFactorization::
+factorBlock(int b, Real conditioningTol) {
+    Block& block = blocks[b];
+    const int n = (int)block.equations.size();
+    if (n == 0) {block.useCholesky = true; return;}
+
+    // A Cholesky pivot below conditioningTol times the largest diagonal
+    // element is where QTZ would start to drop rank. The factorization works
+    // in place but leaves the strict upper triangle alone, so if we have to
+    // fall back to QTZ the block is rebuilt from that and the saved diagonal.
+    Real* a = block.matrix.updContiguousScalarData();
+    block.useCholesky = false;
+    if (isSymmetric(n, a)) {
+        block.diagonal.resize(n);
+        for (int j=0; j < n; ++j)
+            block.diagonal[j] = a[j*n+j];
+        block.useCholesky = factorCholesky(n, a, conditioningTol);
+        if (!block.useCholesky) {
+            for (int j=0; j < n; ++j) {
+                a[j*n+j] = block.diagonal[j];
+                for (int i=j+1; i < n; ++i)
+                    a[j*n+i] = a[i*n+j];
+            }
+        }
+    }
+    if (!block.useCholesky)
+        block.qtz.factor<Real>(block.matrix, conditioningTol);
+}
+
+void ConstraintOperatorFactorization::
+solve(const Vector& rhs, Vector& x) const {
+    assert(rhs.size() == numEquations);
+    x.resize(numEquations);
+    Vector blockRhs, blockX;
+    for (const Block& block : blocks) {
+        const int n = (int)block.equations.size();
+        if (n == 0) continue;
+        blockRhs.resize(n);
+        for (int i=0; i < n; ++i)
+            blockRhs[i] = rhs[block.equations[i]];
+        if (block.useCholesky) {
+            solveCholesky(n, block.matrix.getContiguousScalarData(),
+                          blockRhs.updContiguousScalarData());
+            for (int i=0; i < n; ++i)
+                x[block.equations[i]] = blockRhs[i];
+        } else {
+            block.qtz.solve(blockRhs, blockX);
+            for (int i=0; i < n; ++i)
+                x[block.equations[i]] = blockX[i];
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef SimTK_SIMBODY_CONSTRAINT_OPERATOR_FACTORIZATION_H_
+#define SimTK_SIMBODY_CONSTRAINT_OPERATOR_FACTORIZATION_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This file declares the ConstraintOperatorFactorization class, which holds
+// the factored constraint operator G*M^-1*~G in the matter subsystem's State
+// cache. This is internal source, not part of the Simbody API.
+
+#include "SimTKmath.h"
+
+namespace SimTK {
+
+//==============================================================================
+//                    CONSTRAINT OPERATOR FACTORIZATION
+//==============================================================================
+// G*M^-1*~G is block diagonal (after permutation) when the constraint
+// equations fall into groups that share no mobilized body subtree: M^-1 does
+// not couple mobilities in different subtrees of Ground, so neither does the
+// product. We keep one dense block per group of equations and factor each
+// separately. A block that is symmetric and comfortably positive definite is
+// factored by Cholesky; anything else (redundant constraints, a nonsymmetric
+// force transmission) falls back to the rank-revealing FactorQTZ that Simbody
+// has always used, so redundant constraints are treated as before.
+//
+// The matter subsystem fills in the blocks (see calcGMInvGtBlocks()), calls
+// factorBlock() for each, and then uses solve() as often as it likes until
+// the positions (or, for velocity-dependent constraints, the velocities)
+// change.
+class ConstraintOperatorFactorization {
+public:
+    ConstraintOperatorFactorization() : numEquations(0), uVersion(-1) {}
+
+    // Partition the constraint equations into numBlocks groups; equation i
+    // goes into block blockOfEquation[i]. Within a block the equations keep
+    // their relative order. Block storage is reused if the sizes don't change.
+    void setBlocks(const Array_<int>& blockOfEquation, int numBlocks);
+
+    int getNumEquations() const {return numEquations;}
+    int getNumBlocks() const {return (int)blocks.size();}
+    int getMaxBlockSize() const;
+
+    // The global indices of the constraint equations in block b.
+    const Array_<int>& getBlockEquations(int b) const
+    {   return blocks[b].equations; }
+
+    // The square block of G*M^-1*~G for block b, already sized; fill it in
+    // and then call factorBlock(b).
+    Matrix& updBlockMatrix(int b) {return blocks[b].matrix;}
+
+    // Factor block b in place. conditioningTol is the reciprocal condition
+    // number below which constraints are considered redundant.
+    void factorBlock(int b, Real conditioningTol);
+
+    bool isCholeskyBlock(int b) const {return blocks[b].useCholesky;}
+    int getNumCholeskyBlocks() const;
+
+    // Solve (G*M^-1*~G) x = rhs, where rhs and x have one entry per
+    // constraint equation. x is resized if necessary.
+    void solve(const Vector& rhs, Vector& x) const;
+
+    // The u version of the State when this was factored, if the operator
+    // depends on u; otherwise -1.
+    ValueVersion getUVersion() const {return uVersion;}
+    void setUVersion(ValueVersion version) {uVersion = version;}
+
+private:
+    struct Block {
+        Block() : useCholesky(false) {}
+        Array_<int> equations;
+        Matrix      matrix;      // the block; its Cholesky factor if useCholesky
+        Vector      diagonal;    // saved while attempting Cholesky
+        FactorQTZ   qtz;         // used only if !useCholesky
+        bool        useCholesky;
+    };
+
+    Array_<Block>   blocks;
+    int             numEquations;
+    ValueVersion    uVersion;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_CONSTRAINT_OPERATOR_FACTORIZATION_H_
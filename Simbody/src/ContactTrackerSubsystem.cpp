@@ -32,6 +32,10 @@ using std::pair; using std::make_pair;
 #include <iostream>
 using std::cout; using std::endl;
 #include <set>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using namespace SimTK;
 
@@ -67,54 +71,90 @@ static std::ostream& operator<<(std::ostream& o, const Bubble& bb) {
     return o;
 }
 
-// For spatial sorting of bubbles.
-class BubbleExtent {
-public:
-    BubbleExtent(Real start, Real end, BubbleIndex index) 
-    :   start(start), end(end), index(index) {}
-    BubbleExtent() {}
-    bool operator<(const BubbleExtent& e) const 
-    {   return start < e.start; }
-    Real        start, end; // span along chosen sort axis
-    BubbleIndex index;
+typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
+                  pair<ContactTracker*,bool> > TrackerMap;
+
+// A pair of contact surfaces that might be touching, with the lower numbered
+// surface first so that any given pair of surfaces appears just once, and a 
+// pointer to that pair's Contact object if it is currently being tracked 
+// (null if it is new). However, the surface order in the Contact object will 
+// be determined by the order required by the corresponding tracker. Lists of
+// these are kept sorted by surface indices.
+struct InterestingPair {
+    InterestingPair(ContactSurfaceIndex low, ContactSurfaceIndex high,
+                    const Contact* contact)
+    :   low(low), high(high), contact(contact) {}
+    InterestingPair() {}
+    bool operator<(const InterestingPair& other) const 
+    {   return low < other.low || (low == other.low && high < other.high); }
+    bool operator==(const InterestingPair& other) const
+    {   return low == other.low && high == other.high; }
+
+    ContactSurfaceIndex low, high;
+    const Contact*      contact;
 };
-static std::ostream& operator<<(std::ostream& o, const BubbleExtent& bx) {
-    o << bx.index << ":(" << bx.start << "," << bx.end << ")";
+static std::ostream& operator<<(std::ostream& o, const InterestingPair& ip) {
+    o << ip.low << "," << ip.high << ":0x" << ip.contact;
     return o;
 }
 
-typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
-                  pair<ContactTracker*,bool> > TrackerMap;
+// Working storage for one update of the active contacts. The BroadPhase
+// object remembers its previous spatial sort, which makes the next search
+// faster but never changes its result, so it need not stay with any one
+// State; the arrays are kept only to reuse their heap space.
+struct BroadPhaseWorkspace {
+    explicit BroadPhaseWorkspace(BroadPhase::Method method) 
+    :   broadPhase(method) {}
 
-// This type maps a contact surface onto a set of all the higher-numbered
-// contact surfaces it might be touching, and for each of those we keep
-// a pointer to that pair's Contact object if it is currently being tracked
-// (null if it is new). You must use the *lower* numbered surface as the key 
-// when inserting a pair so that any given pair of surfaces appears just once.
-// However, the surface order in the Contact object will be determined by
-// the order required by the corresponding tracker.
-// TODO: replace with a fast data structure
-typedef std::map<ContactSurfaceIndex,const Contact*> ContactSurfaceSet;
-typedef std::map<ContactSurfaceIndex,ContactSurfaceSet> PairMap;
-
-std::ostream& operator<<(std::ostream& o, const ContactSurfaceSet& css) {
-    ContactSurfaceSet::const_iterator p = css.begin();
-    o << "{";
-    for (; p != css.end(); ++p) {
-        if (p!=css.begin()) o << ", ";
-        o << p->first << ":0x" << p->second;
-    }
-    return o << "}";
-}
+    BroadPhase                      broadPhase;
+    Array_<Geo::AlignedBox>         boxes;          // one per bubble, in G
+    Array_<BroadPhase::IndexPair>   bubblePairs;    // overlapping boxes
+    Array_<InterestingPair>         interesting;
+};
 
-std::ostream& operator<<(std::ostream& o, const PairMap& pm) {
-    PairMap::const_iterator p = pm.begin();
-    for (; p != pm.end(); ++p) {
-        if (p != pm.begin()) o << endl;
-        o << p->first << "->" << p->second;
+// States may be realized concurrently, so each update borrows its own
+// BroadPhaseWorkspace and returns it when done. The workspaces belong to the
+// subsystem rather than to any State, so copying a State doesn't copy them.
+class BroadPhaseWorkspacePool {
+public:
+    BroadPhaseWorkspacePool() = default;
+    // A copy starts out empty.
+    BroadPhaseWorkspacePool(const BroadPhaseWorkspacePool&) {}
+    BroadPhaseWorkspacePool& operator=(const BroadPhaseWorkspacePool&)
+        = delete;
+
+    class Lease {
+    public:
+        Lease(BroadPhaseWorkspacePool& pool, BroadPhase::Method method)
+        :   pool(pool), workspace(pool.acquire(method)) {}
+        ~Lease() {pool.release(std::move(workspace));}
+        BroadPhaseWorkspace& operator*() const {return *workspace;}
+    private:
+        BroadPhaseWorkspacePool&                pool;
+        std::unique_ptr<BroadPhaseWorkspace>    workspace;
+    };
+
+private:
+    std::unique_ptr<BroadPhaseWorkspace> acquire(BroadPhase::Method method) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.empty())
+            return std::unique_ptr<BroadPhaseWorkspace>
+                (new BroadPhaseWorkspace(method));
+        std::unique_ptr<BroadPhaseWorkspace> workspace = 
+            std::move(idle.back());
+        idle.pop_back();
+        if (workspace->broadPhase.getMethod() != method)
+            workspace->broadPhase.setMethod(method);
+        return workspace;
     }
-    return o;
-}
+    void release(std::unique_ptr<BroadPhaseWorkspace> workspace) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(workspace));
+    }
+
+    std::mutex                                          mutex;
+    std::vector<std::unique_ptr<BroadPhaseWorkspace>>   idle;
+};
 
 } // end of anonymous namespace
 
@@ -126,7 +166,9 @@ class ContactTrackerSubsystemImpl : public Subsystem::Guts {
 public:
 // Constructor registers a default set of Trackers to use with geometry
 // we know about. These can be overridden later.
-ContactTrackerSubsystemImpl() : m_defaultTracker(0) {
+ContactTrackerSubsystemImpl() 
+:   m_defaultTracker(0), 
+    m_broadPhaseMethod(BroadPhase::DynamicAABBTree) {
     adoptContactTracker(new ContactTracker::HalfSpaceSphere());
     adoptContactTracker(new ContactTracker::SphereSphere());
     adoptContactTracker(new ContactTracker::HalfSpaceEllipsoid());
@@ -208,6 +250,24 @@ ContactSnapshot& updNextPredictedContacts(const State& state) const {
         (updDiscreteVarUpdateValue(state, m_predictedContactsIx));
     return contacts;
 }
+void setBroadPhaseMethod(BroadPhase::Method method) {
+    m_broadPhaseMethod = method;
+    invalidateSubsystemTopologyCache();
+}
+BroadPhase::Method getBroadPhaseMethod() const {return m_broadPhaseMethod;}
+
+void setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ContactTrackerSubsystem",
+                "setNumberOfThreads", "Number of threads must be positive");
+    if (numThreads == 1)
+        m_broadPhaseExecutor.reset();
+    else
+        m_broadPhaseExecutor = new ParallelExecutor(numThreads);
+}
+int getNumberOfThreads() const {
+    return m_broadPhaseExecutor.empty() 
+        ? 1 : m_broadPhaseExecutor->getMaxThreads();
+}
 
 // Run through all the bodies to find the contact surfaces, assigning each
 // a unique ContactSurfaceIndex. Then for each surface, get its geometry
@@ -274,84 +334,51 @@ int realizeSubsystemVelocityImpl(const State& state) const override {
     return 0;
 }
 
-// Adds new pairs to the existing set, if not already present.
-void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
+// Appends the pairs of surfaces whose bubbles overlap to the workspace's list
+// of interesting pairs, in sorted order. Pairs of surfaces on the same body or in
+// a common clique are omitted. Bubbles are numbered in the same order as their
+// surfaces so the broad phase's sorted bubble pairs are sorted surface pairs.
+void addInBroadPhasePairs(const State& state,
+                          BroadPhaseWorkspace& workspace) const {
     const int numBubbles = getNumBubbles();
-    
-    // Perform a sweep-and-prune on a single axis to identify potential 
-    // contacts. First, find which axis has the most variation in body 
-    // locations. That is the axis we will use.
-    // TODO: this one-axis method is not good enough in general
-    
-    Vector_<Vec3> centers(numBubbles);
+
+    // The broad phase works with axis-aligned boxes in Ground, which we 
+    // refine below with the actual bubble spheres.
+    workspace.boxes.resize(numBubbles);
     for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
         const Bubble&  bubb = m_bubbles[bbx];
         const Surface& surf = m_surfaces[bubb.surface];
-        centers[bbx] = surf.mobod->getBodyTransform(state) 
-                        * bubb.getCenter();
+        workspace.boxes[bbx] = Geo::AlignedBox
+           (surf.mobod->getBodyTransform(state) * bubb.getCenter(),
+            Vec3(bubb.getRadius()));
     }
-    Vec3 average = mean(centers);
-    Vec3 var(0);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx)
-        var += abs(centers[bbx]-average);
-    int axis = (var[0] > var[1] ? 0 : 1);
-    if (var[2] > var[axis])
-        axis = 2;
-    
-    // Find the extent of each bubble along the axis and sort them by 
-    // starting location.
-    Array_<BubbleExtent,int> extents(numBubbles);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
-        const Real radius = m_bubbles[bbx].getRadius();
-        const Real center = centers[bbx][axis];
-        extents[bbx] = BubbleExtent(center-radius, center+radius, bbx);
-    }
-    //cout << "Bubble extents:" << extents << "\n";
-
-    // Expensive: O(n log n)
-    std::sort(extents.begin(), extents.end());
-    
-    // Now sweep along the axis, finding potential contacts.
-    
-    for (int ex1=0; ex1 < numBubbles; ++ex1) {
-        const BubbleExtent& extent1 = extents[ex1];
-        const Bubble&       bubb1   = m_bubbles[extent1.index];
-        const Real          radius1 = bubb1.getRadius();
-        const Vec3&         center1 = centers[extent1.index];
-
-        // Loop over just the overlapping bubbles.
-        for (int ex2(ex1+1); ex2 < numBubbles; ++ex2) {
-            const BubbleExtent& extent2 = extents[ex2];
-            if (extent2.start > extent1.end)
-                break;  // no more bubbles can overlap with extent1
-
-            // These bubbles do overlap along this axis. See if they are
-            // actually touching.
-            const Bubble& bubb2   = m_bubbles[extent2.index];
-            const Real    radius2 = bubb2.getRadius();
-            const Vec3&   center2 = centers[extent2.index];
-            if ((center1-center2).normSqr() > square(radius1+radius2))
-                continue; // nope
-
-            // The bubbles are touching. We'll add the corresponding surfaces
-            // to the narrow-phase list unless there are relevant exclusions.
-            const Surface& surf1 = m_surfaces[bubb1.surface];
-            const Surface& surf2 = m_surfaces[bubb2.surface];
-            // Ignore if on the same body.
-            if (surf1.mobod == surf2.mobod) continue;
-            assert(bubb1.surface != bubb2.surface); // duh!
-            // Ignore if surfaces are in a common clique.
-            if (surf1.surface->isInSameClique(*surf2.surface)) continue;
-            // We'll need to do a narrow phase investigation of these two
-            // surfaces; use the lower-numbered one as the index to avoid
-            // duplicates.
-            ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
-            if (low > high) std::swap(low,high);
-            ContactSurfaceSet& surfSet = pairs[low];
-            // Insert this pair with null Contact if the pair isn't already
-            // in the PairMap.
-            surfSet.insert(make_pair(high,(Contact*)0));
-        }
+
+    workspace.broadPhase.findOverlappingPairs(workspace.boxes, workspace.bubblePairs,
+                                          m_broadPhaseExecutor.upd());
+
+    for (const BroadPhase::IndexPair& bubblePair : workspace.bubblePairs) {
+        const BubbleIndex bbx1(bubblePair.first), bbx2(bubblePair.second);
+        const Bubble& bubb1 = m_bubbles[bbx1];
+        const Bubble& bubb2 = m_bubbles[bbx2];
+        // The boxes overlap. See if the bubbles are actually touching.
+        const Vec3& center1 = workspace.boxes[bbx1].getCenter();
+        const Vec3& center2 = workspace.boxes[bbx2].getCenter();
+        if ((center1-center2).normSqr() 
+                > square(bubb1.getRadius()+bubb2.getRadius()))
+            continue; // nope
+
+        // The bubbles are touching. We'll add the corresponding surfaces
+        // to the narrow-phase list unless there are relevant exclusions.
+        const Surface& surf1 = m_surfaces[bubb1.surface];
+        const Surface& surf2 = m_surfaces[bubb2.surface];
+        // Ignore if on the same body.
+        if (surf1.mobod == surf2.mobod) continue;
+        assert(bubb1.surface != bubb2.surface); // duh!
+        // Ignore if surfaces are in a common clique.
+        if (surf1.surface->isInSameClique(*surf2.surface)) continue;
+        ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
+        if (low > high) std::swap(low,high);
+        workspace.interesting.push_back(InterestingPair(low, high, nullptr));
     }
 }
 
@@ -384,92 +411,102 @@ void ensureActiveContactsUpdated(const State& state) const {
     // TODO: Can we reuse heap space in this cache entry?
     nextActive.clear();
 
-    PairMap interesting;
+    BroadPhaseWorkspacePool::Lease lease(m_broadPhaseWorkspaces,
+                                         m_broadPhaseMethod);
+    BroadPhaseWorkspace& workspace = *lease;
+    Array_<InterestingPair>& interesting = workspace.interesting;
+    interesting.clear();
     for (int i=0; i < active.getNumContacts(); ++i) {
         const Contact& contact = active.getContact(i);
         ContactSurfaceIndex low=contact.getSurface1(), 
                             high=contact.getSurface2();
         if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        interesting.push_back(InterestingPair(low, high, &contact));
     }
     for (int i=0; i < predicted.getNumContacts(); ++i) {
         const Contact& contact = predicted.getContact(i);
         ContactSurfaceIndex low=contact.getSurface1(), 
                             high=contact.getSurface2();
         if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        interesting.push_back(InterestingPair(low, high, &contact));
     }
-    // This will ignore pairs that we already inserted above; new ones
-    // will be inserted with null Contact object pointers.
-    addInBroadPhasePairs(state, interesting);
+    const int numTracked = interesting.size();
+    std::sort(interesting.begin(), interesting.end());
+    assert(std::adjacent_find(interesting.begin(), interesting.end())
+           == interesting.end());
+
+    // The broad phase pairs are appended in sorted order with null Contact 
+    // object pointers. Merge the two sorted runs, preferring the tracked
+    // entry when a pair appears in both so that we keep its Contact.
+    addInBroadPhasePairs(state, workspace);
+    assert(std::is_sorted(interesting.begin()+numTracked, interesting.end()));
+    std::inplace_merge(interesting.begin(), interesting.begin()+numTracked,
+                       interesting.end());
+    interesting.erase(std::unique(interesting.begin(), interesting.end()),
+                      interesting.end());
     //cout << "Interesting pairs:\n" << interesting << "\n";
 
-    PairMap::const_iterator p = interesting.begin();
-    for (; p != interesting.end(); ++p) {
-        const ContactSurfaceIndex index1 = p->first;
-        const Transform transform1 = 
-            m_surfaces[index1].mobod->getBodyTransform(state)
-                * m_surfaces[index1].X_BS;
-        const ContactGeometry& geom1 = m_surfaces[index1].surface->getShape();
-        const ContactGeometryTypeId typeId1 = geom1.getTypeId();
-
-        const ContactSurfaceSet& others = p->second;
-        ContactSurfaceSet::const_iterator q = others.begin();
-        for (; q != others.end(); ++q) {
-            const ContactSurfaceIndex index2 = q->first;
-            const Transform transform2 = 
-                m_surfaces[index2].mobod->getBodyTransform(state)
-                    * m_surfaces[index2].X_BS;
-            const ContactGeometry& geom2 = 
-                m_surfaces[index2].surface->getShape();
-            const ContactGeometryTypeId typeId2 = geom2.getTypeId();
-            if (!hasContactTracker(typeId1,typeId2))
-                continue; // No algorithm available for detecting collisions between these two objects.
-            bool mustReverse;
-            const ContactTracker& tracker = 
-                getContactTracker(typeId1, typeId2, mustReverse);
-
-            // Put the surfaces in the order required by the tracker.
-            const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
-            const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
-
-            UntrackedContact untracked; // empty handle in case we need it
-            const Contact* prev = q->second;
-            if (prev && prev->getCondition() == Contact::Broken)
-                prev = 0; // that contact expired
-            if (!prev) { 
-                untracked = UntrackedContact(trackSurf1, trackSurf2);
-                prev = &untracked;
-            }
-            Contact next; // empty handle
-            if (mustReverse)
-                tracker.trackContact
-                   (*prev, transform2,geom2, transform1,geom1, 0/*TODO*/, next);
-            else
-                tracker.trackContact
-                   (*prev, transform1,geom1, transform2,geom2, 0/*TODO*/, next);
-
-            if (!next.isEmpty()) {
-                next.setSurfaces(trackSurf1,trackSurf2);
-                next.setContactId(prev->getCondition()==Contact::Untracked
-                                    ? Contact::createNewContactId()
-                                    : prev->getContactId()); // persistent
-                if (   prev->getCondition()==Contact::Untracked
-                    || prev->getCondition()==Contact::Anticipated)
-                    next.setCondition(Contact::NewContact);
-                else { // was NewContact or Ongoing; now Ongoing or Broken
-                    assert(prev->getCondition()==Contact::NewContact
-                           || prev->getCondition()==Contact::Ongoing);
-                    if (next.getTypeId() != BrokenContact::classTypeId())
-                        next.setCondition(Contact::Ongoing);
-                    // Condition will already by Broken for a BrokenContact
-                }
-                nextActive.adoptContact(next);
+    ContactSurfaceIndex index1; // invalid
+    Transform transform1;
+    const ContactGeometry* geom1 = nullptr;
+    ContactGeometryTypeId typeId1;
+    for (const InterestingPair& pair : interesting) {
+        if (pair.low != index1) {
+            index1 = pair.low;
+            transform1 = m_surfaces[index1].mobod->getBodyTransform(state)
+                            * m_surfaces[index1].X_BS;
+            geom1 = &m_surfaces[index1].surface->getShape();
+            typeId1 = geom1->getTypeId();
+        }
+        const ContactSurfaceIndex index2 = pair.high;
+        const Transform transform2 = 
+            m_surfaces[index2].mobod->getBodyTransform(state)
+                * m_surfaces[index2].X_BS;
+        const ContactGeometry& geom2 = 
+            m_surfaces[index2].surface->getShape();
+        const ContactGeometryTypeId typeId2 = geom2.getTypeId();
+        if (!hasContactTracker(typeId1,typeId2))
+            continue; // No algorithm available for detecting collisions between these two objects.
+        bool mustReverse;
+        const ContactTracker& tracker = 
+            getContactTracker(typeId1, typeId2, mustReverse);
+
+        // Put the surfaces in the order required by the tracker.
+        const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
+        const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
+
+        UntrackedContact untracked; // empty handle in case we need it
+        const Contact* prev = pair.contact;
+        if (prev && prev->getCondition() == Contact::Broken)
+            prev = 0; // that contact expired
+        if (!prev) { 
+            untracked = UntrackedContact(trackSurf1, trackSurf2);
+            prev = &untracked;
+        }
+        Contact next; // empty handle
+        if (mustReverse)
+            tracker.trackContact
+               (*prev, transform2,geom2, transform1,*geom1, 0/*TODO*/, next);
+        else
+            tracker.trackContact
+               (*prev, transform1,*geom1, transform2,geom2, 0/*TODO*/, next);
+
+        if (!next.isEmpty()) {
+            next.setSurfaces(trackSurf1,trackSurf2);
+            next.setContactId(prev->getCondition()==Contact::Untracked
+                                ? Contact::createNewContactId()
+                                : prev->getContactId()); // persistent
+            if (   prev->getCondition()==Contact::Untracked
+                || prev->getCondition()==Contact::Anticipated)
+                next.setCondition(Contact::NewContact);
+            else { // was NewContact or Ongoing; now Ongoing or Broken
+                assert(prev->getCondition()==Contact::NewContact
+                       || prev->getCondition()==Contact::Ongoing);
+                if (next.getTypeId() != BrokenContact::classTypeId())
+                    next.setCondition(Contact::Ongoing);
+                // Condition will already by Broken for a BrokenContact
             }
+            nextActive.adoptContact(next);
         }
     }
 
@@ -581,6 +618,10 @@ friend class ContactTrackerSubsystem;
 // delete it when replacing or destructing.
 TrackerMap          m_contactTrackers;
 ContactTracker*     m_defaultTracker;
+BroadPhase::Method  m_broadPhaseMethod;
+// Null when the broad phase is to run in the calling thread.
+mutable ClonePtr<ParallelExecutor> m_broadPhaseExecutor;
+mutable BroadPhaseWorkspacePool    m_broadPhaseWorkspaces;
 
     // TOPOLOGY CACHE
 // The pair is the first assigned index, and the number of contact surfaces
@@ -669,6 +710,19 @@ getContactTracker(ContactGeometryTypeId surface1,
                   bool& reverseOrder) const
 {   return getImpl().getContactTracker(surface1,surface2,reverseOrder); }
 
+void ContactTrackerSubsystem::
+setBroadPhaseMethod(BroadPhase::Method method)
+{   updImpl().setBroadPhaseMethod(method); }
+
+BroadPhase::Method ContactTrackerSubsystem::getBroadPhaseMethod() const
+{   return getImpl().getBroadPhaseMethod(); }
+
+void ContactTrackerSubsystem::setNumberOfThreads(unsigned numThreads)
+{   updImpl().setNumberOfThreads(numThreads); }
+
+int ContactTrackerSubsystem::getNumberOfThreads() const
+{   return getImpl().getNumberOfThreads(); }
+
 const ContactSnapshot& ContactTrackerSubsystem::
 getPreviousActiveContacts(const State& state) const
 {   return getImpl().getPrevActiveContacts(state); }
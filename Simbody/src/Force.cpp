@@ -350,6 +350,18 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
                              frc, mobilityForces);
 }
 
+// Like calcForce(), this assumes that this q's qdot is its u.
+bool Force::MobilityLinearSpringImpl::
+calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                             Matrix& dFdU) const
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const int qx = mb.getFirstQIndex(state) + m_whichQ;
+    const int ux = mb.getFirstUIndex(state) + m_whichQ;
+    dFdQ(ux, qx) -= getParams(state).first; // -k
+    return true;
+}
+
 Real Force::MobilityLinearSpringImpl::
 calcPotentialEnergy(const State& state) const {
     const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
@@ -442,6 +454,16 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     mb.applyOneMobilityForce(state, m_whichU, frc, mobilityForces);
 }
 
+bool Force::MobilityLinearDamperImpl::
+calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                             Matrix& dFdU) const
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const int ux = mb.getFirstUIndex(state) + m_whichU;
+    dFdU(ux, ux) -= getDamping(state);
+    return true;
+}
+
 Real Force::MobilityLinearDamperImpl::
 calcPotentialEnergy(const State& state) const {
     return 0;
@@ -663,6 +685,39 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     }
 }
 
+// Differentiate the force calculated above, including the clamping that
+// prevents the dissipation from making the stop sticky. Like calcForce(),
+// this assumes that this q's qdot is its u.
+bool Force::MobilityLinearStopImpl::
+calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                             Matrix& dFdU) const
+{
+    const Parameters& param = getParameters(state);
+    if (param.k == 0) return true;
+
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const Real q = mb.getOneQ(state, m_whichQ);
+    const Real qdot = param.d != 0 ? mb.getOneQDot(state, m_whichQ) 
+                                   : Real(0);
+    const int qx = mb.getFirstQIndex(state) + m_whichQ;
+    const int ux = mb.getFirstUIndex(state) + m_whichQ;
+
+    if (q > param.qHigh) {
+        const Real x = q-param.qHigh;
+        if (1+param.d*qdot > 0) { // fraw > 0, so force is -fraw
+            dFdQ(ux, qx) -= param.k*(1+param.d*qdot);
+            dFdU(ux, ux) -= param.k*x*param.d;
+        }
+    } else if (q < param.qLow) {
+        const Real x = q-param.qLow;
+        if (1-param.d*qdot > 0) { // fraw < 0, so force is -fraw
+            dFdQ(ux, qx) -= param.k*(1-param.d*qdot);
+            dFdU(ux, ux) += param.k*x*param.d;
+        }
+    }
+    return true;
+}
+
 Real Force::MobilityLinearStopImpl::
 calcPotentialEnergy(const State& state) const {
     const Parameters& param = getParameters(state);
@@ -997,6 +1052,13 @@ void Force::GlobalDamperImpl::calcForce(const State& state, Vector_<SpatialVec>&
     mobilityForces -= damping*matter.getU(state);
 }
 
+bool Force::GlobalDamperImpl::
+calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                             Matrix& dFdU) const {
+    dFdU.diag() -= damping;
+    return true;
+}
+
 Real Force::GlobalDamperImpl::calcPotentialEnergy(const State& state) const {
     return 0;
 }
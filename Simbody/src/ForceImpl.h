@@ -52,6 +52,20 @@ public:
     virtual bool shouldBeParallelIfPossible() const{
         return false;
     }
+    // Estimated calcForce() time in seconds, or 0 if GeneralForceSubsystem
+    // should measure it.
+    virtual Real getCostHint() const {
+        return 0;
+    }
+    // Optionally append the bodies and mobilities whose entries of the
+    // calcForce() arrays may change in this State, and return true. False
+    // means any entry may change.
+    virtual bool findAffectedBodiesAndMobilities
+       (const State&                 state,
+        Array_<MobilizedBodyIndex>&  bodies,
+        Array_<UIndex>&              mobilities) const {
+        return false;
+    }
     ForceIndex getForceIndex() const {return index;}
     const GeneralForceSubsystem& getForceSubsystem() const 
     {   assert(forces); return *forces; }
@@ -71,6 +85,18 @@ public:
                            Vector&              mobilityForces) const = 0;
     virtual Real calcPotentialEnergy(const State& state) const = 0;
 
+    // Optionally *add in* this force element's partial derivatives of the
+    // mobility forces with respect to q (nu X nq) and u (nu X nu). Return 
+    // false if the element can't do that; then the System's Jacobian will 
+    // have to be found by finite differences. An element whose forces are 
+    // smooth and weak enough not to matter to an implicit integrator's 
+    // Newton iteration may return true without adding anything.
+    virtual bool calcMobilityForceDerivatives(const State& state, 
+                                              Matrix& dFdQ, 
+                                              Matrix& dFdU) const {
+        return false;
+    }
+
     virtual void realizeTopology    (State& state) const {}
     virtual void realizeModel       (State& state) const {}
     virtual void realizeInstance    (const State& state) const {}
@@ -208,6 +234,8 @@ friend class MobilityLinearSpring;
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override;
 
     // Allocate the discrete state variable for the parameters. 
     void realizeTopology(State& s) const override {
@@ -258,6 +286,8 @@ friend class MobilityLinearDamper;
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override;
 
     // Allocate the discrete state variable for the parameters. 
     void realizeTopology(State& s) const override {
@@ -315,6 +345,8 @@ friend class MobilityConstantForce;
                    override;
 
     Real calcPotentialEnergy(const State& state) const override {return 0;}
+    bool calcMobilityForceDerivatives(const State&, Matrix&, 
+                                      Matrix&) const override {return true;}
 
     // Allocate the discrete state variable for the force. 
     void realizeTopology(State& s) const override {
@@ -373,6 +405,8 @@ friend class MobilityLinearStop;
 
     // We're not bothering to cache P.E. -- just recalculate it when asked.
     Real calcPotentialEnergy(const State& state) const override; 
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override;
 
     // Allocate the state variables and cache entry. 
     void realizeTopology(State& s) const override {
@@ -520,6 +554,10 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    // Constant in Ground; the q-dependence of the resulting mobility forces
+    // is smooth so we leave it out of the Jacobian.
+    bool calcMobilityForceDerivatives(const State&, Matrix&, 
+                                      Matrix&) const override {return true;}
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body;
@@ -542,6 +580,10 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    // Constant in Ground; the q-dependence of the resulting mobility forces
+    // is smooth so we leave it out of the Jacobian.
+    bool calcMobilityForceDerivatives(const State&, Matrix&, 
+                                      Matrix&) const override {return true;}
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body;
@@ -561,6 +603,8 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override;
 private:
     const SimbodyMatterSubsystem& matter;
     Real damping;
@@ -579,6 +623,10 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    // Constant in Ground; the q-dependence of the resulting mobility forces
+    // is smooth so we leave it out of the Jacobian.
+    bool calcMobilityForceDerivatives(const State&, Matrix&, 
+                                      Matrix&) const override {return true;}
     Vec3 getGravity() const {
         return g;
     }
@@ -617,9 +665,23 @@ public:
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) 
                    const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override {
+        return implementation->calcMobilityForceDerivatives(state,dFdQ,dFdU);
+    }
     bool shouldBeParallelIfPossible() const override {
         return implementation->shouldBeParallelIfPossible();
     }
+    Real getCostHint() const override {
+        return implementation->getCostHint();
+    }
+    bool findAffectedBodiesAndMobilities
+       (const State&                 state,
+        Array_<MobilizedBodyIndex>&  bodies,
+        Array_<UIndex>&              mobilities) const override {
+        return implementation->findAffectedBodiesAndMobilities
+                                    (state, bodies, mobilities);
+    }
     ~CustomImpl() {
         delete implementation;
     }
@@ -30,6 +30,8 @@
 
 #include "ForceImpl.h"
 
+#include <atomic>
+
 namespace SimTK {
 
 //==============================================================================
@@ -144,6 +146,14 @@ friend class Force::Gravity;
         return p.mobodIsImmune[mbx];
     }
 
+    // Spelled out only because the evaluation counter is atomic.
+    GravityImpl(const GravityImpl& src)
+    :   ForceImpl(src), matter(src.matter), defDirection(src.defDirection),
+        defMagnitude(src.defMagnitude), defZeroHeight(src.defZeroHeight),
+        defMobodIsImmune(src.defMobodIsImmune), 
+        parametersIx(src.parametersIx), forceCacheIx(src.forceCacheIx),
+        numEvaluations(src.numEvaluations.load()) {}
+
     GravityImpl* clone() const override {
         return new GravityImpl(*this);
     }
@@ -157,6 +167,11 @@ friend class Force::Gravity;
                    override;
     Real calcPotentialEnergy(const State& state) const override;
 
+    // The q-dependence of gravity's mobility forces is smooth, so we leave it
+    // out of the Jacobian.
+    bool calcMobilityForceDerivatives(const State&, Matrix&, 
+                                      Matrix&) const override {return true;}
+
     // Allocate the state variables and cache entries.
     void realizeTopology(State& s) const override;
 
@@ -196,7 +211,8 @@ friend class Force::Gravity;
     DiscreteVariableIndex           parametersIx;
     CacheEntryIndex                 forceCacheIx;
 
-    mutable long long               numEvaluations;
+    // Several States may be realized at once.
+    mutable std::atomic<long long>  numEvaluations;
 };
 
 
@@ -29,6 +29,9 @@
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace SimTK {
 
@@ -47,15 +50,126 @@ public:
     mutable Array_<Real,ContactSurfaceIndex>    sphereRadii;
 };
 
-class ContactBodyExtent {
+// Working storage for the contact detection in one contact set. The
+// BroadPhase remembers the spatial organization of the set's bodies from the
+// last search, which speeds up the next one but never changes its result; the
+// arrays are kept only to reuse their heap space.
+class ContactSetWorkspace {
 public:
-    ContactBodyExtent(Real start, Real end, ContactSurfaceIndex index) 
-    :   start(start), end(end), index(index) {}
-    ContactBodyExtent() {}
-    bool operator<(const ContactBodyExtent& e) const 
-    {   return start < e.start; }
-    Real start, end;
-    ContactSurfaceIndex index;
+    BroadPhase                              broadPhase;
+    Array_<Transform,ContactSurfaceIndex>   transforms; // X_GS of each body
+    Array_<Geo::AlignedBox>                 boxes;      // bounding sphere boxes
+    Array_<BroadPhase::IndexPair>           pairs;      // overlapping boxes
+    Array_<Array_<Contact> >                chunkContacts;
+};
+
+// States may be realized concurrently, so each Dynamics realization borrows
+// its own workspaces (one per contact set) and returns them when done. They
+// belong to the subsystem rather than to any State, so copying a State
+// doesn't copy them.
+class ContactWorkspacePool {
+public:
+    ContactWorkspacePool() = default;
+    // A copy starts out empty.
+    ContactWorkspacePool(const ContactWorkspacePool&) {}
+    ContactWorkspacePool& operator=(const ContactWorkspacePool&) = delete;
+
+    class Lease {
+    public:
+        Lease(ContactWorkspacePool& pool, int numSets,
+              BroadPhase::Method method)
+        :   pool(pool), workspaces(pool.acquire(numSets, method)) {}
+        ~Lease() {pool.release(std::move(workspaces));}
+        Array_<ContactSetWorkspace>& operator*() const {return *workspaces;}
+    private:
+        ContactWorkspacePool&                           pool;
+        std::unique_ptr<Array_<ContactSetWorkspace> >   workspaces;
+    };
+
+private:
+    std::unique_ptr<Array_<ContactSetWorkspace> >
+    acquire(int numSets, BroadPhase::Method method) {
+        std::unique_ptr<Array_<ContactSetWorkspace> > workspaces;
+        {   std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                workspaces = std::move(idle.back());
+                idle.pop_back();
+            }
+        }
+        if (!workspaces)
+            workspaces.reset(new Array_<ContactSetWorkspace>());
+        workspaces->resize(numSets);
+        for (ContactSetWorkspace& workspace : *workspaces)
+            if (workspace.broadPhase.getMethod() != method)
+                workspace.broadPhase.setMethod(method);
+        return workspaces;
+    }
+    void release(std::unique_ptr<Array_<ContactSetWorkspace> > workspaces) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(workspaces));
+    }
+
+    std::mutex                                                      mutex;
+    std::vector<std::unique_ptr<Array_<ContactSetWorkspace> > >     idle;
+};
+
+// Run the narrow phase for one pair of bodies whose bounding boxes overlap,
+// appending any contacts found.
+static void processPair(const ContactSet& set,
+                        const ContactSetWorkspace& workspace,
+                        ContactSurfaceIndex index1, ContactSurfaceIndex index2,
+                        Array_<Contact>& contacts) {
+    // See if the bounding spheres overlap.
+    const Vec3& center1 = workspace.boxes[index1].getCenter();
+    const Vec3& center2 = workspace.boxes[index2].getCenter();
+    const Real sumRadius = set.sphereRadii[index1]+set.sphereRadii[index2];
+    if ((center1-center2).normSqr() > sumRadius*sumRadius)
+        return;
+
+    // Do a full collision detection.
+    const Transform& transform1 = workspace.transforms[index1];
+    const Transform& transform2 = workspace.transforms[index2];
+    const ContactGeometry& geom1 = set.geometry[index1];
+    const ContactGeometry& geom2 = set.geometry[index2];
+    const ContactGeometryTypeId typeId1 = geom1.getTypeId();
+    const ContactGeometryTypeId typeId2 = geom2.getTypeId();
+    CollisionDetectionAlgorithm* algorithm = 
+        CollisionDetectionAlgorithm::getAlgorithm(typeId1, typeId2);
+    if (algorithm == NULL) {
+        algorithm = CollisionDetectionAlgorithm::getAlgorithm(typeId2, typeId1);
+        if (algorithm == NULL)
+            return; // No algorithm available for detecting collisions between these two objects.
+        algorithm->processObjects(index2, geom2, transform2,
+                                  index1, geom1, transform1, contacts);
+    }
+    else {
+        algorithm->processObjects(index1, geom1, transform1,
+                                  index2, geom2, transform2, contacts);
+    }
+}
+
+// Runs the narrow phase for consecutive ranges ("chunks") of a contact set's
+// broad phase pairs, each chunk into its own contact list so that the lists
+// can be concatenated in the same order a serial run would produce.
+class NarrowPhaseTask : public ParallelExecutor::Task {
+public:
+    NarrowPhaseTask(const ContactSet& set, ContactSetWorkspace& workspace,
+                    int numChunks) 
+    :   set(set), workspace(workspace), numChunks(numChunks) {}
+    void execute(int chunk) override {
+        const int numPairs = workspace.pairs.size();
+        const int end = (int)((long long)numPairs*(chunk+1)/numChunks);
+        Array_<Contact>& contacts = workspace.chunkContacts[chunk];
+        for (int p = (int)((long long)numPairs*chunk/numChunks); p < end; ++p) {
+            const BroadPhase::IndexPair& pair = workspace.pairs[p];
+            processPair(set, workspace, ContactSurfaceIndex(pair.first),
+                        ContactSurfaceIndex(pair.second), contacts);
+        }
+    }
+private:
+    const ContactSet&       set;
+    ContactSetWorkspace&    workspace;
+    const int               numChunks;
 };
 
 
@@ -64,7 +178,8 @@ public:
 //==============================================================================
 class GeneralContactSubsystemImpl : public Subsystem::Guts {
 public:
-    GeneralContactSubsystemImpl() {}
+    GeneralContactSubsystemImpl() 
+    :   broadPhaseMethod(BroadPhase::DynamicAABBTree) {}
 
     GeneralContactSubsystemImpl* cloneImpl() const override {
         return new GeneralContactSubsystemImpl(*this);
@@ -126,6 +241,29 @@ public:
         return sets[set].transforms[index];
     }
 
+    void setBroadPhaseMethod(BroadPhase::Method method) {
+        invalidateSubsystemTopologyCache();
+        broadPhaseMethod = method;
+    }
+
+    BroadPhase::Method getBroadPhaseMethod() const {
+        return broadPhaseMethod;
+    }
+
+    void setNumberOfThreads(unsigned numThreads) {
+        SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "GeneralContactSubsystem",
+                    "setNumberOfThreads", "Number of threads must be positive");
+        if (numThreads == 1)
+            contactExecutor.reset();
+        else
+            contactExecutor = new ParallelExecutor(numThreads);
+    }
+
+    int getNumberOfThreads() const {
+        return contactExecutor.empty() 
+            ? 1 : contactExecutor->getMaxThreads();
+    }
+
     const Array_<Contact>& getContacts(const State& state, ContactSetIndex set) const {
         assert(set >= 0 && set < sets.size());
         SimTK_STAGECHECK_GE_ALWAYS(state.getSubsystemStage(getMySubsystemIndex()), Stage::Dynamics, "GeneralContactSubsystemImpl::getContacts()");
@@ -162,72 +300,56 @@ public:
         int numSets = getNumContactSets();
         contacts.resize(numSets);
         
+        ContactWorkspacePool::Lease lease(workspacePool, numSets,
+                                          broadPhaseMethod);
+        Array_<ContactSetWorkspace>& workspaces = *lease;
+        ParallelExecutor* executor = contactExecutor.upd(); // may be null
+
         // Loop over all contact sets.
         
         for (int setIndex = 0; setIndex < numSets; setIndex++) {
             contacts[setIndex].clear();
             const ContactSet& set = sets[setIndex];
+            ContactSetWorkspace& workspace = workspaces[setIndex];
             int numBodies = set.bodies.size();
             
-            // Perform a sweep-and-prune on a single axis to identify potential contacts.  First, find which
-            // axis has the most variation in body locations.  That is the axis we will use.
-            
-            Vector_<Vec3> centers(numBodies);
-            for (ContactSurfaceIndex i(0); i < numBodies; i++)
-                centers[i] = set.bodies[i].getBodyTransform(state)*set.sphereCenters[i];
-            Vec3 average = mean(centers);
-            Vec3 var(0);
-            for (int i = 0; i < numBodies; i++)
-                var += abs(centers[i]-average);
-            int axis = (var[0] > var[1] ? 0 : 1);
-            if (var[2] > var[axis])
-                axis = 2;
-            
-            // Find the extent of each body along the axis and sort them by starting location.
-            
-            Array_<ContactBodyExtent> extents(numBodies);
-            for (ContactSurfaceIndex i(0); i < numBodies; i++)
-                extents[i] = ContactBodyExtent(centers[i][axis]-set.sphereRadii[i], centers[i][axis]+set.sphereRadii[i], i);
-            std::sort(extents.begin(), extents.end());
-            
-            // Now sweep along the axis, finding potential contacts.
-            
-            for (int i = 0; i < numBodies; i++) {
-                const ContactSurfaceIndex index1 = extents[i].index;
-                const Transform transform1 = set.bodies[index1].getBodyTransform(state)*set.transforms[index1];
-                const ContactGeometry& geom1 = set.geometry[index1];
-                const ContactGeometryTypeId typeId1 = geom1.getTypeId();
-                for (int j = i+1; j < numBodies && extents[j].start <= extents[i].end; j++) {
-                    // They overlap along this axis.  See if the bounding spheres overlap.
-                    
-                    const ContactSurfaceIndex index2 = extents[j].index;
-                    const Real sumRadius = set.sphereRadii[index1]+set.sphereRadii[index2];
-                    if ((centers[index1]-centers[index2]).normSqr() <= sumRadius*sumRadius) {
-                        // Do a full collision detection.
-
-                        const Transform transform2 = set.bodies[index2].getBodyTransform(state)*set.transforms[index2];
-                        const ContactGeometry& geom2 = set.geometry[index2];
-                        const ContactGeometryTypeId typeId2 = geom2.getTypeId();
-                        CollisionDetectionAlgorithm* algorithm = 
-                            CollisionDetectionAlgorithm::getAlgorithm
-                                                            (typeId1, typeId2);
-                        if (algorithm == NULL) {
-                            algorithm = CollisionDetectionAlgorithm::
-                                                getAlgorithm(typeId2, typeId1);
-                            if (algorithm == NULL)
-                                continue; // No algorithm available for detecting collisions between these two objects.
-                            algorithm->processObjects(index2, geom2, transform2,
-                                                      index1, geom1, transform1,
-                                                      contacts[setIndex]);
-                        }
-                        else {
-                            algorithm->processObjects(index1, geom1, transform1,
-                                                      index2, geom2, transform2,
-                                                      contacts[setIndex]);
-                        }
-                    }
-                }
+            // Find the location of each body once, and use its bounding
+            // sphere to find the pairs of bodies that might be in contact.
+
+            workspace.transforms.resize(numBodies);
+            workspace.boxes.resize(numBodies);
+            for (ContactSurfaceIndex i(0); i < numBodies; i++) {
+                const Transform& X_GB = set.bodies[i].getBodyTransform(state);
+                workspace.transforms[i] = X_GB*set.transforms[i];
+                workspace.boxes[i] = Geo::AlignedBox(X_GB*set.sphereCenters[i],
+                                                     Vec3(set.sphereRadii[i]));
+            }
+            workspace.broadPhase.findOverlappingPairs(workspace.boxes,
+                                                      workspace.pairs,
+                                                      executor);
+
+            // Do a full collision detection for each pair.
+
+            const int numPairs = workspace.pairs.size();
+            if (!executor || numPairs < MinPairsForParallelNarrowPhase) {
+                for (const BroadPhase::IndexPair& pair : workspace.pairs)
+                    processPair(set, workspace, ContactSurfaceIndex(pair.first),
+                                ContactSurfaceIndex(pair.second),
+                                contacts[setIndex]);
+                continue;
             }
+            // More chunks than threads so that a thread that got pairs with
+            // expensive geometry (meshes) doesn't hold up the others.
+            const int numChunks = std::min(numPairs,
+                                    ChunksPerThread*executor->getMaxThreads());
+            workspace.chunkContacts.resize(numChunks);
+            for (Array_<Contact>& chunk : workspace.chunkContacts)
+                chunk.clear();
+            NarrowPhaseTask task(set, workspace, numChunks);
+            executor->execute(task, numChunks);
+            for (const Array_<Contact>& chunk : workspace.chunkContacts)
+                contacts[setIndex].insert(contacts[setIndex].end(),
+                                          chunk.begin(), chunk.end());
         }
         contactsValid = true;
         return 0;
@@ -236,7 +358,14 @@ public:
     SimTK_DOWNCAST(GeneralContactSubsystemImpl, Subsystem::Guts);
 
 private:
+    static const int ChunksPerThread = 4;
+    static const int MinPairsForParallelNarrowPhase = 8;
+
     Array_<ContactSet>      sets;
+    BroadPhase::Method      broadPhaseMethod;
+    // Null when contacts are to be found in the calling thread.
+    mutable ClonePtr<ParallelExecutor> contactExecutor;
+    mutable ContactWorkspacePool       workspacePool;
 
     mutable CacheEntryIndex contactsCacheIndex;
     mutable CacheEntryIndex contactsValidCacheIndex;
@@ -283,6 +412,22 @@ Transform& GeneralContactSubsystem::updBodyTransform(ContactSetIndex set, Contac
     return updImpl().updBodyTransform(set, index);
 }
 
+void GeneralContactSubsystem::setBroadPhaseMethod(BroadPhase::Method method) {
+    updImpl().setBroadPhaseMethod(method);
+}
+
+BroadPhase::Method GeneralContactSubsystem::getBroadPhaseMethod() const {
+    return getImpl().getBroadPhaseMethod();
+}
+
+void GeneralContactSubsystem::setNumberOfThreads(unsigned numThreads) {
+    updImpl().setNumberOfThreads(numThreads);
+}
+
+int GeneralContactSubsystem::getNumberOfThreads() const {
+    return getImpl().getNumberOfThreads();
+}
+
 const Array_<Contact>& GeneralContactSubsystem::getContacts(const State& state, ContactSetIndex set) const {
     return getImpl().getContacts(state, set);
 }
@@ -40,14 +40,233 @@
 #include "ForceImpl.h"
 
 #include <memory>
+#include <algorithm>
+#include <utility>
+#include <mutex>
 
 //Threading constants used by CalcForcesTask
 namespace {
 using namespace SimTK;
 
-const int NumNonParallelThreads = 1;
 const int NonParallelForcesIndex = 0;
 
+/* Assignment of the enabled forces to the indices ("bins") of a parallel
+CalcForcesTask. Bin NonParallelForcesIndex always starts with every enabled
+non-parallel force, in order, since those must all be computed on the same
+thread; the parallel forces are then packed into the bins so that the
+estimated cost of each bin is about the same. That lets the non-parallel
+forces overlap with the parallel ones instead of leaving the other threads
+idle while they run.
+
+The cost of a force is the user's hint if the force provides one, otherwise
+the wall time of its calcForce() as measured during the most recent sampling
+realization. Sampling happens on the first Dynamics realization after the
+schedule is built and then once every GeneralForceSubsystem load balancing
+interval; the schedule is rebuilt right after each sample.
+
+The schedule is a Dynamics stage cache entry, written only while realizing
+Dynamics; its value is kept from one realization to the next. It is built
+again from scratch at the start of a Dynamics realization whenever the enabled
+forces or the number of threads (see setNumberOfThreads()) are not the ones it
+was last built for. */
+struct ForceSchedule {
+    ForceSchedule()
+    :   unknownCost(1), realizationsSinceBalance(0), measuring(false),
+        builtForNumThreads(0) {}
+
+    int getNumBins() const {return (int)binStart.size() - 1;}
+
+    // Was this schedule built for these enabled forces and thread count?
+    bool isBuiltFor(const Array_<ForceIndex>&    enabledNonParallelForces,
+                    const Array_<ForceIndex>&    enabledParallelForces,
+                    int                          numThreads) const
+    {
+        return numThreads == builtForNumThreads
+            && enabledNonParallelForces == builtForNonParallelForces
+            && enabledParallelForces == builtForParallelForces;
+    }
+
+    // Pack these forces using whatever costs are known so far, and remember
+    // what the schedule was built for.
+    void build(const Array_<Force*>&       forces,
+               const Array_<ForceIndex>&   enabledNonParallelForces,
+               const Array_<ForceIndex>&   enabledParallelForces,
+               int                         numThreads)
+    {
+        measuredCost.resize(forces.size(), Real(0));
+        builtForNonParallelForces = enabledNonParallelForces;
+        builtForParallelForces = enabledParallelForces;
+        builtForNumThreads = numThreads;
+        balance(forces, enabledNonParallelForces, enabledParallelForces,
+                numThreads);
+    }
+
+    // Fill the bins with a longest-processing-time-first greedy packing.
+    void balance(const Array_<Force*>&       forces,
+                 const Array_<ForceIndex>&   enabledNonParallelForces,
+                 const Array_<ForceIndex>&   enabledParallelForces,
+                 int                         numThreads)
+    {
+        const int numItems = (int)enabledParallelForces.size()
+                           + (enabledNonParallelForces.empty() ? 0 : 1);
+        const int numBins = std::max(1, std::min(numThreads, numItems));
+
+        // Forces that have never been timed are assumed to cost as much as
+        // the average of those that have.
+        Real sum = 0; int numKnown = 0;
+        for (const Real cost : measuredCost)
+            if (cost > 0) {sum += cost; ++numKnown;}
+        unknownCost = numKnown ? sum/numKnown : Real(1);
+
+        // Sort the parallel forces by decreasing estimated cost.
+        sortedParallel.clear();
+        for (const auto fx : enabledParallelForces)
+            sortedParallel.push_back(std::make_pair(-getCost(forces, fx), fx));
+        std::stable_sort(sortedParallel.begin(), sortedParallel.end(),
+            [](const std::pair<Real,ForceIndex>& a,
+               const std::pair<Real,ForceIndex>& b) {return a.first<b.first;});
+
+        // The non-parallel forces are preloaded into bin 0.
+        binLoad.assign(numBins, 0);
+        binOf.resize(sortedParallel.size());
+        for (const auto fx : enabledNonParallelForces)
+            binLoad[NonParallelForcesIndex] += getCost(forces, fx);
+        for (int i = 0; i < (int)sortedParallel.size(); ++i) {
+            const int b = (int)(std::min_element(binLoad.begin(), binLoad.end())
+                                - binLoad.begin());
+            binLoad[b] -= sortedParallel[i].first; // cost is stored negated
+            binOf[i] = b;
+        }
+
+        // Lay the bins out contiguously.
+        binStart.assign(numBins+1, 0);
+        binStart[NonParallelForcesIndex+1] = enabledNonParallelForces.size();
+        for (const int b : binOf)
+            ++binStart[b+1];
+        for (int b = 0; b < numBins; ++b)
+            binStart[b+1] += binStart[b];
+        binForces.resize(binStart.back());
+        Array_<int> next(binStart.begin(), binStart.end()-1);
+        for (const auto fx : enabledNonParallelForces)
+            binForces[next[NonParallelForcesIndex]++] = fx;
+        for (int i = 0; i < (int)sortedParallel.size(); ++i)
+            binForces[next[binOf[i]]++] = sortedParallel[i].second;
+    }
+
+    // Estimated cost of one force in seconds.
+    Real getCost(const Array_<Force*>& forces, ForceIndex fx) const {
+        const Real hint = forces[fx]->getImpl().getCostHint();
+        if (hint > 0) return hint;
+        return measuredCost[fx] > 0 ? measuredCost[fx] : unknownCost;
+    }
+
+    // Called concurrently, but each force is only computed on one thread.
+    void recordCost(ForceIndex fx, Real seconds) {
+        measuredCost[fx] = seconds;
+    }
+
+    Array_<ForceIndex>  binForces;  // bin b is binForces[binStart[b]..binStart[b+1])
+    Array_<int>         binStart;
+    Array_<Real>        measuredCost; // indexed by ForceIndex; 0 if unknown
+    Real                unknownCost;
+    int                 realizationsSinceBalance;
+    bool                measuring;  // time calcForce() in this realization
+
+    // What the bins were last built from; see isBuiltFor().
+    Array_<ForceIndex>  builtForNonParallelForces;
+    Array_<ForceIndex>  builtForParallelForces;
+    int                 builtForNumThreads;
+
+    // Temporaries kept around to avoid heap allocation when rebalancing.
+    Array_<std::pair<Real,ForceIndex>>  sortedParallel;
+    Array_<Real>                        binLoad;
+    Array_<int>                         binOf;
+};
+
+/* Private copies of one of the force arrays, used while computing forces in
+parallel. Each bin of the ForceSchedule other than NonParallelForcesIndex
+accumulates into its own slot's buffer. The buffers persist between
+realizations and are kept zero, so a realization only pays for the entries
+that were actually written: the arrays are divided into blocks, and each slot
+has a bitmask of the blocks it wrote. The bits are set as each force is about
+to be computed, from the entries it says it will change, or all at once for a
+force that can't say (see ForceImpl::findAffectedBodiesAndMobilities()).
+reduceWord() then adds into the result (and re-zeroes) only the marked blocks.
+Words of the mask cover separate parts of the arrays, so the reduction can
+itself be done in parallel, with no lock around the State's arrays. */
+template <class T>
+class ForceReduction {
+public:
+    static const int BlockSize = 16;
+    static const int BlocksPerWord = 64;
+
+    ForceReduction() : size(0), numBlocks(0), numWords(0), numUsedSlots(0) {}
+
+    // Must be called before the buffers are used by the worker threads.
+    // Reallocates (and zeroes) only if the slot count or array size changed.
+    void resize(int numSlots, int newSize) {
+        if (numSlots == (int)buffers.size() && newSize == size)
+            return;
+        size = newSize;
+        numBlocks = (size + BlockSize-1) / BlockSize;
+        numWords = (numBlocks + BlocksPerWord-1) / BlocksPerWord;
+        buffers.resize(numSlots);
+        dirty.resize(numSlots);
+        for (int slot = 0; slot < numSlots; ++slot) {
+            buffers[slot].resize(size);
+            buffers[slot].setToZero();
+            dirty[slot].assign(numWords, 0);
+        }
+        numUsedSlots = 0;
+    }
+
+    int getNumSlots() const {return (int)buffers.size();}
+    void setNumUsedSlots(int n) {numUsedSlots = n;}
+    int getNumWords() const {return numWords;}
+    Vector_<T>& updBuffer(int slot) {return buffers[slot];}
+
+    // Note that entry i of this slot's buffer is about to be written. Only
+    // the thread writing the slot may call this.
+    void markEntry(int slot, int i) {
+        assert(0 <= i && i < size);
+        const int block = i / BlockSize;
+        dirty[slot][block/BlocksPerWord] |= 1ULL << (block%BlocksPerWord);
+    }
+    // Note that any entry of this slot's buffer may be written.
+    void markAll(int slot) {
+        dirty[slot].fill(~0ULL);
+    }
+
+    // Add the blocks of this word of the masks into result from every slot
+    // that marked them, leaving those buffers zero and the marks clear.
+    void reduceWord(int word, Vector_<T>& result) {
+        const int firstBlock = word*BlocksPerWord;
+        for (int slot = 0; slot < numUsedSlots; ++slot) {
+            unsigned long long bits = dirty[slot][word];
+            if (!bits)
+                continue;
+            dirty[slot][word] = 0;
+            Vector_<T>& buffer = buffers[slot];
+            for (int block = firstBlock; bits && block < numBlocks;
+                 ++block, bits >>= 1) {
+                if (!(bits & 1))
+                    continue;
+                const int end = std::min(size, (block+1)*BlockSize);
+                for (int i = block*BlockSize; i < end; ++i) {
+                    result[i] += buffer[i];
+                    buffer[i] = T(0);
+                }
+            }
+        }
+    }
+
+private:
+    Array_<Vector_<T>>                  buffers;
+    Array_<Array_<unsigned long long>>  dirty; // per slot, a bit per block
+    int size, numBlocks, numWords;
+    int numUsedSlots;
+};
+
 /* Base class for CalcForcesParallelTask and CalcForcesNonParallelTask - lays 
 out common methods that will be implemented to suit the parallel/non-parallel
 use cases*/
@@ -56,18 +275,22 @@ public:
     CalcForcesTask() = default;
     
     virtual CalcForcesTask* clone() const = 0;
+
+    // Compute the forces with the given executor, using one task index per
+    // bin of the ForceSchedule.
+    virtual void run(ParallelExecutor& executor, int numBins) {
+        executor.execute(*this, numBins);
+    }
     
     virtual void initializeAll(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) = 0;
     virtual void initializeCachedAndNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -76,17 +299,19 @@ public:
             Vector& mobilityForceCache) = 0;
     virtual void initializeNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) = 0;
     
 };
 /*Calculates each enabled force's contribution in the MultibodySystem.
-CalcForcesParallelTask allows force calculations to occur in parallel with
-non-parallel forces being calculated on Thread NonParallelForcesIndex and all
-other parallel forces being calculated on separate threads.*/
+CalcForcesParallelTask allows force calculations to occur in parallel. Each
+task index computes one bin of the ForceSchedule; the non-parallel forces are
+all in bin NonParallelForcesIndex. That bin is computed directly into the
+State's arrays, which nothing else writes until all the bins are done. Every
+other bin accumulates into its own buffers, which are then summed into the
+State's arrays (see ForceReduction).*/
 
 //Implementation of CalcForcesTask for parallel forces
 class CalcForcesParallelTask : public CalcForcesTask {
@@ -99,6 +324,8 @@ public:
         NonCached
     };
     
+    CalcForcesParallelTask() = default;
+
     CalcForcesParallelTask* clone() const override {
         return new CalcForcesParallelTask();
     }
@@ -107,16 +334,14 @@ public:
     // Note: Execute MUST be called directly after CalcForceTask is initialized
     void initializeAll(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
     {
         m_forces = &forces;
         m_state = &s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -125,8 +350,7 @@ public:
     }
     void initializeCachedAndNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -136,8 +360,7 @@ public:
     {
         m_forces = &forces;
         m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -149,16 +372,14 @@ public:
     }
     void initializeNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
     {
         m_forces = &forces;
         m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -166,123 +387,174 @@ public:
         m_mode = NonCached;
     }
     
-    // Set all of the local force contribution arrays to 0. This is so that
-    // each local thread can sum up its force contribution to be later
-    // added into the total force array.
-    void initialize() override {
-        m_rigidBodyForcesLocalStatic.resize(m_rigidBodyForces->size());
-        m_rigidBodyForcesLocalStatic.setToZero();
-        m_particleForcesLocalStatic.resize(m_particleForces->size());
-        m_particleForcesLocalStatic.setToZero();
-        m_mobilityForcesLocalStatic.resize(m_mobilityForces->size());
-        m_mobilityForcesLocalStatic.setToZero();
+    // Each bin but NonParallelForcesIndex accumulates into its own slot of
+    // the ForceReductions, so the slot follows from the task index and needs
+    // no per-thread bookkeeping. With only one bin there is nothing to
+    // reduce, so that bin is computed on the calling thread.
+    void run(ParallelExecutor& executor, int numBins) override {
+        if (numBins == 1) {
+            calcBin(0, NoSlot);
+            return;
+        }
 
+        const int numSlots = numBins-1;
+        m_rigidBodyForcesLocal.resize(numSlots, m_rigidBodyForces->size());
+        m_particleForcesLocal.resize(numSlots, m_particleForces->size());
+        m_mobilityForcesLocal.resize(numSlots, m_mobilityForces->size());
         if (m_mode == CachedAndNonCached) {
-            m_rigidBodyForceCacheLocalStatic.resize(m_rigidBodyForceCache->size());
-            m_rigidBodyForceCacheLocalStatic.setToZero();
-            m_particleForceCacheLocalStatic.resize(m_particleForceCache->size());
-            m_particleForceCacheLocalStatic.setToZero();
-            m_mobilityForceCacheLocalStatic.resize(m_mobilityForceCache->size());
-            m_mobilityForceCacheLocalStatic.setToZero();
+            m_rigidBodyForceCacheLocal.resize(numSlots,
+                                              m_rigidBodyForceCache->size());
+            m_particleForceCacheLocal.resize(numSlots,
+                                             m_particleForceCache->size());
+            m_mobilityForceCacheLocal.resize(numSlots,
+                                             m_mobilityForceCache->size());
         }
+        m_affected.resize(numSlots);
+
+        executor.execute(*this, numBins);
+        reduce(executor, numSlots);
     }
-    
-    // Calculate all enabled forces (taking into account mode and parallelism)
-    void execute(int threadIndex) override {
-      switch (m_mode) {
-        case All:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto force = m_forces.getRef()[forceIndex];
-                    force->getImpl().calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
 
+    // Calculate all enabled forces in one bin. NonParallelForcesIndex is
+    // bin 0, so the other bins use the slots numbered one less.
+    void execute(int binIndex) override {
+        calcBin(binIndex, binIndex == NonParallelForcesIndex ? NoSlot
+                                                             : binIndex-1);
+    }
+    
+private:
+    // The slot of a bin that writes the State's arrays directly.
+    static const int NoSlot = -1;
+
+    // Calculate the forces in one bin (taking into account mode) into the
+    // given slot's buffers, or into the State's arrays if there is no slot.
+    // The cache arrays are used only in CachedAndNonCached mode.
+    void calcBin(int binIndex, int slot) {
+        ForceSchedule& schedule = *m_schedule;
+        const int end = schedule.binStart[binIndex+1];
+        for (int k = schedule.binStart[binIndex]; k < end; ++k) {
+            const ForceIndex forceIndex = schedule.binForces[k];
+            const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
+            const bool positionOnly = impl.dependsOnlyOnPositions();
+            if (m_mode == NonCached && positionOnly)
+                continue; // already in the cache
+
+            const long long start = schedule.measuring ? realTimeInNs() : 0;
+            if (m_mode == CachedAndNonCached && positionOnly) {
+                if (slot == NoSlot)
+                    impl.calcForce(*m_state, *m_rigidBodyForceCache,
+                                   *m_particleForceCache,
+                                   *m_mobilityForceCache);
+                else
+                    calcForceIntoSlot(impl, slot, m_rigidBodyForceCacheLocal,
+                                      m_particleForceCacheLocal,
+                                      m_mobilityForceCacheLocal);
+            } else { // ordinary velocity dependent force
+                if (slot == NoSlot)
+                    impl.calcForce(*m_state, *m_rigidBodyForces,
+                                   *m_particleForces, *m_mobilityForces);
+                else
+                    calcForceIntoSlot(impl, slot, m_rigidBodyForcesLocal,
+                                      m_particleForcesLocal,
+                                      m_mobilityForcesLocal);
             }
-            break;
-
-        case CachedAndNonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache, *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces, *m_particleForces, *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from threadIndex b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                if (impl.dependsOnlyOnPositions()) {
-                    impl.calcForce(*m_state, m_rigidBodyForceCacheLocalStatic, m_particleForceCacheLocalStatic, m_mobilityForceCacheLocalStatic);
-                } else { // ordinary velocity dependent force
-                    impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
-                }
-            }
-            break;
-
-        case NonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                *m_rigidBodyForces, *m_particleForces,
-                                *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                if (!impl.dependsOnlyOnPositions()) {
-                    impl.calcForce(*m_state,
-                            m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic,
-                            m_mobilityForcesLocalStatic);
-                }
-            }
-            break;
+            if (schedule.measuring)
+                schedule.recordCost(forceIndex,
+                                    nsToSec(realTimeInNs() - start));
         }
     }
-    
-    //Once a thread has finished its force calculations, we add in the thread's
-    //contribution into the cached force arrays in the State
-    void finish() override {
-        *m_rigidBodyForces += m_rigidBodyForcesLocalStatic;
-        *m_particleForces += m_particleForcesLocalStatic;
-        *m_mobilityForces += m_mobilityForcesLocalStatic;
 
+    // Mark the blocks of the slot's buffers that the force is going to write,
+    // then compute it into them. Particles are not yet implemented, so the
+    // particle arrays are usually empty; they are always marked in full.
+    void calcForceIntoSlot(const ForceImpl& impl, int slot,
+                           ForceReduction<SpatialVec>& rigidBodyForces,
+                           ForceReduction<Vec3>& particleForces,
+                           ForceReduction<Real>& mobilityForces) {
+        AffectedEntries& affected = m_affected[slot];
+        affected.bodies.clear();
+        affected.mobilities.clear();
+        if (impl.findAffectedBodiesAndMobilities(*m_state, affected.bodies,
+                                                 affected.mobilities)) {
+            for (const MobilizedBodyIndex mbx : affected.bodies)
+                rigidBodyForces.markEntry(slot, mbx);
+            for (const UIndex ux : affected.mobilities)
+                mobilityForces.markEntry(slot, ux);
+        } else {
+            rigidBodyForces.markAll(slot);
+            mobilityForces.markAll(slot);
+        }
+        particleForces.markAll(slot);
+
+        impl.calcForce(*m_state, rigidBodyForces.updBuffer(slot),
+                       particleForces.updBuffer(slot),
+                       mobilityForces.updBuffer(slot));
+    }
+
+    // Sums the per-bin buffers into the State's arrays; each index of this
+    // task handles the same word of the masks of every array.
+    class ReduceTask : public ParallelExecutor::Task {
+    public:
+        explicit ReduceTask(CalcForcesParallelTask& owner) : owner(owner) {}
+        void execute(int word) override {owner.reduceWord(word);}
+    private:
+        CalcForcesParallelTask& owner;
+    };
+
+    // Below this many mask words, the reduction is done on the calling
+    // thread.
+    static const int MinWordsForParallelReduction = 16;
+
+    void reduce(ParallelExecutor& executor, int numUsed) {
+        m_rigidBodyForcesLocal.setNumUsedSlots(numUsed);
+        m_particleForcesLocal.setNumUsedSlots(numUsed);
+        m_mobilityForcesLocal.setNumUsedSlots(numUsed);
+        int numWords = std::max(m_rigidBodyForcesLocal.getNumWords(),
+                       std::max(m_particleForcesLocal.getNumWords(),
+                                m_mobilityForcesLocal.getNumWords()));
         if (m_mode == CachedAndNonCached) {
-            *m_rigidBodyForceCache += m_rigidBodyForceCacheLocalStatic;
-            *m_particleForceCache += m_particleForceCacheLocalStatic;
-            *m_mobilityForceCache += m_mobilityForceCacheLocalStatic;
+            m_rigidBodyForceCacheLocal.setNumUsedSlots(numUsed);
+            m_particleForceCacheLocal.setNumUsedSlots(numUsed);
+            m_mobilityForceCacheLocal.setNumUsedSlots(numUsed);
+            numWords = std::max(numWords,
+                       std::max(m_rigidBodyForceCacheLocal.getNumWords(),
+                       std::max(m_particleForceCacheLocal.getNumWords(),
+                                m_mobilityForceCacheLocal.getNumWords())));
+        }
+
+        if (numUsed > 1 && numWords >= MinWordsForParallelReduction) {
+            ReduceTask reduceTask(*this);
+            executor.execute(reduceTask, numWords);
+        } else {
+            for (int word = 0; word < numWords; ++word)
+                reduceWord(word);
         }
     }
-private:
+
+    void reduceWord(int word) {
+        if (word < m_rigidBodyForcesLocal.getNumWords())
+            m_rigidBodyForcesLocal.reduceWord(word, *m_rigidBodyForces);
+        if (word < m_particleForcesLocal.getNumWords())
+            m_particleForcesLocal.reduceWord(word, *m_particleForces);
+        if (word < m_mobilityForcesLocal.getNumWords())
+            m_mobilityForcesLocal.reduceWord(word, *m_mobilityForces);
+        if (m_mode != CachedAndNonCached)
+            return;
+        if (word < m_rigidBodyForceCacheLocal.getNumWords())
+            m_rigidBodyForceCacheLocal.reduceWord(word, *m_rigidBodyForceCache);
+        if (word < m_particleForceCacheLocal.getNumWords())
+            m_particleForceCacheLocal.reduceWord(word, *m_particleForceCache);
+        if (word < m_mobilityForceCacheLocal.getNumWords())
+            m_mobilityForceCacheLocal.reduceWord(word, *m_mobilityForceCache);
+    }
+
     Mode m_mode;
 
     ReferencePtr<const Array_<Force*>> m_forces;
     ReferencePtr<const State> m_state;
 
-    // Constant state-cache variables for the enabled parallel and non-parallel
-    // forces.
-    ReferencePtr<const Array_<ForceIndex>> m_enabledNonParallelForces;
-    ReferencePtr<const Array_<ForceIndex>> m_enabledParallelForces;
+    // State-cache entry saying which forces each task index computes.
+    ReferencePtr<ForceSchedule> m_schedule;
 
     // ReferencePtrs that point to caches in the state; We eventually add our
     // thread-local result to these vectors.
@@ -294,35 +566,27 @@ private:
     ReferencePtr<Vector_<Vec3>> m_particleForceCache;
     ReferencePtr<Vector> m_mobilityForceCache;
     
-    // These variables are local to a thread. They are set to their default
-    // value when the threads are spawned. We use them to keep track of each
-    // thread's contribution that we will later add in to the final state cache.
-    static thread_local Vector_<SpatialVec> m_rigidBodyForcesLocalStatic;
-    static thread_local Vector_<Vec3> m_particleForcesLocalStatic;
-    static thread_local Vector m_mobilityForcesLocalStatic;
-
-    static thread_local Vector_<SpatialVec> m_rigidBodyForceCacheLocalStatic;
-    static thread_local Vector_<Vec3> m_particleForceCacheLocalStatic;
-    static thread_local Vector m_mobilityForceCacheLocalStatic;
+    // One buffer per slot for each of the arrays above. These persist
+    // between realizations and are zero except while forces are being
+    // computed.
+    ForceReduction<SpatialVec> m_rigidBodyForcesLocal;
+    ForceReduction<Vec3> m_particleForcesLocal;
+    ForceReduction<Real> m_mobilityForcesLocal;
+
+    ForceReduction<SpatialVec> m_rigidBodyForceCacheLocal;
+    ForceReduction<Vec3> m_particleForceCacheLocal;
+    ForceReduction<Real> m_mobilityForceCacheLocal;
+
+    // Per slot, where the force being computed says it will write.
+    struct AffectedEntries {
+        Array_<MobilizedBodyIndex>  bodies;
+        Array_<UIndex>              mobilities;
+    };
+    Array_<AffectedEntries> m_affected;
 };
 
-//local declarations of static member variables
-/*static*/ thread_local Vector_<SpatialVec>
-                    CalcForcesParallelTask::m_rigidBodyForcesLocalStatic;
-/*static*/ thread_local Vector_<Vec3>
-                    CalcForcesParallelTask::m_particleForcesLocalStatic;
-/*static*/ thread_local Vector
-                    CalcForcesParallelTask::m_mobilityForcesLocalStatic;
-
-/*static*/ thread_local Vector_<SpatialVec>
-                    CalcForcesParallelTask::m_rigidBodyForceCacheLocalStatic;
-/*static*/ thread_local Vector_<Vec3>
-                    CalcForcesParallelTask::m_particleForceCacheLocalStatic;
-/*static*/ thread_local Vector
-                    CalcForcesParallelTask::m_mobilityForceCacheLocalStatic;
-
 /* Calculates each enabled force's contribution in the MultibodySystem. These
-calculations occur on the main thread, without use of local thread variables.*/
+calculations occur on the calling thread, directly into the State's arrays.*/
 
 //Implementation of CalcForcesTask for non-parallel forces
 class CalcForcesNonParallelTask : public CalcForcesTask {
@@ -344,16 +608,14 @@ public:
     // Note: Execute MUST be called directly after CalcForceTask is initialized
     void initializeAll(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
     {
         m_forces = &forces;
         m_state = &s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -362,8 +624,7 @@ public:
     }
     void initializeCachedAndNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -373,8 +634,7 @@ public:
     {
         m_forces = &forces;
         m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -386,16 +646,14 @@ public:
     }
     void initializeNonCached(
             const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
+            ForceSchedule& schedule,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
     {
         m_forces = &forces;
         m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
+        m_schedule = &schedule;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -403,99 +661,54 @@ public:
         m_mode = NonCached;
     }
     
-    // Set all of the local force contribution arrays to 0. This is so that
-    // each local thread can sum up it's force contribution to be later
-    // added into the total force array.
-    void initialize() override {
-        m_rigidBodyForcesLocal.resize(m_rigidBodyForces->size());
-        m_rigidBodyForcesLocal.setToZero();
-        m_particleForcesLocal.resize(m_particleForces->size());
-        m_particleForcesLocal.setToZero();
-        m_mobilityForcesLocal.resize(m_mobilityForces->size());
-        m_mobilityForcesLocal.setToZero();
-
-        if (m_mode == CachedAndNonCached) {
-            m_rigidBodyForceCacheLocal.resize(m_rigidBodyForceCache->size());
-            m_rigidBodyForceCacheLocal.setToZero();
-            m_particleForceCacheLocal.resize(m_particleForceCache->size());
-            m_particleForceCacheLocal.setToZero();
-            m_mobilityForceCacheLocal.resize(m_mobilityForceCache->size());
-            m_mobilityForceCacheLocal.setToZero();
-        }
+    // With no parallel forces the schedule has just the one bin, so compute
+    // it here on the calling thread rather than handing it to the executor.
+    void run(ParallelExecutor&, int numBins) override {
+        for (int bin = 0; bin < numBins; ++bin)
+            execute(bin);
     }
-    
-    // Calculate all enabled forces (taking into account mode and parallelism)
-    void execute(int threadIndex) override {
-      switch (m_mode) {
-        case All:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto force = m_forces.getRef()[forceIndex];
-                    force->getImpl().calcForce(*m_state, m_rigidBodyForcesLocal,
-                                  m_particleForcesLocal, m_mobilityForcesLocal);
-                }
-            }
-            break;
-
-        case CachedAndNonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache,
-                                  *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces,
-                                          *m_particleForces, *m_mobilityForces);
-                    }
-                }
-            }
-            break;
-
-        case NonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                *m_rigidBodyForces, *m_particleForces,
-                                *m_mobilityForces);
-                    }
-                }
+
+    // Calculate all enabled forces (taking into account mode). Nothing else
+    // writes the State's force arrays meanwhile, so the forces accumulate
+    // directly into them.
+    void execute(int binIndex) override {
+        if (binIndex != NonParallelForcesIndex)
+            return;
+        for (const auto& forceIndex : getNonParallelForces()) {
+            const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
+            const bool positionOnly = impl.dependsOnlyOnPositions();
+            if (m_mode == NonCached && positionOnly)
+                continue; // already in the cache
+            if (m_mode == CachedAndNonCached && positionOnly) {
+                impl.calcForce(*m_state, *m_rigidBodyForceCache,
+                               *m_particleForceCache, *m_mobilityForceCache);
+            } else { // ordinary velocity dependent force
+                impl.calcForce(*m_state, *m_rigidBodyForces,
+                               *m_particleForces, *m_mobilityForces);
             }
-            break;
         }
     }
     
-    //Once a thread has finished it's force calculations, we add in the thread's
-    //contribution into the cached force arrays in the State
-    void finish() override {
-        *m_rigidBodyForces += m_rigidBodyForcesLocal;
-        *m_particleForces += m_particleForcesLocal;
-        *m_mobilityForces += m_mobilityForcesLocal;
-
-        if (m_mode == CachedAndNonCached) {
-            *m_rigidBodyForceCache += m_rigidBodyForceCacheLocal;
-            *m_particleForceCache += m_particleForceCacheLocal;
-            *m_mobilityForceCache += m_mobilityForceCacheLocal;
-        }
+    ArrayViewConst_<ForceIndex> getNonParallelForces() const {
+        const ForceSchedule& schedule = m_schedule.getRef();
+        return schedule.binForces(
+            schedule.binStart[NonParallelForcesIndex],
+            schedule.binStart[NonParallelForcesIndex+1]
+                - schedule.binStart[NonParallelForcesIndex]);
     }
+
 private:
     Mode m_mode;
 
     ReferencePtr<const Array_<Force*>> m_forces;
     ReferencePtr<const State> m_state;
 
-    // Const. state-cache variables for the enabled parallel and non-parallel
-    // forces.
-    ReferencePtr<const Array_<ForceIndex>> m_enabledNonParallelForces;
-    ReferencePtr<const Array_<ForceIndex>> m_enabledParallelForces;
+    // Const. state-cache variable saying which forces to compute; without
+    // parallel forces everything is in bin NonParallelForcesIndex.
+    ReferencePtr<const ForceSchedule> m_schedule;
 
-    // ReferencePtrs that point to caches in the state; We eventually add our
-    // thread-local result to these vectors.
+    // ReferencePtrs that point to caches in the state; the forces are added
+    // directly into these.
     ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForces;
     ReferencePtr<Vector_<Vec3>> m_particleForces;
     ReferencePtr<Vector> m_mobilityForces;
@@ -503,17 +716,70 @@ private:
     ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForceCache;
     ReferencePtr<Vector_<Vec3>> m_particleForceCache;
     ReferencePtr<Vector> m_mobilityForceCache;
-    
-    // These variables belong to the main thread. We use them to keep track of
-    // each thread's contribution that we will later add in to the final state
-    // cache.
-    Vector_<SpatialVec> m_rigidBodyForcesLocal;
-    Vector_<Vec3> m_particleForcesLocal;
-    Vector m_mobilityForcesLocal;
-
-    Vector_<SpatialVec> m_rigidBodyForceCacheLocal;
-    Vector_<Vec3> m_particleForceCacheLocal;
-    Vector m_mobilityForceCacheLocal;
+};
+
+/* The CalcForcesTasks of a GeneralForceSubsystem. A task refers to the State
+whose forces it is computing, so Dynamics realizations of different States that
+run at the same time (see System::realizeBatch()) each need their own. Extra
+tasks are cloned from the first one when needed and kept, along with their
+per-thread buffers, for later realizations. */
+class CalcForcesTaskPool {
+public:
+    CalcForcesTaskPool() = default;
+    // A copy starts out with one new task of the same kind.
+    CalcForcesTaskPool(const CalcForcesTaskPool& src) {
+        if (!src.tasks.empty())
+            reset(src.tasks.front()->clone());
+    }
+    CalcForcesTaskPool& operator=(const CalcForcesTaskPool&) = delete;
+    ~CalcForcesTaskPool() {clear();}
+
+    // Replace all the tasks with this one, taking over ownership.
+    void reset(CalcForcesTask* task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        clear();
+        tasks.push_back(task);
+        idle.push_back(task);
+    }
+
+    // Lends out a task for the duration of one Dynamics realization.
+    class Lease {
+    public:
+        explicit Lease(CalcForcesTaskPool& pool)
+        :   pool(pool), task(pool.acquire()) {}
+        ~Lease() {pool.release(task);}
+        CalcForcesTask* operator->() const {return task;}
+    private:
+        CalcForcesTaskPool& pool;
+        CalcForcesTask*     task;
+    };
+
+private:
+    CalcForcesTask* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(!tasks.empty());
+        if (idle.empty()) {
+            tasks.push_back(tasks.front()->clone());
+            idle.push_back(tasks.back());
+        }
+        CalcForcesTask* task = idle.back();
+        idle.pop_back();
+        return task;
+    }
+    void release(CalcForcesTask* task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(task);
+    }
+    void clear() {
+        for (CalcForcesTask* task : tasks)
+            delete task;
+        tasks.clear();
+        idle.clear();
+    }
+
+    std::mutex              mutex;
+    Array_<CalcForcesTask*> tasks; // owned
+    Array_<CalcForcesTask*> idle;  // not currently lent out
 };
 } //namespace
 
@@ -532,6 +798,7 @@ public:
         //The default number of threads is the physical number of processors
         //call setNumberOfThreads() if you want to override the thread count
         calcForcesExecutor = new ParallelExecutor();
+        loadBalancingInterval = DefaultLoadBalancingInterval;
     }
 
     ~GeneralForceSubsystemRep() {
@@ -598,6 +865,17 @@ public:
       return calcForcesExecutor->getMaxThreads();
     }
 
+    void setLoadBalancingInterval(int numRealizations) {
+        SimTK_APIARGCHECK_ALWAYS(numRealizations >= 0,
+            "GeneralForceSubsystemRep", "setLoadBalancingInterval",
+            "The interval must be zero or positive");
+        loadBalancingInterval = numRealizations;
+    }
+
+    int getLoadBalancingInterval() const {
+        return loadBalancingInterval;
+    }
+
     // These override default implementations of virtual methods in the
     // Subsystem::Guts class.
 
@@ -608,6 +886,7 @@ public:
         forceEnabledIndex.invalidate();
         enabledParallelForcesIndex.invalidate();
         enabledNonParallelForcesIndex.invalidate();
+        forceScheduleIndex.invalidate();
         cachedForcesAreValidCacheIndex.invalidate();
         rigidBodyForceCacheIndex.invalidate();
         mobilityForceCacheIndex.invalidate();
@@ -651,6 +930,8 @@ public:
                 new Value<Array_<ForceIndex> >(enabledNonParallelForces));
         enabledParallelForcesIndex = allocateCacheEntry(s, Stage::Instance,
                 new Value<Array_<ForceIndex> >(enabledParallelForces));
+        forceScheduleIndex = allocateCacheEntry(s, Stage::Dynamics,
+                new Value<ForceSchedule>());
 
         //Determine whether the subsystem has parallel forces - if so, use the
         //parallel implementation of CalcForcesTask (even if those parallel
@@ -674,9 +955,9 @@ public:
             }
         }
         if (hasParallelForces)
-            calcForcesTask = new CalcForcesParallelTask();
+            calcForcesTasks.reset(new CalcForcesParallelTask());
         else
-            calcForcesTask = new CalcForcesNonParallelTask();
+            calcForcesTasks.reset(new CalcForcesNonParallelTask());
         
         // Note that we'll allocate these even if all the needs-caching
         // elements are presently disabled. That way they'll be around when
@@ -787,6 +1068,19 @@ public:
         const Array_<ForceIndex>& enabledParallelForces =
                 Value<Array_<ForceIndex>>::
                          downcast(getCacheEntry(s, enabledParallelForcesIndex));
+        ForceSchedule& schedule = Value<ForceSchedule>::
+                            updDowncast(updCacheEntry(s, forceScheduleIndex));
+        const int numThreads = getNumberOfThreads();
+        if (!schedule.isBuiltFor(enabledNonParallelForces,
+                                 enabledParallelForces, numThreads)) {
+            // Ask for a fresh measurement in this realization.
+            schedule.build(forces, enabledNonParallelForces,
+                           enabledParallelForces, numThreads);
+            schedule.realizationsSinceBalance = loadBalancingInterval;
+        }
+        schedule.measuring = loadBalancingInterval > 0
+            && schedule.realizationsSinceBalance >= loadBalancingInterval;
+        ++schedule.realizationsSinceBalance;
 
         // Get access to System-global force cache arrays.
         Vector_<SpatialVec>&   rigidBodyForces =
@@ -799,13 +1093,14 @@ public:
         // Short circuit if we're not doing any caching here. Note that we're
         // checking whether the *index* is valid (i.e. does the cache entry
         // exist?), not the contents.
+        CalcForcesTaskPool::Lease calcForcesTask(calcForcesTasks);
         if (!cachedForcesAreValidCacheIndex.isValid()) {
             // Call calcForce() on all Forces, in parallel.
-            calcForcesTask->initializeAll(forces, s,
-                    enabledNonParallelForces, enabledParallelForces,
+            calcForcesTask->initializeAll(forces, s, schedule,
                     rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesTask->run(*calcForcesExecutor, schedule.getNumBins());
+            rebalanceIfMeasured(schedule, enabledNonParallelForces,
+                                enabledParallelForces);
 
             // Allow forces to do their own realization, but wait until all
             // forces have executed calcForce(). TODO: not sure if that is
@@ -843,23 +1138,21 @@ public:
 
             // Run through all the forces, accumulating directly into the
             // force arrays or indirectly into the cache as appropriate.
-            calcForcesTask->initializeCachedAndNonCached(forces, s,
-                                enabledNonParallelForces, enabledParallelForces,
+            calcForcesTask->initializeCachedAndNonCached(forces, s, schedule,
                                 rigidBodyForces, particleForces, mobilityForces,
                                 rigidBodyForceCache, particleForceCache,
                                 mobilityForceCache);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesTask->run(*calcForcesExecutor, schedule.getNumBins());
             cachedForcesAreValid = true;
         } else {
             // Cache already valid; just need to do the non-cached ones (the
             // ones for which dependsOnlyOnPositions is false).
-            calcForcesTask->initializeNonCached(forces, s,
-                               enabledNonParallelForces, enabledParallelForces,
+            calcForcesTask->initializeNonCached(forces, s, schedule,
                                rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesTask->run(*calcForcesExecutor, schedule.getNumBins());
         }
+        rebalanceIfMeasured(schedule, enabledNonParallelForces,
+                            enabledParallelForces);
 
         // Accumulate the values from the cache into the global arrays.
         rigidBodyForces += rigidBodyForceCache;
@@ -886,6 +1179,25 @@ public:
         return energy;
     }
 
+    // All the enabled force elements must be able to supply their 
+    // derivatives or we can't supply any. Try them all before touching the
+    // caller's matrices so that we don't leave a partial sum behind.
+    bool calcMobilityForceDerivatives(const State& state, Matrix& dFdQ, 
+                                      Matrix& dFdU) const override {
+        const Array_<bool>& forceEnabled = Value<Array_<bool> >::downcast
+           (getDiscreteVariable(state, forceEnabledIndex)).get();
+        Matrix dQ(dFdQ.nrow(), dFdQ.ncol(), Real(0));
+        Matrix dU(dFdU.nrow(), dFdU.ncol(), Real(0));
+        for (int i = 0; i < (int) forces.size(); ++i) {
+            if (forceEnabled[i] && 
+                !forces[i]->getImpl().calcMobilityForceDerivatives(state,dQ,dU))
+                return false;
+        }
+        dFdQ += dQ;
+        dFdU += dU;
+        return true;
+    }
+
     int realizeSubsystemAccelerationImpl(const State& s) const override {
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
@@ -915,11 +1227,30 @@ public:
     }
 
 private:
+    // After a realization in which calcForce() times were sampled, repack the
+    // forces for the following realizations.
+    void rebalanceIfMeasured(ForceSchedule& schedule,
+                        const Array_<ForceIndex>& enabledNonParallelForces,
+                        const Array_<ForceIndex>& enabledParallelForces) const
+    {
+        if (!schedule.measuring)
+            return;
+        schedule.measuring = false;
+        schedule.realizationsSinceBalance = 0;
+        schedule.balance(forces, enabledNonParallelForces,
+                         enabledParallelForces, getNumberOfThreads());
+    }
+
+    static const int DefaultLoadBalancingInterval = 100;
+
     Array_<Force*>                  forces;
 
     // For parallel calculation of forces.
     mutable ClonePtr<ParallelExecutor>               calcForcesExecutor;
-    mutable ClonePtr<CalcForcesTask>                 calcForcesTask;
+    mutable CalcForcesTaskPool                       calcForcesTasks;
+    // Number of Dynamics realizations between calcForce() timing samples;
+    // zero means never measure.
+    int                                              loadBalancingInterval;
     
     // TOPOLOGY "CACHE"
     // These indices must be filled in during realizeTopology and treated
@@ -932,6 +1263,9 @@ private:
     //parallel and non-parallel forces
     mutable CacheEntryIndex   enabledParallelForcesIndex;
     mutable CacheEntryIndex   enabledNonParallelForcesIndex;
+    // Which forces are computed by each index of the parallel task. This is
+    // a Dynamics stage entry whose value persists between realizations.
+    mutable CacheEntryIndex   forceScheduleIndex;
 
     // This set of cache entries is allocated only if some force element
     // overrode dependsOnlyOnPositions().
@@ -1007,6 +1341,12 @@ void GeneralForceSubsystem::setNumberOfThreads(unsigned numThreads)
 int GeneralForceSubsystem::getNumberOfThreads() const
 {   return getRep().getNumberOfThreads(); }
 
+void GeneralForceSubsystem::setLoadBalancingInterval(int numRealizations)
+{   updRep().setLoadBalancingInterval(numRealizations); }
+
+int GeneralForceSubsystem::getLoadBalancingInterval() const
+{   return getRep().getLoadBalancingInterval(); }
+
 const MultibodySystem& GeneralForceSubsystem::getMultibodySystem() const
 {   return MultibodySystem::downcast(getSystem()); }
 
@@ -0,0 +1,97 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MassMatrixFactorization.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SimTK;
+
+// L is column major, so L(i,j) is l[j*n+i]. Loops over j = parentU[j] visit
+// the ancestors of a mobility, which are the only nonzero columns in its row.
+
+void MassMatrixFactorization::setStructure(const Array_<int>& parentU) {
+    this->parentU = parentU;
+    const int n = size();
+    for (int i=0; i < n; ++i)
+        assert(parentU[i] < i);
+    L.resize(n, n);
+    factored = false;
+}
+
+// Featherstone, Rigid Body Dynamics Algorithms, Table 6.3, working on the
+// lower triangle. Each row k, from the last up, is scaled by its pivot and
+// then its outer product is subtracted from the rows of k's ancestors.
+bool MassMatrixFactorization::factor() {
+    const int n = size();
+    factored = false;
+    if (n == 0) {factored = true; return true;}
+
+    Real* l = L.updContiguousScalarData();
+    Real maxDiag = 0;
+    for (int k=0; k < n; ++k)
+        maxDiag = std::max(maxDiag, l[k*n+k]);
+    const Real minPivot = Eps*maxDiag;
+
+    for (int k=n-1; k >= 0; --k) {
+        Real& lkk = l[k*n+k];
+        if (!(lkk > minPivot))
+            return false;
+        lkk = std::sqrt(lkk);
+        const Real oolkk = 1/lkk;
+        for (int i=parentU[k]; i >= 0; i=parentU[i])
+            l[i*n+k] *= oolkk;
+        for (int i=parentU[k]; i >= 0; i=parentU[i]) {
+            const Real lki = l[i*n+k];
+            for (int j=i; j >= 0; j=parentU[j])
+                l[j*n+i] -= lki*l[j*n+k];
+        }
+    }
+    factored = true;
+    return true;
+}
+
+void MassMatrixFactorization::solveLTransposeInPlace(Real* y) const {
+    assert(factored);
+    const int n = size();
+    const Real* l = L.getContiguousScalarData();
+    for (int i=n-1; i >= 0; --i) {
+        if (y[i] == 0) continue;
+        const Real yi = (y[i] /= l[i*n+i]);
+        for (int j=parentU[i]; j >= 0; j=parentU[j])
+            y[j] -= l[j*n+i]*yi;
+    }
+}
+
+void MassMatrixFactorization::solveLInPlace(Real* x) const {
+    assert(factored);
+    const int n = size();
+    const Real* l = L.getContiguousScalarData();
+    for (int i=0; i < n; ++i) {
+        Real sum = x[i];
+        for (int j=parentU[i]; j >= 0; j=parentU[j])
+            sum -= l[j*n+i]*x[j];
+        x[i] = sum/l[i*n+i];
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef SimTK_SIMBODY_MASS_MATRIX_FACTORIZATION_H_
+#define SimTK_SIMBODY_MASS_MATRIX_FACTORIZATION_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This file declares the MassMatrixFactorization class, which holds the
+// sparse L^T L factorization of the mass matrix M in the matter subsystem's
+// State cache. This is internal source, not part of the Simbody API.
+
+#include "SimTKmath.h"
+
+namespace SimTK {
+
+//==============================================================================
+//                          MASS MATRIX FACTORIZATION
+//==============================================================================
+// M(i,j) can be nonzero only if mobility i and mobility j are the same or one
+// is an ancestor of the other, where we call mobility j the "parent" of
+// mobility i if it is the previous mobility of the same mobilizer or, for the
+// first mobility of a mobilizer, the last mobility of the nearest inboard
+// mobilizer that has any. Since parents always have lower indices than their
+// children, factoring M = ~L*L from the last row up, with L lower triangular,
+// causes no fill-in: L has exactly the sparsity of the lower triangle of M
+// (Featherstone's LTL factorization). The factor and both triangular solves
+// then cost time proportional to the number of nonzeros rather than n^2 or
+// n^3, and for a branched tree that is much less.
+//
+// We keep L in a dense n X n matrix since it is cheap to index and M is
+// formed there anyway; only the entries on ancestor paths are touched.
+class MassMatrixFactorization {
+public:
+    MassMatrixFactorization() : factored(false) {}
+
+    // Set the mobility tree: parentU[i] is the parent of mobility i as
+    // described above, or -1 if it has none. Parents must precede children.
+    // Also sizes the matrix and forgets any factorization.
+    void setStructure(const Array_<int>& parentU);
+
+    int size() const {return (int)parentU.size();}
+    const Array_<int>& getParentU() const {return parentU;}
+
+    // The n X n mass matrix, already sized; fill in at least its lower
+    // triangle on ancestor paths and then call factor().
+    Matrix& updMatrix() {return L;}
+
+    // Replace the matrix by its factor L, with M = ~L*L. Returns false if a
+    // pivot is not positive, in which case M is not positive definite (for
+    // example, because of massless bodies) and the factor must not be used.
+    bool factor();
+    bool isFactored() const {return factored;}
+
+    // The lower-triangular factor, valid only after factor() succeeds. Entries
+    // not on ancestor paths, and the upper triangle, are garbage.
+    const Matrix& getL() const {return L;}
+
+    // x = M^-1 x, in place. Cost is 4 flops per nonzero in L.
+    void solveInPlace(Real* x) const
+    {   solveLTransposeInPlace(x); solveLInPlace(x); }
+
+    // y = L^-T y, in place. Entries of y that are zero and have no nonzero
+    // descendants stay zero at no cost, so this is cheap for a right hand
+    // side that is nonzero only in one branch of the tree.
+    void solveLTransposeInPlace(Real* y) const;
+
+    // x = L^-1 x, in place.
+    void solveLInPlace(Real* x) const;
+
+private:
+    Array_<int> parentU;
+    Matrix      L;          // M before factoring, then L
+    bool        factored;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_MASS_MATRIX_FACTORIZATION_H_
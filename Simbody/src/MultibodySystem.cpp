@@ -287,6 +287,56 @@ int MultibodySystemRep::realizeAccelerationImpl(const State& s) const {
 
     return 0;
 }
+// The u rows come from the tree forward dynamics derivatives, which hold the
+// applied forces fixed, plus M^-1 times the force subsystems' own 
+// derivatives. For the q rows we use d qdot/du = N and neglect d qdot/dq =
+// dN/dq*u, which is small and smooth. We give up if the matter subsystem
+// doesn't own all of q and u, if there are z's or constraint multipliers
+// (the tree derivatives know nothing of constraint forces), or if any force
+// subsystem can't report its derivatives.
+bool MultibodySystemRep::
+calcYDotJacobianImpl(const State& s, Matrix& dYDotdY) const {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    const int nq = matter.getNQ(s), nu = matter.getNU(s);
+    if (nq != s.getNQ() || nu != s.getNU() || s.getNZ() != 0)
+        return false;
+
+    realize(s, Stage::Dynamics);
+    if (s.getNMultipliers() != 0)
+        return false;
+
+    Matrix dFdQ(nu, nq, Real(0)), dFdU(nu, nu, Real(0));
+    for (int i=0; i < (int)forceSubs.size(); ++i)
+        if (!getForceSubsystem(forceSubs[i]).getRep()
+                .calcMobilityForceDerivatives(s, dFdQ, dFdU))
+            return false;
+
+    Matrix dUDotdQ, dUDotdU, dUDotdTau;
+    matter.calcTreeForwardDynamicsDerivatives(s, 
+        getMobilityForces(s, Stage::Dynamics), 
+        getRigidBodyForces(s, Stage::Dynamics),
+        dUDotdQ, dUDotdU, dUDotdTau);
+    dUDotdQ += dUDotdTau*dFdQ;
+    dUDotdU += dUDotdTau*dFdU;
+
+    const int ny = s.getNY();
+    const int q0 = s.getQStart(), u0 = s.getUStart();
+    dYDotdY.resize(ny, ny);
+    dYDotdY = 0;
+    dYDotdY(u0, q0, nu, nq) = dUDotdQ;
+    dYDotdY(u0, u0, nu, nu) = dUDotdU;
+
+    Vector e(nu, Real(0)), col(nq);
+    for (int j=0; j < nu; ++j) {
+        e[j] = 1;
+        matter.multiplyByN(s, false, e, col);
+        for (int i=0; i < nq; ++i)
+            dYDotdY(q0+i, u0+j) = col[i];
+        e[j] = 0;
+    }
+    return true;
+}
+
 int MultibodySystemRep::realizeReportImpl(const State& s) const {
     getGlobalSubsystem().getRep().realizeSubsystemReport(s);
 
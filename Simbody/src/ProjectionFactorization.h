@@ -0,0 +1,101 @@
+#ifndef SimTK_SIMBODY_PROJECTION_FACTORIZATION_H_
+#define SimTK_SIMBODY_PROJECTION_FACTORIZATION_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This file declares the ProjectionFactorization class, which holds the
+// factored, weighted constraint Jacobian used by projectQ() or projectU() in
+// the matter subsystem's State cache. This is internal source, not part of
+// the Simbody API.
+
+#include "SimTKmath.h"
+
+namespace SimTK {
+
+//==============================================================================
+//                          PROJECTION FACTORIZATION
+//==============================================================================
+// Constraint projection solves a nonlinear least squares problem by Newton
+// iteration on the weighted constraint Jacobian. Forming and factoring that
+// matrix is usually the bulk of the cost of a projection, but the Jacobian
+// changes little between the projections an integrator does after each step.
+// So we keep the last factorization in the State and iterate with it
+// (modified Newton) for as long as it converges quickly enough.
+//
+// A factorization may be used only with the error weights and u weights it
+// was made with; the column scaling actually applied is recorded so that the
+// step computed from a stale factorization is unscaled consistently. The q
+// version says when the factorization is exact for the State's current q.
+class ProjectionFactorization {
+public:
+    ProjectionFactorization() : factored(false), qVersion(-1) {}
+
+    // Forget any factorization; the next projection must factor.
+    void clear() {factored = false; qVersion = -1;}
+
+    // True if there is a factorization made with these error and u weights,
+    // whether or not it is still exact.
+    bool isUsableWith(const Vector& errWeights, const Vector& uWeights) const
+    {   return factored && isSame(errWeights, this->errWeights)
+                        && isSame(uWeights, this->uWeights); }
+
+    // True if the factorization was made at the q with this version.
+    bool isCurrent(ValueVersion qVersion) const
+    {   return factored && qVersion == this->qVersion; }
+
+    // Factor the transposed, weighted Jacobian Jwt = ~(T J colScale), where T
+    // is diag(errWeights), and record how it was made.
+    void factor(const Matrix& Jwt, Real conditioningTol,
+                const Vector& errWeights, const Vector& uWeights,
+                const Vector& colScale, ValueVersion qVersion) {
+        qtz.factor<Real>(~Jwt, conditioningTol);
+        this->errWeights = errWeights;
+        this->uWeights   = uWeights;
+        this->colScale   = colScale;
+        this->qVersion   = qVersion;
+        factored = true;
+    }
+
+    const FactorQTZ& getFactorization() const {return qtz;}
+    const Vector& getColumnScale() const {return colScale;}
+
+private:
+    static bool isSame(const Vector& a, const Vector& b) {
+        if (a.size() != b.size()) return false;
+        for (int i=0; i < a.size(); ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+    FactorQTZ       qtz;
+    Vector          errWeights; // Tp or Tpv
+    Vector          uWeights;   // Wu
+    Vector          colScale;   // column scaling used in the factorization
+    bool            factored;
+    ValueVersion    qVersion;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_PROJECTION_FACTORIZATION_H_
@@ -31,6 +31,7 @@
 
 #include "MobilizedBodyImpl.h"
 #include "SimbodyMatterSubsystemRep.h"
+#include "MassMatrixFactorization.h"
 class RigidBodyNode;
 
 #include <string>
@@ -107,6 +108,34 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+void SimbodyMatterSubsystem::setNumberOfThreads(unsigned numThreads) {
+    updRep().setNumberOfThreads(numThreads);
+}
+
+int SimbodyMatterSubsystem::getNumberOfThreads() const {
+    return getRep().getNumberOfThreads();
+}
+
+void SimbodyMatterSubsystem::setMinBodiesPerParallelLevel(int numBodies) {
+    updRep().setMinBodiesPerParallelLevel(numBodies);
+}
+
+int SimbodyMatterSubsystem::getMinBodiesPerParallelLevel() const {
+    return getRep().getMinBodiesPerParallelLevel();
+}
+
+void SimbodyMatterSubsystem::setUseBranchParallelism(bool useBranches) {
+    updRep().setUseBranchParallelism(useBranches);
+}
+
+bool SimbodyMatterSubsystem::getUseBranchParallelism() const {
+    return getRep().getUseBranchParallelism();
+}
+
+int SimbodyMatterSubsystem::getNumTreeBranches() const {
+    return getRep().getNumTreeBranches();
+}
+
 
 ConstraintIndex SimbodyMatterSubsystem::
 adoptConstraint(Constraint& child) {return updRep().adoptConstraint(child);}
@@ -227,6 +256,58 @@ void SimbodyMatterSubsystem::calcAccelerationIgnoringConstraints
 
 
 
+//==============================================================================
+//                 CALC TREE FORWARD DYNAMICS DERIVATIVES
+//==============================================================================
+void SimbodyMatterSubsystem::calcTreeForwardDynamicsDerivatives
+   (const State&                state,
+    const Vector&               appliedMobilityForces,
+    const Vector_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     dUDotdQ,
+    Matrix&                     dUDotdU,
+    Matrix&                     dUDotdTau) const
+{
+    SimTK_APIARGCHECK2_ALWAYS(
+        appliedMobilityForces.size()==getNumMobilities(),
+        "SimbodyMatterSubsystem", "calcTreeForwardDynamicsDerivatives",
+        "Got %d appliedMobilityForces but there are %d mobilities.",
+        appliedMobilityForces.size(), getNumMobilities());
+    SimTK_APIARGCHECK2_ALWAYS(
+        appliedBodyForces.size()==getNumBodies(),
+        "SimbodyMatterSubsystem", "calcTreeForwardDynamicsDerivatives",
+        "Got %d appliedBodyForces but there are %d bodies (including Ground).",
+        appliedBodyForces.size(), getNumBodies());
+
+    getRep().calcTreeForwardDynamicsDerivatives(state, appliedMobilityForces,
+        appliedBodyForces, dUDotdQ, dUDotdU, dUDotdTau);
+}
+
+void SimbodyMatterSubsystem::findMobilizerYBlocks
+   (const State& state, Array_< Array_<int> >& yBlocks) const
+{
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const SubsystemIndex subsys = getMySubsystemIndex();
+    const int qStart = state.getQStart() + state.getQStart(subsys);
+    const int uStart = state.getUStart() + state.getUStart(subsys);
+
+    const int nb = rep.getNumBodies();
+    yBlocks.resize(nb);
+    yBlocks[0].clear();
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const MobilizedBody& mobod = getMobilizedBody(mbx);
+        Array_<int>& block = yBlocks[mbx];
+        block.clear();
+        const int firstQ = mobod.getFirstQIndex(state);
+        for (int i=0; i < mobod.getNumQ(state); ++i)
+            block.push_back(qStart + firstQ + i);
+        const int firstU = mobod.getFirstUIndex(state);
+        for (int i=0; i < mobod.getNumU(state); ++i)
+            block.push_back(uStart + firstU + i);
+    }
+}
+
+
+
 //==============================================================================
 //                  CALC RESIDUAL FORCE IGNORING CONSTRAINTS
 //==============================================================================
@@ -478,6 +559,49 @@ void SimbodyMatterSubsystem::calcM(const State& s, Matrix& M) const
 void SimbodyMatterSubsystem::calcMInv(const State& s, Matrix& MInv) const 
 {   getRep().calcMInv(s, MInv); }
 
+// Copy out the lower-triangular factor, with zeroes where L has no entries
+// (MassMatrixFactorization leaves garbage there).
+void SimbodyMatterSubsystem::calcMFactor(const State& s, Matrix& L) const {
+    const MassMatrixFactorization& factored = getRep().getFactoredM(s);
+    const Array_<int>& parentU = factored.getParentU();
+    const Matrix& LL = factored.getL();
+    const int nu = factored.size();
+    L.resize(nu,nu);
+    L.setTo(Real(0));
+    for (int i=0; i < nu; ++i)
+        for (int j=i; j >= 0; j=parentU[j])
+            L(i,j) = LL(i,j);
+}
+
+void SimbodyMatterSubsystem::
+multiplyByMInvUsingMFactor(const State& state, const Vector& v, 
+                           Vector& MInvV) const {
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const int nu = rep.getNU(state);
+
+    SimTK_ERRCHK2_ALWAYS(v.size() == nu,
+        "SimbodyMatterSubsystem::multiplyByMInvUsingMFactor()",
+        "Argument 'v' had length %d but should have the same length"
+        " as the number of mobilities (generalized speeds u) %d.", 
+        v.size(), nu);
+
+    rep.multiplyByMInvUsingFactoredM(state, v, MInvV);
+}
+
+void SimbodyMatterSubsystem::
+calcOperationalSpaceInertia(const State& state, const Matrix& J,
+                            Matrix& Lambda) const {
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const int nu = rep.getNU(state);
+
+    SimTK_ERRCHK2_ALWAYS(J.ncol() == nu,
+        "SimbodyMatterSubsystem::calcOperationalSpaceInertia()",
+        "Argument 'J' had %d columns but should have one for each of"
+        " the mobilities (generalized speeds u) %d.", J.ncol(), nu);
+
+    rep.calcOperationalSpaceInertia(state, J, Lambda);
+}
+
 
 // Note: the implementation methods that generate matrices do *not* require 
 // contiguous storage, so we can just forward to them with no preliminaries.
@@ -1366,10 +1490,48 @@ void SimbodyMatterSubsystem::multiplyByStationJacobianTranspose
 }
 
 
+//------------------------------------------------------------------------------
+//                        FOR EACH TASK JACOBIAN COLUMN
+//------------------------------------------------------------------------------
+// Call f(task, ux, w, v) for each nonzero column ux of the Jacobian of the nt
+// task points P fixed on bodies B, where w and v are the angular and linear
+// velocity of the task point in Ground produced by unit u[ux]. Only the
+// mobilities on the path from B to Ground can move P, so we walk that path
+// for each task. Column j of mobilizer A's H_PB_G is the spatial velocity it
+// produces at Ao; we just shift that to P. Cost is 15 flops per task plus 12
+// flops per mobility on each task's path.
+template <class F>
+static void forEachTaskJacobianColumn
+   (const SimbodyMatterSubsystemRep&    rep,
+    const State&                        state,
+    const Array_<MobilizedBodyIndex>&   onBodyB,
+    const Array_<Vec3>&                 p_BP,
+    const char*                         methodName,
+    F                                   f)
+{
+    const int nb = rep.getNumBodies();
+    const SBTreePositionCache& pc = rep.getTreePositionCache(state);
+    for (int task=0; task < (int)onBodyB.size(); ++task) {
+        const MobilizedBodyIndex mobodx = onBodyB[task];
+        SimTK_INDEXCHECK(mobodx, nb, methodName);
+        const RigidBodyNode* node = &rep.getRigidBodyNode(mobodx);
+        const Vec3 p_GP = node->getX_GB(pc) * p_BP[task];           // 15 flops
+        for (; !node->isGroundNode(); node = node->getParent()) {
+            const Vec3 p_AP_G = p_GP - node->getX_GB(pc).p();       //  3 flops
+            for (int j=0; j < node->getDOF(); ++j) {
+                const SpatialVec& H = node->getHCol(pc, j);
+                f(task, node->getUIndex()+j, H[0], H[1] + H[0] % p_AP_G);
+            }                                                       // 12 flops
+        }
+    }
+}
+
+
 //------------------------------------------------------------------------------
 //                       CALC STATION JACOBIAN (spatial)
 //------------------------------------------------------------------------------
-// Cost is 3*nt*(14 + 18nb + 11n) flops.
+// Cost is 15*nt flops plus 12 flops per mobility on each task's path to
+// Ground, plus zeroing the result.
 // Each subsequent multiply by JS_G*u would be 3*nt*(2n-1)~=6*nt*n flops.
 void SimbodyMatterSubsystem::calcStationJacobian
    (const State&                        state,
@@ -1378,7 +1540,7 @@ void SimbodyMatterSubsystem::calcStationJacobian
     Matrix_<Vec3>&                      JS_G) const // nt X nu Vec3s
 {
     const SimbodyMatterSubsystemRep& rep = getRep();
-    const int nb = rep.getNumBodies(), nu = rep.getNumMobilities();
+    const int nu = rep.getNumMobilities();
     const int nt = (int)onBodyB.size(); // number of tasks
 
     SimTK_ERRCHK2_ALWAYS(p_BS.size() == nt,
@@ -1389,32 +1551,12 @@ void SimbodyMatterSubsystem::calcStationJacobian
     // Calculate J=dvdu where v is linear velocity of task stations p_BS.
     // (This is nt half-rows of J.)
     JS_G.resize(nt,nu);
-
-    // We're assuming that 3*nt << nu so that it is cheaper to calculate ~JS
-    // than JS, using ~J*F rather than J*u.
-    // TODO: check dimensions and use whichever method is cheaper.
-    Vector_<SpatialVec> F_G(nb); F_G.setToZero();
-    Vector col(nu); // temporary to hold column of ~J_G
-    for (int task=0; task < nt; ++task) {
-        const MobilizedBodyIndex mobodx = onBodyB[task];
-        SimTK_INDEXCHECK(mobodx, nb,
-            "SimbodyMatterSubsystem::calcStationJacobian()");
-        const MobilizedBody& mobod = rep.getMobilizedBody(mobodx);
-        const Vec3 p_BS_G = 
-            mobod.expressVectorInGroundFrame(state, p_BS[task]);    // 15 flops
-
-        // Calculate the 3 rows of JS corresponding to this task.
-        RowVectorView_<Vec3> row = JS_G[task];
-        SpatialVec& Fb = F_G[mobodx]; // the only one we'll change
-        for (int i=0; i < 3; ++i) {
-            Fb[1][i] = 1;
-            Fb[0] = p_BS_G % Fb[1]; // r X F (9 flops)
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            for (int r=0; r < nu; ++r) row[r][i] = col[r]; 
-            Fb[1][i] = 0;
-            Fb[0] = 0;
-        }
-    }
+    JS_G.setTo(Vec3(0)); // fills contiguous storage directly; setToZero()
+                         // goes element by element
+    forEachTaskJacobianColumn(rep, state, onBodyB, p_BS,
+        "SimbodyMatterSubsystem::calcStationJacobian()",
+        [&](int task, int ux, const Vec3&, const Vec3& v)
+        {   JS_G(task,ux) = v; });
 }
 
 
@@ -1430,7 +1572,7 @@ void SimbodyMatterSubsystem::calcStationJacobian
     Matrix&                             JS_G) const // 3*nt X nu Vec3s
 {
     const SimbodyMatterSubsystemRep& rep = getRep();
-    const int nb = rep.getNumBodies(), nu = rep.getNumMobilities();
+    const int nu = rep.getNumMobilities();
     const int nt = (int)onBodyB.size(); // number of tasks
 
     SimTK_ERRCHK2_ALWAYS(p_BS.size() == nt,
@@ -1441,31 +1583,12 @@ void SimbodyMatterSubsystem::calcStationJacobian
     // Calculate J=dvdu where v is linear velocity of p_BS.
     // (This is nt rows of J.)
     JS_G.resize(3*nt,nu);
-
-    // We're assuming that 3*nt << nu so that it is cheaper to calculate ~JS
-    // than JS, using ~J*F rather than J*u.
-    // TODO: check dimensions and use whichever method is cheaper.
-    Vector_<SpatialVec> F_G(nb); F_G.setToZero();
-    Vector col(nu); // contiguous temporary to hold column of ~J_G
-    for (int task=0; task < nt; ++task) {
-        const MobilizedBodyIndex mobodx = onBodyB[task];
-        SimTK_INDEXCHECK(mobodx, nb,
-            "SimbodyMatterSubsystem::calcStationJacobian()");
-        const MobilizedBody& mobod = rep.getMobilizedBody(mobodx);
-        const Vec3 p_BS_G = 
-            mobod.expressVectorInGroundFrame(state, p_BS[task]);    // 15 flops
-
-        // Calculate the 3 rows of JS corresponding to this task.
-        SpatialVec& Fb = F_G[mobodx]; // the only one we'll change
-        for (int i=0; i < 3; ++i) {
-            Fb[1][i] = 1;
-            Fb[0] = p_BS_G % Fb[1]; // r X F (9 flops)
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            JS_G[3*task + i] = ~col; 
-            Fb[1][i] = 0;
-            Fb[0] = 0;
-        }
-    }
+    JS_G.setTo(Real(0)); // see the other signature
+    forEachTaskJacobianColumn(rep, state, onBodyB, p_BS,
+        "SimbodyMatterSubsystem::calcStationJacobian()",
+        [&](int task, int ux, const Vec3&, const Vec3& v) {
+            for (int i=0; i < 3; ++i) JS_G(3*task+i, ux) = v[i];
+        });
 }
 
 
@@ -1664,7 +1787,8 @@ void SimbodyMatterSubsystem::multiplyByFrameJacobianTranspose
 //------------------------------------------------------------------------------
 //                       CALC FRAME JACOBIAN (spatial)
 //------------------------------------------------------------------------------
-// Cost is 42*nt + 6*(18nb + 11nu) flops.
+// Cost is 15*nt flops plus 12 flops per mobility on each task's path to
+// Ground, plus zeroing the result.
 // Each subsequent multiply by JF_G*u would be 12*nu-6 flops.
 void SimbodyMatterSubsystem::calcFrameJacobian
    (const State&                        state,
@@ -1673,7 +1797,6 @@ void SimbodyMatterSubsystem::calcFrameJacobian
     Matrix_<SpatialVec>&                JF_G) const
 {
     const SimbodyMatterSubsystemRep& rep = getRep();
-    const int nb = rep.getNumBodies(); // includes ground
     const int nu = rep.getNumMobilities();
     const int nt = (int)onBodyB.size(); // number of tasks
 
@@ -1685,42 +1808,11 @@ void SimbodyMatterSubsystem::calcFrameJacobian
     // Calculate J=dVdu where V is spatial velocity of task frames A.
     // (This is nt rows of J.)
     JF_G.resize(nt,nu);
-
-    // We're assuming that 6*nt << nu so that it is cheaper to calculate ~JF
-    // than JF, using ~J*F rather than J*u.
-    // TODO: check dimensions and use whichever method is cheaper.
-    Vector_<SpatialVec> F_G(nb); F_G.setToZero();
-    Vector col(nu); // temporary to hold column of ~J_G
-    for (int task=0; task < nt; ++task) {
-        const MobilizedBodyIndex mobodx = onBodyB[task];
-        SimTK_INDEXCHECK(mobodx, nb,
-            "SimbodyMatterSubsystem::calcFrameJacobian()");
-        const MobilizedBody& mobod = rep.getMobilizedBody(mobodx);
-        const Vec3 p_BA_G = 
-            mobod.expressVectorInGroundFrame(state, p_BA[task]);    // 15 flops
-
-        // Calculate the 6 rows of JS corresponding to this task.
-        RowVectorView_<SpatialVec> row = JF_G[task];
-        SpatialVec& Fb = F_G[mobodx]; // the only one we'll change
-
-        // Rotational part.
-        for (int i=0; i < 3; ++i) {
-            Fb[0][i] = 1;
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            for (int r=0; r < nu; ++r) row[r][0][i] = col[r]; 
-            Fb[0][i] = 0;
-        }
-
-        // Translational part.
-        for (int i=0; i < 3; ++i) {
-            Fb[1][i] = 1;
-            Fb[0] = p_BA_G % Fb[1]; // r X F (9 flops)
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            for (int r=0; r < nu; ++r) row[r][1][i] = col[r]; 
-            Fb[1][i] = 0;
-            Fb[0] = 0;
-        }
-    }
+    JF_G.setTo(SpatialVec(Vec3(0),Vec3(0))); // see calcStationJacobian()
+    forEachTaskJacobianColumn(rep, state, onBodyB, p_BA,
+        "SimbodyMatterSubsystem::calcFrameJacobian()",
+        [&](int task, int ux, const Vec3& w, const Vec3& v)
+        {   JF_G(task,ux) = SpatialVec(w,v); });
 }
 
 
@@ -1729,7 +1821,6 @@ void SimbodyMatterSubsystem::calcFrameJacobian
 //------------------------------------------------------------------------------
 // Alternate signature that returns a frame Jacobian as a 6*nt x n Matrix 
 // rather than as a Matrix of SpatialVecs.
-// Cost is 42*nt + 6*(18*nb + 11*n)
 void SimbodyMatterSubsystem::calcFrameJacobian
    (const State&                        state,
     const Array_<MobilizedBodyIndex>&   onBodyB,
@@ -1737,7 +1828,6 @@ void SimbodyMatterSubsystem::calcFrameJacobian
     Matrix&                             JF_G) const // 6*nt X n
 {
     const SimbodyMatterSubsystemRep& rep = getRep();
-    const int nb = rep.getNumBodies(); // includes ground
     const int nu = rep.getNumMobilities();
     const int nt = (int)onBodyB.size(); // number of tasks
 
@@ -1749,41 +1839,15 @@ void SimbodyMatterSubsystem::calcFrameJacobian
     // Calculate J=dVdu where V is spatial velocity of task frames A.
     // (This is 6*nt rows of the scalar matrix form of J.)
     JF_G.resize(6*nt,nu);
-
-    // We're assuming that 6*nt << nu so that it is cheaper to calculate ~JF
-    // than JF, using ~J*F rather than J*u.
-    // TODO: check dimensions and use whichever method is cheaper.
-    Vector_<SpatialVec> F_G(nb); F_G.setToZero();
-    Vector col(nu); // temporary to hold column of ~J_G
-    for (int task=0; task < nt; ++task) {
-        const MobilizedBodyIndex mobodx = onBodyB[task];
-        SimTK_INDEXCHECK(mobodx, nb,
-            "SimbodyMatterSubsystem::calcFrameJacobian()");
-        const MobilizedBody& mobod = rep.getMobilizedBody(mobodx);
-        const Vec3 p_BA_G = 
-            mobod.expressVectorInGroundFrame(state, p_BA[task]);    // 15 flops
-
-        // Calculate the 6 rows of JS corresponding to this task.
-        SpatialVec& Fb = F_G[mobodx]; // the only one we'll change
-
-        // Rotational part.
-        for (int i=0; i < 3; ++i) {
-            Fb[0][i] = 1;
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            JF_G[6*task + i] = ~col;
-            Fb[0][i] = 0;
-        }
-
-        // Translational part.
-        for (int i=0; i < 3; ++i) {
-            Fb[1][i] = 1;
-            Fb[0] = p_BA_G % Fb[1]; // r X F (9 flops)
-            rep.multiplyBySystemJacobianTranspose(state,F_G,col);// 18nb+11nu flops
-            JF_G[6*task + 3 + i] = ~col;
-            Fb[1][i] = 0;
-            Fb[0] = 0;
-        }
-    }
+    JF_G.setTo(Real(0)); // see calcStationJacobian()
+    forEachTaskJacobianColumn(rep, state, onBodyB, p_BA,
+        "SimbodyMatterSubsystem::calcFrameJacobian()",
+        [&](int task, int ux, const Vec3& w, const Vec3& v) {
+            for (int i=0; i < 3; ++i) {
+                JF_G(6*task+i,   ux) = w[i];
+                JF_G(6*task+3+i, ux) = v[i];
+            }
+        });
 }
 
 
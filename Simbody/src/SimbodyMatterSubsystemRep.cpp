@@ -34,9 +34,14 @@
 #include "MultibodySystemRep.h"
 #include "MobilizedBodyImpl.h"
 #include "ConstraintImpl.h"
+#include "ConstraintOperatorFactorization.h"
+#include "MassMatrixFactorization.h"
+#include "ProjectionFactorization.h"
 
 #include <string>
 #include <iostream>
+#include <exception>
+#include <mutex>
 using std::cout; using std::endl;
 
 SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep
@@ -102,10 +107,140 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     // be deleted when the MobilizedBodyImpl objects are.
     rbNodeLevels.clear();
     nodeNum2NodeMap.clear();
+    treeTrunk.clear();
+    treeBranches.clear();
 
     showDefaultGeometry = true;
 }
 
+//==============================================================================
+//                             PARALLEL SWEEPS
+//==============================================================================
+namespace {
+// Base for the tasks that run parts of a tree sweep on levelExecutor's 
+// threads. The first exception thrown is remembered so that it can be 
+// rethrown on the calling thread.
+class SweepTask : public ParallelExecutor::Task {
+public:
+    void rethrowIfFailed() const {
+        if (error) std::rethrow_exception(error);
+    }
+protected:
+    void recordFailure() {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+    }
+private:
+    std::mutex              errorMutex;
+    std::exception_ptr      error;
+};
+
+// Visits the nodes of one tree level for forEachNodeInLevel(), one contiguous
+// chunk of the level per task index.
+template <class F>
+class NodeLevelTask : public SweepTask {
+public:
+    NodeLevelTask(const RBNodePtrList& nodes, int chunkSize, const F& f)
+    :   nodes(nodes), chunkSize(chunkSize), f(f) {}
+
+    void execute(int chunk) override {
+        const int begin = chunk*chunkSize;
+        const int end = std::min(begin + chunkSize, (int)nodes.size());
+        try {
+            for (int j=begin; j < end; ++j)
+                f(*nodes[j]);
+        } catch (...) {recordFailure();}
+    }
+private:
+    const RBNodePtrList&    nodes;
+    const int               chunkSize;
+    const F&                f;
+};
+
+// Sweeps the whole of one branch of the tree per task index, base to tip or
+// tip to base.
+template <class F>
+class BranchTask : public SweepTask {
+public:
+    BranchTask(const Array_<RBNodePtrList>& branches, bool inward, const F& f)
+    :   branches(branches), inward(inward), f(f) {}
+
+    void execute(int b) override {
+        const RBNodePtrList& nodes = branches[b];
+        const int n = (int)nodes.size();
+        try {
+            if (inward) for (int j=n-1; j >= 0; --j) f(*nodes[j]);
+            else        for (int j=0; j < n; ++j)    f(*nodes[j]);
+        } catch (...) {recordFailure();}
+    }
+private:
+    const Array_<RBNodePtrList>&    branches;
+    const bool                      inward;
+    const F&                        f;
+};
+}
+
+template <class F> void SimbodyMatterSubsystemRep::
+forEachNodeInLevel(int level, const F& f) const {
+    const RBNodePtrList& nodes = rbNodeLevels[level];
+    const int n = (int)nodes.size();
+    if (!levelExecutor || n < minBodiesPerParallelLevel
+        || ParallelExecutor::isWorkerThread()) {
+        for (int j=0; j < n; ++j)
+            f(*nodes[j]);
+        return;
+    }
+
+    const int numThreads = std::min(levelExecutor->getMaxThreads(), n);
+    const int chunkSize = (n + numThreads-1) / numThreads;
+    NodeLevelTask<F> task(nodes, chunkSize, f);
+    levelExecutor->execute(task, (n + chunkSize-1) / chunkSize);
+    task.rethrowIfFailed();
+}
+
+bool SimbodyMatterSubsystemRep::shouldSweepByBranch() const {
+    if (!levelExecutor || !useBranchParallelism || treeBranches.size() < 2
+        || ParallelExecutor::isWorkerThread())
+        return false;
+    // Branches are sorted largest first. If one branch has nearly all the 
+    // bodies there is little to be gained by running it alongside the others
+    // and we're better off dividing up the levels.
+    const int numBranchBodies = getNumMobilizedBodies() - treeTrunk.size();
+    return numBranchBodies >= minBodiesPerParallelLevel
+        && 4*(int)treeBranches.front().size() <= 3*numBranchBodies;
+}
+
+template <class F> void SimbodyMatterSubsystemRep::
+sweepOutward(const F& f) const {
+    if (!shouldSweepByBranch()) {
+        for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
+            forEachNodeInLevel(i, f);
+        return;
+    }
+
+    for (const RigidBodyNode* node : treeTrunk)
+        f(*node);
+    BranchTask<F> task(treeBranches, false, f);
+    levelExecutor->execute(task, treeBranches.size());
+    task.rethrowIfFailed();
+}
+
+template <class F> void SimbodyMatterSubsystemRep::
+sweepInward(const F& f) const {
+    if (!shouldSweepByBranch()) {
+        for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
+            forEachNodeInLevel(i, f);
+        return;
+    }
+
+    BranchTask<F> task(treeBranches, true, f);
+    levelExecutor->execute(task, treeBranches.size());
+    task.rethrowIfFailed();
+    for (int j=treeTrunk.size()-1; j >= 0; --j)
+        f(*treeTrunk[j]);
+}
+
+
 MobilizedBodyIndex SimbodyMatterSubsystemRep::adoptMobilizedBody
    (MobilizedBodyIndex parentIx, MobilizedBody& child) 
 {
@@ -297,10 +432,7 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
     // position level, however they are not topological since modeling
     // choices affect whether we use them. See realizeModel() below.
 
-//    groundAncestorConstraint.clear();
-//    branches.clear(); 
-//    if (rbNodeLevels.size() > 1)
-//        branches.resize(rbNodeLevels[1].size()); // each level 1 body is a branch
+    findTreeBranches();
 
     nextAncestorConstrainedBodyPoolSlot = AncestorConstrainedBodyPoolIndex(0);
 
@@ -329,6 +461,44 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
     }
 }
 
+// Split the tree into independent branches that the parallel sweeps can each
+// do in one piece. The trunk starts at Ground and continues through any chain
+// of single children (a floating base, say) down to the first body with more
+// than one child; the subtree of each of that body's children is a branch. 
+// The nodes of a branch are kept in MobilizedBodyIndex order, which has every
+// parent before its children.
+void SimbodyMatterSubsystemRep::findTreeBranches() {
+    treeTrunk.clear();
+    treeBranches.clear();
+
+    const RigidBodyNode* base = rbNodeLevels[0][0];
+    treeTrunk.push_back(base);
+    while (base->getNumChildren() == 1) {
+        base = base->getChild(0);
+        treeTrunk.push_back(base);
+    }
+    if (base->getNumChildren() == 0)
+        return; // there is only a trunk
+
+    Array_<int,MobilizedBodyIndex> branchOf(getNumMobilizedBodies(), -1);
+    for (int i=0; i < base->getNumChildren(); ++i)
+        branchOf[base->getChild(i)->getNodeNum()] = i;
+    treeBranches.resize(base->getNumChildren());
+    for (MobilizedBodyIndex mbx(0); mbx < getNumMobilizedBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (branchOf[mbx] < 0 && node.getLevel() > base->getLevel() + 1)
+            branchOf[mbx] = branchOf[node.getParent()->getNodeNum()];
+        if (branchOf[mbx] >= 0)
+            treeBranches[branchOf[mbx]].push_back(&node);
+    }
+
+    // Start the biggest branches first so that the small ones fill in around
+    // them. A stable sort keeps the outcome independent of the library.
+    std::stable_sort(treeBranches.begin(), treeBranches.end(),
+        [](const RBNodePtrList& a, const RBNodePtrList& b)
+        {   return a.size() > b.size(); });
+}
+
 int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
     SimTK_STAGECHECK_EQ_ALWAYS(getStage(s), Stage::Empty, 
         "SimbodyMatterSubsystem::realizeTopology()");
@@ -477,6 +647,37 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // The factored constraint operator G*M^-1*~G is needed whenever we
+    // calculate multipliers but depends only on time and positions (and on
+    // velocities if there are nonholonomic or acceleration-only constraints;
+    // the entry itself records the u version in that case). So it survives
+    // velocity and force changes, such as repeated realizations of
+    // Acceleration stage at the same configuration.
+    tc.constraintOperatorCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Time, Stage::Infinity,
+        true /*q*/, false /*u*/, false /*z*/, {} /*dv*/, {} /*ce*/,
+        new Value<ConstraintOperatorFactorization>());
+
+    // The factored mass matrix is needed only on request, but when it is
+    // it's usually needed repeatedly at the same configuration (by a
+    // controller, say), so we keep it until the positions change.
+    tc.massMatrixFactorizationCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, 
+        {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
+        new Value<MassMatrixFactorization>());
+
+    // The factored constraint Jacobians used by projectQ() and projectU().
+    // These are deliberately not invalidated by changes to q or u so that a
+    // projection can start from the previous one's factorization; the
+    // entries record the q version at which they were factored.
+    tc.positionProjectionCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<ProjectionFactorization>());
+    tc.velocityProjectionCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<ProjectionFactorization>());
+
     tc.valid = true;
 
     // Allocate a cache entry for the topologyCache, and save a copy there.
@@ -1130,9 +1331,8 @@ realizePositionKinematics(const State& state) const {
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
     // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    sweepOutward([&](const RigidBodyNode& node) 
+    {   node.realizePosition(stateDigest); });
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1238,9 +1438,8 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    sweepInward([&](const RigidBodyNode& node) 
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); });
 
     markCacheValueRealized(state, abx);
 }
@@ -3559,24 +3758,186 @@ calcGMInvGt(const State&   s,
 
 
 
+// =============================================================================
+//                           CALC G M^-1 G^T BLOCKS
+// =============================================================================
+// M is block diagonal with one block for each subtree of Ground (each "base"
+// body and its descendants), so M^-1 is too. A constraint equation involves 
+// only its participating mobilities, so two equations couple in G M^-1 ~G
+// only if their participating mobilities share a subtree, possibly through a 
+// chain of other equations. We group the equations accordingly and compute
+// all the groups' columns at once: a lambda with one unit entry per group
+// gives a G M^-1 ~G lambda in which each group's rows see only their own 
+// group's column.
+//
+// Complexity is O(k*n + m*k) where k is the size of the largest group; for
+// a single group that is the same as calcGMInvGt().
+
+// Find the representative of x's group, with path halving.
+static int findGroup(Array_<int>& group, int x) {
+    while (group[x] != x) 
+        x = group[x] = group[group[x]];
+    return x;
+}
+
+void SimbodyMatterSubsystemRep::
+calcGMInvGtBlocks(const State&                      s,
+                  ConstraintOperatorFactorization&  blocks) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+
+    // Global problem dimensions.
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
+    const int m        = mHolo+mNonholo+mAccOnly;  
+    const int nu       = getNU(s);
+    const int nb       = getNumBodies();
+    const int nc       = getNumConstraints();
+
+    // Find the base body of the subtree each mobility belongs to. Parents
+    // always have lower indices than their children.
+    Array_<int> baseOfBody(nb, 0), baseOfU(nu, 0);
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const MobilizedBodyIndex parent = 
+            getRigidBodyNode(mbx).getParent()->getNodeNum();
+        baseOfBody[mbx] = parent == GroundIndex ? (int)mbx : baseOfBody[parent];
+        UIndex ux; int nub;
+        findMobilizerUs(s, mbx, ux, nub);
+        for (int i=0; i < nub; ++i)
+            baseOfU[ux+i] = baseOfBody[mbx];
+    }
+
+    // Merge the subtrees that any one constraint involves. Groups 0..nb-1 are
+    // subtrees; group nb+cx is for a constraint that involves no mobilities.
+    Array_<int> group(nb+nc);
+    for (int g=0; g < nb+nc; ++g) group[g] = g;
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        const SBInstancePerConstraintInfo& cInfo =
+            ic.getConstraintInstanceInfo(cx);
+        const int npu = cInfo.getNumParticipatingU();
+        if (npu == 0) continue;
+        const int first = findGroup(group, 
+            baseOfU[cInfo.getUIndexFromParticipatingU(ParticipatingUIndex(0))]);
+        for (ParticipatingUIndex pux(1); pux < npu; ++pux)
+            group[findGroup(group, 
+                    baseOfU[cInfo.getUIndexFromParticipatingU(pux)])] = first;
+    }
+
+    // Number the groups that have equations and assign the equations.
+    Array_<int> blockOfGroup(nb+nc, -1), blockOfEquation(m, -1);
+    int numBlocks = 0;
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        const SBInstancePerConstraintInfo& cInfo =
+            ic.getConstraintInstanceInfo(cx);
+        const Segment& holo    = cInfo.holoErrSegment;
+        const Segment& nonholo = cInfo.nonholoErrSegment;
+        const Segment& accOnly = cInfo.accOnlyErrSegment;
+        if (holo.length + nonholo.length + accOnly.length == 0)
+            continue;
+        const int npu = cInfo.getNumParticipatingU();
+        const int g = npu == 0 ? nb+cx : findGroup(group,
+            baseOfU[cInfo.getUIndexFromParticipatingU(ParticipatingUIndex(0))]);
+        if (blockOfGroup[g] < 0)
+            blockOfGroup[g] = numBlocks++;
+        const int b = blockOfGroup[g];
+        for (int i=0; i < holo.length; ++i)
+            blockOfEquation[holo.offset + i] = b;
+        for (int i=0; i < nonholo.length; ++i)
+            blockOfEquation[mHolo + nonholo.offset + i] = b;
+        for (int i=0; i < accOnly.length; ++i)
+            blockOfEquation[mHolo + mNonholo + accOnly.offset + i] = b;
+    }
+
+    blocks.setBlocks(blockOfEquation, numBlocks);
+    if (m==0) return;
+
+    // Precalculate bias so we can perform multiplication by G efficiently.
+    Vector bias(m);
+    calcBiasForMultiplyByPVA(s,true,true,true,bias);
+
+    Vector lambda(m, Real(0)), Gtcol(nu), MInvGtcol(nu), GMInvGtcol(m);
+    const int maxBlockSize = blocks.getMaxBlockSize();
+    for (int k=0; k < maxBlockSize; ++k) {
+        for (int b=0; b < numBlocks; ++b) {
+            const Array_<int>& eqs = blocks.getBlockEquations(b);
+            if (k < (int)eqs.size()) lambda[eqs[k]] = 1;
+        }
+        multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
+        multiplyByMInv(s, Gtcol, MInvGtcol);
+        multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGtcol);
+        for (int b=0; b < numBlocks; ++b) {
+            const Array_<int>& eqs = blocks.getBlockEquations(b);
+            if (k >= (int)eqs.size()) continue;
+            lambda[eqs[k]] = 0;
+            Matrix& block = blocks.updBlockMatrix(b);
+            for (int i=0; i < (int)eqs.size(); ++i)
+                block(i,k) = GMInvGtcol[eqs[i]];
+        }
+    }
+}
+
+
+
+// =============================================================================
+//                           GET FACTORED G M^-1 G^T
+// =============================================================================
+// The factorization lives in a lazy cache entry that depends on time and q.
+// The u dependence that velocity-level and acceleration-only constraints can
+// introduce is checked here instead, so that purely holonomic systems keep
+// their factorization when only u changes.
+const ConstraintOperatorFactorization& SimbodyMatterSubsystemRep::
+getFactoredGMInvGt(const State& s) const
+{
+    const CacheEntryIndex cox = topologyCache.constraintOperatorCacheIndex;
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const bool dependsOnU = 
+        ic.totalNNonholonomicConstraintEquationsInUse
+        + ic.totalNAccelerationOnlyConstraintEquationsInUse > 0;
+    const ValueVersion uVersion = dependsOnU ? s.getUValueVersion() : -1;
+
+    if (isCacheValueRealized(s, cox)) {
+        const ConstraintOperatorFactorization& factored = 
+            Value<ConstraintOperatorFactorization>::downcast
+               (getCacheEntry(s, cox));
+        if (factored.getUVersion() == uVersion)
+            return factored;
+    }
+
+    ConstraintOperatorFactorization& factored = 
+        Value<ConstraintOperatorFactorization>::updDowncast
+           (updCacheEntry(s, cox));
+    calcGMInvGtBlocks(s, factored);
+
+    // Conditioning tolerance. This determines when we'll drop a constraint.
+    // It is in terms of the total number of constraint equations, as it was
+    // when the whole matrix was factored at once, but the rank and condition
+    // tests are now made on each block separately: a constraint is dropped
+    // only if it is redundant with others in its own block.
+    const Real conditioningTol = factored.getNumEquations()
+        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
+    for (int b=0; b < factored.getNumBlocks(); ++b)
+        factored.factorBlock(b, conditioningTol);
+
+    factored.setUVersion(uVersion);
+    markCacheValueRealized(s, cox);
+    return factored;
+}
+
+
+
 // =============================================================================
 //                     SOLVE FOR CONSTRAINT IMPULSES
 // =============================================================================
-// Current implementation computes G*M^-1*~G, factors it, and does a single
-// solve all at great expense.
-// TODO: should realize factored matrix if needed and reuse if possible.
+// This uses the same factored G*M^-1*~G as forward dynamics, so it deals with
+// constraint redundancies the same way and shares the factorization when
+// called repeatedly at the same configuration.
 void SimbodyMatterSubsystemRep::
 solveForConstraintImpulses(const State&     state,
                            const Vector&    deltaV,
                            Vector&          impulse) const
 {
-    Matrix GMInvGt;
-    calcGMInvGt(state, GMInvGt);
-    // MUST DUPLICATE SIMBODY'S METHOD HERE:
-    const Real conditioningTol = GMInvGt.nrow() 
-                                    * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    getFactoredGMInvGt(state).solve(deltaV, impulse);
 }
 
 
@@ -4080,6 +4441,27 @@ void SimbodyMatterSubsystemRep::enforcePositionConstraints
 
 
 
+//==============================================================================
+//                        UPD PROJECTION FACTORIZATION
+//==============================================================================
+// The factorizations used by projectQ() and projectU() live in lazy cache 
+// entries that are only invalidated by Instance stage changes, which can 
+// alter the set and dimensions of the constraints. After that there is 
+// nothing worth reusing so we return an empty one.
+ProjectionFactorization& SimbodyMatterSubsystemRep::
+updProjectionFactorization(const State& s, CacheEntryIndex cx) const
+{
+    ProjectionFactorization& factored = 
+        Value<ProjectionFactorization>::updDowncast(updCacheEntry(s, cx));
+    if (!isCacheValueRealized(s, cx)) {
+        factored.clear();
+        markCacheValueRealized(s, cx);
+    }
+    return factored;
+}
+
+
+
 //==============================================================================
 //                                  PROJECT Q
 //==============================================================================
@@ -4201,9 +4583,12 @@ int SimbodyMatterSubsystemRep::projectQ
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using full Newton at the moment.
+    // this is set. We do so only for local projections though; a projection
+    // from far away (an assembly, really) gets full Newton and its quadratic
+    // convergence, which typically overshoots the accuracy by a lot.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool useFullNewton = forceFullNewton || !localOnly;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -4229,11 +4614,15 @@ int SimbodyMatterSubsystemRep::projectQ
     // (diagonal weights are symmetric). We only retain rows that 
     // correspond to free (non prescribed) q's.
     //
-    // This is a nonlinear least squares problem. Below is a full Newton 
-    // iteration since we recalculate the iteration matrix each time around the
-    // loop. TODO: a solution could be found using the same iteration matrix, 
-    // since we are projecting from (presumably) not too far away. Q1: will it
-    // be the same solution? Q2: if not, does it matter?
+    // This is a nonlinear least squares problem. For local projections, 
+    // unless full Newton is required, we solve it by modified Newton: the
+    // factored iteration matrix is kept in the State and reused, even from
+    // one projection to the next, for as long as each iteration reduces the
+    // error norm by at least a factor of MaxContractionRate. When that fails
+    // we refactor at the current q; if an out-of-date matrix made the norm
+    // worse we back up first. Since
+    // we are projecting from (presumably) not too far away, the solution is 
+    // the same as the full Newton one to within the requested accuracy.
 
     // These will be updated as we go.
     Real perrNormAchieved = perrNormOnEntry;
@@ -4265,21 +4654,38 @@ int SimbodyMatterSubsystemRep::projectQ
     Vector dfq_WLS(nfq), du(nu), dq(nq); // = Wq^+ dq_WLS
     Vector udfq_WLS(hasPrescribedMotion ? nq : 0); // unpacked if needed
     udfq_WLS.setToZero(); // must initialize unwritten elements
-    FactorQTZ Pqwr_qtz;
+
+    // The factorization acts like a pseudoinverse. It is reused if it was
+    // made with the same weights, unless we need it exact and it isn't.
+    ProjectionFactorization& Pqwr = updProjectionFactorization
+       (s, topologyCache.positionProjectionCacheIndex);
+    bool mustFactor = !Pqwr.isUsableWith(perrWeights, uWeights)
+        || (useFullNewton && !Pqwr.isCurrent(s.getQValueVersion()));
+    if (!mustFactor)
+        results.setNumReusedFactorizations(1);
+    int nFactorizations = 0;
+
     Real prevPerrNormAchieved = perrNormAchieved; // watch for divergence
     bool diverged = false;
     const int MaxIterations  = 20;
+    const Real MaxContractionRate = Real(0.25);
     do {
-        calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
-
-        // This factorization acts like a pseudoinverse.
-        Pqwr_qtz.factor<Real>(~Pqwrt, conditioningTol); 
+        if (mustFactor) {
+            calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
+            Pqwr.factor(Pqwrt, conditioningTol, perrWeights, uWeights,
+                        uAbsScale, s.getQValueVersion());
+            ++nFactorizations;
+            mustFactor = false;
+        }
+        const bool isExact = Pqwr.isCurrent(s.getQValueVersion());
 
         //printf("projectQ %d: m=%d condTol=%g rank=%d rcond=%g\n",
-        //    nItsUsed, Pqwrt.ncol(), conditioningTol, Pqwr_qtz.getRank(),
-        //    Pqwr_qtz.getRCondEstimate());
+        //    nItsUsed, mHolo, conditioningTol, 
+        //    Pqwr.getFactorization().getRank(),
+        //    Pqwr.getFactorization().getRCondEstimate());
 
-        Pqwr_qtz.solve(scaledPerrs, dfq_WLS); // this is weighted dq_WLS=Wq*dq
+        // this is weighted dq_WLS=Wq*dq
+        Pqwr.getFactorization().solve(scaledPerrs, dfq_WLS);
         lastChangeMadeWRMS = dfq_WLS.normRMS(); // change in weighted norm
 
         // switch back to unweighted dq=Wq^+*dq_WLS
@@ -4291,7 +4697,7 @@ int SimbodyMatterSubsystemRep::projectQ
             multiplyByNInv(s,false,dfq_WLS,du);
         }
         // Here du = du_WLS = N^+ * dq_WLS
-        du.rowScaleInPlace(uAbsScale); // Now du = Wu^-1 * du_WLS.
+        du.rowScaleInPlace(Pqwr.getColumnScale()); // Now du = Wu^-1 * du_WLS.
         multiplyByN(s,false,du,dq);     // dq = N*du
 
         // This causes quaternions to become unnormalized, but it doesn't
@@ -4308,6 +4714,18 @@ int SimbodyMatterSubsystemRep::projectQ
                                       : scaledPerrs.normRMS();
         ++nItsUsed;
 
+        if (!isExact && perrNormAchieved > prevPerrNormAchieved) {
+            // An out-of-date iteration matrix made the perr norm worse; 
+            // restore to end of previous iteration and refactor there.
+            updQ(s) += dq;
+            realizeSubsystemPosition(s); // pErrs changes here
+            scaledPerrs = pErrs.rowScale(perrWeights);
+            perrNormAchieved = useNormInf ? scaledPerrs.normInf()
+                                          : scaledPerrs.normRMS();
+            mustFactor = true;
+            continue;
+        }
+
         if (localOnly && nItsUsed >= 2 
             && perrNormAchieved > prevPerrNormAchieved) {
             // perr norm got worse; restore to end of previous iteration
@@ -4320,12 +4738,18 @@ int SimbodyMatterSubsystemRep::projectQ
             break; // diverging -- quit now to prevent a bad solution
         }
 
+        // Convergence is too slow with this matrix; refactor at the new q.
+        if (useFullNewton 
+            || perrNormAchieved > MaxContractionRate*prevPerrNormAchieved)
+            mustFactor = true;
+
         prevPerrNormAchieved = perrNormAchieved;
 
     } while (perrNormAchieved > consAccuracyToTryFor
                 && nItsUsed < MaxIterations);
 
     results.setNumIterations(nItsUsed);
+    results.setNumFactorizations(nFactorizations);
 
     //printf("        perrNormAchieved=%g in %d its\n",perrNormAchieved, nItsUsed);
 
@@ -4334,6 +4758,7 @@ int SimbodyMatterSubsystemRep::projectQ
     // than it was on entry, we'll restore the state to what it was on entry. 
     // Otherwise we'll return with the improved-but-not-good-enough result.
     if (perrNormAchieved > consAccuracy) {
+        Pqwr.clear(); // don't start from this next time
         if (perrNormAchieved >= perrNormOnEntry) { // made it worse
             updQ(s) = saveQ; // revert
             realizeSubsystemPosition(s);
@@ -4394,17 +4819,17 @@ int SimbodyMatterSubsystemRep::projectQ
             zeroKnownQ(s, qErrest_0); // zero out prescribed entries
             multiplyByPq(s, bias_p, qErrest_0, Tp_Pq_qErrest); // (Pq*qErrest)_r
             Tp_Pq_qErrest.rowScaleInPlace(perrWeights); // now Tp*(Pq*qErrest)_r
-            Pqwr_qtz.solve(Tp_Pq_qErrest, dfq_WLS); // weighted
+            Pqwr.getFactorization().solve(Tp_Pq_qErrest, dfq_WLS); // weighted
             unpackFreeQ(s, dfq_WLS, udfq_WLS); // zeroes in q_p slots
             multiplyByNInv(s,false,udfq_WLS,du);
         } else {
             multiplyByPq(s, bias_p, qErrest, Tp_Pq_qErrest); // Pq*qErrest
             Tp_Pq_qErrest.rowScaleInPlace(perrWeights); // now Tp*Pq*qErrest
-            Pqwr_qtz.solve(Tp_Pq_qErrest, dfq_WLS); // weighted
+            Pqwr.getFactorization().solve(Tp_Pq_qErrest, dfq_WLS); // weighted
             multiplyByNInv(s,false,dfq_WLS,du);
         }
         // Here du = du_WLS = N^+ * dq_WLS
-        du.rowScaleInPlace(uAbsScale); // now du = Wu^-1 * du_WLS
+        du.rowScaleInPlace(Pqwr.getColumnScale()); // now du = Wu^-1 * du_WLS
         multiplyByN(s,false,du,dq);     // dq = N*du
         qErrest -= dq; // unweighted
     }
@@ -4744,9 +5169,12 @@ int SimbodyMatterSubsystemRep::projectU
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using modified Newton at the moment.
+    // this is set. We do so only for local projections though; a projection
+    // from far away (an assembly, really) gets full Newton and its quadratic
+    // convergence, which typically overshoots the accuracy by a lot.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool useFullNewton = forceFullNewton || !localOnly;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -4767,7 +5195,12 @@ int SimbodyMatterSubsystemRep::projectU
     // iteration (rather than full) if we're not updating V when we could be.
     //
     // This is a nonlinear least squares problem, but we only need to factor 
-    // once since only the RHS is dependent on u (TODO: see above).
+    // once since only the RHS is dependent on u (TODO: see above). In fact 
+    // for local projections we can usually do without factoring at all: the 
+    // factorization from the previous projection is kept in the State, and as
+    // in projectQ() we iterate with it until it fails to converge quickly 
+    // enough. Then we factor at the current q, after which there is nothing 
+    // more to gain.
 
     // This will be updated as we go.
     Real pverrNormAchieved = pverrNormOnEntry;
@@ -4804,30 +5237,47 @@ int SimbodyMatterSubsystemRep::projectU
     if (hasPrescribedMotion)
         du.setToZero(); // must initialize unwritten elements
 
-    calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
-    // PVwrt is now Eu^-1 (Pt Vt) Tpv
-
-    // Calculate pseudoinverse (just once)
-    FactorQTZ PVwr_qtz;
-    PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
-
-    //printf("projectU m=%d condTol=%g rank=%d rcond=%g\n",
-    //    PVwrt.ncol(), conditioningTol, PVwr_qtz.getRank(),
-    //    PVwr_qtz.getRCondEstimate());
+    // The pseudoinverse, reused if it was made with the same weights (its 
+    // own relative scaling is used with it) unless we need it exact and it 
+    // isn't.
+    ProjectionFactorization& PVwr = updProjectionFactorization
+       (s, topologyCache.velocityProjectionCacheIndex);
+    bool mustFactor = !PVwr.isUsableWith(pverrWeights, uWeights)
+        || (useFullNewton && !PVwr.isCurrent(s.getQValueVersion()));
+    if (!mustFactor)
+        results.setNumReusedFactorizations(1);
+    int nFactorizations = 0;
 
     Real prevPVerrNormAchieved = pverrNormAchieved; // watch for divergence
     bool diverged = false;
     const int MaxIterations  = 7;
+    const Real MaxContractionRate = Real(0.25);
     do {
-        PVwr_qtz.solve(scaledPVerrs, dfu_WLS);
+        if (mustFactor) {
+            calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
+            // PVwrt is now Eu^-1 (Pt Vt) Tpv
+            PVwr.factor(PVwrt, conditioningTol, pverrWeights, uWeights,
+                        uRelScale, s.getQValueVersion());
+            ++nFactorizations;
+            mustFactor = false;
+
+            //printf("projectU m=%d condTol=%g rank=%d rcond=%g\n",
+            //    PVwrt.ncol(), conditioningTol, 
+            //    PVwr.getFactorization().getRank(),
+            //    PVwr.getFactorization().getRCondEstimate());
+        }
+        const bool isExact = PVwr.isCurrent(s.getQValueVersion());
+        const Vector& uScale = PVwr.getColumnScale(); // Eu^-1
+
+        PVwr.getFactorization().solve(scaledPVerrs, dfu_WLS);
         lastChangeMadeWRMS = dfu_WLS.normRMS(); // change in weighted norm
 
         // switch back to unweighted du=Eu^-1*du_WLS
         if (hasPrescribedMotion) {
             unpackFreeU(s, dfu_WLS, du);    // zeroes in u_p slots
-            du.rowScaleInPlace(uRelScale); // du=Eu^-1*unpack(dfu_WLS)
+            du.rowScaleInPlace(uScale); // du=Eu^-1*unpack(dfu_WLS)
         } else {
-            du = dfu_WLS.rowScale(uRelScale); // unscale: du=Eu^-1*du_WLS
+            du = dfu_WLS.rowScale(uScale); // unscale: du=Eu^-1*du_WLS
         }
         updU(s) -= du;
         results.setAnyChangeMade(true);
@@ -4839,6 +5289,18 @@ int SimbodyMatterSubsystemRep::projectU
                                        : scaledPVerrs.normRMS();
         ++nItsUsed;
 
+        if (!isExact && pverrNormAchieved > prevPVerrNormAchieved) {
+            // An out-of-date iteration matrix made the pverr norm worse; 
+            // restore to end of previous iteration and refactor.
+            updU(s) += du;
+            realizeSubsystemVelocity(s); // pvErrs changes here
+            scaledPVerrs = pvErrs.rowScale(pverrWeights);
+            pverrNormAchieved = useNormInf ? scaledPVerrs.normInf()
+                                           : scaledPVerrs.normRMS();
+            mustFactor = true;
+            continue;
+        }
+
         if (localOnly && nItsUsed >= 2 
             && pverrNormAchieved > prevPVerrNormAchieved) {
             // Velocity norm worse -- restore to end of previous iteration.
@@ -4851,18 +5313,25 @@ int SimbodyMatterSubsystemRep::projectU
             break; // diverging -- quit now to prevent a bad solution
         }
 
+        // Convergence is too slow with an out-of-date matrix; refactor.
+        if (!isExact && pverrNormAchieved 
+                        > MaxContractionRate*prevPVerrNormAchieved)
+            mustFactor = true;
+
         prevPVerrNormAchieved = pverrNormAchieved;
 
     } while (pverrNormAchieved > consAccuracyToTryFor
                 && nItsUsed < MaxIterations);
 
     results.setNumIterations(nItsUsed);
+    results.setNumFactorizations(nFactorizations);
 
     // Make sure we achieved at least the required constraint accuracy. If not 
     // we'll return with an error. If we see that the norm has been made worse
     // than it was on entry, we'll restore the state to what it was on entry. 
     // Otherwise we'll return with the improved-but-not-good-enough result.
     if (pverrNormAchieved > consAccuracy) {
+        PVwr.clear(); // don't start from this next time
         if (pverrNormAchieved >= pverrNormOnEntry) { // made it worse
             updU(s) = saveU; // revert
             realizeSubsystemVelocity(s);
@@ -4921,14 +5390,14 @@ int SimbodyMatterSubsystemRep::projectU
             multiplyByPVA(s,true,true,false,bias_pv,
                             uErrest_0,Tpv_PV_uErrest);
             Tpv_PV_uErrest.rowScaleInPlace(pverrWeights); // = Tpv*PV*uErrest_0
-            PVwr_qtz.solve(Tpv_PV_uErrest, dfu_WLS);
+            PVwr.getFactorization().solve(Tpv_PV_uErrest, dfu_WLS);
             unpackFreeU(s, dfu_WLS, du); // still weighted
         } else {
             multiplyByPVA(s,true,true,false,bias_pv,uErrest,Tpv_PV_uErrest);
             Tpv_PV_uErrest.rowScaleInPlace(pverrWeights); // = Tpv PV uErrEst
-            PVwr_qtz.solve(Tpv_PV_uErrest, du);
+            PVwr.getFactorization().solve(Tpv_PV_uErrest, du);
         }
-        du.rowScaleInPlace(uRelScale); // now du=Eu^-1*unpack(dfu_WLS)
+        du.rowScaleInPlace(PVwr.getColumnScale()); // du=Eu^-1*unpack(dfu_WLS)
         uErrest -= du; // this is unweighted now
     }
    
@@ -5107,32 +5576,19 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     if (m==0) return;
     if (nu==0) {multipliers.setToZero(); return;}
 
-    // Conditioning tolerance. This determines when we'll drop a 
-    // constraint. 
-    // TODO: this is probably too tight; should depend on constraint tolerance
-    // and should be consistent with position and velocity projection ranks.
-    // Tricky here because conditioning depends on mass matrix as well as
-    // constraints.
-    const Real conditioningTol = m 
-        //* SignificantReal;
-        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-
     // Calculate multipliers lambda as
     //     (G M^-1 ~G) lambda = aerr
-    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
-    // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    // The mXm matrix G*M^-1*G^T is calculated a block at a time, O(k*n) with
+    // O(n) temporary memory using a series of O(n) operators, and factored 
+    // in O(k^2*m) time, where k is the size of the largest independent block.
+    // That is done only when positions (or for some constraints, velocities)
+    // have changed; otherwise we reuse the factorization from the State 
+    // cache. See getFactoredGMInvGt() for the conditioning tolerance. 
+    // TODO: the tolerance is probably too tight; should depend on constraint
+    // tolerance and should be consistent with position and velocity 
+    // projection ranks. Tricky here because conditioning depends on mass 
+    // matrix as well as constraints.
+    getFactoredGMInvGt(s).solve(udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
@@ -5324,22 +5780,18 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,abvc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    sweepInward([&](const RigidBodyNode& node) {
+        node.calcUDotPass1Inward(ic,tpc,abc,abvc,
+            mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+            hingeForcePtr);
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            hingeForcePtr, aPtr, udotPtr, tauPtr);
+        node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
+                         &qdotdotPtr[node.getQIndex()]);
+    });
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5384,19 +5836,15 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     const Real* fPtr     = &f[0];       
     Real*       MInvfPtr = &MInvf[0];
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass1Inward(ic,tpc,abc,
-                fPtr, z.begin(), zPlus.begin(), eps.begin());
-        }
+    sweepInward([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass1Inward(ic,tpc,abc,
+            fPtr, z.begin(), zPlus.begin(), eps.begin());
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass2Outward(ic,tpc,abc, 
-                eps.cbegin(), A_GB.begin(), MInvfPtr);
-        }
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass2Outward(ic,tpc,abc, 
+            eps.cbegin(), A_GB.begin(), MInvfPtr);
+    });
 }
 //............................. CALC M INVERSE F ...............................
 
@@ -5451,67 +5899,471 @@ void SimbodyMatterSubsystemRep::multiplyByM(const State&    s,
 //==============================================================================
 //                                  CALC M
 //==============================================================================
-// Calculate the mass matrix M in O(n^2) time. This Subsystem must already have
-// been realized to Position stage.
+// Calculate the mass matrix M using the composite rigid body algorithm. This
+// Subsystem must already have been realized to Position stage.
 // It is OK if M's data is not contiguous.
 void SimbodyMatterSubsystemRep::calcM(const State& s, Matrix& M) const {
     const int nu = getTotalDOF();
     M.resize(nu,nu);
     if (nu==0) return;
 
-    // This could be calculated much faster by doing it directly and calculating
-    // only half of it. As a placeholder, however, we're doing this with 
-    // repeated O(n) calls to multiplyByM() to get M one column at a time.
+    // If M is contiguous we can fill it in directly. It is symmetric, so it
+    // doesn't matter whether it is stored by rows or columns.
+    if (M.hasContiguousData()) {
+        calcMUsingCompositeBodyInertias(s, M.updContiguousScalarData());
+        return;
+    }
+
+    Matrix contigM(nu,nu);
+    calcMUsingCompositeBodyInertias(s, contigM.updContiguousScalarData());
+    M = contigM;
+}
 
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = M(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
 
-    Vector v(nu); v.setToZero();
-    for (int i=0; i < nu; ++i) {
-        v[i] = 1;
-        if (isContiguous) {
-            multiplyByM(s, v, M(i));
-        } else {
-            multiplyByM(s, v, contig_col);
-            M(i) = contig_col;
+
+//==============================================================================
+//                  CALC M USING COMPOSITE BODY INERTIAS
+//==============================================================================
+// This is the composite rigid body algorithm. Mobilizer i's columns of M are
+// the generalized forces that each mobilizer would feel if we accelerated
+// mobilizer i alone, with everything outboard of it moving rigidly with it
+// (that is, with composite body inertia R_i). The spatial forces R_i*H_i that
+// produce those accelerations are transmitted unchanged to the ancestors of
+// body i, just shifted to each ancestor's origin, and are projected onto each
+// ancestor's mobilities with its H. Other mobilizers are not involved, so
+// M(i,j) is zero unless i and j are on the same path to Ground.
+//
+// Cost is about 30*d flops for each mobility and ancestor mobility pair, plus
+// the composite body inertias; that's O(n*depth) rather than the O(n^2) of
+// forming M one column at a time with multiplyByM().
+void SimbodyMatterSubsystemRep::
+calcMUsingCompositeBodyInertias(const State& s, Real* M) const {
+    const int nu = getTotalDOF();
+    const int nb = getNumBodies();
+    const SBTreePositionCache& tpc = getTreePositionCache(s);
+    realizeCompositeBodyInertias(s);
+    const Array_<SpatialInertia,MobilizedBodyIndex>& R =
+        getCompositeBodyInertiaCache(s).compositeBodyInertia;
+
+    std::fill(M, M + nu*nu, Real(0));
+
+    SpatialVec F[6]; // a mobilizer has at most 6 mobilities
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const int nub = node.getDOF();
+        if (nub == 0) continue;
+        const int ub = node.getUIndex();
+
+        // Diagonal block ~H_i R_i H_i.
+        for (int c=0; c < nub; ++c)
+            F[c] = R[mbx] * node.getHCol(tpc, c);
+        for (int c=0; c < nub; ++c)
+            for (int r=0; r < nub; ++r)
+                M[(ub+c)*nu + ub+r] = ~node.getHCol(tpc, r) * F[c];
+
+        // Shift the forces inward and project them onto each ancestor's
+        // mobilities, filling in both halves of M.
+        Vec3 p_GF = node.getX_GB(tpc).p(); // where the forces are now
+        for (const RigidBodyNode* anc = node.getParent(); 
+             !anc->isGroundNode(); anc = anc->getParent()) 
+        {
+            const Vec3& p_GA = anc->getX_GB(tpc).p();
+            const Vec3 p_AF = p_GF - p_GA;
+            for (int c=0; c < nub; ++c)
+                F[c][0] += p_AF % F[c][1];
+            p_GF = p_GA;
+
+            const int ua = anc->getUIndex();
+            for (int r=0; r < anc->getDOF(); ++r) {
+                const SpatialVec& H = anc->getHCol(tpc, r);
+                for (int c=0; c < nub; ++c)
+                    M[(ub+c)*nu + ua+r] = M[(ua+r)*nu + ub+c] = ~H * F[c];
+            }
         }
-        v[i] = 0;
     }
 }
 
 
 
+//==============================================================================
+//                               GET FACTORED M
+//==============================================================================
+// The L^T L factorization of M lives in a lazy cache entry that depends on the
+// positions (through the tree position cache) and on the instance variables, 
+// which determine both the masses and which mobilities are prescribed.
+// Prescribed mobilities get identity rows and columns so that solving with the
+// factorization works with Mrr, the block of M for the free mobilities, just 
+// as multiplyByMInv() does.
+const MassMatrixFactorization& SimbodyMatterSubsystemRep::
+getFactoredM(const State& s) const {
+    const CacheEntryIndex mfx = topologyCache.massMatrixFactorizationCacheIndex;
+    if (isCacheValueRealized(s, mfx))
+        return Value<MassMatrixFactorization>::downcast(getCacheEntry(s, mfx));
+
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const int nu = getTotalDOF();
+    const int nb = getNumBodies();
+    MassMatrixFactorization& factored = 
+        Value<MassMatrixFactorization>::updDowncast(updCacheEntry(s, mfx));
+
+    // The parent of each mobility; see MassMatrixFactorization.
+    Array_<int> parentU(nu, -1), lastUOfBody(nb, -1);
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const int ub = node.getUIndex(), nub = node.getDOF();
+        const int parentLast = lastUOfBody[node.getParent()->getNodeNum()];
+        for (int i=0; i < nub; ++i)
+            parentU[ub+i] = i == 0 ? parentLast : ub+i-1;
+        lastUOfBody[mbx] = nub ? ub+nub-1 : parentLast;
+    }
+    if (factored.getParentU() != parentU)
+        factored.setStructure(parentU);
+
+    Matrix& M = factored.updMatrix();
+    if (nu) calcMUsingCompositeBodyInertias(s, M.updContiguousScalarData());
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (!node.isUDotKnown(ic)) continue;
+        for (int i=0; i < node.getDOF(); ++i) {
+            const int ux = node.getUIndex() + i;
+            M(ux) = 0; M[ux] = 0; M(ux,ux) = 1;
+        }
+    }
+
+    SimTK_ERRCHK_ALWAYS(factored.factor(),
+        "SimbodyMatterSubsystem::getFactoredM()",
+        "The mass matrix is not positive definite; there may be massless "
+        "bodies that are not supported by any massive outboard body.");
+
+    markCacheValueRealized(s, mfx);
+    return factored;
+}
+
+
+
 //==============================================================================
 //                                CALC MInv
 //==============================================================================
-// Calculate the mass matrix inverse MInv(=M^-1) in O(n^2) time. This Subsystem
-// must already have been realized to Position stage.
-// It is OK if MInv's data is not contiguous.
+// Calculate the mass matrix inverse MInv(=M^-1) using the factored M, one
+// column at a time. Each solve costs about 4 flops per nonzero of the factor,
+// which for a branched tree is far less than the O(n) sweeps of 
+// multiplyByMInv(). This Subsystem must already have been realized to 
+// Position stage. It is OK if MInv's data is not contiguous.
 void SimbodyMatterSubsystemRep::calcMInv(const State& s, Matrix& MInv) const {
     const int nu = getTotalDOF();
     MInv.resize(nu,nu);
     if (nu==0) return;
 
-    // This could probably be calculated faster by doing it directly and
-    // filling in only half. For now we're doing it with repeated calls to
-    // the O(n) operator multiplyByMInv().
+    const MassMatrixFactorization& factored = getFactoredM(s);
+    const SBInstanceCache& ic = getInstanceCache(s);
 
-    // If M's columns are contiguous we can avoid copying.
+    // If MInv's columns are contiguous we can avoid copying.
     const bool isContiguous = MInv(0).hasContiguousData();
     Vector contig_col(isContiguous ? 0 : nu);
 
-    Vector f(nu); f.setToZero();
-    for (int i=0; i < nu; ++i) {
-        f[i] = 1;
-        if (isContiguous) {
-            multiplyByMInv(s, f, MInv(i));
-        } else {
-            multiplyByMInv(s, f, contig_col);
-            MInv(i) = contig_col;
+    for (int j=0; j < nu; ++j) {
+        VectorView col = MInv(j);
+        Real* x = isContiguous ? &col[0] : &contig_col[0];
+        std::fill(x, x + nu, Real(0));
+        x[j] = 1;
+        factored.solveInPlace(x);
+        if (!isContiguous)
+            col = contig_col;
+    }
+
+    // Prescribed mobilities' rows and columns are zero, as they would be
+    // from multiplyByMInv().
+    for (MobilizedBodyIndex mbx(1); mbx < getNumBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (!node.isUDotKnown(ic)) continue;
+        for (int i=0; i < node.getDOF(); ++i) {
+            const int ux = node.getUIndex() + i;
+            MInv(ux) = 0; MInv[ux] = 0;
+        }
+    }
+}
+
+
+
+//==============================================================================
+//                    MULTIPLY BY M INV USING FACTORED M
+//==============================================================================
+// Same result as multiplyByMInv(), but using the cached factorization of M.
+// f and MInvf may be the same Vector; neither need be contiguous.
+void SimbodyMatterSubsystemRep::
+multiplyByMInvUsingFactoredM(const State& s, const Vector& f, 
+                             Vector& MInvf) const {
+    const int nu = getTotalDOF();
+    assert(f.size() == nu);
+    const MassMatrixFactorization& factored = getFactoredM(s);
+    const SBInstanceCache& ic = getInstanceCache(s);
+
+    Vector x(f);
+    for (MobilizedBodyIndex mbx(1); mbx < getNumBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (node.isUDotKnown(ic))
+            for (int i=0; i < node.getDOF(); ++i)
+                x[node.getUIndex() + i] = 0;
+    }
+    if (nu) factored.solveInPlace(&x[0]);
+    MInvf = x;
+}
+
+
+
+//==============================================================================
+//                      CALC OPERATIONAL SPACE INERTIA
+//==============================================================================
+// Lambda = (J M^-1 ~J)^-1. With M = ~L L, J M^-1 ~J = ~Y Y where Y = L^-T ~J.
+// Column k of Y is nonzero only at the ancestors of the mobilities that row k
+// of J involves, and the L^-T solve costs nothing for the rest, so for a task
+// on one branch of the tree this costs only the depth of that branch. We then
+// invert the small k X k matrix with FactorQTZ so that redundant tasks, for
+// which J M^-1 ~J is singular, give the pseudoinverse rather than garbage.
+void SimbodyMatterSubsystemRep::
+calcOperationalSpaceInertia(const State& s, const Matrix& J, 
+                            Matrix& Lambda) const {
+    const int nu = getTotalDOF();
+    const int k = J.nrow();
+    assert(J.ncol() == nu);
+    const MassMatrixFactorization& factored = getFactoredM(s);
+    const SBInstanceCache& ic = getInstanceCache(s);
+
+    // Prescribed mobilities don't respond to task forces.
+    Array_<bool> isFree(nu, true);
+    for (MobilizedBodyIndex mbx(1); mbx < getNumBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (node.isUDotKnown(ic))
+            for (int i=0; i < node.getDOF(); ++i)
+                isFree[node.getUIndex() + i] = false;
+    }
+
+    // L^-T moves entries only to ancestors, which have lower indices, so
+    // column t of Y is zero past the last nonzero of row t of J; we keep
+    // track of that to shorten the dot products below.
+    Matrix Y(nu, k); // contiguous, by columns
+    Real* y = Y.updContiguousScalarData();
+    Array_<int> end(k, 0);
+    for (int t=0; t < k; ++t) {
+        Real* yt = y + t*nu;
+        for (int i=0; i < nu; ++i) {
+            yt[i] = isFree[i] ? J(t,i) : Real(0);
+            if (yt[i] != 0) end[t] = i+1;
+        }
+        if (nu) factored.solveLTransposeInPlace(yt);
+    }
+
+    Matrix W(k, k);
+    for (int a=0; a < k; ++a) {
+        const Real* ya = y + a*nu;
+        for (int b=0; b <= a; ++b) {
+            const Real* yb = y + b*nu;
+            const int n = std::min(end[a], end[b]);
+            Real sum = 0;
+            for (int i=0; i < n; ++i)
+                sum += ya[i]*yb[i];
+            W(a,b) = W(b,a) = sum;
+        }
+    }
+
+    Lambda.resize(k, k);
+    if (k == 0) return;
+    FactorQTZ qtz(W, k*SqrtEps*std::sqrt(SqrtEps)); // Eps^(3/4)
+    Matrix WInv;
+    qtz.inverse(WInv);
+    Lambda = WInv;
+}
+
+
+
+//==============================================================================
+//                  CALC TREE FORWARD DYNAMICS DERIVATIVES
+//==============================================================================
+// Forward dynamics udot=FD(q,u,f) and inverse dynamics f_resid=ID(q,u,udot,f)
+// satisfy ID(q,u,FD(q,u,f),f)=0 for the free mobilities, so that 
+// dFD/dx = -M^-1 dID/dx with udot held at FD(q,u,f), and dFD/dtau = M^-1.
+// Inverse dynamics needs no articulated body inertias, and we evaluate it on a
+// scratch copy of the State realized only through Velocity stage so that no
+// force elements are evaluated either.
+//
+// ID depends on u only through the inertial forces, which are exactly 
+// quadratic in u since qdot=N*u and HDot are linear in u. So the central
+// difference (ID(u+h e_j) - ID(u-h e_j))/2h is the exact derivative for any
+// h; we take h ~ |u_j| to keep roundoff small. There is no such structure in
+// q so those are ordinary central differences.
+//
+// A coordinate of body B affects only the kinematics, and hence the residual
+// body forces, of B and its outboard bodies. So we perturb at once one
+// coordinate of each of a set of bodies none of which is outboard of another,
+// and attribute each body's change in force to the unique perturbed body
+// inboard of it. That gives the residuals of the mobilities outboard of each
+// perturbed body directly; the ones inboard of it we get by shifting its
+// subtree's change in force inward. Taking coordinate k of each mobilizer 
+// whose coordinates are numbered k+d, d being the total number of coordinates
+// of its ancestors, gives such sets, and the number of them is the largest 
+// number of coordinates on any path to Ground rather than the total.
+void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsDerivatives
+   (const State&                s,
+    const Vector&               appliedMobilityForces,
+    const Vector_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     dUDotdQ,
+    Matrix&                     dUDotdU,
+    Matrix&                     dUDotdTau) const
+{
+    const int nq = getNQ(s), nu = getNU(s), nb = getNumBodies();
+    const SBModelVars& mv = getModelVars(s);
+    const SBTreePositionCache& tpc = getTreePositionCache(s);
+    const MultibodySystem& system = getMultibodySystem();
+
+    // The accelerations about which we're differentiating.
+    Vector udot, qdotdot, tau, netHingeForces(nu);
+    Vector_<SpatialVec> A_GB(nb);
+    Array_<SpatialVec,MobilizedBodyIndex> abForcesZ(nb), abForcesZPlus(nb);
+    calcTreeAccelerations(s, appliedMobilityForces, appliedBodyForces,
+        getDynamicsCache(s).presUDotPool, netHingeForces, abForcesZ, 
+        abForcesZPlus, A_GB, udot, qdotdot, tau);
+
+    calcMInv(s, dUDotdTau);
+
+    // Number of q's and u's on each mobilizer's ancestors.
+    Array_<int> qDepth(nb, 0), uDepth(nb, 0);
+    int nqSets = 0, nuSets = 0;
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const RigidBodyNode& parent = *node.getParent();
+        const int px = parent.getNodeNum();
+        qDepth[mbx] = qDepth[px] + parent.getNQInUse(mv);
+        uDepth[mbx] = uDepth[px] + parent.getDOF();
+        nqSets = std::max(nqSets, qDepth[mbx] + node.getNQInUse(mv));
+        nuSets = std::max(nuSets, uDepth[mbx] + node.getDOF());
+    }
+
+    State tmp(s);
+    Array_<int> coord(nb), owner(nb);
+    Array_<Real> step(nb);
+    Array_<SpatialVec> F(nb), GPlus(nb), GMinus(nb);
+    Vector tauPlus(nu), tauMinus(nu);
+
+    // Realize tmp and calculate the residual mobility forces, and for each 
+    // body the total residual force of it and its outboard bodies, shifted to
+    // its parent's origin.
+    auto calcResiduals = [&](Vector& tauRes, Array_<SpatialVec>& G) {
+        system.realize(tmp, Stage::Velocity);
+        const SBTreePositionCache& pc = getTreePositionCache(tmp);
+        const SBTreeVelocityCache& vc = getTreeVelocityCache(tmp);
+        for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
+            for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
+                rbNodeLevels[i][j]->calcBodyAccelerationsFromUdotOutward
+                   (pc, vc, &udot[0], &A_GB[0]);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+            const RigidBodyNode& node = getRigidBodyNode(mbx);
+            F[mbx] = node.getMk_G(pc)*A_GB[mbx] + node.getGyroscopicForce(vc)
+                     - appliedBodyForces[mbx];
         }
-        f[i] = 0;
+        for (int b=nb-1; b >= 1; --b) {
+            const RigidBodyNode& node = getRigidBodyNode(MobilizedBodyIndex(b));
+            for (int k=0; k < node.getDOF(); ++k)
+                tauRes[node.getUIndex()+k] = ~node.getHCol(pc, k) * F[b];
+            G[b] = node.getPhi(pc) * F[b];
+            F[node.getParent()->getNodeNum()] += G[b];
+        }
+    };
+
+    // Fill in the columns of dID/dx for the set of coordinates numbered k+d 
+    // as described above.
+    auto differenceSet = [&](bool isQ, int k, Matrix& dIDdX) {
+        const Vector& x0 = isQ ? getQ(s) : getU(s);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+            const RigidBodyNode& node = getRigidBodyNode(mbx);
+            const int d = isQ ? qDepth[mbx] : uDepth[mbx];
+            const int n = isQ ? node.getNQInUse(mv) : node.getDOF();
+            coord[mbx] = -1;
+            if (d <= k && k < d+n) {
+                coord[mbx] = (isQ ? (int)node.getQIndex() 
+                                  : (int)node.getUIndex()) + k-d;
+                const Real xabs = std::abs(x0[coord[mbx]]);
+                step[mbx] = isQ ? std::pow(Eps, OneThird)*std::max(xabs,Real(1))
+                                : std::max(xabs, Real(1));
+            }
+        }
+
+        Vector& xPlus = isQ ? updQ(tmp) : updU(tmp);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx)
+            if (coord[mbx] >= 0) xPlus[coord[mbx]] = x0[coord[mbx]]+step[mbx];
+        calcResiduals(tauPlus, GPlus);
+        Vector& xMinus = isQ ? updQ(tmp) : updU(tmp);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx)
+            if (coord[mbx] >= 0) xMinus[coord[mbx]] = x0[coord[mbx]]-step[mbx];
+        calcResiduals(tauMinus, GMinus);
+        Vector& xRestore = isQ ? updQ(tmp) : updU(tmp);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx)
+            if (coord[mbx] >= 0) xRestore[coord[mbx]] = x0[coord[mbx]];
+
+        owner[0] = -1;
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+            const RigidBodyNode& node = getRigidBodyNode(mbx);
+            owner[mbx] = coord[mbx] >= 0 ? (int)mbx
+                         : owner[node.getParent()->getNodeNum()];
+            if (owner[mbx] < 0) continue;
+            const Real oo2h = 1/(2*step[owner[mbx]]);
+            for (int i=0; i < node.getDOF(); ++i) {
+                const int ux = node.getUIndex() + i;
+                dIDdX(ux, coord[owner[mbx]]) = (tauPlus[ux]-tauMinus[ux])*oo2h;
+            }
+        }
+
+        // Ancestors of a perturbed body see the change in its subtree's 
+        // force; their positions haven't changed so this is linear.
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+            if (coord[mbx] < 0) continue;
+            SpatialVec dG = (GPlus[mbx] - GMinus[mbx]) / (2*step[mbx]);
+            for (const RigidBodyNode* anc = getRigidBodyNode(mbx).getParent();
+                 !anc->isGroundNode(); anc = anc->getParent()) 
+            {
+                for (int i=0; i < anc->getDOF(); ++i)
+                    dIDdX(anc->getUIndex()+i, coord[mbx]) = 
+                        ~anc->getHCol(tpc, i) * dG;
+                dG = anc->getPhi(tpc) * dG;
+            }
+        }
+    };
+
+    // Replace each column of dID/dx by -M^-1 times it, with prescribed
+    // accelerations held fixed.
+    const MassMatrixFactorization& factored = getFactoredM(s);
+    const SBInstanceCache& ic = getInstanceCache(s);
+    Array_<Real> freeSign(nu, Real(-1));
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        if (node.isUDotKnown(ic))
+            for (int i=0; i < node.getDOF(); ++i)
+                freeSign[node.getUIndex()+i] = 0;
     }
+    Vector contigCol(nu);
+    auto solveColumns = [&](Matrix& dIDdX) {
+        if (nu == 0) return;
+        for (int j=0; j < dIDdX.ncol(); ++j) {
+            VectorView col = dIDdX(j);
+            const bool isContiguous = col.hasContiguousData();
+            Real* x = isContiguous ? &col[0] : &contigCol[0];
+            if (!isContiguous) contigCol = col;
+            for (int i=0; i < nu; ++i)
+                x[i] *= freeSign[i];
+            factored.solveInPlace(x);
+            if (!isContiguous) col = contigCol;
+        }
+    };
+
+    // Columns for q's that aren't in use (e.g. the 4th q of a ball in Euler 
+    // angle mode) are never touched and stay zero.
+    dUDotdQ.resize(nu, nq); dUDotdQ.setTo(Real(0));
+    dUDotdU.resize(nu, nu); dUDotdU.setTo(Real(0));
+    for (int k=0; k < nqSets; ++k)
+        differenceSet(true, k, dUDotdQ);
+    for (int k=0; k < nuSets; ++k)
+        differenceSet(false, k, dUDotdU);
+    solveColumns(dUDotdQ);
+    solveColumns(dUDotdU);
 }
 
 
@@ -6397,6 +7249,40 @@ void SimbodyMatterSubsystemRep::setShowDefaultGeometry(bool show) {
     showDefaultGeometry = show;
 }
 
+void SimbodyMatterSubsystemRep::setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "SimbodyMatterSubsystem",
+        "setNumberOfThreads", "Number of threads must be positive.");
+    if (numThreads == 1) levelExecutor.reset();
+    else levelExecutor = new ParallelExecutor(numThreads);
+}
+
+int SimbodyMatterSubsystemRep::getNumberOfThreads() const {
+    return levelExecutor ? levelExecutor->getMaxThreads() : 1;
+}
+
+void SimbodyMatterSubsystemRep::setMinBodiesPerParallelLevel(int numBodies) {
+    SimTK_APIARGCHECK1_ALWAYS(numBodies > 0, "SimbodyMatterSubsystem",
+        "setMinBodiesPerParallelLevel", 
+        "Number of bodies must be positive but was %d.", numBodies);
+    minBodiesPerParallelLevel = numBodies;
+}
+
+int SimbodyMatterSubsystemRep::getMinBodiesPerParallelLevel() const {
+    return minBodiesPerParallelLevel;
+}
+
+void SimbodyMatterSubsystemRep::setUseBranchParallelism(bool useBranches) {
+    useBranchParallelism = useBranches;
+}
+
+bool SimbodyMatterSubsystemRep::getUseBranchParallelism() const {
+    return useBranchParallelism;
+}
+
+int SimbodyMatterSubsystemRep::getNumTreeBranches() const {
+    return (int)treeBranches.size();
+}
+
 std::ostream& operator<<(std::ostream& o, const SimbodyMatterSubsystemRep& tree) {
     o << "SimbodyMatterSubsystemRep has " << tree.getNumBodies() << " bodies (incl. G) in "
       << tree.rbNodeLevels.size() << " levels." << std::endl;
@@ -54,6 +54,12 @@ class RBDistanceConstraint;
 class RBStation;
 class RBDirection;
 
+namespace SimTK {
+class ConstraintOperatorFactorization;
+class MassMatrixFactorization;
+class ProjectionFactorization;
+}
+
 using namespace SimTK;
 
 typedef Array_<const RigidBodyNode*>   RBNodePtrList;
@@ -141,7 +147,8 @@ private:
 class SimbodyMatterSubsystemRep : public SimTK::Subsystem::Guts {
 public:
     SimbodyMatterSubsystemRep() 
-      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
+      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1"),
+        minBodiesPerParallelLevel(128), useBranchParallelism(true)
     { 
         clearTopologyCache();
     }
@@ -595,19 +602,54 @@ public:
         const Vector&                   f,
         Vector&                         MInvf) const; 
 
-    // Calculate the mass matrix in O(n^2) time. State must have already
-    // been realized to Position stage. M must be resizeable or already the
-    // right size (nXn). The result is symmetric but the entire matrix is
-    // filled in.
+    // Calculate the mass matrix with the composite rigid body algorithm. 
+    // State must have already been realized to Position stage. M must be 
+    // resizeable or already the right size (nXn). The result is symmetric but
+    // the entire matrix is filled in.
     void calcM(const State& s, Matrix& M) const;
 
-    // Calculate the mass matrix inverse in O(n^2) time. State must have already
-    // been realized to Position stage. MInv must be resizeable or already the
-    // right size (nXn). The result is symmetric but the entire matrix is
-    // filled in. Only the non-prescribed block Mrr is inverted; other elements
-    // are not written.
+    // Fill in the nXn array M (n=nu) with the mass matrix, in O(n*depth) time.
+    // M is symmetric so row and column order are the same. Composite body
+    // inertias are realized first if necessary.
+    void calcMUsingCompositeBodyInertias(const State& s, Real* M) const;
+
+    // Return the sparse ~L*L factorization of the mass matrix from the State
+    // cache, first calculating and factoring M if the positions have changed
+    // since it was last factored. Rows and columns of prescribed mobilities
+    // are replaced by identity, so solves work with Mrr as multiplyByMInv()
+    // does. Throws if M is not positive definite.
+    const MassMatrixFactorization& getFactoredM(const State& s) const;
+
+    // Calculate the mass matrix inverse from the factored M. State must have 
+    // already been realized to Position stage. MInv must be resizeable or 
+    // already the right size (nXn). The result is symmetric but the entire 
+    // matrix is filled in. Only the non-prescribed block Mrr is inverted;
+    // rows and columns of prescribed mobilities are zero.
     void calcMInv(const State& s, Matrix& MInv) const;
 
+    // Same as multiplyByMInv() but using the factored M, with entries of
+    // MInvf for prescribed mobilities set to zero.
+    void multiplyByMInvUsingFactoredM(const State&  s,
+                                      const Vector& f,
+                                      Vector&       MInvf) const;
+
+    // Calculate Lambda = (J M^-1 ~J)^-1 (pseudoinverse if singular) for a kXn
+    // task Jacobian J, using the factored M.
+    void calcOperationalSpaceInertia(const State&   s,
+                                     const Matrix&  J,
+                                     Matrix&        Lambda) const;
+
+    // Calculate dudot/dq, dudot/du and dudot/dtau for the tree system with
+    // the given applied forces held fixed. State must be realized through
+    // Dynamics stage. See the method of the same name in 
+    // SimbodyMatterSubsystem.
+    void calcTreeForwardDynamicsDerivatives(const State&    s,
+        const Vector&               appliedMobilityForces,
+        const Vector_<SpatialVec>&  appliedBodyForces,
+        Matrix&                     dUDotdQ,
+        Matrix&                     dUDotdU,
+        Matrix&                     dUDotdTau) const;
+
     void calcTreeResidualForces(const State&,
         const Vector&               appliedMobilityForces,
         const Vector_<SpatialVec>&  appliedBodyForces,
@@ -944,6 +986,22 @@ public:
                                     const Vector&    deltaV,
                                     Vector&          impulse) const;
 
+    // Return G * M^-1 * G^T in factored form from the State cache, first
+    // calculating and factoring it if the positions (or, when there are 
+    // nonholonomic or acceleration-only constraints, the velocities) have 
+    // changed since it was last factored. Same State requirements as
+    // calcGMInvGt().
+    const ConstraintOperatorFactorization& 
+    getFactoredGMInvGt(const State& state) const;
+
+    // Fill in G * M^-1 * G^T as the independent diagonal blocks that result
+    // from grouping constraint equations that involve the same subtrees of 
+    // Ground. All blocks are filled in together, with one pass of the O(n)
+    // operators per column of the largest block, so this takes O(k*n) time 
+    // rather than O(m*n), where k is the size of the largest block.
+    void calcGMInvGtBlocks(const State&                     state,
+                           ConstraintOperatorFactorization& blocks) const;
+
     // Given an array of nu udots, return nb body accelerations in G (including
     // Ground as the 0th body with A_GB[0]=0). The returned accelerations are
     // A = J*udot + Jdot*u, with the Jdot*u (coriolis acceleration) term
@@ -1210,6 +1268,32 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    void setNumberOfThreads(unsigned numThreads);
+    int getNumberOfThreads() const;
+    void setMinBodiesPerParallelLevel(int numBodies);
+    int getMinBodiesPerParallelLevel() const;
+    void setUseBranchParallelism(bool useBranches);
+    bool getUseBranchParallelism() const;
+    int getNumTreeBranches() const;
+
+    // Call f(node) for every RigidBodyNode in the given level of the tree. 
+    // None of the sweeps this is used for has one node of a level depending
+    // on another, so a large enough level is divided among the threads of 
+    // levelExecutor. Otherwise, or if we're already on a worker thread, the
+    // nodes are visited serially in order. Either way each node does exactly
+    // the same arithmetic, so the results are bitwise identical.
+    template <class F> void forEachNodeInLevel(int level, const F& f) const;
+
+    // Call f(node) for every RigidBodyNode, parents before children 
+    // (sweepOutward) or children before parents (sweepInward). If the tree 
+    // splits into branches that are worth it, each branch is swept as a 
+    // single task and the trunk is done serially before (outward) or after 
+    // (inward) the branches. Otherwise this goes level by level using 
+    // forEachNodeInLevel().
+    template <class F> void sweepOutward(const F& f) const;
+    template <class F> void sweepInward(const F& f) const;
+    bool shouldSweepByBranch() const;
+
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1269,6 +1353,12 @@ public:
         const Vector&    Wuinv, // 1/u weights
         Matrix&          PVrt) const;
 
+    // Return the factored projection iteration matrix kept in the given 
+    // cache entry (positionProjectionCacheIndex or 
+    // velocityProjectionCacheIndex) for reuse by projectQ() or projectU().
+    ProjectionFactorization& 
+    updProjectionFactorization(const State& state, CacheEntryIndex cx) const;
+
     const Array_<QIndex>& getFreeQIndex(const State& state) const;
     const Array_<QIndex>& getPresQIndex(const State& state) const;
     const Array_<QIndex>& getZeroQIndex(const State& state) const;
@@ -1340,6 +1430,7 @@ private:
     // Our realizeTopology method calls this after all bodies & constraints have been added,
     // to construct part of the topology cache below.
     void endConstruction(State&);
+    void findTreeBranches();
     
         // TOPOLOGY CACHE
 
@@ -1364,6 +1455,12 @@ private:
     // Map nodeNum (a.k.a. MobilizedBodyIndex) to (level,offset).
     Array_<RigidBodyNodeIndex,MobilizedBodyIndex> nodeNum2NodeMap;
 
+    // The tree divided into a trunk, from Ground to where the tree first 
+    // splits, and the independent branches off the end of the trunk, largest
+    // first. Nodes are listed parents first. See findTreeBranches().
+    RBNodePtrList              treeTrunk;
+    Array_<RBNodePtrList>      treeBranches;
+
         // Constraints
 
     // Here we sort the above constraints by branch (ancestor's base body), then by
@@ -1436,6 +1533,12 @@ private:
     
     // Specifies whether default decorative geometry should be shown.
     bool showDefaultGeometry;
+
+    // Spreads the nodes of large tree levels over threads in the O(n) 
+    // sweeps; see forEachNodeInLevel(). Null (the default) means serial.
+    mutable ClonePtr<ParallelExecutor> levelExecutor;
+    int minBodiesPerParallelLevel;
+    bool useBranchParallelism;
 };
 
 std::ostream& operator<<(std::ostream&, const SimbodyMatterSubsystemRep&);
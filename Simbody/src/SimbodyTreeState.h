@@ -156,7 +156,11 @@ public:
                           articulatedBodyVelocityCacheIndex,
                           dynamicsCacheIndex, 
                           treeAccelerationCacheIndex, 
-                          constrainedAccelerationCacheIndex;
+                          constrainedAccelerationCacheIndex,
+                          constraintOperatorCacheIndex,
+                          massMatrixFactorizationCacheIndex,
+                          positionProjectionCacheIndex,
+                          velocityProjectionCacheIndex;
 
 
     // These are instance variables that exist regardless of modeling
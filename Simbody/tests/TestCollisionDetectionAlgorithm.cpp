@@ -532,6 +532,69 @@ void testTriangleMeshTriangleMesh() {
     }
 }
 
+// Find the contacts in a pile of spheres resting on a half space with each
+// broad phase method and with several threads, and make sure they all report
+// the same contacts in the same order.
+void findPileContacts(BroadPhase::Method method, int numThreads, Array_<Array_<PointContact> >& result) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    contacts.setBroadPhaseMethod(method);
+    contacts.setNumberOfThreads(numThreads);
+    ASSERT(contacts.getBroadPhaseMethod() == method);
+    ASSERT(contacts.getNumberOfThreads() == numThreads);
+    const int numBodies = 300;
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(), Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    for (int i = 0; i < numBodies; ++i) {
+        MobilizedBody::Translation b(matter.updGround(), Transform(), body, Transform());
+        contacts.addBody(setIndex, b, ContactGeometry::Sphere(0.5), Vec3(0));
+    }
+    State state = system.realizeTopology();
+    Random::Uniform random(0.0, 1.0);
+    random.setSeed(3);
+    result.clear();
+    for (int iteration = 0; iteration < 10; ++iteration) {
+        // Move the spheres a little each time, starting from random positions.
+
+        for (int i = 0; i < state.getNQ(); i++)
+            state.updQ()[i] = iteration == 0 ? 6*random.getValue()
+                                             : state.getQ()[i] + 0.1*(random.getValue()-0.5);
+        system.realize(state, Stage::Dynamics);
+        const Array_<Contact>& contact = contacts.getContacts(state, setIndex);
+        result.push_back();
+        for (int i = 0; i < (int) contact.size(); i++) {
+            ASSERT(PointContact::isInstance(contact[i]));
+            result.back().push_back(static_cast<const PointContact&>(contact[i]));
+        }
+    }
+}
+
+void testParallelContactSet() {
+    Array_<Array_<PointContact> > expected, actual;
+    findPileContacts(BroadPhase::SweepAndPrune, 1, expected);
+    ASSERT(expected[0].size() > 0);
+    const BroadPhase::Method methods[] = {BroadPhase::SweepAndPrune, BroadPhase::IncrementalSweepAndPrune, BroadPhase::DynamicAABBTree};
+    for (BroadPhase::Method method : methods) {
+        for (int numThreads = 1; numThreads <= 3; numThreads += 2) {
+            findPileContacts(method, numThreads, actual);
+            ASSERT(actual.size() == expected.size());
+            for (int step = 0; step < (int) actual.size(); ++step) {
+                ASSERT(actual[step].size() == expected[step].size());
+                for (int i = 0; i < (int) actual[step].size(); ++i) {
+                    const PointContact& a = actual[step][i];
+                    const PointContact& e = expected[step][i];
+                    ASSERT(a.getSurface1() == e.getSurface1());
+                    ASSERT(a.getSurface2() == e.getSurface2());
+                    assertEqual(a.getDepth(), e.getDepth());
+                    assertEqual(a.getLocation(), e.getLocation());
+                }
+            }
+        }
+    }
+}
+
 int main() {
     try {
         testHalfSpaceSphere();
@@ -541,6 +604,7 @@ int main() {
         testHalfSpaceTriangleMesh();
         testSphereTriangleMesh();
         testTriangleMeshTriangleMesh();
+        testParallelContactSet();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -0,0 +1,193 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* The constraint operator G*M^-1*~G is factored in independent blocks and
+cached in the State. These tests check the multipliers it produces against a
+dense factorization of the whole matrix, after each kind of State change that
+may or may not require refactoring. */
+
+#include "SimTKsimbody.h"
+
+#include <cmath>
+
+using namespace SimTK;
+
+// Four independent subtrees of Ground:
+//   A: three ball-jointed links closed to Ground by a ball constraint;
+//   B, C: a pin chain and a pin+slider joined by a rod, with (optionally) a
+//         nonholonomic and an acceleration-only constraint on C;
+//   D: a pin chain held to Ground by two identical, hence redundant, rods.
+class ConstraintOperatorModel {
+public:
+    explicit ConstraintOperatorModel(bool velocityConstraints)
+    :   matter(system), forces(system) {
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        const Vec3 down(0, -1, 0);
+        const Body::Rigid body(MassProperties(1, down/2,
+            Inertia(0.1, 0.2, 0.3) + Inertia(down/2, 1)));
+
+        MobilizedBody parent = matter.Ground();
+        for (int i = 0; i < 3; ++i)
+            parent = MobilizedBody::Ball(parent, i ? down : Vec3(0),
+                                         body, Vec3(0));
+        Constraint::Ball(matter.Ground(), Vec3(0.5, -2, 0), parent, down);
+
+        MobilizedBody b = matter.Ground();
+        for (int i = 0; i < 3; ++i)
+            b = MobilizedBody::Pin(b, i ? down : Vec3(3, 0, 0), body, Vec3(0));
+        MobilizedBody::Pin c1(matter.Ground(), Vec3(6, 0, 0), body, Vec3(0));
+        MobilizedBody::Slider c2(c1, down, body, Vec3(0));
+        Constraint::Rod(b, down, c2, Vec3(0), 3);
+        if (velocityConstraints) {
+            Constraint::ConstantSpeed(c2, 0.5);
+            Constraint::ConstantAcceleration(c1, 1);
+        }
+
+        MobilizedBody::Pin d1(matter.Ground(), Vec3(9, 0, 0), body, Vec3(0));
+        MobilizedBody::Pin d2(d1, down, body, Vec3(0));
+        duplicateRod = Constraint::Rod(matter.Ground(), Vec3(10, -1, 0),
+                                       d2, down, 1.5);
+        Constraint::Rod(matter.Ground(), Vec3(10, -1, 0), d2, down, 1.5);
+
+        system.realizeTopology();
+    }
+
+    void randomize(State& state, int seed, bool q, bool u) const {
+        Random::Uniform random(-1, 1);
+        random.setSeed(seed);
+        if (q) for (int i = 0; i < state.getNQ(); ++i)
+            state.updQ()[i] = random.getValue();
+        if (u) for (int i = 0; i < state.getNU(); ++i)
+            state.updU()[i] = random.getValue();
+    }
+
+    // Solve the whole G*M^-1*~G system with one dense QTZ factorization.
+    Vector solveDense(const State& state, const Vector& rhs) const {
+        Matrix GMInvGt;
+        matter.calcProjectedMInv(state, GMInvGt);
+        const Real conditioningTol =
+            GMInvGt.nrow()*SqrtEps*std::sqrt(SqrtEps);
+        FactorQTZ qtz(GMInvGt, conditioningTol);
+        Vector x;
+        qtz.solve(rhs, x);
+        return x;
+    }
+
+    // The multipliers a dense factorization produces for a State realized
+    // through Dynamics stage.
+    Vector calcDenseMultipliers(const State& state) const {
+        Vector udot, aerr;
+        Vector_<SpatialVec> A_GB;
+        matter.calcAccelerationIgnoringConstraints(state,
+            system.getMobilityForces(state, Stage::Dynamics),
+            system.getRigidBodyForces(state, Stage::Dynamics), udot, A_GB);
+        matter.calcConstraintAccelerationErrors(state, udot, aerr);
+        return solveDense(state, aerr);
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    Constraint::Rod         duplicateRod;
+};
+
+void checkMultipliers(const ConstraintOperatorModel& model,
+                      const State& state) {
+    model.system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getMultipliers(),
+                      model.calcDenseMultipliers(state), 1e-8);
+    SimTK_TEST(state.getUDotErr().normRMS() < 1e-8);
+}
+
+// Every kind of change must give the same multipliers as a fresh dense
+// factorization, whether or not the cached factorization was reused.
+void testMatchesDense(bool velocityConstraints) {
+    ConstraintOperatorModel model(velocityConstraints);
+    State state = model.system.getDefaultState();
+    model.randomize(state, 1, true, true);
+    checkMultipliers(model, state);
+
+    model.randomize(state, 2, false, true); // only u
+    checkMultipliers(model, state);
+
+    model.randomize(state, 3, true, false); // only q
+    checkMultipliers(model, state);
+
+    state.setTime(1.5);
+    checkMultipliers(model, state);
+
+    // Repeated realization at the same configuration, and a copy.
+    state.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+    checkMultipliers(model, state);
+    State copy(state);
+    copy.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+    checkMultipliers(model, copy);
+
+    // Changing the set of constraints changes the block structure.
+    model.duplicateRod.disable(state);
+    checkMultipliers(model, state);
+    model.duplicateRod.enable(state);
+    checkMultipliers(model, state);
+}
+
+void testHolonomic() {testMatchesDense(false);}
+void testNonholonomic() {testMatchesDense(true);}
+
+// The operator form shares the cached factorization across different forces,
+// and impulses are solved with it too.
+void testOperatorsShareFactorization() {
+    ConstraintOperatorModel model(true);
+    State state = model.system.getDefaultState();
+    model.randomize(state, 4, true, true);
+    model.system.realize(state, Stage::Acceleration);
+
+    const int nu = state.getNU(), nb = model.matter.getNumBodies();
+    for (int seed = 0; seed < 3; ++seed) {
+        Random::Uniform random(-10, 10);
+        random.setSeed(seed);
+        Vector f(nu);
+        for (int i = 0; i < nu; ++i) f[i] = random.getValue();
+        Vector_<SpatialVec> F(nb, SpatialVec(Vec3(0), Vec3(0)));
+        for (int i = 1; i < nb; ++i)
+            F[i] = SpatialVec(Vec3(random.getValue()), Vec3(random.getValue()));
+
+        Vector udot, aerr;
+        Vector_<SpatialVec> A_GB;
+        model.matter.calcAcceleration(state, f, F, udot, A_GB);
+        model.matter.calcConstraintAccelerationErrors(state, udot, aerr);
+        SimTK_TEST(aerr.normRMS() < 1e-8);
+
+        Vector deltaV(aerr.size()), impulse;
+        for (int i = 0; i < deltaV.size(); ++i) deltaV[i] = random.getValue();
+        model.matter.solveForConstraintImpulses(state, deltaV, impulse);
+        SimTK_TEST_EQ_TOL(impulse, model.solveDense(state, deltaV), 1e-8);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestConstraintOperator");
+        SimTK_SUBTEST(testHolonomic);
+        SimTK_SUBTEST(testNonholonomic);
+        SimTK_SUBTEST(testOperatorsShareFactorization);
+    SimTK_END_TEST();
+}
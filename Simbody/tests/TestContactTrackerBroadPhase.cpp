@@ -0,0 +1,135 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Checks that ContactTrackerSubsystem finds the same contacts, with the same
+persistent ContactIds, whichever broad phase method and number of threads it
+uses. */
+
+#include "SimTKsimbody.h"
+
+#include <tuple>
+
+using namespace SimTK;
+
+typedef std::tuple<int,int,ContactId,Contact::Condition> ContactRecord;
+
+// A pile of balls free to translate; every tenth ball carries a second sphere
+// and the first few balls share a clique, so that the pairs the subsystem
+// excludes after the broad phase are exercised too.
+static Array_<Array_<ContactRecord>>
+trackPile(BroadPhase::Method method, int numThreads) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    ContactTrackerSubsystem tracker(system);
+    tracker.setBroadPhaseMethod(method);
+    tracker.setNumberOfThreads(numThreads);
+    SimTK_TEST(tracker.getBroadPhaseMethod() == method);
+    SimTK_TEST(tracker.getNumberOfThreads() == numThreads);
+
+    const ContactMaterial material(1e6, 0, 0, 0, 0);
+    const ContactCliqueId clique = ContactSurface::createNewContactClique();
+    const int numBalls = 400;
+    for (int i=0; i < numBalls; ++i) {
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        ContactSurface surface(ContactGeometry::Sphere(0.5), material);
+        if (i < 5)
+            surface.joinClique(clique);
+        body.addContactSurface(Transform(), surface);
+        if (i % 10 == 0)
+            body.addContactSurface(Vec3(0.3,0,0),
+                ContactSurface(ContactGeometry::Sphere(0.3), material));
+        MobilizedBody::Translation(matter.updGround(), body);
+    }
+    matter.updGround().updBody().addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Sphere(2), material));
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-4, 4);
+    random.setSeed(42);
+    Array_<Array_<ContactRecord>> history;
+    for (int step=0; step < 6; ++step) {
+        // Mostly small motions, with an occasional shuffle.
+        const Real size = step == 3 ? 4 : 0.2;
+        for (int i=0; i < state.getNQ(); ++i)
+            state.updQ()[i] = step == 0 ? random.getValue()
+                            : state.getQ()[i] + size*random.getValue()/4;
+        system.realize(state, Stage::Position);
+        const ContactSnapshot& contacts = tracker.getActiveContacts(state);
+        Array_<ContactRecord> records;
+        for (int c=0; c < contacts.getNumContacts(); ++c) {
+            const Contact& contact = contacts.getContact(c);
+            records.push_back(ContactRecord(contact.getSurface1(),
+                                            contact.getSurface2(),
+                                            contact.getContactId(),
+                                            contact.getCondition()));
+        }
+        std::sort(records.begin(), records.end());
+        history.push_back(records);
+        // Make these contacts the previous ones for the next step.
+        system.realize(state, Stage::Dynamics);
+        state.autoUpdateDiscreteVariables();
+    }
+    return history;
+}
+
+void testMethodsAgree() {
+    // ContactIds are handed out globally, so only their reuse from step to
+    // step can be checked; the surface pairs are compared directly.
+    const Array_<Array_<ContactRecord>> reference =
+        trackPile(BroadPhase::SweepAndPrune, 1);
+    SimTK_TEST(!reference[0].empty());
+
+    const BroadPhase::Method methods[] = {BroadPhase::SweepAndPrune,
+                                          BroadPhase::IncrementalSweepAndPrune,
+                                          BroadPhase::DynamicAABBTree};
+    for (BroadPhase::Method method : methods)
+    for (int numThreads : {1, 3}) {
+        const Array_<Array_<ContactRecord>> history =
+            trackPile(method, numThreads);
+        SimTK_TEST(history.size() == reference.size());
+        for (int step=0; step < (int)history.size(); ++step) {
+            const Array_<ContactRecord>& a = reference[step];
+            const Array_<ContactRecord>& b = history[step];
+            SimTK_TEST(a.size() == b.size());
+            for (int c=0; c < (int)a.size(); ++c) {
+                SimTK_TEST(std::get<0>(a[c]) == std::get<0>(b[c]));
+                SimTK_TEST(std::get<1>(a[c]) == std::get<1>(b[c]));
+            }
+            if (step == 0) continue;
+            // A contact that was still unbroken at the previous step keeps
+            // its id.
+            for (int c=0; c < (int)b.size(); ++c)
+                for (const ContactRecord& prev : history[step-1])
+                    if (std::get<0>(prev) == std::get<0>(b[c])
+                        && std::get<1>(prev) == std::get<1>(b[c])
+                        && std::get<3>(prev) != Contact::Broken)
+                        SimTK_TEST(std::get<2>(prev) == std::get<2>(b[c]));
+        }
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestContactTrackerBroadPhase");
+        SimTK_SUBTEST(testMethodsAgree);
+    SimTK_END_TEST();
+}
@@ -266,11 +266,55 @@ void testEffSphereOnPlaneNewFormulation(bool verbose = false)
     }
 }
 
+// Returns the force on a mesh sphere of radius 1 sunk by the given amount into
+// a rigid surface below it.
+static Vec3 calcMeshSphereForce(const ContactGeometry& ground,
+                                const Transform& X_GS, Real stiffness) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    ContactTrackerSubsystem tracker(system);
+    CompliantContactSubsystem contactForces(system, tracker);
+    contactForces.setTransitionVelocity(1e-2);
+    matter.Ground().updBody().addContactSurface(X_GS,
+        ContactSurface(ground, ContactMaterial(2*stiffness, 0, 0, 0, 0), 1));
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    body.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::TriangleMesh
+                            (PolygonalMesh::createSphereMesh(1, 6)),
+                       ContactMaterial(2*stiffness, 0, 0, 0, 0), 1));
+    MobilizedBody::Translation mesh(matter.updGround(), Transform(), body, 
+                                    Transform());
+    const State state = system.realizeTopology();
+    system.realize(state, Stage::Dynamics);
+    ASSERT(contactForces.getNumContactForces(state)==1);
+    return contactForces.getContactForce(state,0).getForceOnSurface2()[1];
+}
+
+// The rigid surface under the mesh is found with a different nearest-point 
+// kernel for each kind of geometry. A very large sphere is locally a plane so
+// must produce the same force as a half space.
+void testEffSphereOnLargeSphere() {
+    const Real stiffness = 1e9, bigRadius = 1e5;
+    for (Real penetration = 0.002; penetration < 0.1; penetration *= 2) {
+        const Vec3 onHalfSpace = calcMeshSphereForce(ContactGeometry::HalfSpace(),
+            Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0,penetration-1,0)), 
+            stiffness);
+        const Vec3 onSphere = calcMeshSphereForce
+           (ContactGeometry::Sphere(bigRadius), 
+            Vec3(0,penetration-1-bigRadius,0), stiffness);
+        ASSERT(onHalfSpace[1] > 0);
+        ASSERT(abs(onSphere[1]/onHalfSpace[1] - 1) < 1e-3);
+        ASSERT(abs(onSphere[0]) < 1e-3*onHalfSpace[1]);
+        ASSERT(abs(onSphere[2]) < 1e-3*onHalfSpace[1]);
+    }
+}
+
 int main() {
     try {
         testForces();
         testEffSphereOnPlaneOldFormulation();
         testEffSphereOnPlaneNewFormulation();
+        testEffSphereOnLargeSphere();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -1342,6 +1342,18 @@ void testTaskJacobians() {
     }
     // These should be exactly the same.
     SimTK_TEST_EQ_TOL(JFmat2, JFmat, SignificantReal);
+
+    // Recalculating into the same storage must reuse it and overwrite
+    // whatever was there, including the columns that should be zero.
+    const Real* JSdata = &JSmat(0,0);
+    const Real* JFdata = &JFmat(0,0);
+    JSmat = NaN; JFmat = NaN;
+    matter.calcStationJacobian(state, allBodies, randS, JSmat);
+    matter.calcFrameJacobian(state, allBodies, randS, JFmat);
+    SimTK_TEST(&JSmat(0,0) == JSdata);
+    SimTK_TEST(&JFmat(0,0) == JFdata);
+    SimTK_TEST_EQ_TOL(JSmat, JS3mat, Slop);
+    SimTK_TEST_EQ_TOL(JFmat, JF3mat, Slop);
 }
 
 // Position kinematics should be valid if:
@@ -1352,6 +1364,176 @@ void testTaskJacobians() {
 // - Instance stage changes
 // It should *not* be invalidated when:
 // - time changes
+// The factored mass matrix is used for calcMInv(), multiplyByMInvUsingMFactor()
+// and calcOperationalSpaceInertia(); check them all against the O(n) 
+// operators, with and without a locked (prescribed) mobilizer in the middle of
+// a branch.
+void testMassMatrixFactorization() {
+    MultibodySystem system;
+    MyForceImpl* frcp;
+    makeSystem(false, system, frcp);
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+
+    State state = system.realizeTopology();
+    const int nq = state.getNQ();
+    const int nu = state.getNU();
+
+    // Attainable accuracy drops with problem size.
+    const Real Slop = nu*SignificantReal;
+
+    system.realizeModel(state);
+    state.updQ() = Test::randVector(nq);
+    state.updU() = Test::randVector(nu);
+    system.realize(state, Stage::Position);
+
+    Matrix M, L;
+    matter.calcM(state, M);
+    matter.calcMFactor(state, L);
+    SimTK_TEST_EQ_SIZE(~L*L, M, nu);
+    for (int i=0; i < nu; ++i)
+        for (int j=i+1; j < nu; ++j)
+            SimTK_TEST(L(i,j) == 0);
+    // Mobilities on different branches don't couple, so L is sparse.
+    for (int i=0; i < nu; ++i)
+        for (int j=0; j < nu; ++j)
+            if (M(i,j) == 0) SimTK_TEST(L(i,j) == 0 && L(j,i) == 0);
+
+    const Vector f = 100*Test::randVector(nu);
+    Vector MInvf, MInvfFactored;
+    matter.multiplyByMInv(state, f, MInvf);
+    matter.multiplyByMInvUsingMFactor(state, f, MInvfFactored);
+    SimTK_TEST_EQ_TOL(MInvfFactored, MInvf, Slop);
+
+    // Two station tasks on different branches and a frame task on the end of
+    // the main branch.
+    const Array_<MobilizedBodyIndex> onBodyB = {MobilizedBodyIndex(9),
+                                                MobilizedBodyIndex(10)};
+    const Array_<Vec3> stations = {Test::randVec3(), Test::randVec3()};
+    Matrix JS, JF;
+    matter.calcStationJacobian(state, onBodyB, stations, JS);
+    matter.calcFrameJacobian(state, MobilizedBodyIndex(5), Test::randVec3(), JF);
+    Matrix J(12, nu);
+    J(0,0,6,nu) = JS; J(6,0,6,nu) = JF;
+
+    Matrix MInv, Lambda;
+    matter.calcMInv(state, MInv);
+    matter.calcOperationalSpaceInertia(state, J, Lambda);
+    Matrix identity(12,12); identity = 1;
+    SimTK_TEST_EQ_SIZE(Lambda*(J*MInv*~J), identity, nu);
+
+    // Repeating a task makes J M^-1 ~J singular; we should get the
+    // pseudoinverse.
+    Matrix Jredundant(18, nu);
+    Jredundant(0,0,12,nu) = J; Jredundant(12,0,6,nu) = JS;
+    const Matrix W = Jredundant*MInv*~Jredundant;
+    matter.calcOperationalSpaceInertia(state, Jredundant, Lambda);
+    SimTK_TEST_EQ_SIZE(W*Lambda*W, W, 10*nu);
+    SimTK_TEST_EQ_SIZE(Lambda*W*Lambda, Lambda, 10*nu);
+
+    // Now lock the Slider that carries a side branch. Its mobility becomes
+    // prescribed and the factorization must work with the remaining block.
+    const MobilizedBody& slider = matter.getMobilizedBody(MobilizedBodyIndex(7));
+    const int ux = slider.getFirstUIndex(state);
+    slider.lock(state);
+    system.realize(state, Stage::Position);
+
+    matter.multiplyByMInv(state, f, MInvf);
+    matter.multiplyByMInvUsingMFactor(state, f, MInvfFactored);
+    SimTK_TEST(MInvfFactored[ux] == 0);
+    MInvf[ux] = 0;
+    SimTK_TEST_EQ_TOL(MInvfFactored, MInvf, Slop);
+
+    matter.calcMInv(state, MInv);
+    Vector e(nu, Real(0));
+    for (int j=0; j < nu; ++j) {
+        e[j] = 1;
+        matter.multiplyByMInv(state, e, MInvf);
+        e[j] = 0;
+        MInvf[ux] = 0;
+        if (j == ux) MInvf = 0;
+        SimTK_TEST_EQ_TOL(MInv(j), MInvf, Slop);
+    }
+
+    // Lambda should now ignore the locked column of J.
+    Matrix Jfree(J);
+    Jfree(ux) = 0;
+    matter.calcOperationalSpaceInertia(state, J, Lambda);
+    SimTK_TEST_EQ_SIZE(Lambda*(Jfree*MInv*~Jfree), identity, nu);
+}
+
+// The forces applied by MyForceImpl don't depend on the state, so numerical
+// derivatives of the full forward dynamics should match the derivatives 
+// calculated with those forces held fixed.
+void testForwardDynamicsDerivatives() {
+    MultibodySystem system;
+    MyForceImpl* frcp;
+    makeSystem(false, system, frcp);
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+
+    State state = system.realizeTopology();
+    const int nq = state.getNQ();
+    const int nu = state.getNU();
+    const int nb = matter.getNumBodies();
+
+    system.realizeModel(state);
+    state.updQ() = Test::randVector(nq);
+    state.updU() = Test::randVector(nu);
+    frcp->setMobilityForces(Test::randVector(nu));
+    Vector_<SpatialVec> bodyForces(nb);
+    for (int i=0; i < nb; ++i)
+        bodyForces[i] = Test::randSpatialVec();
+    frcp->setBodyForces(bodyForces);
+    system.realize(state, Stage::Dynamics);
+
+    // Compare with central differences of realize(Acceleration). Prescribed
+    // accelerations are fixed at zero by a lock, so they are held fixed
+    // there too.
+    auto compareWithNumerical = [&]() {
+        Matrix dUDotdQ, dUDotdU, dUDotdTau;
+        matter.calcTreeForwardDynamicsDerivatives(state,
+            system.getMobilityForces(state, Stage::Dynamics),
+            system.getRigidBodyForces(state, Stage::Dynamics),
+            dUDotdQ, dUDotdU, dUDotdTau);
+        SimTK_TEST(dUDotdQ.nrow() == nu && dUDotdQ.ncol() == nq);
+
+        Matrix MInv;
+        matter.calcMInv(state, MInv);
+        SimTK_TEST_EQ_SIZE(dUDotdTau, MInv, nu);
+
+        State tmp(state);
+        const Real h = 1e-5;
+        Matrix numdUDotdQ(nu,nq), numdUDotdU(nu,nu);
+        for (int j=0; j < nq; ++j) {
+            tmp.updQ()[j] = state.getQ()[j] + h;
+            system.realize(tmp, Stage::Acceleration);
+            const Vector udotPlus = tmp.getUDot();
+            tmp.updQ()[j] = state.getQ()[j] - h;
+            system.realize(tmp, Stage::Acceleration);
+            numdUDotdQ(j) = (udotPlus - tmp.getUDot())/(2*h);
+            tmp.updQ()[j] = state.getQ()[j];
+        }
+        for (int j=0; j < nu; ++j) {
+            tmp.updU()[j] = state.getU()[j] + h;
+            system.realize(tmp, Stage::Acceleration);
+            const Vector udotPlus = tmp.getUDot();
+            tmp.updU()[j] = state.getU()[j] - h;
+            system.realize(tmp, Stage::Acceleration);
+            numdUDotdU(j) = (udotPlus - tmp.getUDot())/(2*h);
+            tmp.updU()[j] = state.getU()[j];
+        }
+
+        SimTK_TEST_EQ_TOL(dUDotdQ, numdUDotdQ, 1e-6);
+        SimTK_TEST_EQ_TOL(dUDotdU, numdUDotdU, 1e-6);
+    };
+
+    compareWithNumerical();
+
+    // Lock the Slider that carries a side branch.
+    matter.getMobilizedBody(MobilizedBodyIndex(7)).lock(state);
+    system.realize(state, Stage::Dynamics);
+    compareWithNumerical();
+}
+
 void testPositionKinematics() {
     MultibodySystem system;
     MyForceImpl* frcp;
@@ -1496,6 +1678,8 @@ int main() {
         SimTK_SUBTEST(testUnconstrainedSystem);
         SimTK_SUBTEST(testConstrainedSystem);
         SimTK_SUBTEST(testTaskJacobians);
+        SimTK_SUBTEST(testMassMatrixFactorization);
+        SimTK_SUBTEST(testForwardDynamicsDerivatives);
     SimTK_END_TEST();
 }
 
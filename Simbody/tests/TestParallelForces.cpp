@@ -88,9 +88,179 @@ void testNonParallelForce()
     system.realize(state, Stage::Dynamics);
 }
 
+// Adds a fixed generalized force and body force; optionally position-only so
+// that GeneralForceSubsystem caches it.
+class ConstantForceImpl : public Force::Custom::Implementation {
+public:
+    ConstantForceImpl(Real value, bool parallel, bool positionOnly,
+                      Real costHint)
+    :   value(value), parallel(parallel), positionOnly(positionOnly),
+        costHint(costHint) {}
+    bool shouldBeParallelIfPossible() const override {return parallel;}
+    bool dependsOnlyOnPositions() const override {return positionOnly;}
+    Real getCostHint() const override {return costHint;}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const override{
+        mobilityForces[0] += value;
+        bodyForces[1][1] += Vec3(value, 2*value, 0);
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        return 0.0;
+    }
+private:
+    Real value;
+    bool parallel, positionOnly;
+    Real costHint;
+};
+
+// Whatever the thread count and however the forces get packed onto threads,
+// the accumulated forces must be the same as when computed serially.
+void testLoadBalancedForceSums() {
+    for (int numThreads = 1; numThreads <= 4; ++numThreads) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        forces.setNumberOfThreads(numThreads);
+        forces.setLoadBalancingInterval(3);
+        MobilizedBody::Pin body(matter.Ground(), Transform(),
+                                Body::Rigid(MassProperties(1, Vec3(0),
+                                            UnitInertia(1))), Transform());
+        Real expected = 0;
+        for (int i = 0; i < 60; ++i) {
+            const Real value = i+1;
+            Force::Custom(forces, new ConstantForceImpl(value, i%3 != 0,
+                          i%4 == 0, i%5 == 0 ? 1e-3*i : 0));
+            expected += value;
+        }
+        system.realizeTopology();
+        State state = system.getDefaultState();
+        for (int step = 0; step < 10; ++step) {
+            // Alternate between recomputing and reusing the cached
+            // position-only forces.
+            if (step % 2 == 0)
+                state.invalidateAllCacheAtOrAbove(Stage::Position);
+            else
+                state.invalidateAllCacheAtOrAbove(Stage::Velocity);
+            system.realize(state, Stage::Dynamics);
+            SimTK_TEST_EQ(system.getMobilityForces(state, Stage::Dynamics)[0],
+                          expected);
+            SimTK_TEST_EQ(
+                system.getRigidBodyForces(state, Stage::Dynamics)[1][1],
+                Vec3(expected, 2*expected, 0));
+        }
+    }
+}
+
+// Changing the number of threads between realizations of the same State must
+// give a schedule with no more bins than the new executor has threads.
+void testThreadCountChange() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    forces.setNumberOfThreads(4);
+    MobilizedBody::Pin body(matter.Ground(), Transform(),
+                            Body::Rigid(MassProperties(1, Vec3(0),
+                                        UnitInertia(1))), Transform());
+    Real expected = 0;
+    for (int i = 0; i < 20; ++i) {
+        Force::Custom(forces, new ConstantForceImpl(i+1, i%4 != 0, false, 0));
+        expected += i+1;
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    const int threadCounts[] = {4, 2, 1, 3, 4};
+    for (int numThreads : threadCounts) {
+        forces.setNumberOfThreads(numThreads);
+        state.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+        system.realize(state, Stage::Dynamics);
+        SimTK_TEST_EQ(system.getMobilityForces(state, Stage::Dynamics)[0],
+                      expected);
+    }
+}
+
+// Each force touches just a few scattered bodies and mobilities of a large
+// system, which exercises the blockwise (and parallel) reduction of the
+// per-thread force buffers. If it is "listed", it says which entries it
+// touches so that only those blocks are reduced.
+class ScatteredForceImpl : public Force::Custom::Implementation {
+public:
+    ScatteredForceImpl(int seed, bool listed) : seed(seed), listed(listed) {}
+    bool shouldBeParallelIfPossible() const override {return true;}
+    bool findAffectedBodiesAndMobilities(const State& state,
+            Array_<MobilizedBodyIndex>& bodies,
+            Array_<UIndex>& mobilities) const override {
+        if (!listed)
+            return false;
+        const int nu = state.getNU(), nb = nu+1;
+        for (int k = 0; k < 3; ++k) {
+            const int i = getIndex(k, nu);
+            mobilities.push_back(UIndex(i));
+            bodies.push_back(MobilizedBodyIndex(1 + i % (nb-1)));
+        }
+        return true;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const override{
+        for (int k = 0; k < 3; ++k) {
+            const int i = getIndex(k, mobilityForces.size());
+            mobilityForces[i] += seed + k;
+            bodyForces[1 + i % (bodyForces.size()-1)][0] += Vec3(seed);
+        }
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        return 0.0;
+    }
+private:
+    int getIndex(int k, int nu) const {return (seed*97 + k*331) % nu;}
+    int seed;
+    bool listed;
+};
+
+void testScatteredForceReduction(bool listed) {
+    const int numBodies = 1500, numForces = 50;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    forces.setNumberOfThreads(4);
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    for (int i = 0; i < numBodies; ++i)
+        MobilizedBody::Slider(matter.Ground(), Transform(), body, Transform());
+    for (int f = 0; f < numForces; ++f)
+        Force::Custom(forces, new ScatteredForceImpl(f, listed));
+
+    system.realizeTopology();
+    State state = system.getDefaultState();
+
+    // Compute the expected totals serially.
+    Vector expectedMobility(numBodies, Real(0));
+    Vector_<SpatialVec> expectedBody(numBodies+1, SpatialVec(Vec3(0),Vec3(0)));
+    Vector_<Vec3> noParticles;
+    for (int f = 0; f < numForces; ++f)
+        ScatteredForceImpl(f, listed).calcForce(state, expectedBody,
+                                                noParticles, expectedMobility);
+
+    for (int step = 0; step < 3; ++step) {
+        state.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+        system.realize(state, Stage::Dynamics);
+        const Vector& mobilityForces =
+            system.getMobilityForces(state, Stage::Dynamics);
+        const Vector_<SpatialVec>& bodyForces =
+            system.getRigidBodyForces(state, Stage::Dynamics);
+        for (int i = 0; i < numBodies; ++i)
+            SimTK_TEST_EQ(mobilityForces[i], expectedMobility[i]);
+        for (int b = 0; b <= numBodies; ++b)
+            SimTK_TEST_EQ(bodyForces[b], expectedBody[b]);
+    }
+}
+
 int main()
 {
     SimTK_START_TEST("TestParallelForces");
+        SimTK_SUBTEST(testLoadBalancedForceSums);
+        SimTK_SUBTEST1(testScatteredForceReduction, false);
+        SimTK_SUBTEST1(testScatteredForceReduction, true);
+        SimTK_SUBTEST(testThreadCountChange);
+
         //Simply pass the test if only one thread is supported on this machine
         unsigned concurrentThreadsSupported = std::thread::hardware_concurrency();
         if(concurrentThreadsSupported <= 1)
@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* The matter subsystem can spread the bodies at each level of the tree over
+several threads during its O(n) sweeps, or sweep each independent branch of
+the tree as a single task. These tests check that doing so gives exactly the
+same bits as the serial sweeps. */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+
+static const Vec3 Down(0, -1, 0);
+
+// A chain of assorted mobilizers.
+static MobilizedBody addChain(MobilizedBody parent, const Vec3& inboard,
+                              int length, int seed) {
+    const Body::Rigid body(MassProperties(1, Down/2,
+        Inertia(0.1, 0.2, 0.3) + Inertia(Down/2, 1)));
+    for (int i = 0; i < length; ++i) {
+        const Vec3 X_PF = i ? Down : inboard;
+        switch ((seed+i) % 3) {
+        case 0: parent = MobilizedBody::Pin(parent, X_PF, body, Vec3(0)); 
+                break;
+        case 1: parent = MobilizedBody::Ball(parent, X_PF, body, Vec3(0)); 
+                break;
+        case 2: parent = MobilizedBody::Gimbal(parent, X_PF, body, Vec3(0)); 
+                break;
+        }
+    }
+    return parent;
+}
+
+// Wide: many short chains hanging from Ground, with a few free bodies and some
+// constraints, so that every level of the tree is wide.
+// Humanoid: a floating base with four long limbs and a head.
+// Lopsided: a floating base with one long limb and one short one, which
+// are not worth sweeping in parallel.
+enum ModelKind {Wide, Humanoid, Lopsided};
+
+class TreeModel {
+public:
+    TreeModel(ModelKind kind, int numThreads, bool useBranches) 
+    :   matter(system), forces(system) {
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        Force::GlobalDamper(forces, matter, 0.1);
+        const Body::Rigid body(MassProperties(1, Down/2,
+            Inertia(0.1, 0.2, 0.3) + Inertia(Down/2, 1)));
+
+        if (kind == Wide) {
+            for (int c = 0; c < 60; ++c) {
+                MobilizedBody end = 
+                    addChain(matter.Ground(), Vec3(2*c, 0, 0), 3, c);
+                if (c % 10 == 0)
+                    Constraint::Ball(matter.Ground(), Vec3(2*c+1, -2.5, 0), 
+                                     end, Down);
+            }
+            for (int i = 0; i < 20; ++i)
+                MobilizedBody::Free(matter.Ground(), Vec3(i, 1, 0), 
+                                    body, Vec3(0));
+        } else {
+            const MobilizedBody::Free pelvis(matter.Ground(), Vec3(0), 
+                                             body, Vec3(0));
+            const MobilizedBody torso = addChain(pelvis, Vec3(0, 1, 0), 2, 0);
+            if (kind == Humanoid) {
+                addChain(pelvis, Vec3(-0.2, 0, 0), 12, 1);
+                addChain(pelvis, Vec3( 0.2, 0, 0), 12, 2);
+                addChain(torso, Vec3(-0.4, 0, 0), 12, 3);
+                addChain(torso, Vec3( 0.4, 0, 0), 12, 4);
+                addChain(torso, Vec3(0, 0.5, 0), 2, 5);
+            } else {
+                addChain(torso, Vec3(-0.4, 0, 0), 30, 3);
+                addChain(torso, Vec3( 0.4, 0, 0), 2, 4);
+            }
+        }
+
+        matter.setNumberOfThreads(numThreads);
+        matter.setMinBodiesPerParallelLevel(1);
+        matter.setUseBranchParallelism(useBranches);
+        system.realizeTopology();
+    }
+
+    State getState() const {
+        State state = system.getDefaultState();
+        Random::Uniform random(-0.5, 0.5);
+        random.setSeed(7);
+        for (int i = 0; i < state.getNQ(); ++i)
+            state.updQ()[i] = random.getValue();
+        for (int i = 0; i < state.getNU(); ++i)
+            state.updU()[i] = random.getValue();
+        system.realize(state, Stage::Time);
+        matter.normalizeQuaternions(state);
+        system.realize(state, Stage::Acceleration);
+        return state;
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+};
+
+// Exact comparison; we want the same bits, not just close answers.
+template <class V>
+bool isIdentical(const V& a, const V& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); ++i)
+        if (!(a[i] == b[i])) return false;
+    return true;
+}
+
+void testSettings() {
+    TreeModel model(Wide, 1, true);
+    SimTK_TEST(model.matter.getNumberOfThreads() == 1);
+    SimTK_TEST(model.matter.getMinBodiesPerParallelLevel() == 1);
+    model.matter.setNumberOfThreads(3);
+    SimTK_TEST(model.matter.getNumberOfThreads() == 3);
+    model.matter.setMinBodiesPerParallelLevel(50);
+    SimTK_TEST(model.matter.getMinBodiesPerParallelLevel() == 50);
+    SimTK_TEST_MUST_THROW(model.matter.setNumberOfThreads(0));
+    SimTK_TEST_MUST_THROW(model.matter.setMinBodiesPerParallelLevel(0));
+    model.matter.setUseBranchParallelism(false);
+    SimTK_TEST(!model.matter.getUseBranchParallelism());
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    SimTK_TEST(matter.getNumberOfThreads() == 1);
+    SimTK_TEST(matter.getMinBodiesPerParallelLevel() == 128);
+    SimTK_TEST(matter.getUseBranchParallelism());
+    SimTK_TEST(matter.getNumTreeBranches() == 0);
+}
+
+// The trunk runs down through single children to the first split.
+void testFindBranches() {
+    SimTK_TEST(TreeModel(Wide, 1, true).matter.getNumTreeBranches() == 80);
+    // The pelvis is in the trunk; the torso and arms are one branch.
+    SimTK_TEST(TreeModel(Humanoid, 1, true).matter.getNumTreeBranches() == 3);
+    // Here the trunk goes on up through the torso.
+    SimTK_TEST(TreeModel(Lopsided, 1, true).matter.getNumTreeBranches() == 2);
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    addChain(matter.Ground(), Vec3(0), 5, 0);
+    system.realizeTopology();
+    SimTK_TEST(matter.getNumTreeBranches() == 0);
+}
+
+void testIdenticalResults(ModelKind kind, bool useBranches) {
+    const TreeModel serial(kind, 1, useBranches), 
+                    parallel(kind, 4, useBranches);
+    const State s = serial.getState();
+    const State p = parallel.getState();
+
+    for (MobodIndex mbx(0); mbx < serial.matter.getNumBodies(); ++mbx) {
+        const MobilizedBody& ms = serial.matter.getMobilizedBody(mbx);
+        const MobilizedBody& mp = parallel.matter.getMobilizedBody(mbx);
+        SimTK_TEST(ms.getBodyTransform(s).p() == mp.getBodyTransform(p).p());
+        SimTK_TEST(ms.getBodyTransform(s).R() == mp.getBodyTransform(p).R());
+        SimTK_TEST(ms.getBodyVelocity(s) == mp.getBodyVelocity(p));
+        SimTK_TEST(ms.getBodyAcceleration(s) == mp.getBodyAcceleration(p));
+    }
+    SimTK_TEST(isIdentical(s.getQErr(), p.getQErr()));
+    SimTK_TEST(isIdentical(s.getUDot(), p.getUDot()));
+    SimTK_TEST(isIdentical(s.getQDotDot(), p.getQDotDot()));
+    SimTK_TEST(isIdentical(s.getMultipliers(), p.getMultipliers()));
+
+    Vector f(s.getNU());
+    Random::Gaussian random;
+    random.setSeed(11);
+    for (int i = 0; i < f.size(); ++i) f[i] = random.getValue();
+    Vector MInvfS, MInvfP;
+    serial.matter.multiplyByMInv(s, f, MInvfS);
+    parallel.matter.multiplyByMInv(p, f, MInvfP);
+    SimTK_TEST(isIdentical(MInvfS, MInvfP));
+}
+
+// Integrating with threads must follow exactly the same trajectory.
+void testIdenticalTrajectory(ModelKind kind, bool useBranches) {
+    const TreeModel serial(kind, 1, useBranches), 
+                    parallel(kind, 4, useBranches);
+    RungeKuttaMersonIntegrator integS(serial.system), integP(parallel.system);
+    integS.setAccuracy(1e-4);
+    integP.setAccuracy(1e-4);
+    TimeStepper tsS(serial.system, integS), tsP(parallel.system, integP);
+    tsS.initialize(serial.getState());
+    tsP.initialize(parallel.getState());
+    tsS.stepTo(0.2);
+    tsP.stepTo(0.2);
+    SimTK_TEST(integS.getNumStepsTaken() == integP.getNumStepsTaken());
+    SimTK_TEST(isIdentical(tsS.getState().getQ(), tsP.getState().getQ()));
+    SimTK_TEST(isIdentical(tsS.getState().getU(), tsP.getState().getU()));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelTreeSweeps");
+        SimTK_SUBTEST(testSettings);
+        SimTK_SUBTEST(testFindBranches);
+        SimTK_SUBTEST2(testIdenticalResults, Wide, false);
+        SimTK_SUBTEST2(testIdenticalResults, Wide, true);
+        SimTK_SUBTEST2(testIdenticalResults, Humanoid, true);
+        SimTK_SUBTEST2(testIdenticalResults, Lopsided, true);
+        SimTK_SUBTEST2(testIdenticalTrajectory, Wide, false);
+        SimTK_SUBTEST2(testIdenticalTrajectory, Humanoid, true);
+    SimTK_END_TEST();
+}
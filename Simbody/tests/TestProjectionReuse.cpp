@@ -0,0 +1,232 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* projectQ() and projectU() keep their factored iteration matrices in the
+State and, for the local projections done during integration, reuse them 
+(modified Newton) until convergence slows. These tests
+check that reuse happens when it should, that it gives the same answers as
+full Newton to within the projection accuracy, and that the factorization and
+reuse counters add up. */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+
+// A ball-jointed chain closed to Ground by a ball constraint, and a pin
+// chain held by a rod with a constant speed constraint on its first link.
+class ProjectionModel {
+public:
+    ProjectionModel() : matter(system), forces(system) {
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        const Vec3 down(0, -1, 0);
+        const Body::Rigid body(MassProperties(1, down/2,
+            Inertia(0.1, 0.2, 0.3) + Inertia(down/2, 1)));
+
+        MobilizedBody parent = matter.Ground();
+        for (int i = 0; i < 3; ++i)
+            parent = MobilizedBody::Ball(parent, i ? down : Vec3(0),
+                                         body, Vec3(0));
+        Constraint::Ball(matter.Ground(), Vec3(0.5, -2, 0), parent, down);
+
+        MobilizedBody::Pin b1(matter.Ground(), Vec3(3, 0, 0), body, Vec3(0));
+        MobilizedBody::Pin b2(b1, down, body, Vec3(0));
+        rod = Constraint::Rod(matter.Ground(), Vec3(4, -1, 0), b2, down, 1.5);
+        Constraint::ConstantSpeed(b1, 0.5);
+
+        system.realizeTopology();
+    }
+
+    // A State that satisfies the constraints, with the projection 
+    // factorizations made at its configuration.
+    State getAssembledState() const {
+        State state = system.getDefaultState();
+        Random::Uniform random(-0.3, 0.3);
+        random.setSeed(1);
+        for (int i = 0; i < state.getNQ(); ++i)
+            state.updQ()[i] += random.getValue();
+        for (int i = 0; i < state.getNU(); ++i)
+            state.updU()[i] = random.getValue();
+        system.realize(state, Stage::Time);
+        system.project(state, 1e-10);
+        projectQ(state, true, true);
+        projectU(state, true, true);
+        return state;
+    }
+
+    void perturb(State& state, Real size, int seed) const {
+        Random::Uniform random(-size, size);
+        random.setSeed(seed);
+        for (int i = 0; i < state.getNQ(); ++i)
+            state.updQ()[i] += random.getValue();
+        for (int i = 0; i < state.getNU(); ++i)
+            state.updU()[i] += random.getValue();
+    }
+
+    ProjectResults projectQ(State& state, bool fullNewton, 
+                            bool force=false) const {
+        ProjectOptions opts(1e-8);
+        opts.setOption(ProjectOptions::LocalOnly);
+        if (fullNewton) opts.setOption(ProjectOptions::ForceFullNewton);
+        if (force) opts.setOption(ProjectOptions::ForceProjection);
+        Vector qErrEst;
+        ProjectResults results;
+        system.realize(state, Stage::Position);
+        system.projectQ(state, qErrEst, opts, results);
+        return results;
+    }
+
+    ProjectResults projectU(State& state, bool fullNewton, 
+                            bool force=false) const {
+        ProjectOptions opts(1e-8);
+        opts.setOption(ProjectOptions::LocalOnly);
+        if (fullNewton) opts.setOption(ProjectOptions::ForceFullNewton);
+        if (force) opts.setOption(ProjectOptions::ForceProjection);
+        Vector uErrEst;
+        ProjectResults results;
+        system.realize(state, Stage::Velocity);
+        system.projectU(state, uErrEst, opts, results);
+        return results;
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    Constraint::Rod         rod;
+};
+
+// After a small change to q, the previous factorization is good enough and
+// the result agrees with a full Newton projection.
+void testQReuse() {
+    ProjectionModel model;
+    const State assembled = model.getAssembledState();
+
+    State modified(assembled), full(assembled);
+    model.perturb(modified, 1e-3, 2);
+    model.perturb(full, 1e-3, 2);
+
+    const ProjectResults r = model.projectQ(modified, false);
+    SimTK_TEST(r.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(r.getNumReusedFactorizations() == 1);
+    SimTK_TEST(r.getNumFactorizations() == 0);
+    SimTK_TEST(r.getNumIterations() >= 1);
+
+    const ProjectResults f = model.projectQ(full, true);
+    SimTK_TEST(f.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(f.getNumReusedFactorizations() == 0);
+    SimTK_TEST(f.getNumFactorizations() == f.getNumIterations());
+
+    SimTK_TEST(modified.getQErr().normRMS() < 1e-8);
+    SimTK_TEST_EQ_TOL(modified.getQ(), full.getQ(), 1e-6);
+
+    // A full Newton projection right after another at the same q can use
+    // its factorization, which is exact.
+    const ProjectResults again = model.projectQ(full, true);
+    SimTK_TEST(again.getExitStatus() == ProjectResults::Succeeded);
+}
+
+// A large change makes the old factorization useless; it must be replaced
+// but the projection still succeeds.
+void testQRefactorsWhenSlow() {
+    ProjectionModel model;
+    State state = model.getAssembledState();
+    model.perturb(state, 0.2, 3);
+
+    const ProjectResults r = model.projectQ(state, false);
+    SimTK_TEST(r.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(r.getNumReusedFactorizations() == 1);
+    SimTK_TEST(r.getNumFactorizations() >= 1);
+    SimTK_TEST(state.getQErr().normRMS() < 1e-8);
+}
+
+void testUReuse() {
+    ProjectionModel model;
+    const State assembled = model.getAssembledState();
+
+    State modified(assembled), full(assembled);
+    model.perturb(modified, 1e-3, 4);
+    model.perturb(full, 1e-3, 4);
+    model.projectQ(modified, false);
+    model.projectQ(full, true);
+
+    const ProjectResults r = model.projectU(modified, false);
+    SimTK_TEST(r.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(r.getNumReusedFactorizations() == 1);
+
+    const ProjectResults f = model.projectU(full, true);
+    SimTK_TEST(f.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(f.getNumReusedFactorizations() == 0);
+    SimTK_TEST(f.getNumFactorizations() == 1);
+
+    SimTK_TEST(modified.getUErr().normRMS() < 1e-8);
+    SimTK_TEST_EQ_TOL(modified.getU(), full.getU(), 1e-6);
+}
+
+// Disabling a constraint changes the iteration matrix's dimensions, so the
+// old factorization must not be used.
+void testInstanceChangeForcesFactorization() {
+    ProjectionModel model;
+    State state = model.getAssembledState();
+    model.rod.disable(state);
+    model.perturb(state, 1e-3, 5);
+
+    const ProjectResults r = model.projectQ(state, false);
+    SimTK_TEST(r.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(r.getNumReusedFactorizations() == 0);
+    SimTK_TEST(r.getNumFactorizations() >= 1);
+    SimTK_TEST(state.getQErr().normRMS() < 1e-8);
+}
+
+// While integrating, nearly every projection should reuse a factorization.
+void testCountersWhileIntegrating() {
+    ProjectionModel model;
+    State state = model.getAssembledState();
+    model.system.resetAllCountersToZero();
+
+    RungeKuttaMersonIntegrator integ(model.system);
+    integ.setAccuracy(1e-6);
+    TimeStepper ts(model.system, integ);
+    ts.initialize(state);
+    ts.stepTo(1);
+
+    const int nProjections = model.system.getNumQProjections()
+                           + model.system.getNumUProjections();
+    const int nFactored = model.system.getNumProjectionFactorizations();
+    const int nReused = model.system.getNumReusedProjectionFactorizations();
+    SimTK_TEST(nProjections > 0);
+    SimTK_TEST(nReused > nFactored);
+    SimTK_TEST(ts.getState().getQErr().normRMS() < 1e-5);
+
+    model.system.resetAllCountersToZero();
+    SimTK_TEST(model.system.getNumProjectionFactorizations() == 0);
+    SimTK_TEST(model.system.getNumReusedProjectionFactorizations() == 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestProjectionReuse");
+        SimTK_SUBTEST(testQReuse);
+        SimTK_SUBTEST(testQRefactorsWhenSlow);
+        SimTK_SUBTEST(testUReuse);
+        SimTK_SUBTEST(testInstanceChangeForcesFactorization);
+        SimTK_SUBTEST(testCountersWhileIntegrating);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,164 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+
+// A spring on one mobility, optionally computed in parallel with the other
+// forces or cached by GeneralForceSubsystem as position-only.
+class MobilitySpringImpl : public Force::Custom::Implementation {
+public:
+    MobilitySpringImpl(const MobilizedBody& mobod, Real stiffness,
+                       bool parallel, bool positionOnly)
+    :   mobod(mobod), stiffness(stiffness), parallel(parallel),
+        positionOnly(positionOnly) {}
+    bool shouldBeParallelIfPossible() const override {return parallel;}
+    bool dependsOnlyOnPositions() const override {return positionOnly;}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const override{
+        mobod.applyOneMobilityForce(state, 0,
+            -stiffness*mobod.getOneQ(state, 0), mobilityForces);
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        return 0.5*stiffness*square(mobod.getOneQ(state, 0));
+    }
+private:
+    MobilizedBody mobod; // a reference handle
+    Real stiffness;
+    bool parallel, positionOnly;
+};
+
+// A pendulum chain plus a free body, with gravity, springs of every kind
+// GeneralForceSubsystem handles differently, and a coordinate coupler.
+class BatchModel {
+public:
+    BatchModel() : matter(system), forces(system) {
+        forces.setNumberOfThreads(2);
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        const Body::Rigid body(MassProperties(1, Vec3(0, -0.5, 0),
+                                              UnitInertia(0.1)));
+        MobilizedBody parent = matter.Ground();
+        for (int i = 0; i < NumLinks; ++i) {
+            MobilizedBody::Pin link(parent, Vec3(0, -1, 0), body, Vec3(0));
+            links.push_back(link);
+            Force::Custom(forces, new MobilitySpringImpl(links.back(),
+                          10+i, i%2 == 0, i%3 == 0));
+            parent = link;
+        }
+        MobilizedBody::Free free(matter.Ground(), Vec3(2, 0, 0), body,
+                                 Vec3(0));
+        Force::TwoPointLinearSpring(forces, links.back(), Vec3(0),
+                                    free, Vec3(0), 50, 1);
+        Constraint::CoordinateCoupler(matter,
+            new Function::Linear(Vector(Vec3(1, -2, 0))),
+            Array_<MobilizedBodyIndex>{links[1], links[2]},
+            Array_<MobilizerQIndex>(2, MobilizerQIndex(0)));
+        system.realizeTopology();
+    }
+
+    // A State with pseudorandom q's and u's.
+    State makeState(int seed) const {
+        State state = system.getDefaultState();
+        Random::Uniform random(-1, 1);
+        random.setSeed(seed);
+        for (int i = 0; i < state.getNQ(); ++i)
+            state.updQ()[i] = random.getValue();
+        for (int i = 0; i < state.getNU(); ++i)
+            state.updU()[i] = random.getValue();
+        state.setTime(0.1*seed);
+        system.realize(state, Stage::Time);
+        matter.normalizeQuaternions(state); // free body's orientation
+        return state;
+    }
+
+    static const int NumLinks = 8;
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    Array_<MobilizedBody>   links;
+};
+
+// Each State realized in a batch must come out as if realized by itself.
+void testBatchMatchesSerial() {
+    const int NumStates = 50;
+    BatchModel model;
+    Array_<State> expected, batch;
+    for (int i = 0; i < NumStates; ++i) {
+        expected.push_back(model.makeState(i));
+        batch.push_back(expected.back());
+        model.system.realize(expected.back(), Stage::Acceleration);
+    }
+    Array_<State*> states;
+    for (State& state : batch)
+        states.push_back(&state);
+
+    ParallelExecutor executor(4);
+    for (int pass = 0; pass < 2; ++pass) {
+        const int numBefore =
+            model.system.getNumRealizationsOfThisStage(Stage::Acceleration);
+        model.system.realizeBatch(states, Stage::Acceleration,
+                                  pass == 0 ? &executor : nullptr);
+        SimTK_TEST(model.system.getNumRealizationsOfThisStage
+                   (Stage::Acceleration) == numBefore + NumStates);
+        for (int i = 0; i < NumStates; ++i) {
+            SimTK_TEST(batch[i].getSystemStage() == Stage::Acceleration);
+            SimTK_TEST_EQ(batch[i].getUDot(), expected[i].getUDot());
+            SimTK_TEST_EQ(batch[i].getMultipliers(),
+                          expected[i].getMultipliers());
+            SimTK_TEST_EQ(model.system.calcPotentialEnergy(batch[i]),
+                          model.system.calcPotentialEnergy(expected[i]));
+            batch[i].invalidateAllCacheAtOrAbove(Stage::Position);
+        }
+    }
+
+    // Realizing to a lower stage leaves the States there.
+    model.system.realizeBatch(states, Stage::Velocity, &executor);
+    for (const State& state : batch)
+        SimTK_TEST(state.getSystemStage() == Stage::Velocity);
+}
+
+// An exception from one State is rethrown after the rest are realized.
+void testBatchRethrows() {
+    BatchModel model;
+    State good1 = model.makeState(1), good2 = model.makeState(2);
+    State bad; // never set up for this System
+    Array_<State*> states{&good1, &bad, &good2};
+    ParallelExecutor executor(2);
+    SimTK_TEST_MUST_THROW(
+        model.system.realizeBatch(states, Stage::Dynamics, &executor));
+    SimTK_TEST(good1.getSystemStage() == Stage::Dynamics);
+    SimTK_TEST(good2.getSystemStage() == Stage::Dynamics);
+
+    MultibodySystem unrealized;
+    SimbodyMatterSubsystem matter(unrealized);
+    SimTK_TEST_MUST_THROW(
+        unrealized.realizeBatch(Array_<State*>(), Stage::Dynamics));
+}
+
+int main() {
+    SimTK_START_TEST("TestRealizeBatch");
+        SimTK_SUBTEST(testBatchMatchesSerial);
+        SimTK_SUBTEST(testBatchRethrows);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,246 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Integrates a stiff, damped multibody chain with the implicit integrators
+and their optional linear solvers and checks that they agree with the 
+default, and checks MultibodySystem's analytic ydot Jacobian. */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+
+// A chain hanging from a ball joint, then pins about alternating axes, with
+// stiff, damped springs at every pin. The springs' natural frequencies are
+// far above the motion we're following, which is what makes it stiff.
+// Optionally the first pin starts out pressed against a stop.
+class StiffChain {
+public:
+    explicit StiffChain(int numPins, bool withStop=false, Real k=1e4, 
+                        Real c=10)
+    :   matter(system), forces(system)
+    {
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(0.1)));
+        MobilizedBody parent = MobilizedBody::Ball(matter.Ground(), Vec3(0),
+                                                   body, Vec3(0, 0.5, 0));
+        for (int i=0; i < numPins; ++i) {
+            const Rotation axis = i % 2 ? Rotation(Pi/2, XAxis) : Rotation();
+            MobilizedBody::Pin pin(parent, Transform(axis, Vec3(0, -0.5, 0)),
+                                   body, Transform(axis, Vec3(0, 0.5, 0)));
+            Force::MobilityLinearSpring(forces, pin, MobilizerQIndex(0),
+                                        k, 0);
+            Force::MobilityLinearDamper(forces, pin, MobilizerUIndex(0), c);
+            if (withStop && i == 0)
+                Force::MobilityLinearStop(forces, pin, MobilizerQIndex(0),
+                                          1e5, 0.5, -0.1, 0.01);
+            parent = pin;
+        }
+        system.realizeTopology();
+    }
+
+    State makeInitialState() const {
+        State state = system.getDefaultState();
+        for (MobilizedBodyIndex mbx(2); mbx < matter.getNumBodies(); ++mbx)
+            matter.getMobilizedBody(mbx).setOneQ(state, 0, 0.01*(mbx % 3));
+        matter.getMobilizedBody(MobilizedBodyIndex(1))
+            .setQToFitRotation(state, Rotation(0.3, ZAxis));
+        system.realize(state, Stage::Model);
+        return state;
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+};
+
+static Vector integrateWith(const StiffChain& chain, Integrator& integ,
+                            Real finalTime, Real accuracy=1e-6) {
+    integ.setAccuracy(accuracy);
+    TimeStepper ts(chain.system, integ);
+    ts.initialize(chain.makeInitialState());
+    ts.stepTo(finalTime);
+    return ts.getState().getY();
+}
+
+// Central differences of ydot, for checking the analytic Jacobian.
+static Matrix calcNumericalYDotJacobian(const StiffChain& chain,
+                                        const State& state) {
+    const int ny = state.getNY();
+    Matrix J(ny, ny);
+    State tmp = state;
+    for (int j=0; j < ny; ++j) {
+        const Real dy = 1e-6;
+        tmp.updY()[j] = state.getY()[j] + dy;
+        chain.system.realize(tmp, Stage::Acceleration);
+        const Vector ydotPlus = tmp.getYDot();
+        tmp.updY()[j] = state.getY()[j] - dy;
+        chain.system.realize(tmp, Stage::Acceleration);
+        J(j) = (ydotPlus - tmp.getYDot()) / (2*dy);
+        tmp.updY()[j] = state.getY()[j];
+    }
+    return J;
+}
+
+void testFindMobilizerYBlocks() {
+    StiffChain chain(3);
+    const State state = chain.makeInitialState();
+
+    Array_< Array_<int> > blocks;
+    chain.matter.findMobilizerYBlocks(state, blocks);
+    SimTK_TEST(blocks.size() == 5);
+    SimTK_TEST(blocks[0].empty());
+    SimTK_TEST(blocks[1].size() == 7); // quaternion and angular velocity
+    for (int b=2; b < 5; ++b)
+        SimTK_TEST(blocks[b].size() == 2);
+
+    // The blocks partition y, and each starts with its mobilizer's q's.
+    Array_<int> count(state.getNY(), 0);
+    for (const Array_<int>& block : blocks)
+        for (int j : block)
+            ++count[j];
+    for (int j=0; j < state.getNY(); ++j)
+        SimTK_TEST(count[j] == 1);
+    const MobilizedBody& pin = chain.matter.getMobilizedBody
+                                                        (MobilizedBodyIndex(3));
+    SimTK_TEST(blocks[3][0] == state.getQStart() + pin.getFirstQIndex(state));
+    SimTK_TEST(blocks[3][1] == state.getUStart() + pin.getFirstUIndex(state));
+}
+
+void testCPodesLinearSolvers() {
+    StiffChain chain(8);
+    const Real finalTime = 0.2;
+
+    CPodesIntegrator dense(chain.system);
+    const Vector yDense = integrateWith(chain, dense, finalTime);
+
+    CPodesIntegrator krylov(chain.system);
+    krylov.setLinearSolver(CPodesIntegrator::KrylovLinearSolver);
+    Array_< Array_<int> > blocks;
+    chain.matter.findMobilizerYBlocks(chain.makeInitialState(), blocks);
+    krylov.setPreconditionerBlocks(blocks);
+    const Vector yKrylov = integrateWith(chain, krylov, finalTime);
+    SimTK_TEST_EQ_TOL(yKrylov, yDense, 1e-4);
+    SimTK_TEST(krylov.getNumKrylovIterations() > 0);
+    SimTK_TEST(krylov.getNumPreconditionerEvaluations() > 0);
+
+    // Through M^-1 every udot depends on every q and u, so a multibody
+    // Jacobian isn't banded; with a full band this must match the dense one.
+    const int ny = yDense.size();
+    CPodesIntegrator banded(chain.system);
+    banded.setLinearSolver(CPodesIntegrator::BandedLinearSolver);
+    banded.setJacobianBandwidth(ny-1, ny-1);
+    const Vector yBanded = integrateWith(chain, banded, finalTime);
+    SimTK_TEST_EQ_TOL(yBanded, yDense, 1e-4);
+
+    SimTK_TEST_MUST_THROW(
+        krylov.setLinearSolver(CPodesIntegrator::DenseLinearSolver));
+    CPodesIntegrator bad(chain.system);
+    SimTK_TEST_MUST_THROW(bad.setJacobianBandwidth(-1, 0));
+    SimTK_TEST_MUST_THROW(bad.setMaxKrylovDimension(-1));
+    bad.setLinearSolver(CPodesIntegrator::KrylovLinearSolver);
+    blocks[2].push_back(blocks[1][0]); // overlap
+    bad.setPreconditionerBlocks(blocks);
+    SimTK_TEST_MUST_THROW(integrateWith(chain, bad, finalTime));
+}
+
+// A force element that doesn't know its own derivatives.
+class NoDerivativesForce : public Force::Custom::Implementation {
+public:
+    void calcForce(const State&, Vector_<SpatialVec>&, Vector_<Vec3>&,
+                   Vector&) const override {}
+    Real calcPotentialEnergy(const State&) const override {return 0;}
+};
+
+// The u rows must match finite differences. Of the q rows we only get 
+// d qdot/d u = N; d qdot/d q is left out.
+void testYDotJacobian() {
+    StiffChain chain(3, true);
+    State state = chain.makeInitialState();
+    state.updU() = 0.3;
+    chain.system.realize(state, Stage::Velocity);
+
+    Matrix J;
+    SimTK_TEST(chain.system.calcYDotJacobian(state, J));
+    const Matrix Jnum = calcNumericalYDotJacobian(chain, state);
+    const int nq = state.getNQ(), nu = state.getNU();
+    SimTK_TEST(J.nrow() == nq+nu && J.ncol() == nq+nu);
+    // The stiff elements make some entries 1e5 times bigger than others, 
+    // so compare in norm; the difference is differencing noise.
+    const Matrix dUDot = J(nq, 0, nu, nq+nu) - Jnum(nq, 0, nu, nq+nu);
+    SimTK_TEST(dUDot.norm() <= 1e-8*J.norm());
+    SimTK_TEST_EQ_TOL(J(0, nq, nq, nu), Jnum(0, nq, nq, nu), 1e-8);
+    SimTK_TEST_EQ(J(0, 0, nq, nq), Matrix(nq, nq, Real(0)));
+
+    // A force element that can't supply derivatives turns this off.
+    Force::Custom(chain.forces, new NoDerivativesForce());
+    chain.system.realizeTopology();
+    State state2 = chain.makeInitialState();
+    chain.system.realize(state2, Stage::Velocity);
+    SimTK_TEST(!chain.system.calcYDotJacobian(state2, J));
+}
+
+// Here the springs are stiff enough and damped enough that an explicit 
+// integrator's step is limited by stability rather than accuracy.
+void testSDIRK3() {
+    StiffChain chain(8, true, 1e6, 1e3);
+    const Real finalTime = 0.2;
+
+    CPodesIntegrator cpodes(chain.system);
+    cpodes.setInternalStepLimit(5000);
+    const Vector yCPodes = integrateWith(chain, cpodes, finalTime);
+
+    SDIRK3Integrator sdirk(chain.system);
+    const Vector ySDIRK = integrateWith(chain, sdirk, finalTime);
+    SimTK_TEST_EQ_TOL(ySDIRK, yCPodes, 1e-4);
+    SimTK_TEST(sdirk.getNumJacobianEvaluations() 
+               < sdirk.getNumStepsTaken());
+    SimTK_TEST(sdirk.getNumFactorizations() < sdirk.getNumStepsTaken());
+
+    // Finite differences cost a ydot evaluation per state per Jacobian.
+    SDIRK3Integrator sdirkFD(chain.system);
+    sdirkFD.setUseSystemJacobian(false);
+    const Vector ySDIRKFD = integrateWith(chain, sdirkFD, finalTime);
+    SimTK_TEST_EQ_TOL(ySDIRKFD, yCPodes, 1e-4);
+    SimTK_TEST(sdirk.getNumRealizations() < sdirkFD.getNumRealizations());
+
+    SDIRK3Integrator sdirkLoose(chain.system);
+    RungeKuttaMersonIntegrator rkmLoose(chain.system);
+    integrateWith(chain, sdirkLoose, finalTime, 1e-3);
+    integrateWith(chain, rkmLoose, finalTime, 1e-3);
+    std::cout << "steps at 1e-3: SDIRK3 " << sdirkLoose.getNumStepsTaken() 
+              << ", RungeKuttaMerson " << rkmLoose.getNumStepsTaken() 
+              << std::endl;
+    SimTK_TEST(3*sdirkLoose.getNumStepsTaken() < rkmLoose.getNumStepsTaken());
+}
+
+int main() {
+    SimTK_START_TEST("TestStiffIntegration");
+        SimTK_SUBTEST(testFindMobilizerYBlocks);
+        SimTK_SUBTEST(testCPodesLinearSolvers);
+        SimTK_SUBTEST(testYDotJacobian);
+        SimTK_SUBTEST(testSDIRK3);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,138 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the cost of calculating constraint multipliers at Acceleration
+stage for two kinds of constrained models:
+  - "chains": many independent pendulum chains, each closed to Ground by a
+    ball constraint, so G*M^-1*~G has many small independent blocks;
+  - "loops": one long pin chain in which every link is tied to the link two
+    further along by a rod, so G*M^-1*~G is a single large block.
+For each it reports microseconds per Acceleration realization when q changes
+every time (so the constraint operator must be refactored) and when only u
+changes (so it is reused), along with the cost of forming and factoring the
+whole matrix densely with FactorQTZ, as was done on every realization before.
+
+Usage: ConstraintOperatorScaling [numRealizations]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+static const Vec3 Down(0, -1, 0);
+
+static Body::Rigid makeLink() {
+    return Body::Rigid(MassProperties(1, Down/2,
+        Inertia(0.01, 0.02, 0.03) + Inertia(Down/2, 1)));
+}
+
+static void buildChains(SimbodyMatterSubsystem& matter, int numChains) {
+    const Body::Rigid link = makeLink();
+    for (int c = 0; c < numChains; ++c) {
+        MobilizedBody parent = matter.Ground();
+        for (int i = 0; i < 4; ++i)
+            parent = MobilizedBody::Ball(parent,
+                i ? Down : Vec3(2*c, 0, 0), link, Vec3(0));
+        Constraint::Ball(matter.Ground(), Vec3(2*c + 1, -3, 0), parent, Down);
+    }
+}
+
+static void buildLoops(SimbodyMatterSubsystem& matter, int numLinks) {
+    const Body::Rigid link = makeLink();
+    Array_<MobilizedBody> links;
+    MobilizedBody parent = matter.Ground();
+    for (int i = 0; i < numLinks; ++i) {
+        parent = MobilizedBody::Pin(parent, i ? Down : Vec3(0), link,
+                                    Vec3(0));
+        links.push_back(parent);
+    }
+    for (int i = 0; i+2 < numLinks; i += 2)
+        Constraint::Rod(links[i], Vec3(0.3, 0, 0), links[i+2], Vec3(0.3, 0, 0),
+                        1.5);
+}
+
+static void report(const char* kind, int size, int numRealizations,
+                   bool chains) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    if (chains) buildChains(matter, size);
+    else buildLoops(matter, size);
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Random::Uniform random(-0.5, 0.5);
+    for (int i = 0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    system.realize(state, Stage::Time);
+    matter.normalizeQuaternions(state);
+    system.realize(state, Stage::Acceleration);
+    const int m = state.getNMultipliers();
+
+    double start = realTime();
+    for (int r = 0; r < numRealizations; ++r) {
+        state.updQ()[0] += 1e-6;
+        system.realize(state, Stage::Acceleration);
+    }
+    const double qTime = (realTime() - start) / numRealizations;
+
+    start = realTime();
+    for (int r = 0; r < numRealizations; ++r) {
+        state.updU()[0] += 1e-6;
+        system.realize(state, Stage::Acceleration);
+    }
+    const double uTime = (realTime() - start) / numRealizations;
+
+    const Vector rhs(m, Real(1));
+    Matrix GMInvGt;
+    Vector x;
+    start = realTime();
+    for (int r = 0; r < numRealizations; ++r) {
+        matter.calcProjectedMInv(state, GMInvGt);
+        FactorQTZ qtz(GMInvGt, m*SqrtEps*std::sqrt(SqrtEps));
+        qtz.solve(rhs, x);
+    }
+    const double denseTime = (realTime() - start) / numRealizations;
+
+    printf("  %6s %6d %6d %6d  %10.1f %10.1f %10.1f\n", kind, size,
+           state.getNU(), m, 1e6*qTime, 1e6*uTime, 1e6*denseTime);
+}
+
+int main(int argc, char** argv) {
+    const int numRealizations = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    printf("microseconds per Acceleration realization\n");
+    printf("  %6s %6s %6s %6s  %10s %10s %10s\n", "model", "size", "nu", "m",
+           "q changes", "u changes", "dense QTZ");
+    const int numChains[] = {10, 50, 200};
+    for (int n : numChains)
+        report("chains", n, numRealizations, true);
+    const int numLinks[] = {50, 200, 600};
+    for (int n : numLinks)
+        report("loops", n, numRealizations, false);
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures how the contact detection of GeneralContactSubsystem scales with
+the number of threads in an ElasticFoundationForce scene: a layer of mesh
+spheres resting on, and slightly sunk into, a half space.
+
+Usage: ElasticFoundationScaling [numBodies] [numRealizations]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+static double timeRealizations(int numBodies, int numThreads,
+                               int numRealizations) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem forces(system);
+    contacts.setNumberOfThreads(numThreads);
+    forces.setNumberOfThreads(1);
+
+    const ContactSetIndex setIndex = contacts.createContactSet();
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(),
+                     Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    const ContactGeometry::TriangleMesh ball
+        (PolygonalMesh::createSphereMesh(0.5, 3));
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    const int width = (int)std::ceil(std::sqrt(double(numBodies)));
+    for (int i = 0; i < numBodies; ++i) {
+        const MobilizedBody::Free mobod(matter.updGround(),
+            Vec3(1.1*(i % width), 0.45, 1.1*(i / width)), body, Transform());
+        contacts.addBody(setIndex, mobod, ball, Transform());
+    }
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    for (int i = 1; i <= numBodies; ++i) // 0 is the half space
+        ef.setBodyParameters(ContactSurfaceIndex(i), 1e6, 0.01, 0.5, 0.4, 0.1);
+
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    system.realize(state, Stage::Dynamics); // warm up
+
+    const double start = realTime();
+    for (int r = 0; r < numRealizations; ++r) {
+        state.invalidateAllCacheAtOrAbove(Stage::Position);
+        system.realize(state, Stage::Dynamics);
+    }
+    return (realTime() - start) / numRealizations;
+}
+
+int main(int argc, char** argv) {
+    const int numBodies = argc > 1 ? std::atoi(argv[1]) : 400;
+    const int numRealizations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    printf("%d mesh spheres on a half space; milliseconds per Dynamics "
+           "realization\n", numBodies);
+    printf("  threads       time\n");
+    const int threadCounts[] = {1, 2, 4, 8};
+    for (int numThreads : threadCounts)
+        printf("  %7d  %9.2f\n", numThreads,
+               1e3*timeRealizations(numBodies, numThreads, numRealizations));
+    return 0;
+}
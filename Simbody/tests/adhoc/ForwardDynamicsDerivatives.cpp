@@ -0,0 +1,132 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Compares two ways of obtaining dudot/dq, dudot/du and dudot/dtau for a
+humanoid-like tree (a free base with a torso and four 7-link limbs) under
+constant applied forces: numerically differentiating realize(Acceleration) 
+with Differentiator, as a trajectory optimizer would, and
+calcTreeForwardDynamicsDerivatives(). Gravity is applied as constant body 
+forces so that the two should agree.
+
+Usage: ForwardDynamicsDerivatives [numRepetitions]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+// f(q,u,tau) = udot, by realizing the full system.
+class ForwardDynamics : public Differentiator::JacobianFunction {
+public:
+    ForwardDynamics(const MultibodySystem& system, const State& state,
+                    Force::DiscreteForces& forces)
+    :   JacobianFunction(state.getNU(), state.getNQ() + 2*state.getNU()),
+        system(system), forces(forces), tmp(state) {}
+
+    int f(const Vector& y, Vector& fy) const override {
+        const int nq = tmp.getNQ(), nu = tmp.getNU();
+        tmp.updQ() = y(0, nq);
+        tmp.updU() = y(nq, nu);
+        forces.setAllMobilityForces(tmp, y(nq+nu, nu));
+        system.realize(tmp, Stage::Acceleration);
+        fy = tmp.getUDot();
+        return 0;
+    }
+private:
+    const MultibodySystem&  system;
+    Force::DiscreteForces&  forces;
+    mutable State           tmp;
+};
+
+int main(int argc, char** argv) {
+    const int numReps = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forceSubsys(system);
+    Force::DiscreteForces forces(forceSubsys, matter);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-0.5,0),
+        UnitInertia(0.1, 0.02, 0.1).shiftFromCentroid(Vec3(0,0.5,0))));
+    MobilizedBody::Free pelvis(matter.Ground(), link);
+    MobilizedBody::Ball torso(pelvis, Vec3(0,0.2,0), link, Vec3(0,-0.5,0));
+    const MobilizedBody roots[] = {pelvis, pelvis, torso, torso};
+    for (const MobilizedBody& root : roots) {
+        MobilizedBody parent = root;
+        for (int i = 0; i < 7; ++i)
+            parent = (i%3 == 0)
+                ? (MobilizedBody)MobilizedBody::Ball(parent, Vec3(0,-1,0),
+                                                     link, Vec3(0))
+                : (MobilizedBody)MobilizedBody::Pin(parent, Vec3(0,-1,0),
+                                                    link, Vec3(0));
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    Random::Uniform random(-0.5, 0.5);
+    for (int i = 0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i = 0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Time);
+    matter.normalizeQuaternions(state);
+
+    const int nb = matter.getNumBodies(), nq = state.getNQ(), nu = state.getNU();
+    Vector_<SpatialVec> bodyForces(nb, SpatialVec(Vec3(0), Vec3(0)));
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx)
+        bodyForces[mbx][1] = Vec3(0, -9.8, 0);
+    forces.setAllBodyForces(state, bodyForces);
+    Vector tau(nu);
+    for (int i = 0; i < nu; ++i) tau[i] = random.getValue();
+    forces.setAllMobilityForces(state, tau);
+    system.realize(state, Stage::Dynamics);
+    printf("%d bodies, nq=%d, nu=%d\n", nb-1, nq, nu);
+
+    ForwardDynamics fd(system, state, forces);
+    Differentiator differentiator(fd, Differentiator::CentralDifference);
+    Vector y(nq + 2*nu);
+    y(0, nq) = state.getQ(); y(nq, nu) = state.getU(); y(nq+nu, nu) = tau;
+    Matrix dfdy;
+    double start = realTime();
+    for (int r = 0; r < numReps; ++r)
+        dfdy = differentiator.calcJacobian(y);
+    const double numTime = (realTime() - start) / numReps;
+
+    Matrix dUDotdQ, dUDotdU, dUDotdTau;
+    start = realTime();
+    for (int r = 0; r < numReps; ++r)
+        matter.calcTreeForwardDynamicsDerivatives(state,
+            system.getMobilityForces(state, Stage::Dynamics),
+            system.getRigidBodyForces(state, Stage::Dynamics),
+            dUDotdQ, dUDotdU, dUDotdTau);
+    const double derivTime = (realTime() - start) / numReps;
+
+    const Real scale = dfdy.normRMS();
+    printf("  relative RMS differences: q %g, u %g, tau %g\n",
+           (dfdy(0,0,nu,nq) - dUDotdQ).normRMS()/scale,
+           (dfdy(0,nq,nu,nu) - dUDotdU).normRMS()/scale,
+           (dfdy(0,nq+nu,nu,nu) - dUDotdTau).normRMS()/scale);
+    printf("  milliseconds per Jacobian: Differentiator %.3f, "
+           "calcTreeForwardDynamicsDerivatives %.3f (%.1fx)\n", 
+           1e3*numTime, 1e3*derivTime, numTime/derivTime);
+    return 0;
+}
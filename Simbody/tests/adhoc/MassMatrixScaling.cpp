@@ -0,0 +1,129 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the cost of the explicit mass matrix quantities on a humanoid-like
+tree (a free base with a torso and four 7-link limbs): M, M^-1, and the
+operational space inertia Lambda = (J M^-1 ~J)^-1 for a few station tasks. For
+comparison it also forms M and M^-1 a column at a time with multiplyByM() and
+multiplyByMInv(), which is how calcM() and calcMInv() used to do it. The
+"new q" times include realizing Position stage and refactoring M; the others
+reuse the factorization cached in the State.
+
+Usage: MassMatrixScaling [numRepetitions]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+template <class F>
+static double timeReps(int numReps, F f) {
+    const double start = realTime();
+    for (int r = 0; r < numReps; ++r) f();
+    return 1e6*(realTime() - start)/numReps;
+}
+
+int main(int argc, char** argv) {
+    const int numReps = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-0.5,0),
+        UnitInertia(0.1, 0.02, 0.1).shiftFromCentroid(Vec3(0,0.5,0))));
+    MobilizedBody::Free pelvis(matter.Ground(), link);
+    MobilizedBody::Ball torso(pelvis, Vec3(0,0.2,0), link, Vec3(0,-0.5,0));
+    const MobilizedBody roots[] = {pelvis, pelvis, torso, torso};
+    Array_<MobilizedBodyIndex> hands;
+    for (const MobilizedBody& root : roots) {
+        MobilizedBody parent = root;
+        for (int i = 0; i < 7; ++i)
+            parent = (i%3 == 0)
+                ? (MobilizedBody)MobilizedBody::Ball(parent, Vec3(0,-1,0),
+                                                     link, Vec3(0))
+                : (MobilizedBody)MobilizedBody::Pin(parent, Vec3(0,-1,0),
+                                                    link, Vec3(0));
+        hands.push_back(parent.getMobilizedBodyIndex());
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    Random::Uniform random(-0.5, 0.5);
+    for (int i = 0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    system.realize(state, Stage::Time);
+    matter.normalizeQuaternions(state);
+    system.realize(state, Stage::Position);
+
+    const int nu = state.getNU();
+    printf("%d bodies, %d mobilities\n", matter.getNumBodies()-1, nu);
+    printf("microseconds per call\n");
+
+    Matrix M(nu,nu), MInv(nu,nu), Mcols(nu,nu), MInvcols(nu,nu);
+    Vector e(nu, Real(0));
+    const double mTime = timeReps(numReps, [&]{matter.calcM(state, M);});
+    const double mColsTime = timeReps(numReps, [&]{
+        for (int j = 0; j < nu; ++j) {
+            e[j] = 1; matter.multiplyByM(state, e, Mcols(j)); e[j] = 0;
+        }});
+    const double mInvTime = 
+        timeReps(numReps, [&]{matter.calcMInv(state, MInv);});
+    const double mInvColsTime = timeReps(numReps, [&]{
+        for (int j = 0; j < nu; ++j) {
+            e[j] = 1; matter.multiplyByMInv(state, e, MInvcols(j)); e[j] = 0;
+        }});
+    if ((M - Mcols).normRMS() > 1e-10*M.normRMS()
+        || (MInv - MInvcols).normRMS() > 1e-10*MInv.normRMS())
+        printf("  WARNING: matrices differ\n");
+
+    const Vector f = Test::randVector(nu);
+    Vector MInvf(nu);
+    const double mInvfTime = timeReps(numReps, [&]{
+        matter.multiplyByMInv(state, f, MInvf);});
+    const double mInvfFactorTime = timeReps(numReps, [&]{
+        matter.multiplyByMInvUsingMFactor(state, f, MInvf);});
+
+    // One station task on each hand.
+    const Array_<Vec3> stations(hands.size(), Vec3(0,-1,0));
+    Matrix J, Lambda;
+    matter.calcStationJacobian(state, hands, stations, J);
+    const double lambdaTime = timeReps(numReps, [&]{
+        matter.calcOperationalSpaceInertia(state, J, Lambda);});
+
+    const Vector q = state.getQ();
+    const double realizeTime = timeReps(numReps, [&]{
+        state.updQ() = q; system.realize(state, Stage::Position);});
+    const double lambdaNewQTime = timeReps(numReps, [&]{
+        state.updQ() = q; system.realize(state, Stage::Position);
+        matter.calcOperationalSpaceInertia(state, J, Lambda);});
+
+    printf("  %-28s %10.2f %10.2f (by columns)\n", "M", mTime, mColsTime);
+    printf("  %-28s %10.2f %10.2f (by columns)\n", "M^-1", mInvTime, 
+           mInvColsTime);
+    printf("  %-28s %10.2f %10.2f (multiplyByMInv)\n", "M^-1*f", 
+           mInvfFactorTime, mInvfTime);
+    printf("  %-28s %10.2f\n", "Lambda, 4 tasks", lambdaTime);
+    printf("  %-28s %10.2f\n", "realize Position", realizeTime);
+    printf("  %-28s %10.2f\n", "realize + Lambda, new q", lambdaNewQTime);
+    return 0;
+}
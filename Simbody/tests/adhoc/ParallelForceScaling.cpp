@@ -0,0 +1,116 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures how the Dynamics-stage force calculation of GeneralForceSubsystem
+scales with the number of bodies and threads when there are many cheap
+parallel forces that each touch only a couple of bodies. This is the case in
+which the per-thread force arrays, rather than the forces themselves, used to
+dominate: each thread zeroed and then added whole-system arrays under a lock.
+The "listed" column is for forces that list the bodies they affect, so only
+those entries of the threads' arrays are added up; the "unlisted" column is for
+the same forces without the list. One thread is the serial calculation.
+
+Usage: ParallelForceScaling [numForces] [numRealizations]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+// A spring-like force between two bodies chosen from the force's index.
+class PairForceImpl : public Force::Custom::Implementation {
+public:
+    PairForceImpl(MobilizedBodyIndex b1, MobilizedBodyIndex b2, bool listed)
+    :   b1(b1), b2(b2), listed(listed) {}
+    bool shouldBeParallelIfPossible() const override {return true;}
+    bool findAffectedBodiesAndMobilities(const State& state,
+            Array_<MobilizedBodyIndex>& bodies,
+            Array_<UIndex>& mobilities) const override {
+        if (!listed)
+            return false;
+        bodies.push_back(b1);
+        bodies.push_back(b2);
+        return true;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const override{
+        Real work = 0;
+        for (int i = 0; i < 200; ++i) // make it cost something
+            work += std::sin(i*0.01);
+        bodyForces[b1][1] += Vec3(work, 0, 0);
+        bodyForces[b2][1] -= Vec3(work, 0, 0);
+    }
+    Real calcPotentialEnergy(const State& state) const override {return 0;}
+private:
+    MobilizedBodyIndex b1, b2;
+    bool               listed;
+};
+
+static double timeRealizations(int numBodies, int numForces, int numThreads,
+                               bool listed, int numRealizations) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    forces.setNumberOfThreads(numThreads);
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    for (int i = 0; i < numBodies; ++i)
+        MobilizedBody::Free(matter.Ground(), Transform(Vec3(i,0,0)),
+                            body, Transform());
+    for (int f = 0; f < numForces; ++f)
+        Force::Custom(forces, new PairForceImpl(
+            MobilizedBodyIndex(1 + (f*7919) % numBodies),
+            MobilizedBodyIndex(1 + (f*104729) % numBodies), listed));
+
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    system.realize(state, Stage::Dynamics); // warm up
+
+    const double start = realTime();
+    for (int r = 0; r < numRealizations; ++r) {
+        state.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+        system.realize(state, Stage::Dynamics);
+    }
+    return (realTime() - start) / numRealizations;
+}
+
+int main(int argc, char** argv) {
+    const int numForces = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int numRealizations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    printf("%d two-body forces; microseconds per Dynamics realization\n",
+           numForces);
+    printf("   bodies  threads     listed   unlisted\n");
+    const int bodyCounts[] = {1000, 10000};
+    const int threadCounts[] = {1, 2, 4, 8};
+    for (int numBodies : bodyCounts)
+        for (int numThreads : threadCounts)
+            printf("  %7d  %7d  %9.1f  %9.1f\n", numBodies, numThreads,
+                   1e6*timeRealizations(numBodies, numForces, numThreads,
+                                        true, numRealizations),
+                   1e6*timeRealizations(numBodies, numForces, numThreads,
+                                        false, numRealizations));
+    return 0;
+}
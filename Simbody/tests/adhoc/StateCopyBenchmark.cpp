@@ -0,0 +1,97 @@
+/* -------------------------------------------------------------------------- *
+ *                      Simbody(tm): SimTKsimbody                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the cost of copying a realized State of a pendulum chain with a few
+forces, and of copying it and then realizing the copy through Position and
+through Acceleration stage, as an integrator, a visualizer queue or a state
+history would. The "repeat" case copies the same unmodified source again and
+again; the "after step" case modifies the source's q before each copy, which
+is the usual pattern while time stepping.
+
+Usage: StateCopyBenchmark [numBodies [numRepetitions]]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+template <class F>
+static double timeReps(int numReps, F f) {
+    const double start = realTime();
+    for (int r = 0; r < numReps; ++r) f();
+    return 1e6*(realTime() - start)/numReps;
+}
+
+int main(int argc, char** argv) {
+    const int numBodies = argc > 1 ? std::atoi(argv[1]) : 50;
+    const int numReps   = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-0.5,0),
+        UnitInertia(0.1, 0.02, 0.1).shiftFromCentroid(Vec3(0,0.5,0))));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < numBodies; ++i) {
+        MobilizedBody::Pin body(parent, Vec3(0,-1,0), link, Vec3(0));
+        Force::MobilityLinearDamper(forces, body, MobilizerUIndex(0), 0.1);
+        parent = body;
+    }
+
+    State source = system.realizeTopology();
+    for (int i=0; i < source.getNQ(); ++i) source.updQ()[i] = 0.01*i;
+    system.realize(source, Stage::Acceleration);
+
+    State copy;
+    std::printf("%d bodies, %d repetitions; microseconds per operation\n",
+                numBodies, numReps);
+    std::printf("  %-34s %10.2f\n", "copy (repeat)",
+        timeReps(numReps, [&] {copy = source;}));
+    std::printf("  %-34s %10.2f\n", "copy + realize Position (repeat)",
+        timeReps(numReps, [&] {
+            copy = source; system.realize(copy, Stage::Position);}));
+    std::printf("  %-34s %10.2f\n", "copy + realize Accel (repeat)",
+        timeReps(numReps, [&] {
+            copy = source; system.realize(copy, Stage::Acceleration);}));
+
+    // Modify and realize the source each time so it has written its values
+    // since the last copy, then copy it. The time to do the step alone is
+    // subtracted.
+    Real q0 = source.getQ()[0];
+    auto step = [&] {
+        source.updQ()[0] = (q0 += 1e-6);
+        system.realize(source, Stage::Acceleration);
+    };
+    const double stepOnly = timeReps(numReps, step);
+    std::printf("  %-34s %10.2f\n", "copy (after step)",
+        timeReps(numReps, [&] {step(); copy = source;}) - stepOnly);
+    std::printf("  %-34s %10.2f\n", "copy + realize Accel (after step)",
+        timeReps(numReps, [&] {
+            step(); copy = source; system.realize(copy, Stage::Acceleration);})
+        - stepOnly);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Times CPodesIntegrator on a long chain of pins joined by stiff, damped
+springs, comparing the dense linear solver with the Krylov solver, with and
+without the mobilizer block preconditioner.
+
+Usage: StiffChainLinearSolvers [numBodies [finalTime]]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int  n         = argc > 1 ? std::atoi(argv[1]) : 200;
+    const Real finalTime = argc > 2 ? std::atof(argv[2]) : 0.1;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(0.1)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < n; ++i) {
+        MobilizedBody::Pin pin(parent, Vec3(0, -0.1, 0), body, Vec3(0, 0.1, 0));
+        Force::MobilityLinearSpring(forces, pin, MobilizerQIndex(0), 1e4, 0);
+        Force::MobilityLinearDamper(forces, pin, MobilizerUIndex(0), 10);
+        parent = pin;
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    for (int i=0; i < n; ++i)
+        state.updQ()[i] = 0.01*(i % 5);
+    system.realize(state, Stage::Model);
+
+    Array_< Array_<int> > blocks;
+    matter.findMobilizerYBlocks(state, blocks);
+
+    printf("%d states, final time %g\n", state.getNY(), finalTime);
+    printf("  %-16s %8s %8s %10s %10s\n",
+           "solver", "steps", "Newton", "Krylov", "seconds");
+    for (int solver=0; solver < 3; ++solver) {
+        CPodesIntegrator integ(system);
+        integ.setAccuracy(1e-4);
+        const char* name = "dense";
+        if (solver > 0) {
+            integ.setLinearSolver(CPodesIntegrator::KrylovLinearSolver);
+            name = "Krylov";
+        }
+        if (solver > 1) {
+            integ.setPreconditionerBlocks(blocks);
+            name = "Krylov+blocks";
+        }
+        TimeStepper ts(system, integ);
+        ts.initialize(state);
+        const double start = realTime();
+        ts.stepTo(finalTime);
+        printf("  %-16s %8d %8d %10d %10.3f\n", name,
+               integ.getNumStepsTaken(), integ.getNumIterations(),
+               integ.getNumKrylovIterations(), realTime() - start);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measures the cost of the task-space quantities a whole-body controller needs
+each control step for many station tasks on a humanoid-like tree (a free base
+with a torso and four 7-link limbs): the 3*nt X n station Jacobian JS, the
+bias JSDot*u, and ~JS*f. For comparison it also forms JS a row at a time with
+multiplyByStationJacobianTranspose(), which is how calcStationJacobian() used
+to do it, costing three sweeps of the whole tree per task.
+
+Usage: TaskJacobianScaling [numRepetitions]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int numReps = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-0.5,0),
+        UnitInertia(0.1, 0.02, 0.1).shiftFromCentroid(Vec3(0,0.5,0))));
+    MobilizedBody::Free pelvis(matter.Ground(), link);
+    MobilizedBody::Ball torso(pelvis, Vec3(0,0.2,0), link, Vec3(0,-0.5,0));
+    const MobilizedBody roots[] = {pelvis, pelvis, torso, torso};
+    for (const MobilizedBody& root : roots) {
+        MobilizedBody parent = root;
+        for (int i = 0; i < 7; ++i)
+            parent = (i%3 == 0)
+                ? (MobilizedBody)MobilizedBody::Ball(parent, Vec3(0,-1,0),
+                                                     link, Vec3(0))
+                : (MobilizedBody)MobilizedBody::Pin(parent, Vec3(0,-1,0),
+                                                    link, Vec3(0));
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    Random::Uniform random(-0.5, 0.5);
+    for (int i = 0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i = 0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Time);
+    matter.normalizeQuaternions(state);
+    system.realize(state, Stage::Velocity);
+
+    const int nb = matter.getNumBodies(), nu = state.getNU();
+    printf("%d bodies, %d mobilities\n", nb-1, nu);
+    printf("microseconds per call\n");
+    printf("  %5s %10s %10s %10s %10s\n", "tasks", "JS", "JSDot*u", "~JS*f",
+           "JS by rows");
+
+    const int numTasks[] = {1, 10, 50};
+    for (int nt : numTasks) {
+        Array_<MobilizedBodyIndex> bodies(nt);
+        Array_<Vec3> stations(nt);
+        for (int t = 0; t < nt; ++t) {
+            bodies[t] = MobilizedBodyIndex(1 + (t*7) % (nb-1));
+            stations[t] = Vec3(random.getValue(), random.getValue(), 0);
+        }
+        Matrix JS(3*nt, nu);
+        Vector JSDotu(3*nt), f(nu);
+        const Vector_<Vec3> taskForces(nt, Vec3(1,2,3));
+
+        double start = realTime();
+        for (int r = 0; r < numReps; ++r)
+            matter.calcStationJacobian(state, bodies, stations, JS);
+        const double jsTime = (realTime() - start) / numReps;
+
+        start = realTime();
+        for (int r = 0; r < numReps; ++r)
+            matter.calcBiasForStationJacobian(state, bodies, stations, JSDotu);
+        const double biasTime = (realTime() - start) / numReps;
+
+        start = realTime();
+        for (int r = 0; r < numReps; ++r)
+            matter.multiplyByStationJacobianTranspose(state, bodies, stations,
+                                                      taskForces, f);
+        const double jtfTime = (realTime() - start) / numReps;
+
+        Matrix JSrows(3*nt, nu);
+        Vector_<Vec3> unitForces(nt, Vec3(0));
+        Vector col(nu);
+        start = realTime();
+        for (int r = 0; r < numReps; ++r) {
+            for (int t = 0; t < nt; ++t)
+                for (int k = 0; k < 3; ++k) {
+                    unitForces[t][k] = 1;
+                    matter.multiplyByStationJacobianTranspose(state, bodies,
+                        stations, unitForces, col);
+                    JSrows[3*t+k] = ~col;
+                    unitForces[t][k] = 0;
+                }
+        }
+        const double rowsTime = (realTime() - start) / numReps;
+        if ((JS - JSrows).normRMS() > 1e-12)
+            printf("  WARNING: Jacobians differ for %d tasks\n", nt);
+
+        printf("  %5d %10.2f %10.2f %10.2f %10.2f\n", nt, 1e6*jsTime,
+               1e6*biasTime, 1e6*jtfTime, 1e6*rowsTime);
+    }
+    return 0;
+}